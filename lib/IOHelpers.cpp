@@ -55,7 +55,7 @@ bool write_file_buffer(const std::filesystem::path& path, std::span<uint8_t> dat
     return true;
 }
 
-std::vector<uint8_t> auto_decompress(std::vector<uint8_t>& vec, size_t initial_size)
+std::vector<uint8_t> auto_decompress(const std::vector<uint8_t>& vec, size_t initial_size)
 {
     if (vec.size() < 2 || vec[0] != 0x1F && vec[1] != 0x8B)
     {
@@ -66,8 +66,17 @@ std::vector<uint8_t> auto_decompress(std::vector<uint8_t>& vec, size_t initial_s
         return out_vec;
     }
 
-    // we dont know what the decompressed size is, so we reallocate a buffer until we find the right size lol
+    // the gzip trailer holds the decompressed size modulo 2^32, which is exact for anything we load.
+    // if it's wrong anyway (e.g. the file is truncated), we reallocate a buffer until we find the right size
     size_t buf_size = initial_size;
+    if (vec.size() >= 18)
+    {
+        const size_t isize = vec[vec.size() - 4] | vec[vec.size() - 3] << 8 | vec[vec.size() - 2] << 16 | static_cast<size_t>(vec[vec.size() - 1]) << 24;
+        if (isize != 0)
+        {
+            buf_size = isize;
+        }
+    }
     auto out_buf = static_cast<uint8_t*>(malloc(buf_size));
     auto decompressor = libdeflate_alloc_decompressor();
     while (true)
@@ -0,0 +1,561 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/*
+ * Headless benchmark and movie replay harness for the core.
+ *
+ * Boots a rom (optionally playing back a movie) with stub plugins, runs the specified amount of VIs as fast as possible
+ * and prints the VI rate, the emulated instruction rate, savestate latencies and a hash of RDRAM at the last measured VI.
+ *
+ * Usage: mupen64-bench --rom <path> [--movie <path>] [--vis <count>] [--core <type>] [--st-iterations <count>] [--saves <path>] [--verbose]
+ */
+
+#include "stdafx.h"
+#include <core_api.h>
+#include <argh.h>
+#include <md5.h>
+#include <spdlog/sinks/stdout_sinks.h>
+
+// The size of RDRAM in bytes.
+constexpr size_t RDRAM_SIZE = 0x800000;
+
+// The name of the directory the harness creates inside the saves path, and which it clears before every run.
+constexpr auto SAVES_SUBDIRECTORY = "mupen64-bench-saves";
+
+struct t_bench_params {
+    std::filesystem::path rom_path;
+    std::filesystem::path movie_path;
+    std::filesystem::path saves_path;
+    size_t vis = 3600;
+    size_t st_iterations = 10;
+};
+
+struct t_bench_results {
+    std::chrono::high_resolution_clock::time_point start_time;
+    std::chrono::high_resolution_clock::time_point end_time;
+    uint64_t start_instructions;
+    uint64_t end_instructions;
+    std::string rdram_hash;
+    std::string telemetry;
+    std::vector<double> save_latencies;
+    std::vector<double> load_latencies;
+};
+
+static core_params g_core{};
+static core_cfg g_config{};
+static std::shared_ptr<spdlog::logger> g_logger;
+
+static t_bench_params g_params;
+static t_bench_results g_results;
+
+// Whether VIs are being counted. Set once the emulator is launched and, if a movie is played back, the playback has started.
+static std::atomic<bool> g_measuring = false;
+static size_t g_vi = 0;
+
+// Savestate measurement state, only accessed from the emulation thread.
+static bool g_st_pending = false;
+static std::chrono::high_resolution_clock::time_point g_st_request_time;
+static std::vector<uint8_t> g_st_buffer;
+
+static std::mutex g_done_mutex;
+static std::condition_variable g_done_cv;
+static bool g_done = false;
+
+#pragma region Stub Plugins
+
+static void __cdecl stub_void()
+{
+}
+
+static int32_t __cdecl stub_initiate_gfx(core_gfx_info)
+{
+    return 1;
+}
+
+static void __cdecl stub_read_screen(void**, int32_t*, int32_t*)
+{
+}
+
+static void __cdecl stub_move_screen(int32_t, int32_t)
+{
+}
+
+static void __cdecl stub_fb_read(uint32_t)
+{
+}
+
+static void __cdecl stub_fb_write(uint32_t, uint32_t)
+{
+}
+
+static void __cdecl stub_fb_get_frame_buffer_info(void*)
+{
+}
+
+static void __cdecl stub_ai_dacrate_changed(int32_t)
+{
+}
+
+static uint32_t __cdecl stub_ai_read_length()
+{
+    return 0;
+}
+
+static int32_t __cdecl stub_initiate_audio(core_audio_info)
+{
+    return 1;
+}
+
+static void __cdecl stub_ai_update(int32_t)
+{
+}
+
+static void __cdecl stub_controller_command(int32_t, unsigned char*)
+{
+}
+
+static void __cdecl stub_get_keys(int32_t, core_buttons* keys)
+{
+    *keys = {0};
+}
+
+static void __cdecl stub_set_keys(int32_t, core_buttons)
+{
+}
+
+static void __cdecl stub_initiate_controllers(core_input_info)
+{
+}
+
+static void __cdecl stub_key(uint32_t, int32_t)
+{
+}
+
+static uint32_t __cdecl stub_do_rsp_cycles(uint32_t cycles)
+{
+    return cycles;
+}
+
+static void __cdecl stub_initiate_rsp(core_rsp_info, uint32_t*)
+{
+}
+
+static core_plugin_funcs get_stub_plugin_funcs()
+{
+    return core_plugin_funcs{
+    .close_dll_gfx = stub_void,
+    .initiate_gfx = stub_initiate_gfx,
+    .process_d_list = stub_void,
+    .process_rdp_list = stub_void,
+    .rom_closed_gfx = stub_void,
+    .rom_open_gfx = stub_void,
+    .show_cfb = stub_void,
+    .update_screen = stub_void,
+    .vi_status_changed = stub_void,
+    .vi_width_changed = stub_void,
+    .read_screen = stub_read_screen,
+    .dll_crt_free = nullptr,
+    .move_screen = stub_move_screen,
+    .capture_screen = nullptr,
+    .get_video_size = nullptr,
+    .read_video = nullptr,
+    .fb_read = stub_fb_read,
+    .fb_write = stub_fb_write,
+    .fb_get_frame_buffer_info = stub_fb_get_frame_buffer_info,
+    .change_window = stub_void,
+
+    .ai_dacrate_changed = stub_ai_dacrate_changed,
+    .ai_len_changed = stub_void,
+    .ai_read_length = stub_ai_read_length,
+    .close_dll_audio = stub_void,
+    .initiate_audio = stub_initiate_audio,
+    .process_a_list = stub_void,
+    .rom_closed_audio = stub_void,
+    .rom_open_audio = stub_void,
+    .ai_update = stub_ai_update,
+
+    .close_dll_input = stub_void,
+    .controller_command = stub_controller_command,
+    .get_keys = stub_get_keys,
+    .set_keys = stub_set_keys,
+    .old_initiate_controllers = nullptr,
+    .initiate_controllers = stub_initiate_controllers,
+    .read_controller = stub_controller_command,
+    .rom_closed_input = stub_void,
+    .rom_open_input = stub_void,
+    .key_down = stub_key,
+    .key_up = stub_key,
+
+    .close_dll_rsp = stub_void,
+    .do_rsp_cycles = stub_do_rsp_cycles,
+    .initiate_rsp = stub_initiate_rsp,
+    .rom_closed_rsp = stub_void,
+    };
+}
+
+#pragma endregion
+
+static std::string hash_rdram()
+{
+    md5_state_t state;
+    md5_byte_t digest[16];
+    md5_init(&state);
+    md5_append(&state, reinterpret_cast<const md5_byte_t*>(g_core.rdram), RDRAM_SIZE);
+    md5_finish(&state, digest);
+
+    std::string hash;
+    for (const auto byte : digest)
+    {
+        hash += std::format("{:02X}", byte);
+    }
+    return hash;
+}
+
+static void signal_done()
+{
+    {
+        std::scoped_lock lock(g_done_mutex);
+        g_done = true;
+    }
+    g_done_cv.notify_all();
+}
+
+static double elapsed_ms(std::chrono::high_resolution_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - since).count();
+}
+
+/**
+ * Requests the next savestate operation. Saves and loads alternate, with each load restoring the preceding save.
+ * Operations are requested one at a time, as the task queue can't be modified from within a savestate callback.
+ */
+static void step_savestates()
+{
+    if (g_st_pending)
+    {
+        return;
+    }
+
+    if (g_results.load_latencies.size() >= g_params.st_iterations)
+    {
+        signal_done();
+        return;
+    }
+
+    g_st_pending = true;
+    g_st_request_time = std::chrono::high_resolution_clock::now();
+
+    if (g_results.save_latencies.size() == g_results.load_latencies.size())
+    {
+        core_st_do_memory({}, core_st_job_save, [](const core_result result, const std::vector<uint8_t>& buffer) {
+            g_results.save_latencies.push_back(elapsed_ms(g_st_request_time));
+            g_st_pending = false;
+
+            if (result != Res_Ok)
+            {
+                g_logger->error("Savestate save failed with error code {}", static_cast<int32_t>(result));
+                g_params.st_iterations = 0;
+                return;
+            }
+
+            g_st_buffer = buffer;
+        }, true);
+        return;
+    }
+
+    core_st_do_memory(g_st_buffer, core_st_job_load, [](const core_result result, const std::vector<uint8_t>&) {
+        g_results.load_latencies.push_back(elapsed_ms(g_st_request_time));
+        g_st_pending = false;
+
+        if (result != Res_Ok)
+        {
+            g_logger->error("Savestate load failed with error code {}", static_cast<int32_t>(result));
+            g_params.st_iterations = 0;
+        }
+    }, true);
+}
+
+static void on_vi()
+{
+    if (!g_measuring)
+    {
+        return;
+    }
+
+    const auto vi = g_vi++;
+
+    if (vi == 0)
+    {
+        g_results.start_time = std::chrono::high_resolution_clock::now();
+        g_results.start_instructions = core_vr_get_executed_instructions();
+        return;
+    }
+
+    if (vi < g_params.vis)
+    {
+        return;
+    }
+
+    if (vi == g_params.vis)
+    {
+        g_results.end_time = std::chrono::high_resolution_clock::now();
+        g_results.end_instructions = core_vr_get_executed_instructions();
+        g_results.rdram_hash = hash_rdram();
+        g_results.telemetry = core_tm_dump(g_params.vis);
+    }
+
+    step_savestates();
+}
+
+static std::wstring find_available_rom(const std::function<bool(const core_rom_header&)>& predicate)
+{
+    FILE* f = fopen(g_params.rom_path.string().c_str(), "rb");
+    if (!f)
+    {
+        return L"";
+    }
+
+    core_rom_header header{};
+    const auto read = fread(&header, sizeof(core_rom_header), 1, f);
+    fclose(f);
+
+    if (read != 1)
+    {
+        return L"";
+    }
+
+    core_vr_byteswap(reinterpret_cast<uint8_t*>(&header));
+
+    if (!predicate(header))
+    {
+        g_logger->error("The rom doesn't match the movie");
+        return L"";
+    }
+
+    return g_params.rom_path.wstring();
+}
+
+static void setup_controllers()
+{
+    for (auto& control : g_core.controls)
+    {
+        control = {};
+    }
+
+    if (g_params.movie_path.empty())
+    {
+        g_core.controls[0].Present = 1;
+        return;
+    }
+
+    core_vcr_movie_header header{};
+    if (core_vcr_parse_header(g_params.movie_path, &header) != Res_Ok)
+    {
+        return;
+    }
+
+    // The movie's controller setup has to be matched for playback to proceed without warnings
+    for (int32_t i = 0; i < 4; ++i)
+    {
+        g_core.controls[i].Present = (header.controller_flags & CONTROLLER_X_PRESENT(i)) != 0;
+
+        if (header.controller_flags & CONTROLLER_X_MEMPAK(i))
+        {
+            g_core.controls[i].Plugin = (int32_t)ce_mempak;
+        }
+        else if (header.controller_flags & CONTROLLER_X_RUMBLE(i))
+        {
+            g_core.controls[i].Plugin = (int32_t)ce_rumblepak;
+        }
+        else
+        {
+            g_core.controls[i].Plugin = (int32_t)ce_none;
+        }
+    }
+}
+
+static void init_core()
+{
+    g_logger = std::make_shared<spdlog::logger>("Core", std::make_shared<spdlog::sinks::stdout_sink_mt>());
+
+    // Benchmarks must be reproducible, so nothing that depends on timing or user interaction may be enabled
+    g_config.silent_mode = 1;
+    g_config.vcr_readonly = 1;
+    g_config.vcr_backups = 0;
+    g_config.is_movie_loop_enabled = 0;
+    g_config.st_undo_load = 0;
+    g_config.st_screenshot = 0;
+    g_config.seek_savestate_interval = 0;
+    g_config.max_lag = 0;
+    g_config.use_summercart = 0;
+
+    g_core.cfg = &g_config;
+    g_core.logger = g_logger.get();
+    g_core.callbacks = {};
+    g_core.callbacks.vi = on_vi;
+    g_core.callbacks.input = [](core_buttons*, int) {};
+    g_core.callbacks.frame = [] {};
+    g_core.callbacks.interval = [] {};
+    g_core.callbacks.ai_len_changed = [] {};
+    g_core.callbacks.play_movie = [] {
+        g_measuring = true;
+    };
+    g_core.callbacks.stop_movie = [] {};
+    g_core.callbacks.save_state = [] {};
+    g_core.callbacks.load_state = [] {};
+    g_core.callbacks.reset = [] {};
+    g_core.callbacks.seek_completed = [] {};
+    g_core.callbacks.load_plugins = [] {
+        return true;
+    };
+    g_core.callbacks.load_plugin_globals = [] {
+        g_core.plugin_funcs = get_stub_plugin_funcs();
+    };
+    g_core.callbacks.core_executing_changed = [](bool) {};
+    g_core.callbacks.emu_paused_changed = [](bool) {};
+    g_core.callbacks.emu_launched_changed = [](bool value) {
+        if (value && g_params.movie_path.empty())
+        {
+            g_measuring = true;
+        }
+    };
+    g_core.callbacks.emu_starting_changed = [](bool) {};
+    g_core.callbacks.emu_stopping = [] {};
+    g_core.callbacks.reset_completed = [] {};
+    g_core.callbacks.speed_modifier_changed = [](int32_t) {};
+    g_core.callbacks.warp_modify_status_changed = [](bool) {};
+    g_core.callbacks.current_sample_changed = [](int32_t) {};
+    g_core.callbacks.task_changed = [](core_vcr_task) {};
+    g_core.callbacks.rerecords_changed = [](uint64_t) {};
+    g_core.callbacks.unfreeze_completed = [] {};
+    g_core.callbacks.seek_savestate_changed = [](size_t) {};
+    g_core.callbacks.readonly_changed = [](bool) {};
+    g_core.callbacks.dacrate_changed = [](core_system_type) {};
+    g_core.callbacks.debugger_resumed_changed = [](bool) {};
+    g_core.callbacks.debugger_cpu_state_changed = [](core_dbg_cpu_state*) {};
+    g_core.callbacks.lag_limit_exceeded = [] {};
+    g_core.callbacks.seek_status_changed = [] {};
+    g_core.plugin_funcs = get_stub_plugin_funcs();
+    g_core.invoke_async = [](const std::function<void()>& func, size_t) {
+        std::thread(func).detach();
+    };
+    g_core.get_saves_directory = [] {
+        return g_params.saves_path;
+    };
+    g_core.show_multiple_choice_dialog = [](const std::vector<std::wstring>&, const wchar_t* str, const wchar_t*, core_dialog_type) -> size_t {
+        g_logger->warn(L"{}", str);
+        return 0;
+    };
+    g_core.show_ask_dialog = [](const wchar_t* str, const wchar_t*, bool) {
+        g_logger->warn(L"{}", str);
+        return true;
+    };
+    g_core.show_dialog = [](const wchar_t* str, const wchar_t*, core_dialog_type type) {
+        if (type == fsvc_error)
+        {
+            g_logger->error(L"{}", str);
+        }
+        else
+        {
+            g_logger->warn(L"{}", str);
+        }
+    };
+    g_core.show_statusbar = [](const wchar_t*) {};
+    g_core.update_screen = [] {};
+    g_core.copy_video = [](void*) {};
+    g_core.find_available_rom = find_available_rom;
+    g_core.load_screen = [](void*) {};
+    g_core.get_plugin_names = [](char* video, char* audio, char* input, char* rsp) {
+        for (const auto name : {video, audio, input, rsp})
+        {
+            if (name)
+            {
+                strncpy(name, "Benchmark Stub", 64);
+            }
+        }
+    };
+
+    core_init(&g_core);
+}
+
+static std::string format_latencies(std::vector<double> latencies)
+{
+    if (latencies.empty())
+    {
+        return "n/a";
+    }
+
+    std::ranges::sort(latencies);
+    const auto mean = std::accumulate(latencies.begin(), latencies.end(), 0.0) / latencies.size();
+    return std::format("min {:.2f}ms, median {:.2f}ms, mean {:.2f}ms ({} samples)", latencies.front(), latencies[latencies.size() / 2], mean, latencies.size());
+}
+
+static void print_results()
+{
+    const auto seconds = std::chrono::duration<double>(g_results.end_time - g_results.start_time).count();
+    const auto instructions = g_results.end_instructions - g_results.start_instructions;
+
+    std::puts(std::format("rom: {}", g_params.rom_path.string()).c_str());
+    std::puts(std::format("movie: {}", g_params.movie_path.empty() ? "none" : g_params.movie_path.string()).c_str());
+    std::puts(std::format("core type: {}", g_config.core_type).c_str());
+    std::puts(std::format("vis: {}", g_params.vis).c_str());
+    std::puts(std::format("elapsed: {:.3f}s", seconds).c_str());
+    std::puts(std::format("vi/s: {:.2f}", g_params.vis / seconds).c_str());
+    std::puts(std::format("instructions: {}", instructions).c_str());
+    std::puts(std::format("instructions/s: {:.0f}", instructions / seconds).c_str());
+    std::puts(std::format("savestate save: {}", format_latencies(g_results.save_latencies)).c_str());
+    std::puts(std::format("savestate load: {}", format_latencies(g_results.load_latencies)).c_str());
+    std::puts(std::format("rdram md5: {}", g_results.rdram_hash).c_str());
+    std::puts(std::format("telemetry: {}", g_results.telemetry).c_str());
+}
+
+int main(int argc, char* argv[])
+{
+    argh::parser cmdl(argc, argv, argh::parser::PREFER_PARAM_FOR_UNREG_OPTION);
+
+    g_params.rom_path = cmdl({"--rom", "-g"}, "").str();
+    g_params.movie_path = cmdl({"--movie", "-m64"}, "").str();
+    g_params.saves_path = std::filesystem::path(cmdl({"--saves"}, std::filesystem::temp_directory_path().string()).str()) / SAVES_SUBDIRECTORY;
+    cmdl({"--vis"}, g_params.vis) >> g_params.vis;
+    cmdl({"--st-iterations"}, g_params.st_iterations) >> g_params.st_iterations;
+    cmdl({"--core"}, g_config.core_type) >> g_config.core_type;
+
+    if (g_params.rom_path.empty() || g_params.vis == 0)
+    {
+        std::fputs("Usage: mupen64-bench --rom <path> [--movie <path>] [--vis <count>] [--core <0|1|2>] [--st-iterations <count>] [--saves <path>] [--verbose]\n", stderr);
+        return 1;
+    }
+
+    init_core();
+    g_logger->set_level(cmdl["--verbose"] ? spdlog::level::trace : spdlog::level::warn);
+
+    // Persistent saves left over from a previous run would make the results differ between runs.
+    // Only the harness' own subdirectory is cleared, never the directory passed as the saves path.
+    std::error_code ec;
+    std::filesystem::remove_all(g_params.saves_path, ec);
+    std::filesystem::create_directories(g_params.saves_path, ec);
+
+    setup_controllers();
+    core_vr_set_benchmark_enabled(true);
+
+    const auto result = g_params.movie_path.empty() ? core_vr_start_rom(g_params.rom_path, true) : core_vcr_start_playback(g_params.movie_path);
+    if (result != Res_Ok)
+    {
+        g_logger->error("Failed to start emulation with error code {}", static_cast<int32_t>(result));
+        return 1;
+    }
+
+    {
+        std::unique_lock lock(g_done_mutex);
+        g_done_cv.wait(lock, [] { return g_done; });
+    }
+
+    core_vr_close_rom(true, true);
+    core_vr_set_benchmark_enabled(false);
+
+    print_results();
+    return 0;
+}
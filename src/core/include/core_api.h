@@ -221,11 +221,6 @@ typedef struct {
 #pragma region Core-Provided
     core_controller controls[4];
 
-    core_timer_delta g_frame_deltas[core_timer_max_deltas];
-    std::mutex g_frame_deltas_mutex;
-    core_timer_delta g_vi_deltas[core_timer_max_deltas];
-    std::mutex g_vi_deltas_mutex;
-
     uint8_t* rom;
     uint32_t* rdram;
     core_rdram_reg* rdram_register;
@@ -352,6 +347,18 @@ EXPORT void CALL core_vr_toggle_fullscreen_mode();
  */
 EXPORT void CALL core_vr_set_fast_forward(bool);
 
+/**
+ * \brief Sets the benchmark mode state.
+ * \remarks In benchmark mode, the core runs as fast as possible and counts executed instructions.
+ */
+EXPORT void CALL core_vr_set_benchmark_enabled(bool);
+
+/**
+ * \brief Gets the amount of instructions executed while benchmark mode was enabled.
+ * \remarks The count is derived from the Count register at each VI, so it lags behind by up to one VI. Should be read from the emulation thread (e.g.: in the VI callback).
+ */
+EXPORT uint64_t CALL core_vr_get_executed_instructions();
+
 /**
  * \brief Gets whether tracelogging is active.
  */
@@ -597,16 +604,92 @@ EXPORT bool CALL core_vcr_has_seek_savestate_at_frame(size_t frame);
 /**
  * \brief Starts trace logging to the specified file.
  * \param path The output path.
- * \param binary Whether log output is in a binary format.
+ * \param format The log output's format.
  * \param append Whether log output will be appended to the file.
  */
-EXPORT void CALL core_tl_start(std::filesystem::path path, bool binary, bool append);
+EXPORT void CALL core_tl_start(std::filesystem::path path, core_tl_format format, bool append);
 
 /**
  * \brief Stops trace logging.
  */
 EXPORT void CALL core_tl_stop();
 
+/**
+ * \brief Converts a trace log in the compressed format to the text format.
+ * \param src The compressed trace log's path.
+ * \param dst The output path.
+ * \return The operation result.
+ */
+EXPORT core_result CALL core_tl_convert(const std::filesystem::path& src, const std::filesystem::path& dst);
+
+#pragma endregion
+
+#pragma region Profiler
+
+/**
+ * \brief Starts sampling the guest code. Samples are added to the ones collected previously.
+ * \param interval The amount of executed instructions between samples.
+ * \remarks
+ * Calls and returns are tracked through JAL, JALR, JR ra, exceptions and ERET to attribute samples to call stacks.
+ * Only the interpreter cores are profiled.
+ */
+EXPORT void CALL core_prof_start(uint32_t interval);
+
+/**
+ * \brief Stops sampling the guest code.
+ */
+EXPORT void CALL core_prof_stop();
+
+/**
+ * \brief Gets whether the guest code is being sampled.
+ */
+EXPORT bool CALL core_prof_is_active();
+
+/**
+ * \brief Discards the collected samples.
+ */
+EXPORT void CALL core_prof_reset();
+
+/**
+ * \brief Aggregates the collected samples by guest function.
+ * \param functions The functions which were sampled, ordered by descending self sample count.
+ */
+EXPORT void CALL core_prof_get_functions(std::vector<core_prof_function>& functions);
+
+/**
+ * \brief Writes the collected samples as folded stacks, which flamegraph tools can render.
+ * \param path The output path.
+ * \return The operation result.
+ */
+EXPORT core_result CALL core_prof_write_folded(const std::filesystem::path& path);
+
+#pragma endregion
+
+#pragma region Telemetry
+
+/**
+ * \brief Gets the timings of the most recent VIs.
+ * \param samples The buffer to write the timings to, from oldest to newest.
+ * \param count The buffer's capacity.
+ * \return The amount of timings written.
+ * \remarks Timings are recorded by the emulation thread without locking, so this function can be called from any thread at any rate.
+ */
+EXPORT size_t CALL core_tm_get_samples(core_tm_sample* samples, size_t count);
+
+/**
+ * \brief Computes statistics over the most recent VIs.
+ * \param count The maximum amount of VIs to compute the statistics over.
+ * \param stats The computed statistics.
+ */
+EXPORT void CALL core_tm_get_stats(size_t count, core_tm_stats* stats);
+
+/**
+ * \brief Computes statistics over the most recent VIs and formats them as JSON.
+ * \param count The maximum amount of VIs to compute the statistics over.
+ * \return The JSON document. Durations are in nanoseconds.
+ */
+EXPORT std::string CALL core_tm_dump(size_t count);
+
 #pragma endregion
 
 #pragma region Savestates
@@ -618,6 +701,7 @@ EXPORT void CALL core_tl_stop();
  * \param callback The callback to call when the operation is complete.
  * \param ignore_warnings Whether warnings, such as those about ROM compatibility, shouldn't be shown.
  * \warning The operation won't complete immediately. Must be called via AsyncExecutor unless calls are originating from the emu thread.
+ * \remarks Saves are compressed and written to disk in the background. The callback of a save is called once its file was written, usually from a background thread.
  * \return Whether the operation was enqueued.
  */
 EXPORT bool CALL core_st_do_file(const std::filesystem::path& path, core_st_job job, const core_st_callback& callback, bool ignore_warnings);
@@ -629,6 +713,7 @@ EXPORT bool CALL core_st_do_file(const std::filesystem::path& path, core_st_job
  * \param callback The callback to call when the operation is complete.
  * \param ignore_warnings Whether warnings, such as those about ROM compatibility, shouldn't be shown.
  * \warning The operation won't complete immediately. Must be called via AsyncExecutor unless calls are originating from the emu thread.
+ * \remarks Saves are compressed and written to disk in the background. The callback of a save is called once its file was written, usually from a background thread.
  * \return Whether the operation was enqueued.
  */
 EXPORT bool CALL core_st_do_slot(int32_t slot, core_st_job job, const core_st_callback& callback, bool ignore_warnings);
@@ -649,6 +734,40 @@ EXPORT bool CALL core_st_do_memory(const std::vector<uint8_t>& buffer, core_st_j
  */
 EXPORT void CALL core_st_get_undo_savestate(std::vector<uint8_t>& buffer);
 
+/**
+ * \brief Notifies the savestate system that RDRAM was modified from outside the core, e.g. by a script.
+ * \param addr The start address of the modified range.
+ * \param len The size of the modified range in bytes.
+ */
+EXPORT void CALL core_st_mark_rdram_dirty(uint32_t addr, uint32_t len);
+
+#pragma endregion
+
+#pragma region Bruteforcer
+
+/**
+ * \brief Starts a search for the best input sequences from a savestate.
+ * Starting from the root, every sequence in the search's current frame is extended by each of its input candidates.
+ * The extended sequences are scored one frame later and the best ones, as specified by the beam width, are extended in the next frame.
+ * \param params The search parameters.
+ * \return The operation result.
+ * \remarks
+ * The search runs on the emulation thread, driven by controller polls, so the emulator mustn't be paused.
+ * States are saved and loaded in memory as deltas without going through the savestate queue. No input callbacks are invoked during the search.
+ * Once finished, the root savestate is loaded again and the callback is invoked on the emulation thread.
+ */
+EXPORT core_result CALL core_bf_start(const core_bf_params& params);
+
+/**
+ * \brief Stops the running search. Its callback is invoked with <c>BF_Cancelled</c> and the sequences found so far.
+ */
+EXPORT void CALL core_bf_stop();
+
+/**
+ * \brief Gets whether a search is running.
+ */
+EXPORT bool CALL core_bf_is_running();
+
 #pragma endregion
 
 #pragma region Debugger
@@ -693,6 +812,24 @@ EXPORT void CALL core_dbg_set_rsp_enabled(bool);
  */
 EXPORT char* CALL core_dbg_disassemble(char* buf, uint32_t w, uint32_t pc);
 
+/**
+ * \brief Adds a watchpoint, which invokes a callback whenever the CPU accesses a range of RDRAM.
+ * \param addr The range's start address. Can be physical or in KSEG0/KSEG1.
+ * \param len The range's size in bytes.
+ * \param type The access types to watch.
+ * \param callback The callback, invoked on the emulation thread right after the access.
+ * \return The watchpoint's id, or 0 if the range isn't within RDRAM.
+ * \remarks Only accesses to the 64KB pages containing watched ranges are slowed down. DMA transfers don't trigger watchpoints.
+ * The watchpoint takes effect at the emulation thread's next interrupt.
+ */
+EXPORT size_t CALL core_dbg_add_watch(uint32_t addr, uint32_t len, core_dbg_watch_type type, const core_dbg_watch_callback& callback);
+
+/**
+ * \brief Removes a watchpoint.
+ * \param id The watchpoint's id.
+ */
+EXPORT void CALL core_dbg_remove_watch(size_t id);
+
 #pragma endregion
 
 #pragma region Cheats
@@ -9,6 +9,46 @@
 
 #include <cstdint>
 
+/**
+ * \brief The operation performed by a compiled cheat op.
+ */
+typedef enum : uint8_t {
+    /// Writes a byte.
+    cht_op_write8,
+    /// Writes a halfword.
+    cht_op_write16,
+    /// Writes a byte if the GameShark button is pressed.
+    cht_op_write8_gs,
+    /// Writes a halfword if the GameShark button is pressed.
+    cht_op_write16_gs,
+    /// Executes the following ops, which are all unconditional byte or halfword writes. The op's skip is the amount of writes.
+    cht_op_batch,
+    /// Continues if the byte equals the value, otherwise skips ahead.
+    cht_op_eq8,
+    /// Continues if the halfword equals the value, otherwise skips ahead.
+    cht_op_eq16,
+    /// Continues if the byte differs from the value, otherwise skips ahead.
+    cht_op_ne8,
+    /// Continues if the halfword differs from the value, otherwise skips ahead.
+    cht_op_ne16,
+} core_cheat_opcode;
+
+/**
+ * \brief An op of a compiled cheat.
+ */
+typedef struct {
+    core_cheat_opcode opcode;
+
+    /// The value to write or compare against, already masked to the access width.
+    uint16_t value;
+
+    /// The RDRAM byte offset being accessed, already adjusted for the access width and the host's byte order.
+    uint32_t offset;
+
+    /// The amount of ops to skip after this one: the jump distance of a failed comparison, or the length of a batch.
+    uint32_t skip;
+} core_cheat_op;
+
 /**
  * \brief Represents a cheat.
  */
@@ -16,7 +56,7 @@ typedef struct CoreCheat {
     std::wstring name = L"Unnamed Cheat";
     std::wstring code;
     bool active = true;
-    std::vector<std::tuple<bool, std::function<bool()>>> instructions;
+    std::vector<core_cheat_op> ops;
 } core_cheat;
 
 /**
@@ -106,6 +146,8 @@ typedef enum {
     ST_DecompressionError,
     // The event queue was too long
     ST_EventQueueTooLong,
+    // The savestate was created by a newer version with an unsupported format revision
+    ST_UnsupportedRevision,
     // The user cancelled the operation
     ST_Cancelled,
 #pragma endregion
@@ -116,6 +158,29 @@ typedef enum {
     // The plugin doesn't export a GetDllInfo function
     Pl_NoGetDllInfo,
 #pragma endregion
+
+#pragma region Bruteforcer
+    // A search is already running
+    BF_AlreadyRunning,
+    // The search parameters are invalid
+    BF_InvalidParams,
+    // Searching requires no movie to be playing or recording
+    BF_NeedsIdleVcr,
+    // The search was stopped before completing
+    BF_Cancelled,
+#pragma endregion
+
+#pragma region Profiler
+    // The profile file couldn't be opened
+    PF_FileOpenFailed,
+#pragma endregion
+
+#pragma region Tracelog
+    // The trace log file couldn't be opened
+    TL_FileOpenFailed,
+    // The trace log has an invalid format
+    TL_InvalidFormat,
+#pragma endregion
 } core_result;
 
 typedef enum {
@@ -1029,7 +1094,12 @@ typedef struct CoreCfg {
     /// <summary>
     /// The maximum amount of warp modify savestates to keep in memory
     /// </summary>
-    int32_t seek_savestate_max_count = 20;
+    int32_t seek_savestate_max_count = 100;
+
+    /// <summary>
+    /// The maximum amount of memory in megabytes used by warp modify savestates, or 0 for no limit
+    /// </summary>
+    int32_t seek_savestate_max_size = 512;
 
     /// <summary>
     /// Whether piano roll edits are constrained to the column they started on
@@ -1475,14 +1545,157 @@ typedef enum {
     core_st_medium_memory,
 } core_st_medium;
 
+typedef enum {
+    // Each instruction is logged as a line of text.
+    core_tl_format_text,
+    // Each instruction is logged as a binary record.
+    core_tl_format_binary,
+    // Instructions are logged as binary records, which are compressed and written on a background thread. Can be converted to text with <c>core_tl_convert</c>.
+    core_tl_format_compressed,
+} core_tl_format;
+
+typedef enum {
+    core_dbg_watch_read = 1 << 0,
+    core_dbg_watch_write = 1 << 1,
+    core_dbg_watch_read_write = core_dbg_watch_read | core_dbg_watch_write,
+} core_dbg_watch_type;
+
 using core_st_callback = std::function<void(core_result result, const std::vector<uint8_t>&)>;
 
-typedef std::common_type_t<std::chrono::duration<int64_t, std::ratio<1, 1000000000>>, std::chrono::duration<int64_t, std::ratio<1, 1000000000>>> core_timer_delta;
+/**
+ * \brief Invoked when a watched memory range is accessed.
+ * \param address The access's physical address.
+ * \param size The access's size in bytes.
+ * \param type The access's type.
+ * \param value The value which was read or written.
+ */
+using core_dbg_watch_callback = std::function<void(uint32_t address, uint32_t size, core_dbg_watch_type type, uint64_t value)>;
+
+/**
+ * \brief An input sequence found by the bruteforcer.
+ */
+typedef struct {
+    // The inputs, one per frame.
+    std::vector<core_buttons> inputs;
+    // The score of the state the inputs lead to.
+    double score;
+} core_bf_result;
+
+/**
+ * \brief Generates the input candidates to try after an input sequence.
+ * \param inputs The input sequence leading to the state the candidates are tried from. Empty for the root state.
+ */
+using core_bf_generator = std::function<std::vector<core_buttons>(const std::vector<core_buttons>& inputs)>;
+
+/**
+ * \brief Scores the state reached after an input sequence. Higher scores are better.
+ * \param rdram The RDRAM contents.
+ * \param inputs The input sequence.
+ * \return The score, or nothing if the sequence should be discarded along with all its continuations.
+ */
+using core_bf_scorer = std::function<std::optional<double>(const uint32_t* rdram, const std::vector<core_buttons>& inputs)>;
+
+/**
+ * \brief Invoked when a search finishes.
+ * \param result The search's result.
+ * \param results The best input sequences reaching the horizon, ordered from best to worst.
+ */
+using core_bf_callback = std::function<void(core_result result, const std::vector<core_bf_result>& results)>;
+
+/**
+ * \brief The parameters of a bruteforce search.
+ */
+typedef struct {
+    // The savestate the search starts from.
+    std::vector<uint8_t> root;
+    // The input candidate generator.
+    core_bf_generator generator;
+    // The scoring predicate.
+    core_bf_scorer scorer;
+    // The callback invoked when the search finishes.
+    core_bf_callback callback;
+    // The amount of frames to search.
+    size_t horizon;
+    // The amount of best sequences kept after each frame. 0 keeps all of them, making the search an exhaustive breadth-first one.
+    size_t beam_width;
+    // The maximum amount of sequences to report.
+    size_t result_count;
+    // The controller whose inputs are searched. The other controllers receive no input.
+    int32_t controller;
+} core_bf_params;
+
+/**
+ * \brief The samples the profiler attributed to a guest function.
+ */
+typedef struct {
+    // The function's entry address.
+    uint32_t address;
+    // The amount of samples taken while the function was executing its own code.
+    uint64_t self_samples;
+    // The amount of samples taken while the function or any of its callees were executing.
+    uint64_t total_samples;
+} core_prof_function;
+
+/**
+ * \brief The sections the time spent in a VI is split into.
+ */
+typedef enum {
+    // Emulating the CPU and everything else not covered by the other sections.
+    core_tm_cpu,
+    // Graphics tasks run by the RSP plugin, including the video plugin's display list processing.
+    core_tm_rsp_gfx,
+    // Audio and other tasks run by the RSP plugin.
+    core_tm_rsp_audio,
+    // The video plugin's screen updates.
+    core_tm_update_screen,
+    // The host's VI, frame and input callbacks, which include Lua callbacks.
+    core_tm_callbacks,
+    // Sleeping to limit the emulation speed.
+    core_tm_sleep,
+    // Waiting while paused or frame advancing.
+    core_tm_idle,
+    core_tm_section_count,
+} core_tm_section;
+
+/**
+ * \brief The timing of a VI.
+ */
+typedef struct {
+    // The VI's duration in nanoseconds.
+    uint64_t total;
+    // The time spent in each section in nanoseconds.
+    uint64_t sections[core_tm_section_count];
+    // The amount of frames generated during the VI.
+    uint32_t frames;
+} core_tm_sample;
+
+/**
+ * \brief The distribution of a duration over a set of VIs, in nanoseconds.
+ */
+typedef struct {
+    double mean;
+    uint64_t p50;
+    uint64_t p95;
+    uint64_t p99;
+    uint64_t max;
+} core_tm_distribution;
+
+/**
+ * \brief Statistics computed over the most recent VIs.
+ */
+typedef struct {
+    // The amount of VIs the statistics were computed over.
+    size_t sample_count;
+    double vis_per_second;
+    double frames_per_second;
+    // The distribution of the VIs' durations.
+    core_tm_distribution total;
+    // The distribution of the time spent in each section.
+    core_tm_distribution sections[core_tm_section_count];
+} core_tm_stats;
 
 typedef struct
 {
     uint32_t opcode;
     uint32_t address;
 } core_dbg_cpu_state;
-
-constexpr uint8_t core_timer_max_deltas = 60;
@@ -9,6 +9,7 @@
 #include "flashram.h"
 #include "memory.h"
 #include "pif.h"
+#include "savedata.h"
 #include "savestates.h"
 #include "stdafx.h"
 #include "summercart.h"
@@ -30,15 +31,13 @@ void dma_pi_read()
     {
         if (use_flashram != 1)
         {
-            fseek(g_sram_file, 0, SEEK_SET);
-            fread(sram, 1, 0x8000, g_sram_file);
-
             for (i = 0; i < (pi_register.pi_rd_len_reg & 0xFFFFFF) + 1; i++)
                 sram[((pi_register.pi_cart_addr_reg - 0x08000000) + i) ^ S8] = ((unsigned char*)rdram)[(pi_register.
                     pi_dram_addr_reg + i) ^ S8];
 
-            fseek(g_sram_file, 0, SEEK_SET);
-            fwrite(sram, 1, 0x8000, g_sram_file);
+            // The byte order swizzling keeps the accesses within the words covering the range
+            const uint32_t start = (pi_register.pi_cart_addr_reg - 0x08000000) & ~3;
+            save_mark_dirty(save_sram, start, (pi_register.pi_rd_len_reg & 0xFFFFFF) + 1 + 6);
             use_flashram = -1;
         }
         else
@@ -88,6 +87,9 @@ void dma_pi_write()
     uint32_t longueur;
     int32_t i;
 
+    // Covers every path below, including the flashram one
+    rdram_mark_range_dirty(pi_register.pi_dram_addr_reg, (pi_register.pi_wr_len_reg & 0xFFFFFF) + 1);
+
     if (pi_register.pi_cart_addr_reg < 0x10000000)
     {
         if (pi_register.pi_cart_addr_reg >= 0x08000000 &&
@@ -95,9 +97,6 @@ void dma_pi_write()
         {
             if (use_flashram != 1)
             {
-                fseek(g_sram_file, 0, SEEK_SET);
-                fread(sram, 1, 0x8000, g_sram_file);
-
                 for (i = 0; i < (pi_register.pi_wr_len_reg & 0xFFFFFF) + 1; i++)
                     ((unsigned char*)rdram)[(pi_register.pi_dram_addr_reg + i) ^ S8] =
                         sram[(((pi_register.pi_cart_addr_reg - 0x08000000) & 0xFFFF) + i) ^ S8];
@@ -204,9 +203,11 @@ void dma_pi_write()
         case 3:
         case 6:
             rdram[0x318 / 4] = 0x800000;
+            rdram_mark_dirty(0x318);
             break;
         case 5:
             rdram[0x3F0 / 4] = 0x800000;
+            rdram_mark_dirty(0x3F0);
             break;
         }
     }
@@ -237,6 +238,7 @@ void dma_sp_write()
 void dma_sp_read()
 {
     int32_t i;
+    rdram_mark_range_dirty(sp_register.sp_dram_addr_reg, (sp_register.sp_wr_len_reg & 0xFFF) + 1);
     if ((sp_register.sp_mem_addr_reg & 0x1000) > 0)
     {
         for (i = 0; i < ((sp_register.sp_wr_len_reg & 0xFFF) + 1); i++)
@@ -277,6 +279,7 @@ void dma_si_read()
     update_pif_read();
     for (i = 0; i < (64 / 4); i++)
         rdram[si_register.si_dram_addr / 4 + i] = sl(PIF_RAM[i]);
+    rdram_mark_range_dirty(si_register.si_dram_addr, 64);
     if (!g_st_skip_dma) //st already did this, see savestates.cpp, we still copy pif ram tho because it has new inputs
     {
         update_count();
@@ -10,12 +10,14 @@
 #include "flashram.h"
 #include "pif.h"
 #include "summercart.h"
+#include "watchpoints.h"
 #include <core/Core.h>
 #include <core/r4300/interrupt.h>
 #include <core/r4300/macros.h>
 #include <core/r4300/ops.h>
 #include <core/r4300/r4300.h>
 #include <core/r4300/recomph.h>
+#include <core/r4300/telemetry.h>
 #include <core/r4300/timers.h>
 #include <core/r4300/vcr.h>
 
@@ -39,6 +41,8 @@ uint8_t flashram[0x20000];
 uint8_t eeprom[0x800];
 uint8_t mempack[4][0x8000];
 uint8_t* rdramb = (uint8_t*)rdram;
+uint8_t g_rdram_dirty_pages[0x800000 / DIRTY_PAGE_SIZE];
+uint32_t g_rdram_page_generations[0x800000 / DIRTY_PAGE_SIZE];
 uint32_t SP_DMEM[0x1000 / 4 * 2];
 uint32_t* SP_IMEM = SP_DMEM + 0x1000 / 4;
 unsigned char* SP_DMEMb = (unsigned char*)(SP_DMEM);
@@ -127,6 +131,7 @@ int32_t init_memory()
     //init RDRAM
     for (i = 0; i < (0x800000 / 4); i++)
         rdram[i] = 0;
+    rdram_mark_all_dirty();
     for (i = 0; i < /*0x40*/0x80; i++)
     {
         readmem[(0x8000 + i)] = read_rdram;
@@ -1019,6 +1024,8 @@ int32_t init_memory()
     fast_memory = 1;
     firstFrameBufferSetting = 1;
 
+    watch_apply_traps();
+
     g_core->logger->info("memory initialized");
     return 0;
 }
@@ -1205,7 +1212,9 @@ void update_SP()
             g_vr_frame_skipped = is_frame_skipped();
             if (!g_vr_frame_skipped)
             {
+                t_tm_scope scope(core_tm_rsp_gfx);
                 g_core->plugin_funcs.do_rsp_cycles(100);
+                rdram_mark_all_dirty();
             }
 
             rsp_register.rsp_pc |= save_pc;
@@ -1278,6 +1287,9 @@ void update_SP()
                     }
                 }
             }
+
+            // the framebuffer handlers might have replaced watchpoint traps
+            watch_apply_traps();
         }
         else if (SP_DMEM[0xFC0 / 4] == 2)
         {
@@ -1286,7 +1298,9 @@ void update_SP()
 
             if (!g_vr_fast_forward || !g_core->cfg->fastforward_silent)
             {
+                t_tm_scope scope(core_tm_rsp_audio);
                 g_core->plugin_funcs.do_rsp_cycles(100);
+                rdram_mark_all_dirty();
             }
             rsp_register.rsp_pc |= save_pc;
 
@@ -1302,7 +1316,9 @@ void update_SP()
             rsp_register.rsp_pc &= 0xFFF;
             if (!g_vr_fast_forward || !g_core->cfg->fastforward_silent)
             {
+                t_tm_scope scope(core_tm_rsp_audio);
                 g_core->plugin_funcs.do_rsp_cycles(100);
+                rdram_mark_all_dirty();
             }
             rsp_register.rsp_pc |= save_pc;
 
@@ -1564,22 +1580,52 @@ void read_rdramFBd()
 void write_rdram()
 {
     *((uint32_t*)(rdramb + (address & 0xFFFFFF))) = word;
+    rdram_mark_dirty(address);
 }
 
 void write_rdramb()
 {
     *((rdramb + ((address & 0xFFFFFF) ^ S8))) = g_byte;
+    rdram_mark_dirty(address);
 }
 
 void write_rdramh()
 {
     *(uint16_t*)((rdramb + ((address & 0xFFFFFF) ^ S16))) = hword;
+    rdram_mark_dirty(address);
 }
 
 void write_rdramd()
 {
     *((uint32_t*)(rdramb + (address & 0xFFFFFF))) = dword >> 32;
     *((uint32_t*)(rdramb + (address & 0xFFFFFF) + 4)) = dword & 0xFFFFFFFF;
+    rdram_mark_dirty(address);
+}
+
+void rdram_mark_range_dirty(uint32_t offset, uint32_t length)
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    offset &= AddrMask;
+    const uint32_t first = offset / DIRTY_PAGE_SIZE;
+    const uint32_t last = std::min(offset + length - 1, AddrMask) / DIRTY_PAGE_SIZE;
+    memset(g_rdram_dirty_pages + first, 1, last - first + 1);
+    for (uint32_t page = first; page <= last; ++page)
+    {
+        ++g_rdram_page_generations[page];
+    }
+}
+
+void rdram_mark_all_dirty()
+{
+    memset(g_rdram_dirty_pages, 1, sizeof(g_rdram_dirty_pages));
+    for (auto& generation : g_rdram_page_generations)
+    {
+        ++generation;
+    }
 }
 
 void write_rdramFB()
@@ -2067,6 +2113,7 @@ void write_dp()
         break;
     case 0x4:
         g_core->plugin_funcs.process_rdp_list();
+        rdram_mark_all_dirty();
         MI_register.mi_intr_reg |= 0x20;
         check_interrupt();
         break;
@@ -2122,6 +2169,7 @@ void write_dpb()
     case 0x6:
     case 0x7:
         g_core->plugin_funcs.process_rdp_list();
+        rdram_mark_all_dirty();
         MI_register.mi_intr_reg |= 0x20;
         check_interrupt();
         break;
@@ -2161,6 +2209,7 @@ void write_dph()
     case 0x4:
     case 0x6:
         g_core->plugin_funcs.process_rdp_list();
+        rdram_mark_all_dirty();
         MI_register.mi_intr_reg |= 0x20;
         check_interrupt();
         break;
@@ -2188,6 +2237,7 @@ void write_dpd()
     case 0x0:
         dpc_register.dpc_current = dpc_register.dpc_start;
         g_core->plugin_funcs.process_rdp_list();
+        rdram_mark_all_dirty();
         MI_register.mi_intr_reg |= 0x20;
         check_interrupt();
         break;
@@ -3700,3 +3750,62 @@ void write_sc_regd()
 {
     write_summercart(address, dword >> 32);
 }
+
+template <typename T>
+std::optional<T> mem_load_slow(uint32_t vaddr)
+{
+    uint64_t value = 0;
+    address = vaddr;
+    rdword = &value;
+
+    if constexpr (sizeof(T) == 1)
+        read_byte_in_memory();
+    else if constexpr (sizeof(T) == 2)
+        read_hword_in_memory();
+    else if constexpr (sizeof(T) == 4)
+        read_word_in_memory();
+    else
+        read_dword_in_memory();
+
+    // The nomem handlers zero the address when the TLB lookup raised an exception, in which case nothing was read
+    if (!address)
+        return std::nullopt;
+
+    return (T)value;
+}
+
+template <typename T>
+void mem_store_slow(uint32_t vaddr, T value)
+{
+    address = vaddr;
+
+    if constexpr (sizeof(T) == 1)
+    {
+        g_byte = value;
+        write_byte_in_memory();
+    }
+    else if constexpr (sizeof(T) == 2)
+    {
+        hword = value;
+        write_hword_in_memory();
+    }
+    else if constexpr (sizeof(T) == 4)
+    {
+        word = value;
+        write_word_in_memory();
+    }
+    else
+    {
+        dword = value;
+        write_dword_in_memory();
+    }
+}
+
+template std::optional<uint8_t> mem_load_slow<uint8_t>(uint32_t);
+template std::optional<uint16_t> mem_load_slow<uint16_t>(uint32_t);
+template std::optional<uint32_t> mem_load_slow<uint32_t>(uint32_t);
+template std::optional<uint64_t> mem_load_slow<uint64_t>(uint32_t);
+template void mem_store_slow<uint8_t>(uint32_t, uint8_t);
+template void mem_store_slow<uint16_t>(uint32_t, uint16_t);
+template void mem_store_slow<uint32_t>(uint32_t, uint32_t);
+template void mem_store_slow<uint64_t>(uint32_t, uint64_t);
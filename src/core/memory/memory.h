@@ -25,6 +25,42 @@ extern uint32_t PIF_RAM[0x40 / 4];
 extern unsigned char* PIF_RAMb;
 extern uint32_t rdram[0x800000 / 4];
 extern uint8_t* rdramb;
+
+/**
+ * \brief The granularity at which modifications to RDRAM are tracked, in bytes.
+ */
+constexpr uint32_t DIRTY_PAGE_SIZE = 0x1000;
+
+/**
+ * \brief Flags for each RDRAM page, set whenever the page is written to. Consumed by the delta savestate encoder.
+ */
+extern uint8_t g_rdram_dirty_pages[0x800000 / DIRTY_PAGE_SIZE];
+
+/**
+ * \brief Counters for each RDRAM page, incremented whenever the page is written to.
+ * Unlike the dirty flags they're never reset, so any number of consumers can compare against the value they last saw.
+ */
+extern uint32_t g_rdram_page_generations[0x800000 / DIRTY_PAGE_SIZE];
+
+/**
+ * \brief Marks the RDRAM page containing the specified offset as modified.
+ */
+inline void rdram_mark_dirty(uint32_t offset)
+{
+    const uint32_t page = (offset & AddrMask) / DIRTY_PAGE_SIZE;
+    g_rdram_dirty_pages[page] = 1;
+    ++g_rdram_page_generations[page];
+}
+
+/**
+ * \brief Marks the RDRAM pages overlapping the specified range as modified.
+ */
+void rdram_mark_range_dirty(uint32_t offset, uint32_t length);
+
+/**
+ * \brief Marks all of RDRAM as modified. Used after writes whose extent isn't known, such as the ones done by plugins.
+ */
+void rdram_mark_all_dirty();
 extern uint8_t sram[0x8000];
 extern uint8_t flashram[0x20000];
 extern uint8_t eeprom[0x800];
@@ -277,4 +313,113 @@ template <typename T>
 extern void StoreRDRAMSafe(uint32_t addr, T value)
 {
     *((T*)(rdramb + ((ToAddr<T>(addr) & AddrMask)))) = value;
+    rdram_mark_dirty(ToAddr<T>(addr));
+}
+
+/**
+ * \brief Reads a value through the memory handler tables, without any fast path
+ * \tparam T The value's type. Must be uint8_t, uint16_t, uint32_t or uint64_t.
+ * \param vaddr The virtual address of the value
+ * \return The value, or std::nullopt if the address translation raised an exception
+ */
+template <typename T>
+std::optional<T> mem_load_slow(uint32_t vaddr);
+
+/**
+ * \brief Writes a value through the memory handler tables, without any fast path
+ * \tparam T The value's type. Must be uint8_t, uint16_t, uint32_t or uint64_t.
+ * \param vaddr The virtual address of the value
+ * \param value The value to write
+ */
+template <typename T>
+void mem_store_slow(uint32_t vaddr, T value);
+
+/**
+ * \brief Reads a value from the specified virtual address
+ * \tparam T The value's type. Must be uint8_t, uint16_t, uint32_t or uint64_t.
+ * \param vaddr The virtual address of the value
+ * \return The value, or std::nullopt if the address translation raised an exception
+ * \remarks Plain RDRAM accesses are served inline. Everything else, including framebuffer-protected pages, goes through the <c>readmem</c> tables.
+ */
+template <typename T>
+std::optional<T> mem_load(uint32_t vaddr)
+{
+    const uint32_t offset = vaddr & 0xFFFFFF;
+
+    if constexpr (sizeof(T) == 1)
+    {
+        if (readmemb[vaddr >> 16] == read_rdramb)
+            return *(rdramb + (offset ^ S8));
+    }
+    else if constexpr (sizeof(T) == 2)
+    {
+        if (readmemh[vaddr >> 16] == read_rdramh)
+            return *(uint16_t*)(rdramb + (offset ^ S16));
+    }
+    else if constexpr (sizeof(T) == 4)
+    {
+        if (readmem[vaddr >> 16] == read_rdram)
+            return *(uint32_t*)(rdramb + offset);
+    }
+    else
+    {
+        if (readmemd[vaddr >> 16] == read_rdramd)
+            return ((uint64_t)*(uint32_t*)(rdramb + offset) << 32) | *(uint32_t*)(rdramb + offset + 4);
+    }
+
+    return mem_load_slow<T>(vaddr);
+}
+
+/**
+ * \brief Writes a value to the specified virtual address
+ * \tparam T The value's type. Must be uint8_t, uint16_t, uint32_t or uint64_t.
+ * \param vaddr The virtual address of the value
+ * \param value The value to write
+ * \remarks Plain RDRAM accesses are served inline. Everything else, including framebuffer-protected pages, goes through the <c>writemem</c> tables.
+ * No code invalidation is performed, callers running under the recompiler must take care of it.
+ */
+template <typename T>
+void mem_store(uint32_t vaddr, T value)
+{
+    const uint32_t offset = vaddr & 0xFFFFFF;
+
+    if constexpr (sizeof(T) == 1)
+    {
+        if (writememb[vaddr >> 16] == write_rdramb)
+        {
+            *(rdramb + (offset ^ S8)) = value;
+            rdram_mark_dirty(offset);
+            return;
+        }
+    }
+    else if constexpr (sizeof(T) == 2)
+    {
+        if (writememh[vaddr >> 16] == write_rdramh)
+        {
+            *(uint16_t*)(rdramb + (offset ^ S16)) = value;
+            rdram_mark_dirty(offset);
+            return;
+        }
+    }
+    else if constexpr (sizeof(T) == 4)
+    {
+        if (writemem[vaddr >> 16] == write_rdram)
+        {
+            *(uint32_t*)(rdramb + offset) = value;
+            rdram_mark_dirty(offset);
+            return;
+        }
+    }
+    else
+    {
+        if (writememd[vaddr >> 16] == write_rdramd)
+        {
+            *(uint32_t*)(rdramb + offset) = value >> 32;
+            *(uint32_t*)(rdramb + offset + 4) = value & 0xFFFFFFFF;
+            rdram_mark_dirty(offset);
+            return;
+        }
+    }
+
+    mem_store_slow<T>(vaddr, value);
 }
@@ -9,9 +9,12 @@
 #include <core/memory/memory.h>
 #include <core/memory/pif.h>
 #include <core/memory/pif_lut.h>
+#include <core/memory/savedata.h>
 #include <core/memory/savestates.h>
+#include <core/r4300/bruteforce.h>
 #include <core/r4300/gameshark.h>
 #include <core/r4300/r4300.h>
+#include <core/r4300/telemetry.h>
 #include <core/r4300/vcr.h>
 
 int32_t frame_advancing = 0;
@@ -59,19 +62,13 @@ void EepromCommand(uint8_t* Command)
         break;
     case 4: // read
         {
-            fseek(g_eeprom_file, 0, SEEK_SET);
-            fread(eeprom, 1, 0x800, g_eeprom_file);
             memcpy(&Command[4], eeprom + Command[3] * 8, 8);
         }
         break;
     case 5: // write
         {
-            fseek(g_eeprom_file, 0, SEEK_SET);
-            fread(eeprom, 1, 0x800, g_eeprom_file);
             memcpy(eeprom + Command[3] * 8, &Command[4], 8);
-
-            fseek(g_eeprom_file, 0, SEEK_SET);
-            fwrite(eeprom, 1, 0x800, g_eeprom_file);
+            save_mark_dirty(save_eeprom, Command[3] * 8, 8);
         }
         break;
     default:
@@ -143,7 +140,10 @@ void internal_ReadController(int32_t Control, uint8_t* Command)
 
             lag_count = 0;
             core_buttons input = {0};
-            vcr_on_controller_poll(Control, &input);
+            if (!bf_on_controller_poll(Control, &input))
+            {
+                vcr_on_controller_poll(Control, &input);
+            }
             *((uint32_t*)(Command + 3)) = input.Value;
 #ifdef COMPARE_CORE
             check_input_sync(Command + 3);
@@ -211,12 +211,6 @@ void internal_ControllerCommand(int32_t Control, uint8_t* Command)
                         address &= 0xFFE0;
                         if (address <= 0x7FE0)
                         {
-                            fseek(g_mpak_file, 0, SEEK_SET);
-                            fread(mempack[0], 1, 0x8000, g_mpak_file);
-                            fread(mempack[1], 1, 0x8000, g_mpak_file);
-                            fread(mempack[2], 1, 0x8000, g_mpak_file);
-                            fread(mempack[3], 1, 0x8000, g_mpak_file);
-
                             memcpy(&Command[5], &mempack[Control][address], 0x20);
                         }
                         else
@@ -254,19 +248,8 @@ void internal_ControllerCommand(int32_t Control, uint8_t* Command)
                         address &= 0xFFE0;
                         if (address <= 0x7FE0)
                         {
-                            fseek(g_mpak_file, 0, SEEK_SET);
-                            fread(mempack[0], 1, 0x8000, g_mpak_file);
-                            fread(mempack[1], 1, 0x8000, g_mpak_file);
-                            fread(mempack[2], 1, 0x8000, g_mpak_file);
-                            fread(mempack[3], 1, 0x8000, g_mpak_file);
-
                             memcpy(&mempack[Control][address], &Command[5], 0x20);
-
-                            fseek(g_mpak_file, 0, SEEK_SET);
-                            fwrite(mempack[0], 1, 0x8000, g_mpak_file);
-                            fwrite(mempack[1], 1, 0x8000, g_mpak_file);
-                            fwrite(mempack[2], 1, 0x8000, g_mpak_file);
-                            fwrite(mempack[3], 1, 0x8000, g_mpak_file);
+                            save_mark_dirty(save_mempak, Control * sizeof(mempack[0]) + address, 0x20);
                         }
                         Command[0x25] = mempack_crc(&Command[5]);
                     }
@@ -418,6 +401,8 @@ void update_pif_read()
                     {
                         once = false;
 
+                        t_tm_scope idle_scope(core_tm_idle);
+
                         if (g_wait_counter == 0)
                         {
                             frame_advancing = 0;
@@ -448,6 +433,7 @@ void update_pif_read()
                     if (stAllowed)
                     {
                         st_do_work();
+                        bf_on_pif_read();
                     }
                     if (g_st_old)
                     {
@@ -466,6 +452,7 @@ void update_pif_read()
                     {
                         g_core->plugin_funcs.read_controller(channel, &PIF_RAMb[i]);
                         auto ptr = (core_buttons*)&PIF_RAMb[i + 3];
+                        t_tm_scope scope(core_tm_callbacks);
                         g_core->callbacks.input(ptr, channel);
                     }
                     else
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include "savedata.h"
+#include "memory.h"
+#include <core/Core.h>
+#include <core/r4300/rom.h>
+
+struct t_save_memory {
+    /// The save memory's contents.
+    uint8_t* data;
+
+    size_t size;
+
+    /// The save file's extension.
+    const wchar_t* extension;
+
+    FILE* file;
+
+    /// The start of the modified range.
+    size_t dirty_start;
+
+    /// The end of the modified range, exclusive. The range is empty if it's not after the start.
+    size_t dirty_end;
+};
+
+// How often the writer writes back modifications.
+constexpr auto WRITE_BACK_INTERVAL = std::chrono::seconds(1);
+
+static t_save_memory g_memories[save_type_count] = {
+{eeprom, sizeof(eeprom), L"eep"},
+{sram, sizeof(sram), L"sra"},
+{flashram, sizeof(flashram), L"fla"},
+{(uint8_t*)mempack, sizeof(mempack), L"mpk"},
+};
+
+// Locked when accessing the modified ranges or the writer's state.
+static std::mutex g_save_mutex;
+
+static std::condition_variable g_writer_cv;
+static std::thread g_writer_thread;
+static bool g_writer_stop;
+
+static std::filesystem::path get_save_path(const t_save_memory& memory)
+{
+    return std::format(L"{}{} {}.{}", g_core->get_saves_directory().wstring(), string_to_wstring((const char*)ROM_HEADER.nom), core_vr_country_code_to_country_name(ROM_HEADER.Country_code), memory.extension);
+}
+
+static bool open_core_file_stream(const std::filesystem::path& path, FILE** file)
+{
+    g_core->logger->info("[Core] Opening core stream from {}...", path.string().c_str());
+
+    if (!exists(path))
+    {
+        FILE* f = fopen(path.string().c_str(), "w");
+        if (!f)
+        {
+            return false;
+        }
+        fflush(f);
+        fclose(f);
+    }
+    *file = fopen(path.string().c_str(), "rb+");
+    return *file != nullptr;
+}
+
+/**
+ * Writes the modified range of a save memory back to its file.
+ */
+static void write_back(t_save_memory& memory)
+{
+    std::vector<uint8_t> buf;
+    size_t offset;
+
+    {
+        std::scoped_lock lock(g_save_mutex);
+
+        if (memory.dirty_start >= memory.dirty_end)
+        {
+            return;
+        }
+
+        // The emulation thread marks ranges after modifying them, so a range modified while being copied is marked again and written next time
+        offset = memory.dirty_start;
+        buf.assign(memory.data + memory.dirty_start, memory.data + memory.dirty_end);
+        memory.dirty_start = memory.size;
+        memory.dirty_end = 0;
+    }
+
+    fseek(memory.file, offset, SEEK_SET);
+    fwrite(buf.data(), 1, buf.size(), memory.file);
+    fflush(memory.file);
+}
+
+static void write_back_all()
+{
+    for (auto& memory : g_memories)
+    {
+        write_back(memory);
+    }
+}
+
+static void writer_thread()
+{
+    std::unique_lock lock(g_save_mutex);
+    while (!g_writer_stop)
+    {
+        g_writer_cv.wait_for(lock, WRITE_BACK_INTERVAL, [] { return g_writer_stop; });
+
+        lock.unlock();
+        write_back_all();
+        lock.lock();
+    }
+}
+
+static void close_files()
+{
+    for (auto& memory : g_memories)
+    {
+        if (memory.file)
+        {
+            fclose(memory.file);
+            memory.file = nullptr;
+        }
+    }
+}
+
+bool save_open()
+{
+    for (auto& memory : g_memories)
+    {
+        if (!open_core_file_stream(get_save_path(memory), &memory.file))
+        {
+            close_files();
+            return false;
+        }
+
+        // Files which are shorter than the save memory, such as newly created ones, are padded with zeroes
+        fseek(memory.file, 0, SEEK_SET);
+        const size_t read = fread(memory.data, 1, memory.size, memory.file);
+        memset(memory.data + read, 0, memory.size - read);
+
+        memory.dirty_start = memory.size;
+        memory.dirty_end = 0;
+    }
+
+    g_writer_stop = false;
+    g_writer_thread = std::thread(writer_thread);
+
+    return true;
+}
+
+void save_close()
+{
+    if (g_writer_thread.joinable())
+    {
+        {
+            std::scoped_lock lock(g_save_mutex);
+            g_writer_stop = true;
+        }
+        g_writer_cv.notify_one();
+        g_writer_thread.join();
+    }
+
+    write_back_all();
+    close_files();
+}
+
+void save_mark_dirty(t_save_type type, size_t offset, size_t length)
+{
+    auto& memory = g_memories[type];
+
+    if (offset >= memory.size)
+    {
+        return;
+    }
+
+    std::scoped_lock lock(g_save_mutex);
+    memory.dirty_start = std::min(memory.dirty_start, offset);
+    memory.dirty_end = std::max(memory.dirty_end, std::min(offset + length, memory.size));
+}
+
+void save_clear()
+{
+    for (auto& memory : g_memories)
+    {
+        FILE* f = fopen(get_save_path(memory).string().c_str(), "wb");
+        if (f)
+        {
+            fclose(f);
+        }
+    }
+}
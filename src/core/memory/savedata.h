@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+/*
+ * The cartridge and controller pack save memories are loaded from their files once when the ROM is opened,
+ * and are then only accessed in memory. Modified ranges are written back by a writer thread periodically and when the ROM is closed.
+ */
+
+/**
+ * The save memory types.
+ */
+enum t_save_type {
+    save_eeprom,
+    save_sram,
+    save_flashram,
+    save_mempak,
+    save_type_count,
+};
+
+/**
+ * \brief Opens the current ROM's save files and loads them into the save memories, then starts the writer.
+ * \return Whether all save files could be opened.
+ */
+bool save_open();
+
+/**
+ * \brief Stops the writer, writes back all pending modifications and closes the save files.
+ */
+void save_close();
+
+/**
+ * \brief Marks a range of a save memory as modified, so it gets written back to its file.
+ * \param type The save memory type.
+ * \param offset The range's start offset.
+ * \param length The range's length.
+ */
+void save_mark_dirty(t_save_type type, size_t offset, size_t length);
+
+/**
+ * \brief Overwrites the current ROM's save files with blank save memories. Must be called while the save files are closed.
+ */
+void save_clear();
@@ -6,7 +6,6 @@
 
 #include "stdafx.h"
 #include "savestates.h"
-#include <libdeflate.h>
 #include <core/Core.h>
 #include <core/r4300/interrupt.h>
 #include <core/r4300/r4300.h>
@@ -16,6 +15,7 @@
 #include <IOHelpers.h>
 #include "flashram.h"
 #include "memory.h"
+#include "st_compression.h"
 #include "summercart.h"
 
 // st that comes from no delay fix mupen, it has some differences compared to new st:
@@ -57,6 +57,24 @@ struct t_savestate_task {
 
     /// Whether warnings, such as those about ROM compatibility, shouldn't be shown.
     bool ignore_warnings;
+
+    /// Whether a save's file is written before the task finishes, instead of in the background.
+    bool sync_persist;
+};
+
+/// Represents a savestate which is being compressed and written to disk in the background.
+struct t_pending_persist {
+    /// The savestate's path.
+    std::filesystem::path path;
+
+    /// The uncompressed savestate.
+    std::shared_ptr<const std::vector<uint8_t>> buffer;
+
+    /// The callbacks to invoke once the savestate was written. Includes those of older savestates to the same path which this one superseded.
+    std::vector<core_st_callback> callbacks;
+
+    /// Whether the writer is currently writing the savestate.
+    bool writing;
 };
 
 // Enable fixing .st to work for old mupen and m64p
@@ -80,12 +98,59 @@ char g_flashram_buf[1024]{};
 // Buffer used for storing event queue data during loading
 char g_event_queue_buf[1024]{};
 
-// Buffer used for storing st data up to event queue
+// Magic which precedes the format revision in savestates with one. Legacy savestates start with the ROM hash instead, which can't contain it.
+constexpr uint32_t ST_MAGIC = 0x5336344D; // "M64S"
+
+// The savestate format revision written by this version.
+// 0: Legacy format, which contains the first 1MB of the TLB lookup tables.
+// 1: Omits the TLB lookup tables, which are rebuilt from the TLB entries on load.
+constexpr uint32_t ST_REVISION = 1;
+
+// The size of the TLB lookup tables in legacy savestates.
+constexpr size_t LEGACY_TLB_LUT_SIZE = 0x200000;
+
+// Buffer used for storing st data up to event queue, sized for legacy savestates
 uint8_t g_first_block[0xA02BB4 - 32]{};
 
+// The largest uncompressed savestate accepted when loading: the fixed part, plus room for a movie's freeze data and a screenshot.
+constexpr size_t MAX_ST_SIZE = sizeof(g_first_block) + sizeof(g_event_queue_buf) + 512 * 1024 * 1024;
+
 // The undo savestate buffer.
 std::vector<uint8_t> g_undo_savestate;
 
+// The granularity at which delta savestates are computed, in bytes.
+constexpr size_t DELTA_PAGE_SIZE = 0x1000;
+
+// The maximum number of deltas chained onto a full savestate. Bounds the cost of decoding and of keeping ancestors alive.
+constexpr size_t MAX_DELTA_DEPTH = 64;
+
+// Offset of RDRAM in savestate buffers, as laid out by generate_savestate.
+size_t g_st_rdram_offset;
+
+// The seek savestate chain, which owns the dirty page tracking.
+t_st_delta_encoder g_delta_encoder{.tracks_dirty_pages = true};
+
+// The maximum number of savestates which can be waiting to be written to disk. Once this is reached, the emulation thread writes savestates itself.
+constexpr size_t MAX_PENDING_PERSISTS = 4;
+
+// The persist mutex. Locked when accessing the persistence state.
+std::mutex g_persist_mutex;
+
+// Signalled when a savestate is queued or the writer should stop.
+std::condition_variable g_persist_cv;
+
+// The savestates which are waiting to be written to disk, in the order they were saved.
+std::deque<t_pending_persist> g_pending_persists;
+
+// The thread which writes the pending savestates. Runs from the first background save until the core stops.
+std::thread g_persist_thread;
+
+// Whether the writer should exit once all pending savestates are written.
+bool g_persist_stop = false;
+
+// Locked while a savestate file is being written, so a synchronous write can't interleave with the writer's.
+std::mutex g_persist_write_mutex;
+
 void get_paths_for_task(const t_savestate_task& task, std::filesystem::path& st_path, std::filesystem::path& sd_path)
 {
     sd_path = std::format("{}{}.sd", g_core->get_saves_directory().string(), (const char*)ROM_HEADER.nom);
@@ -101,7 +166,12 @@ void get_paths_for_task(const t_savestate_task& task, std::filesystem::path& st_
 }
 
 
-void load_memory_from_buffer(uint8_t* p)
+/**
+ * Loads the memory and CPU state from the first block of a savestate.
+ * \param p The first block.
+ * \param revision The savestate's format revision.
+ */
+void load_memory_from_buffer(uint8_t* p, uint32_t revision)
 {
     memread(&p, &rdram_register, sizeof(core_rdram_reg));
     if (rdram_register.rdram_device_manuf & RDRAM_DEVICE_MANUF_NEW_FIX_BIT)
@@ -128,8 +198,11 @@ void load_memory_from_buffer(uint8_t* p)
     memread(&p, buf, 24);
     load_flashram_infos(buf);
 
-    memread(&p, tlb_LUT_r, 0x100000);
-    memread(&p, tlb_LUT_w, 0x100000);
+    // The lookup tables in legacy savestates are incomplete, so they're rebuilt from the TLB entries instead
+    if (revision == 0)
+    {
+        p += LEGACY_TLB_LUT_SIZE;
+    }
 
     memread(&p, &llbit, 4);
     memread(&p, reg, 32 * 8);
@@ -144,6 +217,7 @@ void load_memory_from_buffer(uint8_t* p)
     memread(&p, &FCR0, 4);
     memread(&p, &FCR31, 4);
     memread(&p, tlb_e, 32 * sizeof(tlb));
+    tlb_rebuild_luts();
     if (!dynacore && interpcore)
         memread(&p, &interp_addr, 4);
     else
@@ -158,13 +232,15 @@ void load_memory_from_buffer(uint8_t* p)
     memread(&p, &next_interrupt, 4);
     memread(&p, &next_vi, 4);
     memread(&p, &vi_field, 4);
+
+    rdram_mark_all_dirty();
 }
 
 std::vector<uint8_t> generate_savestate()
 {
     std::vector<uint8_t> b;
 
-    b.reserve(0xB624F0);
+    b.reserve(0x9624F8);
 
     memset(g_flashram_buf, 0, sizeof(g_flashram_buf));
     memset(g_event_queue_buf, 0, sizeof(g_event_queue_buf));
@@ -190,6 +266,7 @@ std::vector<uint8_t> generate_savestate()
             g_core->logger->warn("[ST] No SI interrupt in queue, adding one...");
             for (size_t i = 0; i < (64 / 4); i++)
                 rdram[si_register.si_dram_addr / 4 + i] = sl(PIF_RAM[i]);
+            rdram_mark_range_dirty(si_register.si_dram_addr, 64);
             update_count();
             add_interrupt_event(SI_INT, /*0x100*/ 0x900);
             rdram_register.rdram_device_manuf |= RDRAM_DEVICE_MANUF_NEW_FIX_BIT;
@@ -202,6 +279,8 @@ std::vector<uint8_t> generate_savestate()
     save_flashram_infos(g_flashram_buf);
     const int32_t event_queue_len = save_eventqueue_infos(g_event_queue_buf);
 
+    const uint32_t header[] = {ST_MAGIC, ST_REVISION};
+    vecwrite(b, header, sizeof(header));
     vecwrite(b, rom_md5, 32);
     vecwrite(b, &rdram_register, sizeof(core_rdram_reg));
     vecwrite(b, &MI_register, sizeof(core_mips_reg));
@@ -214,13 +293,12 @@ std::vector<uint8_t> generate_savestate()
     vecwrite(b, &ai_register, sizeof(core_ai_reg));
     vecwrite(b, &dpc_register, sizeof(core_dpc_reg));
     vecwrite(b, &dps_register, sizeof(core_dps_reg));
+    g_st_rdram_offset = b.size();
     vecwrite(b, rdram, 0x800000);
     vecwrite(b, SP_DMEM, 0x1000);
     vecwrite(b, SP_IMEM, 0x1000);
     vecwrite(b, PIF_RAM, 0x40);
     vecwrite(b, g_flashram_buf, 24);
-    vecwrite(b, tlb_LUT_r, 0x100000);
-    vecwrite(b, tlb_LUT_w, 0x100000);
     vecwrite(b, &llbit, 4);
     vecwrite(b, reg, 32 * 8);
     for (size_t i = 0; i < 32; i++)
@@ -271,11 +349,191 @@ std::vector<uint8_t> generate_savestate()
     return b;
 }
 
+/**
+ * Compresses a savestate and writes it to disk.
+ * \return The result of the operation.
+ */
+static core_result write_savestate(const std::filesystem::path& path, const std::vector<uint8_t>& st)
+{
+    const auto compressed_buffer = st_compress(st);
+
+    FILE* f = fopen(path.string().c_str(), "wb");
+
+    if (f == nullptr)
+    {
+        return ST_FileWriteError;
+    }
+
+    fwrite(compressed_buffer.data(), compressed_buffer.size(), 1, f);
+    fclose(f);
+
+    return Res_Ok;
+}
+
+/**
+ * Writes a savestate to disk, then notifies the savestate callback if it succeeded and invokes the specified callbacks.
+ * \param write_lock The lock on the write mutex, which is released once the file is written.
+ */
+static void finish_persist(std::unique_lock<std::mutex> write_lock, const std::filesystem::path& path, const std::vector<uint8_t>& st, const std::vector<core_st_callback>& callbacks)
+{
+    core_result result;
+    {
+        ScopeTimer timer("Savestate writing", g_core->logger);
+        result = write_savestate(path, st);
+    }
+    write_lock.unlock();
+
+    if (result == Res_Ok)
+    {
+        g_core->callbacks.save_state();
+    }
+
+    for (const auto& callback : callbacks)
+    {
+        callback(result, st);
+    }
+}
+
+/**
+ * Writes the pending savestates in the order they were saved. Exits once stopped and all savestates are written.
+ */
+static void persist_thread()
+{
+    std::unique_lock lock(g_persist_mutex);
+    while (true)
+    {
+        g_persist_cv.wait(lock, [] { return g_persist_stop || !g_pending_persists.empty(); });
+
+        if (g_pending_persists.empty())
+        {
+            return;
+        }
+
+        // When a newer savestate is going to the same file, there's no need to write this one. Its tasks finish along with the newer one.
+        auto& front = g_pending_persists.front();
+        const auto newer = std::find_if(g_pending_persists.begin() + 1, g_pending_persists.end(), [&](const auto& pending) {
+            return pending.path == front.path;
+        });
+        if (newer != g_pending_persists.end())
+        {
+            g_core->logger->info("[ST] Skipping write of {}, as a newer savestate will be written to it", front.path.string());
+            newer->callbacks.insert(newer->callbacks.begin(), front.callbacks.begin(), front.callbacks.end());
+            g_pending_persists.pop_front();
+            continue;
+        }
+
+        // The savestate stays pending while it's written, so loads of the path keep using it.
+        // The write lock is taken before it's marked as being written, so a synchronous write to the same path waits for it.
+        std::unique_lock write_lock(g_persist_write_mutex);
+        front.writing = true;
+        const auto path = front.path;
+        const auto buffer = front.buffer;
+        const auto callbacks = front.callbacks;
+
+        lock.unlock();
+        finish_persist(std::move(write_lock), path, *buffer, callbacks);
+        lock.lock();
+
+        g_pending_persists.pop_front();
+    }
+}
+
+/**
+ * Writes a savestate to disk on the calling thread. Older savestates to the same path which are still waiting to be written are superseded.
+ */
+static void persist_sync(const t_savestate_task& task, const std::filesystem::path& path, const std::shared_ptr<const std::vector<uint8_t>>& st)
+{
+    std::vector<core_st_callback> callbacks;
+    {
+        std::scoped_lock lock(g_persist_mutex);
+        std::erase_if(g_pending_persists, [&](const auto& pending) {
+            if (pending.writing || pending.path != path)
+            {
+                return false;
+            }
+            callbacks.insert(callbacks.end(), pending.callbacks.begin(), pending.callbacks.end());
+            return true;
+        });
+    }
+    callbacks.push_back(task.callback);
+
+    // A savestate to the same path which the writer is already writing finishes first, as the writer holds the write lock
+    finish_persist(std::unique_lock(g_persist_write_mutex), path, *st, callbacks);
+}
+
+/**
+ * Compresses and writes a savestate to disk in the background, then calls the task's callback from the writer thread.
+ * Never waits for the writer: once too many savestates are pending, the savestate is written on the calling thread instead.
+ */
+static void persist_async(const t_savestate_task& task, const std::filesystem::path& path, std::shared_ptr<const std::vector<uint8_t>> st)
+{
+    {
+        std::scoped_lock lock(g_persist_mutex);
+
+        if (g_pending_persists.size() < MAX_PENDING_PERSISTS)
+        {
+            if (!g_persist_thread.joinable())
+            {
+                g_persist_stop = false;
+                g_persist_thread = std::thread(persist_thread);
+            }
+
+            g_pending_persists.push_back({
+            .path = path,
+            .buffer = std::move(st),
+            .callbacks = {task.callback},
+            });
+            g_persist_cv.notify_one();
+            return;
+        }
+    }
+
+    g_core->logger->warn("[ST] Too many savestates are waiting to be written, writing synchronously...");
+    persist_sync(task, path, st);
+}
+
+/**
+ * Stops the writer once all pending savestates are written.
+ */
+static void drain_persists()
+{
+    if (!g_persist_thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::scoped_lock lock(g_persist_mutex);
+        g_persist_stop = true;
+    }
+    g_persist_cv.notify_one();
+    g_persist_thread.join();
+}
+
+/**
+ * Finds the newest savestate which is waiting to be written to the specified path.
+ * \return The uncompressed savestate, or null if there's none.
+ */
+static std::shared_ptr<const std::vector<uint8_t>> find_pending_persist(const std::filesystem::path& path)
+{
+    std::scoped_lock lock(g_persist_mutex);
+
+    for (auto it = g_pending_persists.rbegin(); it != g_pending_persists.rend(); ++it)
+    {
+        if (it->path == path)
+        {
+            return it->buffer;
+        }
+    }
+
+    return nullptr;
+}
+
 void savestates_save_immediate_impl(const t_savestate_task& task)
 {
     ScopeTimer timer("Savestate saving", g_core->logger);
 
-    const auto st = generate_savestate();
+    auto st = std::make_shared<const std::vector<uint8_t>>(generate_savestate());
 
     if (task.medium == core_st_medium_slot || task.medium == core_st_medium_path)
     {
@@ -286,29 +544,17 @@ void savestates_save_immediate_impl(const t_savestate_task& task)
         if (g_core->cfg->use_summercart)
             save_summercart(new_sd_path.string().c_str());
 
-        // Generate compressed buffer
-        std::vector<uint8_t> compressed_buffer;
-        compressed_buffer.resize(st.size());
-
-        const auto compressor = libdeflate_alloc_compressor(6);
-        const size_t final_size = libdeflate_gzip_compress(compressor, st.data(), st.size(), compressed_buffer.data(), compressed_buffer.size());
-        libdeflate_free_compressor(compressor);
-        compressed_buffer.resize(final_size);
-
-        // write compressed st to disk
-        FILE* f = fopen(new_st_path.string().c_str(), "wb");
-
-        if (f == nullptr)
+        if (!task.sync_persist)
         {
-            task.callback(ST_FileWriteError, st);
+            persist_async(task, new_st_path, std::move(st));
             return;
         }
 
-        fwrite(compressed_buffer.data(), compressed_buffer.size(), 1, f);
-        fclose(f);
+        persist_sync(task, new_st_path, st);
+        return;
     }
 
-    task.callback(Res_Ok, st);
+    task.callback(Res_Ok, *st);
     g_core->callbacks.save_state();
 }
 
@@ -331,7 +577,16 @@ void savestates_load_immediate_impl(const t_savestate_task& task)
     {
     case core_st_medium_slot:
     case core_st_medium_path:
-        st_buf = read_file_buffer(new_st_path);
+        // The file might not be written yet, in which case we take the savestate from memory
+        if (const auto pending = find_pending_persist(new_st_path))
+        {
+            g_core->logger->info("[ST] Loading savestate which is still being written from memory");
+            st_buf = *pending;
+        }
+        else
+        {
+            st_buf = read_file_buffer(new_st_path);
+        }
         break;
     case core_st_medium_memory:
         st_buf = task.params.buffer;
@@ -346,7 +601,7 @@ void savestates_load_immediate_impl(const t_savestate_task& task)
         return;
     }
 
-    std::vector<uint8_t> decompressed_buf = auto_decompress(st_buf);
+    std::vector<uint8_t> decompressed_buf = st_decompress(st_buf, MAX_ST_SIZE);
     if (decompressed_buf.empty())
     {
         task.callback(ST_DecompressionError, {});
@@ -357,6 +612,20 @@ void savestates_load_immediate_impl(const t_savestate_task& task)
     // find another way of doing this
     auto ptr = decompressed_buf.data();
 
+    uint32_t revision = 0;
+    if (decompressed_buf.size() >= sizeof(uint32_t) * 2 && *reinterpret_cast<uint32_t*>(ptr) == ST_MAGIC)
+    {
+        ptr += sizeof(uint32_t);
+        memread(&ptr, &revision, sizeof(revision));
+
+        if (revision > ST_REVISION)
+        {
+            g_core->logger->error("[ST] Unsupported savestate revision {}", revision);
+            task.callback(ST_UnsupportedRevision, {});
+            return;
+        }
+    }
+
     // compare current rom hash with one stored in state
     char md5[33] = {0};
     memread(&ptr, &md5, 32);
@@ -377,7 +646,7 @@ void savestates_load_immediate_impl(const t_savestate_task& task)
     }
 
     // new version does one bigass gzread for first part of .st (static size)
-    memread(&ptr, g_first_block, sizeof(g_first_block));
+    memread(&ptr, g_first_block, revision == 0 ? sizeof(g_first_block) : sizeof(g_first_block) - LEGACY_TLB_LUT_SIZE);
 
     // now read interrupt queue into buf
     int32_t len;
@@ -481,7 +750,7 @@ void savestates_load_immediate_impl(const t_savestate_task& task)
 
         // so far loading success! overwrite memory
         load_eventqueue_infos(g_event_queue_buf);
-        load_memory_from_buffer(g_first_block);
+        load_memory_from_buffer(g_first_block, revision);
 
         // NOTE: We don't want to restore screen buffer while seeking, since it creates a int16_t ugly flicker when the movie restarts by loading state
         if (core_vr_get_mge_available() && video_buffer && !core_vcr_is_seeking())
@@ -506,7 +775,10 @@ failedLoad:
     g_st_old = (interp_addr == 0x80000180 || PC->addr == 0x80000180);
     // doubled because can't just reuse this variable
     if (interp_addr == 0x80000180 || (PC->addr == 0x80000180 && !dynacore))
+    {
         g_vr_beq_ignore_jmp = true;
+        g_interp_variant_dirty = true;
+    }
     if (!dynacore && interpcore)
     {
         // g_core->logger->info(".st jump: {:#06x}, stopped here:{:#06x}", interp_addr, last_addr);
@@ -519,6 +791,119 @@ failedLoad:
     }
 }
 
+/**
+ * Gets whether all the RDRAM pages overlapping a range of a savestate buffer are unmodified since the last delta was encoded.
+ */
+static bool st_delta_range_clean(size_t offset, size_t length)
+{
+    if (offset < g_st_rdram_offset || offset + length > g_st_rdram_offset + 0x800000)
+    {
+        return false;
+    }
+
+    const size_t first = (offset - g_st_rdram_offset) / DIRTY_PAGE_SIZE;
+    const size_t last = (offset + length - 1 - g_st_rdram_offset) / DIRTY_PAGE_SIZE;
+    for (size_t i = first; i <= last; i++)
+    {
+        if (g_rdram_dirty_pages[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<const t_st_delta> st_encode_delta(t_st_delta_encoder& encoder, const std::vector<uint8_t>& buffer)
+{
+    ScopeTimer timer("Delta savestate encoding", g_core->logger);
+
+    auto delta = std::make_shared<t_st_delta>();
+    delta->size = buffer.size();
+    delta->depth = 0;
+
+    const bool full = !encoder.last || encoder.last->depth + 1 >= MAX_DELTA_DEPTH;
+    if (!full)
+    {
+        delta->parent = encoder.last;
+        delta->depth = encoder.last->depth + 1;
+    }
+
+    // The recompiler writes to RDRAM directly from generated code, bypassing the dirty page tracking
+    const bool trust_dirty_pages = encoder.tracks_dirty_pages && !full && !dynacore;
+
+    encoder.shadow.resize(buffer.size());
+
+    const size_t page_count = (buffer.size() + DELTA_PAGE_SIZE - 1) / DELTA_PAGE_SIZE;
+    for (size_t i = 0; i < page_count; i++)
+    {
+        const size_t offset = i * DELTA_PAGE_SIZE;
+        const size_t length = std::min(DELTA_PAGE_SIZE, buffer.size() - offset);
+        const uint8_t* page = buffer.data() + offset;
+
+        if (!full && offset + length <= delta->parent->size)
+        {
+            if (trust_dirty_pages && st_delta_range_clean(offset, length))
+            {
+                continue;
+            }
+            if (!memcmp(page, encoder.shadow.data() + offset, length))
+            {
+                continue;
+            }
+        }
+
+        delta->pages.push_back(static_cast<uint32_t>(i));
+        delta->data.insert(delta->data.end(), page, page + length);
+        memcpy(encoder.shadow.data() + offset, page, length);
+    }
+
+    if (encoder.tracks_dirty_pages)
+    {
+        memset(g_rdram_dirty_pages, 0, sizeof(g_rdram_dirty_pages));
+    }
+
+    g_core->logger->trace("[ST] Encoded delta savestate with {} of {} pages at depth {}", delta->pages.size(), page_count, delta->depth);
+
+    encoder.last = delta;
+    return delta;
+}
+
+std::shared_ptr<const t_st_delta> st_encode_delta(const std::vector<uint8_t>& buffer)
+{
+    return st_encode_delta(g_delta_encoder, buffer);
+}
+
+std::vector<uint8_t> st_decode_delta(const t_st_delta& delta)
+{
+    std::vector<const t_st_delta*> chain;
+    for (auto current = &delta; current; current = current->parent.get())
+    {
+        chain.push_back(current);
+    }
+
+    // Apply the pages from the oldest ancestor onwards, so newer pages overwrite older ones
+    std::vector<uint8_t> buffer(delta.size);
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+    {
+        const t_st_delta* current = *it;
+        size_t data_offset = 0;
+
+        for (const auto page : current->pages)
+        {
+            const size_t offset = page * DELTA_PAGE_SIZE;
+            const size_t length = std::min(DELTA_PAGE_SIZE, current->size - offset);
+
+            if (offset < buffer.size())
+            {
+                memcpy(buffer.data() + offset, current->data.data() + data_offset, std::min(length, buffer.size() - offset));
+            }
+            data_offset += length;
+        }
+    }
+
+    return buffer;
+}
+
 /**
  * Simplifies the task queue by removing duplicates. Only slot-based tasks are affected for now.
  */
@@ -686,11 +1071,40 @@ void st_do_work()
     g_tasks.clear();
 }
 
+std::vector<uint8_t> st_save_immediate()
+{
+    return generate_savestate();
+}
+
+core_result st_load_immediate(const std::vector<uint8_t>& buffer)
+{
+    core_result result = Res_Ok;
+
+    const t_savestate_task task = {
+    .job = core_st_job_load,
+    .medium = core_st_medium_memory,
+    .callback = [&](const core_result task_result, const std::vector<uint8_t>&) {
+        result = task_result;
+    },
+    .params = {
+    .buffer = buffer},
+    .ignore_warnings = true,
+    };
+
+    savestates_load_immediate_impl(task);
+    return result;
+}
+
 void st_on_core_stop()
 {
+    drain_persists();
+    st_stop_workers();
+
     std::scoped_lock lock(g_task_mutex);
     g_tasks.clear();
     g_undo_savestate.clear();
+    g_delta_encoder.shadow.clear();
+    g_delta_encoder.last.reset();
 }
 
 /**
@@ -701,7 +1115,7 @@ bool can_push_work()
     return core_executing;
 }
 
-bool core_st_do_file(const std::filesystem::path& path, const core_st_job job, const core_st_callback& callback, bool ignore_warnings)
+bool st_do_file(const std::filesystem::path& path, const core_st_job job, const core_st_callback& callback, bool ignore_warnings, bool sync_persist)
 {
     std::scoped_lock lock(g_task_mutex);
 
@@ -744,12 +1158,18 @@ bool core_st_do_file(const std::filesystem::path& path, const core_st_job job, c
     .params = {
     .path = path},
     .ignore_warnings = ignore_warnings,
+    .sync_persist = sync_persist,
     };
 
     g_tasks.insert(g_tasks.begin(), task);
     return true;
 }
 
+bool core_st_do_file(const std::filesystem::path& path, const core_st_job job, const core_st_callback& callback, bool ignore_warnings)
+{
+    return st_do_file(path, job, callback, ignore_warnings, false);
+}
+
 bool core_st_do_slot(const int32_t slot, const core_st_job job, const core_st_callback& callback, bool ignore_warnings)
 {
     std::scoped_lock lock(g_task_mutex);
@@ -830,3 +1250,8 @@ void core_st_get_undo_savestate(std::vector<uint8_t>& buffer)
     buffer.clear();
     buffer = g_undo_savestate;
 }
+
+void core_st_mark_rdram_dirty(uint32_t addr, uint32_t len)
+{
+    rdram_mark_range_dirty(addr, len);
+}
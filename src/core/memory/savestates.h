@@ -11,6 +11,85 @@
 extern bool g_st_skip_dma;
 extern bool g_st_old;
 
+/**
+ * \brief A savestate stored as the pages in which it differs from its parent.
+ */
+struct t_st_delta {
+    /// The savestate this one is based on, or null if all pages are stored.
+    std::shared_ptr<const t_st_delta> parent;
+
+    /// The number of ancestors.
+    size_t depth;
+
+    /// The size of the full savestate buffer.
+    size_t size;
+
+    /// The indices of the stored pages, in ascending order.
+    std::vector<uint32_t> pages;
+
+    /// The stored pages' contents, back to back. Only the savestate's last page can be shorter than a full page.
+    std::vector<uint8_t> data;
+};
+
+/**
+ * \brief A chain of delta savestates, each encoded against the previous one.
+ * Independent users of delta savestates need their own chains, as encoding a savestate moves the chain's base.
+ */
+struct t_st_delta_encoder {
+    /// The savestate buffer most recently encoded, which the next one is computed against.
+    std::vector<uint8_t> shadow;
+
+    /// The delta savestate most recently encoded.
+    std::shared_ptr<const t_st_delta> last;
+
+    /// Whether the chain uses and resets RDRAM's dirty page tracking to skip unchanged pages. Only one chain can, as encoding resets the tracking.
+    bool tracks_dirty_pages;
+};
+
+/**
+ * \brief Encodes a savestate buffer as a delta against the previously encoded one of the seek savestate chain.
+ * \param buffer A savestate buffer, as passed to the callback of a save task.
+ * \return The delta savestate. It keeps its ancestors alive.
+ * \warning This function must only be called from the callback of a save task, as the dirty page tracking state has to describe the emulator state the buffer was generated from.
+ */
+std::shared_ptr<const t_st_delta> st_encode_delta(const std::vector<uint8_t>& buffer);
+
+/**
+ * \brief Encodes a savestate buffer as a delta against the previously encoded one of the specified chain.
+ * \param encoder The chain. If it tracks dirty pages, the restrictions of the seek savestate chain's overload apply.
+ * \param buffer A savestate buffer.
+ * \return The delta savestate. It keeps its ancestors alive.
+ */
+std::shared_ptr<const t_st_delta> st_encode_delta(t_st_delta_encoder& encoder, const std::vector<uint8_t>& buffer);
+
+/**
+ * \brief Reconstructs the full savestate buffer from a delta savestate.
+ * \param delta The delta savestate.
+ * \return The savestate buffer, which can be loaded with <c>core_st_do_memory</c>.
+ */
+std::vector<uint8_t> st_decode_delta(const t_st_delta& delta);
+
+/**
+ * \brief Executes a savestate operation to a path, like <c>core_st_do_file</c>.
+ * \param sync_persist Whether a save's file is written on the emulation thread before the callback is called, instead of in the background.
+ * \return Whether the operation was enqueued.
+ */
+bool st_do_file(const std::filesystem::path& path, core_st_job job, const core_st_callback& callback, bool ignore_warnings, bool sync_persist);
+
+/**
+ * \brief Generates a savestate of the current emulator state without going through the task queue.
+ * \warning This function must only be called from the emulation thread.
+ */
+std::vector<uint8_t> st_save_immediate();
+
+/**
+ * \brief Loads a savestate buffer without going through the task queue. No warnings are shown.
+ * \param buffer The savestate buffer, which can be compressed.
+ * \return The operation result.
+ * \warning This function must only be called from the emulation thread.
+ */
+core_result st_load_immediate(const std::vector<uint8_t>& buffer);
+
 /**
  * \brief Does the pending savestate work.
  * \warning This function must only be called from the emulation thread. Other callers must use the <c>savestates_do_x</c> family.
@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include "st_compression.h"
+#include <libdeflate.h>
+#include <IOHelpers.h>
+
+// The size of an uncompressed chunk. Small enough for the chunks of a savestate to spread evenly over many cores.
+constexpr size_t CHUNK_SIZE = 256 * 1024;
+
+// The compression level used for every chunk.
+constexpr int32_t COMPRESSION_LEVEL = 6;
+
+// The version of the index stored in the first member's extra field.
+constexpr uint8_t INDEX_VERSION = 1;
+
+// The extra field subfield identifier of the index.
+constexpr uint8_t INDEX_SI1 = 'M';
+constexpr uint8_t INDEX_SI2 = 'C';
+
+// Size of the index without the per-chunk sizes: version, 3 reserved bytes, uncompressed size, chunk size, chunk count.
+constexpr size_t INDEX_FIXED_SIZE = 4 + 8 + 4 + 4;
+
+// Size of a gzip member header without extra field.
+constexpr size_t GZIP_HEADER_SIZE = 10;
+
+// Size of a gzip member trailer: CRC32 and uncompressed size.
+constexpr size_t GZIP_TRAILER_SIZE = 8;
+
+constexpr uint8_t GZIP_FLAG_EXTRA = 0x04;
+
+// The largest extra field a gzip header can hold.
+constexpr size_t GZIP_MAX_EXTRA_SIZE = UINT16_MAX;
+
+template <typename T>
+static void write_le(uint8_t* dest, T value)
+{
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        dest[i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+}
+
+template <typename T>
+static T read_le(const uint8_t* src)
+{
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        value |= static_cast<T>(src[i]) << (i * 8);
+    }
+    return value;
+}
+
+// The signature of a worker. Workers pull task indices from the shared counter until all tasks are taken.
+using t_worker = std::function<void(std::atomic<size_t>&)>;
+
+// Locked when accessing the worker pool's state.
+static std::mutex g_pool_mutex;
+
+// Serializes run_workers calls, since savestates are compressed on the persist thread and decompressed on the emulation thread.
+static std::mutex g_pool_run_mutex;
+
+static std::condition_variable g_pool_work_cv;
+static std::condition_variable g_pool_done_cv;
+
+// The pool threads. Started when first needed and kept until st_stop_workers is called.
+static std::vector<std::thread> g_pool_threads;
+static bool g_pool_stop;
+
+// The work being run, and the task counter its workers share.
+static const t_worker* g_pool_worker;
+static std::atomic<size_t>* g_pool_next_task;
+
+// Incremented whenever work is posted, so a pool thread joins each run at most once.
+static size_t g_pool_generation;
+
+// The amount of pool threads which should still join the current run.
+static size_t g_pool_wanted;
+
+// The amount of pool threads currently running a worker.
+static size_t g_pool_running;
+
+static void pool_thread()
+{
+    size_t generation = 0;
+
+    std::unique_lock lock(g_pool_mutex);
+    while (true)
+    {
+        g_pool_work_cv.wait(lock, [&] { return g_pool_stop || (g_pool_wanted > 0 && g_pool_generation != generation); });
+
+        if (g_pool_stop)
+        {
+            return;
+        }
+
+        generation = g_pool_generation;
+        --g_pool_wanted;
+        ++g_pool_running;
+
+        const auto worker = g_pool_worker;
+        const auto next_task = g_pool_next_task;
+
+        lock.unlock();
+        (*worker)(*next_task);
+        lock.lock();
+
+        if (--g_pool_running == 0)
+        {
+            g_pool_done_cv.notify_all();
+        }
+    }
+}
+
+/**
+ * Runs a worker on as many threads as useful for the specified amount of tasks, including the calling thread.
+ */
+static void run_workers(size_t task_count, const t_worker& worker)
+{
+    std::scoped_lock run_lock(g_pool_run_mutex);
+
+    std::atomic<size_t> next_task = 0;
+
+    {
+        std::scoped_lock lock(g_pool_mutex);
+
+        if (g_pool_threads.empty())
+        {
+            const size_t thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1) - 1;
+            g_pool_stop = false;
+            for (size_t i = 0; i < thread_count; ++i)
+            {
+                g_pool_threads.emplace_back(pool_thread);
+            }
+        }
+
+        g_pool_worker = &worker;
+        g_pool_next_task = &next_task;
+        g_pool_wanted = std::min(g_pool_threads.size(), std::max<size_t>(task_count, 1) - 1);
+        ++g_pool_generation;
+    }
+    g_pool_work_cv.notify_all();
+
+    worker(next_task);
+
+    // Every task is taken once the calling thread's worker returns, so pool threads which didn't join yet have nothing left to do
+    std::unique_lock lock(g_pool_mutex);
+    g_pool_wanted = 0;
+    g_pool_done_cv.wait(lock, [] { return g_pool_running == 0; });
+    g_pool_worker = nullptr;
+    g_pool_next_task = nullptr;
+}
+
+void st_stop_workers()
+{
+    std::scoped_lock run_lock(g_pool_run_mutex);
+
+    {
+        std::scoped_lock lock(g_pool_mutex);
+        g_pool_stop = true;
+    }
+    g_pool_work_cv.notify_all();
+
+    for (auto& thread : g_pool_threads)
+    {
+        thread.join();
+    }
+    g_pool_threads.clear();
+}
+
+static void write_gzip_header(uint8_t* dest, uint8_t flags)
+{
+    dest[0] = 0x1F;
+    dest[1] = 0x8B;
+    dest[2] = 8; // deflate
+    dest[3] = flags;
+    write_le<uint32_t>(dest + 4, 0); // no modification time
+    dest[8] = 0;
+    dest[9] = 0xFF; // unknown OS
+}
+
+std::vector<uint8_t> st_compress(std::span<const uint8_t> buffer)
+{
+    // The chunk count is bounded by the space for the index in the extra field
+    constexpr size_t max_chunk_count = (GZIP_MAX_EXTRA_SIZE - 4 - INDEX_FIXED_SIZE) / 4;
+    const size_t chunk_size = std::max(CHUNK_SIZE, (buffer.size() + max_chunk_count - 1) / max_chunk_count);
+    const size_t chunk_count = std::max<size_t>(1, (buffer.size() + chunk_size - 1) / chunk_size);
+
+    std::vector<std::vector<uint8_t>> chunks(chunk_count);
+    std::vector<uint32_t> crcs(chunk_count);
+
+    run_workers(chunk_count, [&](std::atomic<size_t>& next_task) {
+        const auto compressor = libdeflate_alloc_compressor(COMPRESSION_LEVEL);
+
+        for (size_t i; (i = next_task++) < chunk_count;)
+        {
+            const auto chunk = buffer.subspan(i * chunk_size, std::min(chunk_size, buffer.size() - i * chunk_size));
+
+            chunks[i].resize(libdeflate_deflate_compress_bound(compressor, chunk.size()));
+            chunks[i].resize(libdeflate_deflate_compress(compressor, chunk.data(), chunk.size(), chunks[i].data(), chunks[i].size()));
+            crcs[i] = libdeflate_crc32(0, chunk.data(), chunk.size());
+        }
+
+        libdeflate_free_compressor(compressor);
+    });
+
+    const size_t index_size = INDEX_FIXED_SIZE + chunk_count * 4;
+    const size_t extra_size = 4 + index_size;
+
+    size_t total_size = 2 + extra_size;
+    for (const auto& chunk : chunks)
+    {
+        total_size += GZIP_HEADER_SIZE + chunk.size() + GZIP_TRAILER_SIZE;
+    }
+
+    std::vector<uint8_t> out(total_size);
+    uint8_t* ptr = out.data();
+
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        const size_t uncompressed_size = std::min(chunk_size, buffer.size() - i * chunk_size);
+
+        write_gzip_header(ptr, i == 0 ? GZIP_FLAG_EXTRA : 0);
+        ptr += GZIP_HEADER_SIZE;
+
+        if (i == 0)
+        {
+            write_le<uint16_t>(ptr, static_cast<uint16_t>(extra_size));
+            ptr[2] = INDEX_SI1;
+            ptr[3] = INDEX_SI2;
+            write_le<uint16_t>(ptr + 4, static_cast<uint16_t>(index_size));
+            ptr += 6;
+
+            ptr[0] = INDEX_VERSION;
+            ptr[1] = ptr[2] = ptr[3] = 0;
+            write_le<uint64_t>(ptr + 4, buffer.size());
+            write_le<uint32_t>(ptr + 12, static_cast<uint32_t>(chunk_size));
+            write_le<uint32_t>(ptr + 16, static_cast<uint32_t>(chunk_count));
+            ptr += INDEX_FIXED_SIZE;
+
+            for (const auto& chunk : chunks)
+            {
+                write_le<uint32_t>(ptr, static_cast<uint32_t>(chunk.size()));
+                ptr += 4;
+            }
+        }
+
+        memcpy(ptr, chunks[i].data(), chunks[i].size());
+        ptr += chunks[i].size();
+
+        write_le<uint32_t>(ptr, crcs[i]);
+        write_le<uint32_t>(ptr + 4, static_cast<uint32_t>(uncompressed_size));
+        ptr += GZIP_TRAILER_SIZE;
+    }
+
+    assert(ptr == out.data() + out.size());
+    return out;
+}
+
+/**
+ * Finds the index in the first gzip member's extra field.
+ * \return A pointer to the index and the index's size, or a null pointer if the buffer isn't a chunked container.
+ */
+static std::pair<const uint8_t*, size_t> find_index(const std::vector<uint8_t>& buffer)
+{
+    if (buffer.size() < GZIP_HEADER_SIZE + 2 || buffer[0] != 0x1F || buffer[1] != 0x8B || !(buffer[3] & GZIP_FLAG_EXTRA))
+    {
+        return {nullptr, 0};
+    }
+
+    const size_t extra_size = read_le<uint16_t>(buffer.data() + GZIP_HEADER_SIZE);
+    if (buffer.size() < GZIP_HEADER_SIZE + 2 + extra_size)
+    {
+        return {nullptr, 0};
+    }
+
+    const uint8_t* ptr = buffer.data() + GZIP_HEADER_SIZE + 2;
+    const uint8_t* end = ptr + extra_size;
+
+    while (end - ptr >= 4)
+    {
+        const size_t subfield_size = read_le<uint16_t>(ptr + 2);
+        if (static_cast<size_t>(end - ptr - 4) < subfield_size)
+        {
+            break;
+        }
+
+        if (ptr[0] == INDEX_SI1 && ptr[1] == INDEX_SI2)
+        {
+            return {ptr + 4, subfield_size};
+        }
+
+        ptr += 4 + subfield_size;
+    }
+
+    return {nullptr, 0};
+}
+
+std::vector<uint8_t> st_decompress(const std::vector<uint8_t>& buffer, size_t max_size)
+{
+    const auto [index, index_size] = find_index(buffer);
+
+    if (!index || index_size < INDEX_FIXED_SIZE || index[0] != INDEX_VERSION)
+    {
+        return auto_decompress(buffer);
+    }
+
+    const auto uncompressed_size = read_le<uint64_t>(index + 4);
+    const size_t chunk_size = read_le<uint32_t>(index + 12);
+    const size_t chunk_count = read_le<uint32_t>(index + 16);
+
+    if (uncompressed_size > max_size)
+    {
+        return {};
+    }
+
+    if (chunk_size == 0 || index_size < INDEX_FIXED_SIZE + chunk_count * 4 || (uncompressed_size + chunk_size - 1) / chunk_size > chunk_count)
+    {
+        return {};
+    }
+
+    // Locate every chunk's compressed data
+    std::vector<std::span<const uint8_t>> chunks(chunk_count);
+    size_t offset = GZIP_HEADER_SIZE + 2 + read_le<uint16_t>(buffer.data() + GZIP_HEADER_SIZE);
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        const size_t compressed_size = read_le<uint32_t>(index + INDEX_FIXED_SIZE + i * 4);
+        const size_t header_size = i == 0 ? 0 : GZIP_HEADER_SIZE;
+
+        if (buffer.size() < offset + header_size + compressed_size + GZIP_TRAILER_SIZE)
+        {
+            return {};
+        }
+
+        chunks[i] = std::span(buffer).subspan(offset + header_size, compressed_size + GZIP_TRAILER_SIZE);
+        offset += header_size + compressed_size + GZIP_TRAILER_SIZE;
+    }
+
+    std::vector<uint8_t> out(uncompressed_size);
+    std::atomic<bool> failed = false;
+
+    run_workers(chunk_count, [&](std::atomic<size_t>& next_task) {
+        const auto decompressor = libdeflate_alloc_decompressor();
+
+        for (size_t i; (i = next_task++) < chunk_count && !failed;)
+        {
+            const size_t start = std::min(i * chunk_size, out.size());
+            const size_t size = std::min(chunk_size, out.size() - start);
+            const auto chunk = chunks[i];
+            const auto trailer = chunk.data() + chunk.size() - GZIP_TRAILER_SIZE;
+
+            const auto result = libdeflate_deflate_decompress(decompressor, chunk.data(), chunk.size() - GZIP_TRAILER_SIZE, out.data() + start, size, nullptr);
+
+            if (result != LIBDEFLATE_SUCCESS || read_le<uint32_t>(trailer + 4) != size || read_le<uint32_t>(trailer) != libdeflate_crc32(0, out.data() + start, size))
+            {
+                failed = true;
+            }
+        }
+
+        libdeflate_free_decompressor(decompressor);
+    });
+
+    if (failed)
+    {
+        return {};
+    }
+
+    return out;
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+/*
+ * Savestates are written as a series of concatenated gzip members, each holding an independently compressed chunk of the savestate.
+ * The first member's header carries an extra field with the uncompressed size and the compressed size of every chunk,
+ * which lets chunks be compressed and decompressed in parallel.
+ *
+ * Since concatenated gzip members are still a valid gzip stream, these files stay readable by other tools.
+ * Plain gzip savestates written by older versions are decompressed the old way.
+ */
+
+/**
+ * \brief Compresses a savestate buffer into the chunked container, using all available cores.
+ * \param buffer The savestate buffer.
+ * \return The compressed buffer.
+ */
+std::vector<uint8_t> st_compress(std::span<const uint8_t> buffer);
+
+/**
+ * \brief Decompresses a savestate buffer, which can be in the chunked container, plain gzip-compressed or uncompressed.
+ * \param buffer The buffer.
+ * \param max_size The largest uncompressed size accepted from a chunked container's index. Larger ones are rejected before allocating.
+ * \return The decompressed savestate buffer, or an empty buffer if the operation failed.
+ */
+std::vector<uint8_t> st_decompress(const std::vector<uint8_t>& buffer, size_t max_size);
+
+/**
+ * \brief Stops the threads compressing and decompressing chunks. They're started again when next needed.
+ */
+void st_stop_workers();
@@ -7,7 +7,6 @@
 #include "stdafx.h"
 #include "tlb.h"
 #include "memory.h"
-#include <zlib.h>
 #include <core/Core.h>
 #include <core/r4300/exception.h>
 #include <core/r4300/interrupt.h>
@@ -17,13 +16,14 @@
 #include <core/r4300/recomph.h>
 #include <core/r4300/rom.h>
 
-uint32_t tlb_LUT_r[0x100000];
-uint32_t tlb_LUT_w[0x100000];
+// The chunk which unallocated chunks point to
+static const uint32_t g_zero_chunk[1024]{};
+
+t_tlb_lut tlb_LUT_r;
+t_tlb_lut tlb_LUT_w;
 extern uint32_t interp_addr;
 int32_t jump_marker = 0;
 
-uLong ZEXPORT adler32(uLong adler, const Bytef* buf, uInt len);
-
 uint32_t virtual_to_physical_address(uint32_t addresse, int32_t w)
 {
 	if (addresse >= 0x7f000000 && addresse < 0x80000000) // golden eye hack (it uses TLB a lot)
@@ -37,12 +37,12 @@ uint32_t virtual_to_physical_address(uint32_t addresse, int32_t w)
 	}
 	if (w == 1)
 	{
-		if (tlb_LUT_w[addresse >> 12])
-			return (tlb_LUT_w[addresse >> 12] & 0xFFFFF000) | (addresse & 0xFFF);
+		if (tlb_LUT_w.get(addresse >> 12))
+			return (tlb_LUT_w.get(addresse >> 12) & 0xFFFFF000) | (addresse & 0xFFF);
 	} else
 	{
-		if (tlb_LUT_r[addresse >> 12])
-			return (tlb_LUT_r[addresse >> 12] & 0xFFFFF000) | (addresse & 0xFFF);
+		if (tlb_LUT_r.get(addresse >> 12))
+			return (tlb_LUT_r.get(addresse >> 12) & 0xFFFFF000) | (addresse & 0xFFF);
 	}
 	//g_core->logger->warn("tlb exception !!! @ {:#06x}, {:#06x}, add:{:#06x}", addresse, w, interp_addr);
 	//getchar();
@@ -116,8 +116,8 @@ int32_t probe_nop(uint32_t address)
 	uint32_t a;
 	if (address < 0x80000000 || address > 0xc0000000)
 	{
-		if (tlb_LUT_r[address >> 12])
-			a = (tlb_LUT_r[address >> 12] & 0xFFFFF000) | (address & 0xFFF);
+		if (tlb_LUT_r.get(address >> 12))
+			a = (tlb_LUT_r.get(address >> 12) & 0xFFFFF000) | (address & 0xFFF);
 		else
 			return 0;
 	} else
@@ -134,6 +134,88 @@ int32_t probe_nop(uint32_t address)
 	} else return 0;
 }
 
+t_tlb_lut::t_tlb_lut()
+{
+    std::ranges::fill(m_chunks, const_cast<uint32_t*>(g_zero_chunk));
+}
+
+t_tlb_lut::~t_tlb_lut()
+{
+    clear();
+}
+
+void t_tlb_lut::set(uint32_t page, uint32_t value)
+{
+    uint32_t*& chunk = m_chunks[page >> CHUNK_BITS];
+    if (chunk == g_zero_chunk)
+    {
+        if (!value)
+        {
+            return;
+        }
+        chunk = new uint32_t[CHUNK_SIZE]{};
+    }
+    chunk[page & (CHUNK_SIZE - 1)] = value;
+    ++m_generation;
+}
+
+void t_tlb_lut::clear()
+{
+    ++m_generation;
+    for (auto& chunk : m_chunks)
+    {
+        if (chunk != g_zero_chunk)
+        {
+            delete[] chunk;
+            chunk = const_cast<uint32_t*>(g_zero_chunk);
+        }
+    }
+}
+
+void tlb_map_range(uint32_t start, uint32_t end, uint32_t phys, bool dirty)
+{
+    if (start < end && !(start >= 0x80000000 && end < 0xC0000000) && phys < 0x20000000)
+    {
+        for (uint32_t page = start >> 12; page <= (end - 1) >> 12; page++)
+        {
+            const uint32_t last = std::min(end - 1, (page << 12) | 0xFFF);
+            const uint32_t value = 0x80000000 | (phys + (last - start));
+
+            tlb_LUT_r.set(page, value);
+            if (dirty)
+                tlb_LUT_w.set(page, value);
+        }
+    }
+}
+
+void tlb_unmap_range(uint32_t start, uint32_t end, bool dirty)
+{
+    if (start < end)
+    {
+        for (uint32_t page = start >> 12; page <= (end - 1) >> 12; page++)
+        {
+            tlb_LUT_r.set(page, 0);
+            if (dirty)
+                tlb_LUT_w.set(page, 0);
+        }
+    }
+}
+
+void tlb_rebuild_luts()
+{
+    tlb_LUT_r.clear();
+    tlb_LUT_w.clear();
+
+    // Entries are mapped in index order, so the highest-indexed entry wins where entries overlap
+    for (const auto& entry : tlb_e)
+    {
+        if (entry.v_even)
+            tlb_map_range(entry.start_even, entry.end_even, entry.phys_even, entry.d_even);
+        if (entry.v_odd)
+            tlb_map_range(entry.start_odd, entry.end_odd, entry.phys_odd, entry.d_odd);
+    }
+}
+
 void TLBR()
 {
     int32_t index;
@@ -157,8 +239,8 @@ void TLBWI()
     {
         for (i = tlb_e[core_Index & 0x3F].start_even >> 12; i <= tlb_e[core_Index & 0x3F].end_even >> 12; i++)
         {
-            if (!invalid_code[i] && (invalid_code[tlb_LUT_r[i] >> 12] ||
-                invalid_code[(tlb_LUT_r[i] >> 12) + 0x20000]))
+            if (!invalid_code[i] && (invalid_code[tlb_LUT_r.get(i) >> 12] ||
+                invalid_code[(tlb_LUT_r.get(i) >> 12) + 0x20000]))
                 invalid_code[i] = 1;
             if (!invalid_code[i])
             {
@@ -167,12 +249,12 @@ void TLBWI()
                 md5_byte_t digest[16];
                 md5_init(&state);
                 md5_append(&state,
-                       (const md5_byte_t*)&rdram[(tlb_LUT_r[i]&0x7FF000)/4],
+                       (const md5_byte_t*)&rdram[(tlb_LUT_r.get(i)&0x7FF000)/4],
                        0x1000);
                 md5_finish(&state, digest);
                 for (j=0; j<16; j++) blocks[i]->md5[j] = digest[j];*/
 
-                blocks[i]->adler32 = adler32(0, (const Bytef*)&rdram[(tlb_LUT_r[i] & 0x7FF000) / 4], 0x1000);
+                blocks[i]->hash = hash_code_page(&rdram[(tlb_LUT_r.get(i) & 0x7FF000) / 4]);
 
                 invalid_code[i] = 1;
             }
@@ -180,20 +262,18 @@ void TLBWI()
             {
                 /*int32_t j;
                 for (j=0; j<16; j++) blocks[i]->md5[j] = 0;*/
-                blocks[i]->adler32 = 0;
+                blocks[i]->hash = 0;
             }
-            tlb_LUT_r[i] = 0;
         }
-        if (tlb_e[core_Index & 0x3F].d_even)
-            for (i = tlb_e[core_Index & 0x3F].start_even >> 12; i <= tlb_e[core_Index & 0x3F].end_even >> 12; i++)
-                tlb_LUT_w[i] = 0;
+        tlb_unmap_range(tlb_e[core_Index & 0x3F].start_even, tlb_e[core_Index & 0x3F].end_even,
+            tlb_e[core_Index & 0x3F].d_even);
     }
     if (tlb_e[core_Index & 0x3F].v_odd)
     {
         for (i = tlb_e[core_Index & 0x3F].start_odd >> 12; i <= tlb_e[core_Index & 0x3F].end_odd >> 12; i++)
         {
-            if (!invalid_code[i] && (invalid_code[tlb_LUT_r[i] >> 12] ||
-                invalid_code[(tlb_LUT_r[i] >> 12) + 0x20000]))
+            if (!invalid_code[i] && (invalid_code[tlb_LUT_r.get(i) >> 12] ||
+                invalid_code[(tlb_LUT_r.get(i) >> 12) + 0x20000]))
                 invalid_code[i] = 1;
             if (!invalid_code[i])
             {
@@ -202,12 +282,12 @@ void TLBWI()
                 md5_byte_t digest[16];
                 md5_init(&state);
                 md5_append(&state,
-                       (const md5_byte_t*)&rdram[(tlb_LUT_r[i]&0x7FF000)/4],
+                       (const md5_byte_t*)&rdram[(tlb_LUT_r.get(i)&0x7FF000)/4],
                        0x1000);
                 md5_finish(&state, digest);
                 for (j=0; j<16; j++) blocks[i]->md5[j] = digest[j];*/
 
-                blocks[i]->adler32 = adler32(0, (const Bytef*)&rdram[(tlb_LUT_r[i] & 0x7FF000) / 4], 0x1000);
+                blocks[i]->hash = hash_code_page(&rdram[(tlb_LUT_r.get(i) & 0x7FF000) / 4]);
 
                 invalid_code[i] = 1;
             }
@@ -215,13 +295,11 @@ void TLBWI()
             {
                 /*int32_t j;
                 for (j=0; j<16; j++) blocks[i]->md5[j] = 0;*/
-                blocks[i]->adler32 = 0;
+                blocks[i]->hash = 0;
             }
-            tlb_LUT_r[i] = 0;
         }
-        if (tlb_e[core_Index & 0x3F].d_odd)
-            for (i = tlb_e[core_Index & 0x3F].start_odd >> 12; i <= tlb_e[core_Index & 0x3F].end_odd >> 12; i++)
-                tlb_LUT_w[i] = 0;
+        tlb_unmap_range(tlb_e[core_Index & 0x3F].start_odd, tlb_e[core_Index & 0x3F].end_odd,
+            tlb_e[core_Index & 0x3F].d_odd);
     }
     tlb_e[core_Index & 0x3F].g = (core_EntryLo0 & core_EntryLo1 & 1);
     tlb_e[core_Index & 0x3F].pfn_even = (core_EntryLo0 & 0x3FFFFFC0) >> 6;
@@ -244,19 +322,8 @@ void TLBWI()
 
     if (tlb_e[core_Index & 0x3F].v_even)
     {
-        if (tlb_e[core_Index & 0x3F].start_even < tlb_e[core_Index & 0x3F].end_even &&
-            !(tlb_e[core_Index & 0x3F].start_even >= 0x80000000 &&
-                tlb_e[core_Index & 0x3F].end_even < 0xC0000000) &&
-            tlb_e[core_Index & 0x3F].phys_even < 0x20000000)
-        {
-            for (i = tlb_e[core_Index & 0x3F].start_even; i < tlb_e[core_Index & 0x3F].end_even; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Index & 0x3F].phys_even + (i - tlb_e[core_Index & 0x3F].start_even));
-            if (tlb_e[core_Index & 0x3F].d_even)
-                for (i = tlb_e[core_Index & 0x3F].start_even; i < tlb_e[core_Index & 0x3F].end_even; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                        (tlb_e[core_Index & 0x3F].phys_even + (i - tlb_e[core_Index & 0x3F].start_even));
-        }
+        tlb_map_range(tlb_e[core_Index & 0x3F].start_even, tlb_e[core_Index & 0x3F].end_even,
+            tlb_e[core_Index & 0x3F].phys_even, tlb_e[core_Index & 0x3F].d_even);
 
         for (i = tlb_e[core_Index & 0x3F].start_even >> 12; i <= tlb_e[core_Index & 0x3F].end_even >> 12; i++)
         {
@@ -269,7 +336,7 @@ void TLBWI()
              md5_byte_t digest[16];
              md5_init(&state);
              md5_append(&state,
-                    (const md5_byte_t*)&rdram[(tlb_LUT_r[i]&0x7FF000)/4],
+                    (const md5_byte_t*)&rdram[(tlb_LUT_r.get(i)&0x7FF000)/4],
                     0x1000);
              md5_finish(&state, digest);
              for (j=0; j<16; j++)
@@ -277,9 +344,9 @@ void TLBWI()
                  equal = 0;
              if (equal) invalid_code[i] = 0;
              }*/
-            if (blocks[i] && blocks[i]->adler32)
+            if (blocks[i] && blocks[i]->hash)
             {
-                if (blocks[i]->adler32 == adler32(0, (const Bytef*)&rdram[(tlb_LUT_r[i] & 0x7FF000) / 4], 0x1000))
+                if (blocks[i]->hash == hash_code_page(&rdram[(tlb_LUT_r.get(i) & 0x7FF000) / 4]))
                     invalid_code[i] = 0;
             }
         }
@@ -291,19 +358,8 @@ void TLBWI()
 
     if (tlb_e[core_Index & 0x3F].v_odd)
     {
-        if (tlb_e[core_Index & 0x3F].start_odd < tlb_e[core_Index & 0x3F].end_odd &&
-            !(tlb_e[core_Index & 0x3F].start_odd >= 0x80000000 &&
-                tlb_e[core_Index & 0x3F].end_odd < 0xC0000000) &&
-            tlb_e[core_Index & 0x3F].phys_odd < 0x20000000)
-        {
-            for (i = tlb_e[core_Index & 0x3F].start_odd; i < tlb_e[core_Index & 0x3F].end_odd; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Index & 0x3F].phys_odd + (i - tlb_e[core_Index & 0x3F].start_odd));
-            if (tlb_e[core_Index & 0x3F].d_odd)
-                for (i = tlb_e[core_Index & 0x3F].start_odd; i < tlb_e[core_Index & 0x3F].end_odd; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                        (tlb_e[core_Index & 0x3F].phys_odd + (i - tlb_e[core_Index & 0x3F].start_odd));
-        }
+        tlb_map_range(tlb_e[core_Index & 0x3F].start_odd, tlb_e[core_Index & 0x3F].end_odd,
+            tlb_e[core_Index & 0x3F].phys_odd, tlb_e[core_Index & 0x3F].d_odd);
 
         for (i = tlb_e[core_Index & 0x3F].start_odd >> 12; i <= tlb_e[core_Index & 0x3F].end_odd >> 12; i++)
         {
@@ -316,7 +372,7 @@ void TLBWI()
              md5_byte_t digest[16];
              md5_init(&state);
              md5_append(&state,
-                    (const md5_byte_t*)&rdram[(tlb_LUT_r[i]&0x7FF000)/4],
+                    (const md5_byte_t*)&rdram[(tlb_LUT_r.get(i)&0x7FF000)/4],
                     0x1000);
              md5_finish(&state, digest);
              for (j=0; j<16; j++)
@@ -324,9 +380,9 @@ void TLBWI()
                  equal = 0;
              if (equal) invalid_code[i] = 0;
               }*/
-            if (blocks[i] && blocks[i]->adler32)
+            if (blocks[i] && blocks[i]->hash)
             {
-                if (blocks[i]->adler32 == adler32(0, (const Bytef*)&rdram[(tlb_LUT_r[i] & 0x7FF000) / 4], 0x1000))
+                if (blocks[i]->hash == hash_code_page(&rdram[(tlb_LUT_r.get(i) & 0x7FF000) / 4]))
                     invalid_code[i] = 0;
             }
         }
@@ -344,8 +400,8 @@ void TLBWR()
     {
         for (i = tlb_e[core_Random].start_even >> 12; i <= tlb_e[core_Random].end_even >> 12; i++)
         {
-            if (!invalid_code[i] && (invalid_code[tlb_LUT_r[i] >> 12] ||
-                invalid_code[(tlb_LUT_r[i] >> 12) + 0x20000]))
+            if (!invalid_code[i] && (invalid_code[tlb_LUT_r.get(i) >> 12] ||
+                invalid_code[(tlb_LUT_r.get(i) >> 12) + 0x20000]))
                 invalid_code[i] = 1;
             if (!invalid_code[i])
             {
@@ -354,12 +410,12 @@ void TLBWR()
                 md5_byte_t digest[16];
                 md5_init(&state);
                 md5_append(&state,
-                       (const md5_byte_t*)&rdram[(tlb_LUT_r[i]&0x7FF000)/4],
+                       (const md5_byte_t*)&rdram[(tlb_LUT_r.get(i)&0x7FF000)/4],
                        0x1000);
                 md5_finish(&state, digest);
                 for (j=0; j<16; j++) blocks[i]->md5[j] = digest[j];*/
 
-                blocks[i]->adler32 = adler32(0, (const Bytef*)&rdram[(tlb_LUT_r[i] & 0x7FF000) / 4], 0x1000);
+                blocks[i]->hash = hash_code_page(&rdram[(tlb_LUT_r.get(i) & 0x7FF000) / 4]);
 
                 invalid_code[i] = 1;
             }
@@ -367,20 +423,17 @@ void TLBWR()
             {
                 /*int32_t j;
                 for (j=0; j<16; j++) blocks[i]->md5[j] = 0;*/
-                blocks[i]->adler32 = 0;
+                blocks[i]->hash = 0;
             }
-            tlb_LUT_r[i] = 0;
         }
-        if (tlb_e[core_Random].d_even)
-            for (i = tlb_e[core_Random].start_even >> 12; i <= tlb_e[core_Random].end_even >> 12; i++)
-                tlb_LUT_w[i] = 0;
+        tlb_unmap_range(tlb_e[core_Random].start_even, tlb_e[core_Random].end_even, tlb_e[core_Random].d_even);
     }
     if (tlb_e[core_Random].v_odd)
     {
         for (i = tlb_e[core_Random].start_odd >> 12; i <= tlb_e[core_Random].end_odd >> 12; i++)
         {
-            if (!invalid_code[i] && (invalid_code[tlb_LUT_r[i] >> 12] ||
-                invalid_code[(tlb_LUT_r[i] >> 12) + 0x20000]))
+            if (!invalid_code[i] && (invalid_code[tlb_LUT_r.get(i) >> 12] ||
+                invalid_code[(tlb_LUT_r.get(i) >> 12) + 0x20000]))
                 invalid_code[i] = 1;
             if (!invalid_code[i])
             {
@@ -389,12 +442,12 @@ void TLBWR()
                 md5_byte_t digest[16];
                 md5_init(&state);
                 md5_append(&state,
-                       (const md5_byte_t*)&rdram[(tlb_LUT_r[i]&0x7FF000)/4],
+                       (const md5_byte_t*)&rdram[(tlb_LUT_r.get(i)&0x7FF000)/4],
                        0x1000);
                 md5_finish(&state, digest);
                 for (j=0; j<16; j++) blocks[i]->md5[j] = digest[j];*/
 
-                blocks[i]->adler32 = adler32(0, (const Bytef*)&rdram[(tlb_LUT_r[i] & 0x7FF000) / 4], 0x1000);
+                blocks[i]->hash = hash_code_page(&rdram[(tlb_LUT_r.get(i) & 0x7FF000) / 4]);
 
                 invalid_code[i] = 1;
             }
@@ -402,13 +455,10 @@ void TLBWR()
             {
                 /*int32_t j;
                 for (j=0; j<16; j++) blocks[i]->md5[j] = 0;*/
-                blocks[i]->adler32 = 0;
+                blocks[i]->hash = 0;
             }
-            tlb_LUT_r[i] = 0;
         }
-        if (tlb_e[core_Random].d_odd)
-            for (i = tlb_e[core_Random].start_odd >> 12; i <= tlb_e[core_Random].end_odd >> 12; i++)
-                tlb_LUT_w[i] = 0;
+        tlb_unmap_range(tlb_e[core_Random].start_odd, tlb_e[core_Random].end_odd, tlb_e[core_Random].d_odd);
     }
     tlb_e[core_Random].g = (core_EntryLo0 & core_EntryLo1 & 1);
     tlb_e[core_Random].pfn_even = (core_EntryLo0 & 0x3FFFFFC0) >> 6;
@@ -431,19 +481,8 @@ void TLBWR()
 
     if (tlb_e[core_Random].v_even)
     {
-        if (tlb_e[core_Random].start_even < tlb_e[core_Random].end_even &&
-            !(tlb_e[core_Random].start_even >= 0x80000000 &&
-                tlb_e[core_Random].end_even < 0xC0000000) &&
-            tlb_e[core_Random].phys_even < 0x20000000)
-        {
-            for (i = tlb_e[core_Random].start_even; i < tlb_e[core_Random].end_even; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Random].phys_even + (i - tlb_e[core_Random].start_even));
-            if (tlb_e[core_Random].d_even)
-                for (i = tlb_e[core_Random].start_even; i < tlb_e[core_Random].end_even; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                        (tlb_e[core_Random].phys_even + (i - tlb_e[core_Random].start_even));
-        }
+        tlb_map_range(tlb_e[core_Random].start_even, tlb_e[core_Random].end_even,
+            tlb_e[core_Random].phys_even, tlb_e[core_Random].d_even);
 
         for (i = tlb_e[core_Random].start_even >> 12; i <= tlb_e[core_Random].end_even >> 12; i++)
         {
@@ -456,7 +495,7 @@ void TLBWR()
              md5_byte_t digest[16];
              md5_init(&state);
              md5_append(&state,
-                    (const md5_byte_t*)&rdram[(tlb_LUT_r[i]&0x7FF000)/4],
+                    (const md5_byte_t*)&rdram[(tlb_LUT_r.get(i)&0x7FF000)/4],
                     0x1000);
              md5_finish(&state, digest);
              for (j=0; j<16; j++)
@@ -464,9 +503,9 @@ void TLBWR()
                  equal = 0;
              if (equal) invalid_code[i] = 0;
               }*/
-            if (blocks[i] && blocks[i]->adler32)
+            if (blocks[i] && blocks[i]->hash)
             {
-                if (blocks[i]->adler32 == adler32(0, (const Bytef*)&rdram[(tlb_LUT_r[i] & 0x7FF000) / 4], 0x1000))
+                if (blocks[i]->hash == hash_code_page(&rdram[(tlb_LUT_r.get(i) & 0x7FF000) / 4]))
                     invalid_code[i] = 0;
             }
         }
@@ -478,19 +517,8 @@ void TLBWR()
 
     if (tlb_e[core_Random].v_odd)
     {
-        if (tlb_e[core_Random].start_odd < tlb_e[core_Random].end_odd &&
-            !(tlb_e[core_Random].start_odd >= 0x80000000 &&
-                tlb_e[core_Random].end_odd < 0xC0000000) &&
-            tlb_e[core_Random].phys_odd < 0x20000000)
-        {
-            for (i = tlb_e[core_Random].start_odd; i < tlb_e[core_Random].end_odd; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Random].phys_odd + (i - tlb_e[core_Random].start_odd));
-            if (tlb_e[core_Random].d_odd)
-                for (i = tlb_e[core_Random].start_odd; i < tlb_e[core_Random].end_odd; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                        (tlb_e[core_Random].phys_odd + (i - tlb_e[core_Random].start_odd));
-        }
+        tlb_map_range(tlb_e[core_Random].start_odd, tlb_e[core_Random].end_odd,
+            tlb_e[core_Random].phys_odd, tlb_e[core_Random].d_odd);
 
         for (i = tlb_e[core_Random].start_odd >> 12; i <= tlb_e[core_Random].end_odd >> 12; i++)
         {
@@ -503,7 +531,7 @@ void TLBWR()
              md5_byte_t digest[16];
              md5_init(&state);
              md5_append(&state,
-                    (const md5_byte_t*)&rdram[(tlb_LUT_r[i]&0x7FF000)/4],
+                    (const md5_byte_t*)&rdram[(tlb_LUT_r.get(i)&0x7FF000)/4],
                     0x1000);
              md5_finish(&state, digest);
              for (j=0; j<16; j++)
@@ -511,9 +539,9 @@ void TLBWR()
                  equal = 0;
              if (equal) invalid_code[i] = 0;
              }*/
-            if (blocks[i] && blocks[i]->adler32)
+            if (blocks[i] && blocks[i]->hash)
             {
-                if (blocks[i]->adler32 == adler32(0, (const Bytef*)&rdram[(tlb_LUT_r[i] & 0x7FF000) / 4], 0x1000))
+                if (blocks[i]->hash == hash_code_page(&rdram[(tlb_LUT_r.get(i) & 0x7FF000) / 4]))
                     invalid_code[i] = 0;
             }
         }
@@ -31,7 +31,83 @@ typedef struct _tlb
     uint32_t phys_odd;
 } tlb;
 
-extern uint32_t tlb_LUT_r[0x100000];
-extern uint32_t tlb_LUT_w[0x100000];
+/**
+ * \brief A lookup table from virtual pages to physical addresses.
+ * The table is split into chunks of 1024 pages, which are only allocated once a page in them is mapped.
+ * Unallocated chunks share a zeroed chunk, so lookups don't need to check for them.
+ */
+class t_tlb_lut {
+public:
+    t_tlb_lut();
+    ~t_tlb_lut();
+
+    t_tlb_lut(const t_tlb_lut&) = delete;
+    t_tlb_lut& operator=(const t_tlb_lut&) = delete;
+
+    /**
+     * \brief Gets the entry of a virtual page, or 0 if the page isn't mapped.
+     */
+    uint32_t get(uint32_t page) const
+    {
+        return m_chunks[page >> CHUNK_BITS][page & (CHUNK_SIZE - 1)];
+    }
+
+    /**
+     * \brief Sets the entry of a virtual page.
+     */
+    void set(uint32_t page, uint32_t value);
+
+    /**
+     * \brief Unmaps all pages and frees the chunks.
+     */
+    void clear();
+
+    /**
+     * \brief Gets a counter which is incremented whenever an entry changes, so lookups cached elsewhere can be revalidated.
+     */
+    uint32_t generation() const
+    {
+        return m_generation;
+    }
+
+private:
+    static constexpr uint32_t CHUNK_BITS = 10;
+    static constexpr uint32_t CHUNK_SIZE = 1 << CHUNK_BITS;
+
+    uint32_t* m_chunks[0x100000 / CHUNK_SIZE];
+    uint32_t m_generation = 0;
+};
+
+extern t_tlb_lut tlb_LUT_r;
+extern t_tlb_lut tlb_LUT_w;
+
+/**
+ * \brief Maps one half of a TLB entry in the lookup tables, one page at a time.
+ * \param start The first virtual address of the half.
+ * \param end The last virtual address of the half.
+ * \param phys The physical address \p start translates to.
+ * \param dirty Whether the half is writable, in which case it's also mapped in the write table.
+ * \remarks Each page holds the translation of the last byte of the half within it. Halves outside the mappable range
+ * are left alone.
+ */
+void tlb_map_range(uint32_t start, uint32_t end, uint32_t phys, bool dirty);
+
+/**
+ * \brief Unmaps one half of a TLB entry from the lookup tables, one page at a time.
+ * \param start The first virtual address of the half.
+ * \param end The last virtual address of the half.
+ * \param dirty Whether the half is writable, in which case it's also unmapped from the write table.
+ */
+void tlb_unmap_range(uint32_t start, uint32_t end, bool dirty);
+
+/**
+ * \brief Rebuilds the TLB lookup tables from the TLB entries.
+ * \remarks The result only depends on the entries, not on the order they were written in. Where valid entries overlap,
+ * the highest-indexed one wins, while the tables maintained by TLBWI and TLBWR hold whichever was written last, minus
+ * the pages unmapped by overwriting another entry. Games don't rely on overlapping entries, as the hardware raises
+ * a TLB shutdown for them, so the difference only shows in states which were already undefined.
+ */
+void tlb_rebuild_luts();
+
 uint32_t virtual_to_physical_address(uint32_t addresse, int32_t w);
 int32_t probe_nop(uint32_t address);
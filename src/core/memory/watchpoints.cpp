@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include "watchpoints.h"
+#include "memory.h"
+#include <core/Core.h>
+#include <core/r4300/r4300.h>
+
+struct t_watch {
+    size_t id;
+
+    /// The watched range's physical start address.
+    uint32_t start;
+
+    /// The watched range's physical end address, exclusive.
+    uint32_t end;
+
+    core_dbg_watch_type type;
+
+    std::shared_ptr<const core_dbg_watch_callback> callback;
+};
+
+constexpr uint32_t RDRAM_SIZE = 0x800000;
+
+// The amount of memory handler table entries covering RDRAM.
+constexpr uint32_t RDRAM_PAGE_COUNT = RDRAM_SIZE >> 16;
+
+// The amount of memory handler tables: one per access width, for reads and writes.
+constexpr size_t TABLE_COUNT = 8;
+
+// Locked when accessing the watchpoints or the page state. Recursive since callbacks may add or remove watchpoints.
+static std::recursive_mutex g_watch_mutex;
+
+static std::vector<t_watch> g_watches;
+
+static size_t g_next_watch_id = 1;
+
+// Whether any watchpoint exists. Lets the table maintenance skip locking while there's nothing to do.
+static std::atomic<bool> g_has_watches = false;
+
+// Whether the page types changed since the traps were last applied. The tables are only touched on the emulation thread.
+static std::atomic<bool> g_traps_pending = false;
+
+// The access types watched in each RDRAM page.
+static uint8_t g_page_types[RDRAM_PAGE_COUNT]{};
+
+// The RDRAM segments whose table entries are trapped: cached (0x8000) and uncached (0xa000).
+static constexpr uint32_t g_segments[] = {0x8000, 0xa000};
+
+// The handlers which were replaced by the trapping handlers, per table, segment and page.
+static void (*g_inner_handlers[TABLE_COUNT][std::size(g_segments)][RDRAM_PAGE_COUNT])();
+
+static void (**const g_tables[TABLE_COUNT])() = {
+readmemb, readmemh, readmem, readmemd,
+writememb, writememh, writemem, writememd,
+};
+
+static void fire(uint32_t physical_address, uint32_t size, core_dbg_watch_type type, uint64_t value)
+{
+    std::vector<std::shared_ptr<const core_dbg_watch_callback>> callbacks;
+
+    {
+        std::scoped_lock lock(g_watch_mutex);
+        for (const auto& watch : g_watches)
+        {
+            if ((watch.type & type) && physical_address < watch.end && physical_address + size > watch.start)
+            {
+                callbacks.push_back(watch.callback);
+            }
+        }
+    }
+
+    for (const auto& callback : callbacks)
+    {
+        (*callback)(physical_address, size, type, value);
+    }
+}
+
+/**
+ * The trapping handler for a table. The table's index encodes the access direction and width.
+ */
+template <size_t Table>
+static void trap_handler()
+{
+    constexpr bool write = Table >= 4;
+    constexpr uint32_t size = 1 << (Table % 4);
+
+    const uint32_t physical_address = address & (RDRAM_SIZE - 1);
+    g_inner_handlers[Table][(address >> 29) & 1][physical_address >> 16]();
+
+    if constexpr (write)
+    {
+        const uint64_t values[] = {g_byte, hword, word, dword};
+        fire(physical_address, size, core_dbg_watch_write, values[Table % 4]);
+    }
+    else
+    {
+        fire(physical_address, size, core_dbg_watch_read, *rdword);
+    }
+}
+
+static void (*const g_trap_handlers[TABLE_COUNT])() = {
+trap_handler<0>, trap_handler<1>, trap_handler<2>, trap_handler<3>,
+trap_handler<4>, trap_handler<5>, trap_handler<6>, trap_handler<7>,
+};
+
+/**
+ * Recomputes the access types watched in each page. The watch mutex must be held.
+ */
+static void update_page_types()
+{
+    memset(g_page_types, 0, sizeof(g_page_types));
+    for (const auto& watch : g_watches)
+    {
+        for (uint32_t page = watch.start >> 16; page <= (watch.end - 1) >> 16; ++page)
+        {
+            g_page_types[page] |= watch.type;
+        }
+    }
+}
+
+/**
+ * Swaps the handlers of every page according to the watched access types. The watch mutex must be held.
+ */
+static void apply_traps()
+{
+    for (uint32_t page = 0; page < RDRAM_PAGE_COUNT; ++page)
+    {
+        for (size_t i = 0; i < TABLE_COUNT; ++i)
+        {
+            const auto type = i >= 4 ? core_dbg_watch_write : core_dbg_watch_read;
+            const bool trapped = g_page_types[page] & type;
+
+            for (size_t segment = 0; segment < std::size(g_segments); ++segment)
+            {
+                auto& entry = g_tables[i][g_segments[segment] + page];
+                auto& inner = g_inner_handlers[i][segment][page];
+
+                if (trapped && entry != g_trap_handlers[i])
+                {
+                    inner = entry;
+                    entry = g_trap_handlers[i];
+                }
+                else if (!trapped && entry == g_trap_handlers[i])
+                {
+                    entry = inner;
+                }
+            }
+        }
+    }
+
+    // The dynarec inlines RDRAM accesses while fast memory is enabled, so it has to be turned off and the existing code recompiled.
+    // Like with framebuffer protection, it stays off until the next ROM is started.
+    if (!g_watches.empty() && fast_memory)
+    {
+        fast_memory = 0;
+        memset(invalid_code, 1, sizeof(invalid_code));
+    }
+}
+
+void watch_apply_traps()
+{
+    if (!g_has_watches && !g_traps_pending)
+    {
+        return;
+    }
+
+    std::scoped_lock lock(g_watch_mutex);
+    g_traps_pending = false;
+    apply_traps();
+}
+
+void watch_apply_pending_traps()
+{
+    if (!g_traps_pending)
+    {
+        return;
+    }
+
+    std::scoped_lock lock(g_watch_mutex);
+    g_traps_pending = false;
+    apply_traps();
+}
+
+/**
+ * Schedules the traps to be applied on the emulation thread after the watchpoints changed. The watch mutex must be held.
+ */
+static void watches_changed()
+{
+    update_page_types();
+    g_has_watches = !g_watches.empty();
+    g_traps_pending = true;
+}
+
+size_t core_dbg_add_watch(uint32_t addr, uint32_t len, core_dbg_watch_type type, const core_dbg_watch_callback& callback)
+{
+    const uint32_t start = addr & 0x1FFFFFFF;
+
+    if (len == 0 || start >= RDRAM_SIZE || len > RDRAM_SIZE - start || !(type & core_dbg_watch_read_write) || !callback)
+    {
+        return 0;
+    }
+
+    std::scoped_lock lock(g_watch_mutex);
+
+    const size_t id = g_next_watch_id++;
+    g_watches.push_back(t_watch{
+    .id = id,
+    .start = start,
+    .end = start + len,
+    .type = static_cast<core_dbg_watch_type>(type & core_dbg_watch_read_write),
+    .callback = std::make_shared<const core_dbg_watch_callback>(callback),
+    });
+
+    watches_changed();
+
+    g_core->logger->info("[Watch] Added watchpoint {} at {:#08x}-{:#08x}", id, start, start + len);
+    return id;
+}
+
+void core_dbg_remove_watch(size_t id)
+{
+    std::scoped_lock lock(g_watch_mutex);
+
+    if (std::erase_if(g_watches, [=](const auto& watch) { return watch.id == id; }) == 0)
+    {
+        return;
+    }
+
+    watches_changed();
+}
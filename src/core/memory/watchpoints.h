@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+/*
+ * Watchpoints are implemented by swapping the memory handler table entries of the 64KB RDRAM pages containing watched ranges
+ * for trapping handlers, which forward to the replaced handler and then invoke the matching watchpoints' callbacks.
+ * Accesses to unwatched pages keep going through the regular handlers.
+ *
+ * TLB-mapped accesses are translated before being dispatched through the tables, so they're trapped too.
+ */
+
+/**
+ * \brief Installs the trapping handlers on the RDRAM pages containing watched ranges, and restores the replaced handlers on the other ones.
+ * Must be called after the RDRAM entries of the memory handler tables are overwritten.
+ */
+void watch_apply_traps();
+
+/**
+ * \brief Applies the traps if the watchpoints changed since they were last applied.
+ * Watchpoints are added and removed from other threads, so the tables are only updated here, on the emulation thread.
+ */
+void watch_apply_pending_traps();
@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include "bruteforce.h"
+#include <core/Core.h>
+#include <core/memory/memory.h>
+#include <core/memory/savestates.h>
+#include <core/r4300/r4300.h>
+
+struct t_bf_node {
+    /// The state reached after the inputs.
+    std::shared_ptr<const t_st_delta> state;
+
+    /// The inputs leading to the state from the root.
+    std::vector<core_buttons> inputs;
+
+    double score;
+};
+
+// Locked when accessing the search state. Recursive since the generator and scorer may query the search.
+static std::recursive_mutex g_bf_mutex;
+
+// The running search's parameters, or nothing if no search is running.
+static std::optional<core_bf_params> g_params;
+
+// Whether the running search should be stopped at the next poll.
+static bool g_stop_requested;
+
+// Whether the root savestate was loaded.
+static bool g_started;
+
+// The sequences being extended in the current frame.
+static std::vector<t_bf_node> g_frontier;
+
+// The extended sequences which survived scoring, forming the next frame's frontier.
+static std::vector<t_bf_node> g_children;
+
+// The frontier node being extended.
+static size_t g_parent_index;
+
+// The candidates of the frontier node being extended.
+static std::vector<core_buttons> g_candidates;
+
+// The candidate being tried.
+static size_t g_candidate_index;
+
+// Whether the candidate is being tried, so it's provided at polls and has to be scored at the next PIF read.
+static bool g_evaluating;
+
+// Whether the candidate was provided at a poll since it started being tried.
+static bool g_delivered;
+
+// The chain the nodes' states are encoded in. Kept apart from the seek savestates' chain, so neither moves the other's base.
+static t_st_delta_encoder g_encoder;
+
+static t_bf_node save_node(std::vector<core_buttons> inputs, double score)
+{
+    return t_bf_node{
+    .state = st_encode_delta(g_encoder, st_save_immediate()),
+    .inputs = std::move(inputs),
+    .score = score,
+    };
+}
+
+static void sort_by_score(std::vector<t_bf_node>& nodes)
+{
+    std::ranges::stable_sort(nodes, std::greater{}, &t_bf_node::score);
+}
+
+/**
+ * Ends the running search. The search mutex must be held.
+ * \return The callback to invoke and the results to pass to it.
+ */
+static std::pair<core_bf_callback, std::vector<core_bf_result>> finish()
+{
+    sort_by_score(g_frontier);
+
+    std::vector<core_bf_result> results;
+    for (auto& node : g_frontier)
+    {
+        if (results.size() >= g_params->result_count)
+        {
+            break;
+        }
+
+        // The root is only left in the frontier when stopping before the first frame was searched
+        if (node.inputs.empty())
+        {
+            continue;
+        }
+
+        results.push_back(core_bf_result{
+        .inputs = std::move(node.inputs),
+        .score = node.score,
+        });
+    }
+
+    auto callback = std::move(g_params->callback);
+
+    g_params.reset();
+    g_frontier.clear();
+    g_children.clear();
+    g_candidates.clear();
+    g_encoder = {};
+
+    return {std::move(callback), std::move(results)};
+}
+
+/**
+ * Advances to the next candidate to try, moving on to the next frame once all frontier nodes were extended. The search mutex must be held.
+ * \return Whether there's a candidate to try.
+ */
+static bool next_candidate()
+{
+    while (g_candidate_index >= g_candidates.size())
+    {
+        if (++g_parent_index >= g_frontier.size())
+        {
+            sort_by_score(g_children);
+            if (g_params->beam_width && g_children.size() > g_params->beam_width)
+            {
+                g_children.resize(g_params->beam_width);
+            }
+
+            g_frontier = std::move(g_children);
+            g_children.clear();
+            g_parent_index = 0;
+
+            if (g_frontier.empty() || g_frontier.front().inputs.size() >= g_params->horizon)
+            {
+                return false;
+            }
+
+            g_core->logger->info("[BF] Searching frame {} with {} sequences", g_frontier.front().inputs.size() + 1, g_frontier.size());
+        }
+
+        g_candidates = g_params->generator(g_frontier[g_parent_index].inputs);
+        g_candidate_index = 0;
+    }
+
+    return true;
+}
+
+/**
+ * Advances the search at the start of a PIF read, before any controller is read. The search mutex must be held.
+ * \return The result of the search if it ended.
+ */
+static std::optional<core_result> step()
+{
+    if (!g_started)
+    {
+        if (const auto result = st_load_immediate(g_params->root); result != Res_Ok)
+        {
+            return result;
+        }
+
+        g_started = true;
+        g_frontier = {save_node({}, 0)};
+        g_parent_index = 0;
+        g_candidates = g_params->generator({});
+        g_candidate_index = 0;
+    }
+    else if (g_evaluating && !g_stop_requested)
+    {
+        // The game didn't poll the searched controller since the candidate started being tried, so its frame isn't over yet
+        if (!g_delivered)
+        {
+            return std::nullopt;
+        }
+
+        g_evaluating = false;
+
+        auto inputs = g_frontier[g_parent_index].inputs;
+        inputs.push_back(g_candidates[g_candidate_index]);
+
+        if (const auto score = g_params->scorer(rdram, inputs); score.has_value())
+        {
+            g_children.push_back(save_node(std::move(inputs), score.value()));
+        }
+
+        ++g_candidate_index;
+    }
+
+    if (g_stop_requested)
+    {
+        return BF_Cancelled;
+    }
+
+    if (!next_candidate())
+    {
+        return Res_Ok;
+    }
+
+    if (const auto result = st_load_immediate(st_decode_delta(*g_frontier[g_parent_index].state)); result != Res_Ok)
+    {
+        return result;
+    }
+
+    g_evaluating = true;
+    g_delivered = false;
+    return std::nullopt;
+}
+
+void bf_on_pif_read()
+{
+    std::unique_lock lock(g_bf_mutex);
+
+    if (!g_params.has_value())
+    {
+        return;
+    }
+
+    const auto result = step();
+    if (!result.has_value())
+    {
+        return;
+    }
+
+    const auto root = std::move(g_params->root);
+    const bool started = g_started;
+    auto [callback, results] = finish();
+    lock.unlock();
+
+    g_core->logger->info("[BF] Search finished with result {}", static_cast<int32_t>(result.value()));
+
+    // Go back to where the search started from, so the emulator state doesn't depend on which branch was tried last
+    if (started)
+    {
+        st_load_immediate(root);
+    }
+
+    callback(result.value(), results);
+}
+
+bool bf_on_controller_poll(int32_t index, core_buttons* input)
+{
+    std::scoped_lock lock(g_bf_mutex);
+
+    if (!g_params.has_value())
+    {
+        return false;
+    }
+
+    if (index != g_params->controller || !g_evaluating)
+    {
+        *input = {};
+        return true;
+    }
+
+    *input = g_candidates[g_candidate_index];
+    g_delivered = true;
+    return true;
+}
+
+void bf_on_core_stop()
+{
+    std::unique_lock lock(g_bf_mutex);
+
+    if (!g_params.has_value())
+    {
+        return;
+    }
+
+    auto [callback, results] = finish();
+    lock.unlock();
+
+    callback(BF_Cancelled, results);
+}
+
+core_result core_bf_start(const core_bf_params& params)
+{
+    if (!core_executing)
+    {
+        return VR_NotRunning;
+    }
+
+    if (params.root.empty() || !params.generator || !params.scorer || !params.callback || params.horizon == 0 || params.controller < 0 || params.controller > 3)
+    {
+        return BF_InvalidParams;
+    }
+
+    if (core_vcr_get_task() != task_idle)
+    {
+        return BF_NeedsIdleVcr;
+    }
+
+    std::scoped_lock lock(g_bf_mutex);
+
+    if (g_params.has_value())
+    {
+        return BF_AlreadyRunning;
+    }
+
+    g_params = params;
+    g_stop_requested = false;
+    g_started = false;
+    g_evaluating = false;
+    g_delivered = false;
+
+    g_core->logger->info("[BF] Starting search over {} frames with beam width {}", params.horizon, params.beam_width);
+    return Res_Ok;
+}
+
+void core_bf_stop()
+{
+    std::scoped_lock lock(g_bf_mutex);
+    g_stop_requested = true;
+}
+
+bool core_bf_is_running()
+{
+    std::scoped_lock lock(g_bf_mutex);
+    return g_params.has_value();
+}
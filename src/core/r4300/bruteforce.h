@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <core/include/core_api.h>
+
+/**
+ * \brief Notifies the bruteforcer of the start of a PIF read, before any controller is read. Savestates are only loaded here, like those of the task queue.
+ */
+void bf_on_pif_read();
+
+/**
+ * \brief Notifies the bruteforcer of a controller poll.
+ * \param index The controller index.
+ * \param input The controller's input.
+ * \return Whether the input was provided by the bruteforcer, in which case the poll mustn't be handled further.
+ */
+bool bf_on_controller_poll(int32_t index, core_buttons* input);
+
+/**
+ * \brief Cancels the running search when the core stops.
+ */
+void bf_on_core_stop();
@@ -7,6 +7,7 @@
 #include "stdafx.h"
 #include <core/r4300/debugger.h>
 #include <core/Core.h>
+#include <core/r4300/r4300.h>
 
 bool g_resumed = true;
 bool g_instruction_advancing = false;
@@ -32,6 +33,7 @@ void core_dbg_set_is_resumed(bool value)
         g_instruction_advancing = false;
     }
     g_resumed = value;
+    g_interp_variant_dirty = true;
     g_core->callbacks.debugger_resumed_changed(g_resumed);
 }
 
@@ -39,6 +41,7 @@ void core_dbg_step()
 {
     g_instruction_advancing = true;
     g_resumed = true;
+    g_interp_variant_dirty = true;
 }
 
 bool core_dbg_get_dma_read_enabled()
@@ -71,6 +74,11 @@ void core_dbg_set_rsp_enabled(bool value)
         g_core->plugin_funcs.do_rsp_cycles = dummy_doRspCycles;
 }
 
+bool Debugger::is_active()
+{
+    return !g_resumed || g_instruction_advancing;
+}
+
 void Debugger::on_late_cycle(uint32_t opcode, uint32_t address)
 {
     g_cpu_state = {
@@ -8,6 +8,11 @@
 
 namespace Debugger
 {
+    /**
+     * \brief Gets whether the debugger is paused or stepping, and thus has to be notified of every processor cycle
+     */
+    bool is_active();
+
     /**
      * \brief Notifies the debugger of a processor cycle ending
      * \param opcode The processor's opcode
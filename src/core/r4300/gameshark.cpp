@@ -10,11 +10,184 @@
 #include <core/r4300/gameshark.h>
 #include <core/r4300/r4300.h>
 
+/*
+ * Cheats are compiled into flat op arrays. Comparisons carry the distance to jump ahead by when they fail,
+ * and runs of unconditional writes are grouped into batches which are executed without per-op dispatch.
+ * The ops of all active cheats are concatenated into a single program, which is run at every controller poll.
+ */
+
 static std::vector<core_cheat> cheats;
 
+// The concatenated ops of all active cheats.
+static std::vector<core_cheat_op> g_program;
+
+// Locked when accessing the cheat list or the program.
+static std::mutex g_cheat_mutex;
+
+template <typename T>
+static core_cheat_op make_op(core_cheat_opcode opcode, uint32_t address, uint32_t value)
+{
+    return core_cheat_op{
+    .opcode = opcode,
+    .value = static_cast<uint16_t>(static_cast<T>(value)),
+    .offset = ToAddr<T>(address) & AddrMask,
+    .skip = 0,
+    };
+}
+
+static bool is_comparison(const core_cheat_op& op)
+{
+    return op.opcode >= cht_op_eq8;
+}
+
+static bool is_plain_write(const core_cheat_op& op)
+{
+    return op.opcode == cht_op_write8 || op.opcode == cht_op_write16;
+}
+
+/**
+ * Groups runs of unconditional writes into batches and computes the comparisons' jump distances.
+ * A failed comparison skips the comparisons directly following it and the first op after those, so that op is never put into a batch.
+ */
+static std::vector<core_cheat_op> link_ops(const std::vector<core_cheat_op>& ops)
+{
+    std::vector<core_cheat_op> linked;
+    linked.reserve(ops.size());
+
+    for (size_t i = 0; i < ops.size();)
+    {
+        const bool guarded = i > 0 && is_comparison(ops[i - 1]);
+
+        size_t run = 0;
+        while (!guarded && i + run < ops.size() && is_plain_write(ops[i + run]))
+        {
+            ++run;
+        }
+
+        if (run < 2)
+        {
+            linked.push_back(ops[i++]);
+            continue;
+        }
+
+        linked.push_back(core_cheat_op{
+        .opcode = cht_op_batch,
+        .skip = static_cast<uint32_t>(run),
+        });
+        linked.insert(linked.end(), ops.begin() + i, ops.begin() + i + run);
+        i += run;
+    }
+
+    for (size_t i = 0; i < linked.size(); ++i)
+    {
+        if (!is_comparison(linked[i]))
+        {
+            continue;
+        }
+
+        size_t target = i + 1;
+        while (target < linked.size() && is_comparison(linked[target]))
+        {
+            ++target;
+        }
+        target = std::min(target + 1, linked.size());
+
+        linked[i].skip = static_cast<uint32_t>(target - i - 1);
+    }
+
+    return linked;
+}
+
+template <typename T>
+static void write(const core_cheat_op& op)
+{
+    *(T*)(rdramb + op.offset) = static_cast<T>(op.value);
+    rdram_mark_dirty(op.offset);
+}
+
+template <typename T>
+static T read(const core_cheat_op& op)
+{
+    return *(T*)(rdramb + op.offset);
+}
+
+/**
+ * Runs a compiled op array.
+ */
+static void run_ops(const core_cheat_op* ops, size_t count)
+{
+    const bool gs_button = core_vr_get_gs_button();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& op = ops[i];
+
+        switch (op.opcode)
+        {
+        case cht_op_write8:
+            write<uint8_t>(op);
+            break;
+        case cht_op_write16:
+            write<uint16_t>(op);
+            break;
+        case cht_op_write8_gs:
+            if (gs_button)
+            {
+                write<uint8_t>(op);
+            }
+            break;
+        case cht_op_write16_gs:
+            if (gs_button)
+            {
+                write<uint16_t>(op);
+            }
+            break;
+        case cht_op_batch:
+            for (const auto* batched = &op + 1; batched <= &op + op.skip; ++batched)
+            {
+                if (batched->opcode == cht_op_write8)
+                {
+                    write<uint8_t>(*batched);
+                }
+                else
+                {
+                    write<uint16_t>(*batched);
+                }
+            }
+            i += op.skip;
+            break;
+        case cht_op_eq8:
+            if (read<uint8_t>(op) != op.value)
+            {
+                i += op.skip;
+            }
+            break;
+        case cht_op_eq16:
+            if (read<uint16_t>(op) != op.value)
+            {
+                i += op.skip;
+            }
+            break;
+        case cht_op_ne8:
+            if (read<uint8_t>(op) == op.value)
+            {
+                i += op.skip;
+            }
+            break;
+        case cht_op_ne16:
+            if (read<uint16_t>(op) == op.value)
+            {
+                i += op.skip;
+            }
+            break;
+        }
+    }
+}
+
 bool core_cht_compile(const std::wstring& code, core_cheat& cheat)
 {
     core_cheat compiled_cheat{};
+    std::vector<core_cheat_op> ops;
 
     auto lines = split_string(code, L"\n");
 
@@ -52,10 +225,7 @@ bool core_cht_compile(const std::wstring& code, core_cheat& cheat)
             {
                 // Madghostek: warning, assumes that serial codes are writing bytes, which seems to match pj64
                 // Madghostek: if not, change WB to WW
-                compiled_cheat.instructions.emplace_back(std::make_tuple(false, [=] {
-                    StoreRDRAMSafe<uint8_t>(address + serial_offset * i, val + serial_diff * i);
-                    return true;
-                }));
+                ops.push_back(make_op<uint8_t>(cht_op_write8, address + serial_offset * i, val + serial_diff * i));
             }
             serial = false;
             continue;
@@ -65,68 +235,42 @@ bool core_cht_compile(const std::wstring& code, core_cheat& cheat)
         if (opcode == L"80" || opcode == L"A0")
         {
             // Write byte
-            compiled_cheat.instructions.emplace_back(std::make_tuple(false, [=] {
-                StoreRDRAMSafe<uint8_t>(address, val & 0xFF);
-                return true;
-            }));
+            ops.push_back(make_op<uint8_t>(cht_op_write8, address, val));
         }
         else if (opcode == L"81" || opcode == L"A1")
         {
             // Write word
-            compiled_cheat.instructions.emplace_back(std::make_tuple(false, [=] {
-                StoreRDRAMSafe<uint16_t>(address, val);
-                return true;
-            }));
+            ops.push_back(make_op<uint16_t>(cht_op_write16, address, val));
         }
         else if (opcode == L"88")
         {
             // Write byte if GS button pressed
-            compiled_cheat.instructions.emplace_back(std::make_tuple(false, [=] {
-                if (core_vr_get_gs_button())
-                {
-                    StoreRDRAMSafe<uint8_t>(address, val & 0xFF);
-                }
-                return true;
-            }));
+            ops.push_back(make_op<uint8_t>(cht_op_write8_gs, address, val));
         }
         else if (opcode == L"89")
         {
             // Write word if GS button pressed
-            compiled_cheat.instructions.emplace_back(std::make_tuple(false, [=] {
-                if (core_vr_get_gs_button())
-                {
-                    StoreRDRAMSafe<uint16_t>(address, val);
-                }
-                return true;
-            }));
+            ops.push_back(make_op<uint16_t>(cht_op_write16_gs, address, val));
         }
         else if (opcode == L"D0")
         {
             // Byte equality comparison
-            compiled_cheat.instructions.emplace_back(std::make_tuple(true, [=] {
-                return LoadRDRAMSafe<uint8_t>(address) == (val & 0xFF);
-            }));
+            ops.push_back(make_op<uint8_t>(cht_op_eq8, address, val));
         }
         else if (opcode == L"D1")
         {
             // Word equality comparison
-            compiled_cheat.instructions.emplace_back(std::make_tuple(true, [=] {
-                return LoadRDRAMSafe<uint16_t>(address) == val;
-            }));
+            ops.push_back(make_op<uint16_t>(cht_op_eq16, address, val));
         }
         else if (opcode == L"D2")
         {
             // Byte inequality comparison
-            compiled_cheat.instructions.emplace_back(std::make_tuple(true, [=] {
-                return LoadRDRAMSafe<uint8_t>(address) != (val & 0xFF);
-            }));
+            ops.push_back(make_op<uint8_t>(cht_op_ne8, address, val));
         }
         else if (opcode == L"D3")
         {
             // Word inequality comparison
-            compiled_cheat.instructions.emplace_back(std::make_tuple(true, [=] {
-                return LoadRDRAMSafe<uint16_t>(address) != val;
-            }));
+            ops.push_back(make_op<uint16_t>(cht_op_ne16, address, val));
         }
         else if (opcode == L"50")
         {
@@ -144,6 +288,7 @@ bool core_cht_compile(const std::wstring& code, core_cheat& cheat)
     }
 
     compiled_cheat.code = code;
+    compiled_cheat.ops = link_ops(ops);
     cheat = compiled_cheat;
     
     return true;
@@ -152,40 +297,30 @@ bool core_cht_compile(const std::wstring& code, core_cheat& cheat)
 
 void core_cht_get_list(std::vector<core_cheat>& list)
 {
+    std::scoped_lock lock(g_cheat_mutex);
     list.clear();
     list = cheats;
 }
 
 void core_cht_set_list(const std::vector<core_cheat>& list)
 {
-    cheats = list;
-}
-
-void cht_execute(const core_cheat& cheat)
-{
-    if (!cheat.active)
-    {
-        return;
-    }
-
-    bool execute = true;
-    for (auto instruction : cheat.instructions)
+    // Jump distances never reach past the end of their cheat, so the cheats' ops can be concatenated as-is
+    std::vector<core_cheat_op> program;
+    for (const auto& cheat : list)
     {
-        if (execute)
+        if (cheat.active)
         {
-            execute = std::get<1>(instruction)();
-        }
-        else if (!std::get<0>(instruction))
-        {
-            execute = true;
+            program.insert(program.end(), cheat.ops.begin(), cheat.ops.end());
         }
     }
+
+    std::scoped_lock lock(g_cheat_mutex);
+    cheats = list;
+    g_program = std::move(program);
 }
 
 void cht_execute()
 {
-    for (const auto& cheat : cheats)
-    {
-        cht_execute(cheat);
-    }
+    std::scoped_lock lock(g_cheat_mutex);
+    run_ops(g_program.data(), g_program.size());
 }
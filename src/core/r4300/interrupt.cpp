@@ -14,95 +14,164 @@
 #include <core/r4300/macros.h>
 #include <core/r4300/exception.h>
 #include <core/r4300/vcr.h>
+#include <core/r4300/telemetry.h>
 #include <core/r4300/timers.h>
 #include <core/memory/pif.h>
+#include <core/memory/watchpoints.h>
 
 typedef struct _interrupt_queue
 {
     int32_t type;
     uint32_t count;
     struct _interrupt_queue* next;
+    struct _interrupt_queue* prev;
 } interrupt_queue;
 
+/**
+ * The number of type slots. Interrupt types are single bits, so their bit index is used as the slot index.
+ * The last slot collects any unknown types, which can only come from corrupted savestates.
+ */
+constexpr size_t type_slot_count = 10;
+
 static interrupt_queue* q = NULL;
 
 interrupt_queue g_pool[128]{};
-uint8_t g_pool_used[sizeof(g_pool)]{};
-size_t g_known_unused_index = SIZE_MAX;
+interrupt_queue* g_pool_free = nullptr;
+
+/**
+ * The first queued event of each type, in queue order.
+ */
+static interrupt_queue* g_type_first[type_slot_count]{};
+
+/**
+ * The number of queued events of each type. Usually 0 or 1, CHECK_INT being the only type which legitimately stacks up.
+ */
+static uint32_t g_type_queued[type_slot_count]{};
+
+static size_t type_slot(int32_t type)
+{
+    const auto index = std::countr_zero((uint32_t)type);
+    return (type & (type - 1)) == 0 && index < type_slot_count - 1 ? index : type_slot_count - 1;
+}
+
+void pool_clear();
 
 /**
  * Allocates an item in the interrupt pool.
  */
 interrupt_queue* pool_alloc()
 {
-    size_t unused_index = SIZE_MAX;
+    // The free list is built lazily, as the queue can be used before it is first cleared
+    if (g_pool_free == nullptr && q == NULL)
+        pool_clear();
+
+    assert(g_pool_free != nullptr);
+
+    interrupt_queue* item = g_pool_free;
+    g_pool_free = item->next;
+    return item;
+}
+
+/**
+ * Frees an interrupt from the pool, allowing it to be reused.
+ */
+void pool_free(interrupt_queue* ptr)
+{
+    assert(ptr >= g_pool && ptr < g_pool + std::size(g_pool));
+
+    ptr->next = g_pool_free;
+    ptr->prev = nullptr;
+    g_pool_free = ptr;
+}
 
-    // OPTIMIZATION: If we know that there is an unused index, use it
-    if (g_known_unused_index != SIZE_MAX)
+/**
+ * Clears the pool.
+ */
+void pool_clear()
+{
+    g_pool_free = nullptr;
+    for (auto& item : g_pool)
     {
-        unused_index = g_known_unused_index;
+        pool_free(&item);
     }
-    else
+    memset(g_type_first, 0, sizeof(g_type_first));
+    memset(g_type_queued, 0, sizeof(g_type_queued));
+}
+
+/**
+ * Finds the first queued event of the specified slot by walking the queue.
+ * Only needed when a type is queued more than once, which is rare.
+ */
+static void refresh_type_first(size_t slot)
+{
+    g_type_first[slot] = nullptr;
+    for (interrupt_queue* aux = q; aux != NULL; aux = aux->next)
     {
-        for (int32_t i = 0; i < sizeof(g_pool); ++i)
+        if (type_slot(aux->type) == slot)
         {
-            if (g_pool_used[i] == false)
-            {
-                unused_index = i;
-                break;
-            }
+            g_type_first[slot] = aux;
+            return;
         }
-        assert(unused_index != SIZE_MAX);
     }
-
-    g_pool_used[unused_index] = true;
-    g_known_unused_index = SIZE_MAX;
-
-    return &g_pool[unused_index];
 }
 
 /**
- * Frees an interrupt from the pool, allowing it to be reused.
+ * Allocates an event and links it into the queue after the specified event.
+ * \param prev The event to insert after, or NULL to insert at the head of the queue.
  */
-void pool_free(const interrupt_queue* ptr)
+static interrupt_queue* queue_insert_after(interrupt_queue* prev, int32_t type, uint32_t count)
 {
-    const auto index_in_pool = ptr - (interrupt_queue*)&g_pool;
+    interrupt_queue* item = pool_alloc();
+    item->type = type;
+    item->count = count;
+    item->prev = prev;
 
-#ifdef _DEBUG
-    size_t index = SIZE_MAX;
-    for (int32_t i = 0; i < sizeof(g_pool); ++i)
+    if (prev == NULL)
     {
-        if (&g_pool[i] == ptr)
-        {
-            index = i;
-            break;
-        }
+        item->next = q;
+        q = item;
     }
+    else
+    {
+        item->next = prev->next;
+        prev->next = item;
+    }
+    if (item->next != NULL)
+        item->next->prev = item;
 
-    assert(index != SIZE_MAX);
-    assert(index == index_in_pool);
-#endif
+    const size_t slot = type_slot(type);
+    if (g_type_queued[slot]++ == 0)
+        g_type_first[slot] = item;
+    else
+        refresh_type_first(slot);
 
-    g_pool_used[index_in_pool] = false;
-    g_known_unused_index = index_in_pool;
+    return item;
 }
 
 /**
- * Clears the pool.
+ * Unlinks an event from the queue and returns it to the pool.
  */
-void pool_clear()
+static void queue_unlink(interrupt_queue* item)
 {
-    memset(g_pool_used, 0, std::size(g_pool_used));
-    g_known_unused_index = SIZE_MAX;
+    if (item->prev == NULL)
+        q = item->next;
+    else
+        item->prev->next = item->next;
+    if (item->next != NULL)
+        item->next->prev = item->prev;
+
+    const size_t slot = type_slot(item->type);
+    if (--g_type_queued[slot] == 0)
+        g_type_first[slot] = nullptr;
+    else if (g_type_first[slot] == item)
+        refresh_type_first(slot);
+
+    pool_free(item);
 }
 
 void clear_queue()
 {
-    while (q != NULL)
-    {
-        interrupt_queue* aux = q->next;
-        q = aux;
-    }
+    q = NULL;
     pool_clear();
 }
 
@@ -187,10 +256,7 @@ void add_interrupt_event(int32_t type, uint32_t delay)
 
     if (q == NULL)
     {
-        q = pool_alloc();
-        q->next = NULL;
-        q->count = count;
-        q->type = type;
+        queue_insert_after(NULL, type, count);
         next_interrupt = q->count;
         //print_queue();
         return;
@@ -199,10 +265,7 @@ void add_interrupt_event(int32_t type, uint32_t delay)
     // finds place in queue to insert the interrupt ( its sorted )
     if (before_event(count, q->count, q->type) && !special)
     {
-        q = pool_alloc();
-        q->next = aux;
-        q->count = count;
-        q->type = type;
+        queue_insert_after(NULL, type, count);
         next_interrupt = q->count;
         //print_queue();
         return;
@@ -212,27 +275,11 @@ void add_interrupt_event(int32_t type, uint32_t delay)
         || special))
         aux = aux->next;
 
-    if (aux->next == NULL)
-    {
-        aux->next = pool_alloc();
-        aux = aux->next;
-        aux->next = NULL;
-        aux->count = count;
-        aux->type = type;
-    }
-    else
-    {
-        interrupt_queue* aux2;
-        if (type != SPECIAL_INT)
-            while (aux->next != NULL && aux->next->count == count)
-                aux = aux->next;
-        aux2 = aux->next;
-        aux->next = pool_alloc();
-        aux = aux->next;
-        aux->next = aux2;
-        aux->count = count;
-        aux->type = type;
-    }
+    if (aux->next != NULL && type != SPECIAL_INT)
+        while (aux->next != NULL && aux->next->count == count)
+            aux = aux->next;
+
+    queue_insert_after(aux, type, count);
     /*if (q->count > Count || (Count - q->count) < 0x80000000)
       next_interrupt = q->count;
     else
@@ -253,10 +300,8 @@ void add_interrupt_event_count(int32_t type, uint32_t count)
 
 void remove_interrupt_event()
 {
-    interrupt_queue* aux = q->next;
     if (q->type == SPECIAL_INT) SPECIAL_done = 1;
-    pool_free(q);
-    q = aux;
+    queue_unlink(q);
     if (q != NULL && (q->count > core_Count || (core_Count - q->count) < 0x80000000))
         next_interrupt = q->count;
     else
@@ -270,15 +315,15 @@ void remove_interrupt_event()
 /// <returns></returns>
 uint32_t get_event(int32_t type)
 {
-    interrupt_queue* aux = q;
-    if (q == NULL) return 0;
-    if (q->type == type)
-        return q->count;
-    while (aux->next != NULL && aux->next->type != type)
-        aux = aux->next;
-    if (aux->next != NULL)
-        return aux->next->count;
-    return 0;
+    const size_t slot = type_slot(type);
+    const interrupt_queue* item = g_type_first[slot];
+
+    // Unknown types share a slot, so the first one of that slot isn't necessarily the one we're looking for
+    if (slot == type_slot_count - 1)
+        while (item != NULL && item->type != type)
+            item = item->next;
+
+    return item != NULL && item->type == type ? item->count : 0;
 }
 
 /// <summary>
@@ -287,23 +332,15 @@ uint32_t get_event(int32_t type)
 /// <param name="type">interrupt type to find</param>
 void remove_event(int32_t type)
 {
-    interrupt_queue* aux = q;
-    if (q == NULL) return;
-    if (q->type == type)
-    {
-        aux = aux->next;
-        pool_free(q);
-        q = aux;
-        return;
-    }
-    while (aux->next != NULL && aux->next->type != type)
-        aux = aux->next;
-    if (aux->next != NULL) // it's a type int32_t
-    {
-        interrupt_queue* aux2 = aux->next->next;
-        pool_free(aux->next);
-        aux->next = aux2;
-    }
+    const size_t slot = type_slot(type);
+    interrupt_queue* item = g_type_first[slot];
+
+    if (slot == type_slot_count - 1)
+        while (item != NULL && item->type != type)
+            item = item->next;
+
+    if (item == NULL || item->type != type) return;
+    queue_unlink(item);
 }
 
 void translate_event_queue(uint32_t base)
@@ -386,21 +423,7 @@ void check_interrupt()
     // (which does nothing itself but makes cpu jump to general exception vector)
     if (core_Status & core_Cause & 0xFF00)
     {
-        if (q == NULL)
-        {
-            q = pool_alloc();
-            q->next = NULL;
-            q->count = core_Count;
-            q->type = CHECK_INT;
-        }
-        else
-        {
-            interrupt_queue* aux = pool_alloc();
-            aux->next = q;
-            aux->count = core_Count;
-            aux->type = CHECK_INT;
-            q = aux;
-        }
+        queue_insert_after(NULL, CHECK_INT, core_Count);
         next_interrupt = core_Count;
     }
 }
@@ -416,6 +439,7 @@ void gen_interrupt()
     if (stop)
     {
         dyna_stop();
+        return;
     }
 
     if (skip_jump /*&& !dynacore*/)
@@ -445,6 +469,9 @@ void gen_interrupt()
         skip_jump = 0;
         return;
     }
+
+    watch_apply_pending_traps();
+
     auto type = q->type;
     switch (q->type)
     {
@@ -468,11 +495,17 @@ void gen_interrupt()
             // The update-limiting logic doesn't apply in frameadvance because there are no high-frequency updates
             if (update || frame_advancing)
             {
+                t_tm_scope scope(core_tm_update_screen);
                 g_core->update_screen();
+                // The video plugin may write the framebuffer back to RDRAM
+                rdram_mark_all_dirty();
                 screen_invalidated = false;
             }
 
-            g_core->callbacks.vi();
+            {
+                t_tm_scope scope(core_tm_callbacks);
+                g_core->callbacks.vi();
+            }
 
             vcr_on_vi();
 
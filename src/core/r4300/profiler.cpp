@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include "profiler.h"
+#include <core/Core.h>
+#include <core/r4300/r4300.h>
+
+struct t_prof_frame {
+    /// The called function's entry address.
+    uint32_t function;
+
+    /// The address the function returns to, or 0 for exception handlers.
+    uint32_t return_address;
+};
+
+struct t_stack_hash {
+    size_t operator()(const std::vector<uint32_t>& stack) const
+    {
+        size_t hash = 14695981039346656037ULL;
+        for (const auto function : stack)
+        {
+            hash = (hash ^ function) * 1099511628211ULL;
+        }
+        return hash;
+    }
+};
+
+// The maximum depth of the shadow call stack. Deeper frames push out the outermost ones.
+constexpr size_t MAX_STACK_DEPTH = 128;
+
+// The entry point of general exception handlers.
+constexpr uint32_t EXCEPTION_VECTOR = 0x80000180;
+
+constexpr uint32_t OP_JR_RA = 0x03E00008;
+constexpr uint32_t OP_ERET = 0x42000018;
+
+bool g_prof_enabled = false;
+
+// The amount of instructions between samples.
+static uint32_t g_interval = 1000;
+
+// The amount of instructions left until the next sample.
+static uint32_t g_countdown;
+
+// The shadow call stack, built from calls and returns. Only touched by the emulation thread.
+static std::vector<t_prof_frame> g_stack;
+
+// Set when the shadow call stack should be cleared before the next instruction.
+static std::atomic<bool> g_stack_reset_requested;
+
+// Locked when accessing the aggregated samples.
+static std::mutex g_samples_mutex;
+
+// The sample counts of each observed call stack, from the outermost function to the innermost one.
+static std::unordered_map<std::vector<uint32_t>, uint64_t, t_stack_hash> g_samples;
+
+static void push_frame(uint32_t function, uint32_t return_address)
+{
+    if (g_stack.size() >= MAX_STACK_DEPTH)
+    {
+        g_stack.erase(g_stack.begin());
+    }
+    g_stack.push_back({function, return_address});
+}
+
+/**
+ * Pops the topmost frame matching a predicate along with all frames above it. The stack is left untouched if no frame matches, since that means the return didn't belong to a call we observed.
+ */
+template <typename F>
+static void pop_frames(F predicate)
+{
+    for (size_t i = g_stack.size(); i > 0; --i)
+    {
+        if (predicate(g_stack[i - 1]))
+        {
+            g_stack.resize(i - 1);
+            return;
+        }
+    }
+}
+
+static void take_sample()
+{
+    std::vector<uint32_t> stack(g_stack.size());
+    for (size_t i = 0; i < g_stack.size(); ++i)
+    {
+        stack[i] = g_stack[i].function;
+    }
+
+    std::scoped_lock lock(g_samples_mutex);
+    ++g_samples[std::move(stack)];
+}
+
+void prof_on_instruction(uint32_t address, uint32_t opcode)
+{
+    if (g_stack_reset_requested.exchange(false, std::memory_order_relaxed))
+    {
+        g_stack.clear();
+    }
+
+    if (address == EXCEPTION_VECTOR)
+    {
+        push_frame(EXCEPTION_VECTOR, 0);
+    }
+
+    if (--g_countdown == 0)
+    {
+        g_countdown = g_interval;
+        take_sample();
+    }
+
+    const uint32_t op = opcode >> 26;
+
+    // JAL
+    if (op == 3)
+    {
+        push_frame((address & 0xF0000000) | ((opcode & 0x3FFFFFF) << 2), address + 8);
+        return;
+    }
+
+    if (op == 0)
+    {
+        // JR ra
+        if (opcode == OP_JR_RA)
+        {
+            const auto ra = static_cast<uint32_t>(reg[31]);
+            pop_frames([=](const t_prof_frame& frame) { return frame.return_address == ra; });
+            return;
+        }
+
+        // JALR
+        if ((opcode & 0x3F) == 9)
+        {
+            push_frame(static_cast<uint32_t>(reg[(opcode >> 21) & 0x1F]), address + 8);
+        }
+        return;
+    }
+
+    if (opcode == OP_ERET)
+    {
+        pop_frames([](const t_prof_frame& frame) { return frame.return_address == 0; });
+    }
+}
+
+void core_prof_start(uint32_t interval)
+{
+    g_interval = std::max<uint32_t>(interval, 1);
+    g_countdown = g_interval;
+    g_stack_reset_requested = true;
+    g_prof_enabled = true;
+    g_interp_variant_dirty = true;
+}
+
+void core_prof_stop()
+{
+    g_prof_enabled = false;
+    g_interp_variant_dirty = true;
+}
+
+bool core_prof_is_active()
+{
+    return g_prof_enabled;
+}
+
+void core_prof_reset()
+{
+    std::scoped_lock lock(g_samples_mutex);
+    g_samples.clear();
+}
+
+void core_prof_get_functions(std::vector<core_prof_function>& functions)
+{
+    std::unordered_map<uint32_t, core_prof_function> map;
+
+    {
+        std::scoped_lock lock(g_samples_mutex);
+        for (const auto& [stack, count] : g_samples)
+        {
+            if (stack.empty())
+            {
+                continue;
+            }
+
+            map[stack.back()].self_samples += count;
+
+            // Recursive functions appear several times in a stack but only count once towards their total
+            for (size_t i = 0; i < stack.size(); ++i)
+            {
+                if (std::find(stack.begin(), stack.begin() + i, stack[i]) == stack.begin() + i)
+                {
+                    map[stack[i]].total_samples += count;
+                }
+            }
+        }
+    }
+
+    functions.clear();
+    functions.reserve(map.size());
+    for (auto& [address, function] : map)
+    {
+        function.address = address;
+        functions.push_back(function);
+    }
+
+    std::ranges::sort(functions, std::greater{}, &core_prof_function::self_samples);
+}
+
+core_result core_prof_write_folded(const std::filesystem::path& path)
+{
+    std::string text;
+
+    {
+        std::scoped_lock lock(g_samples_mutex);
+        for (const auto& [stack, count] : g_samples)
+        {
+            // The outermost frames usually precede the start of profiling, so every stack is rooted at a placeholder
+            text += "[unknown]";
+            for (const auto function : stack)
+            {
+                text += std::format(";{:#010x}", function);
+            }
+            text += std::format(" {}\n", count);
+        }
+    }
+
+    FILE* f = _wfopen(path.wstring().c_str(), L"wb");
+    if (!f)
+    {
+        return PF_FileOpenFailed;
+    }
+
+    fwrite(text.data(), 1, text.size(), f);
+    fclose(f);
+    return Res_Ok;
+}
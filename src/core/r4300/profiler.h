@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+/**
+ * \brief Whether the guest profiler is active. Checked by the interpreters before calling <c>prof_on_instruction</c>.
+ */
+extern bool g_prof_enabled;
+
+/**
+ * \brief Notifies the profiler of an instruction about to be executed.
+ * \param address The instruction's address.
+ * \param opcode The instruction's opcode.
+ * \remarks Instructions in delay slots don't have to be reported.
+ */
+void prof_on_instruction(uint32_t address, uint32_t opcode);
@@ -14,6 +14,7 @@
 #include <core/r4300/exception.h>
 #include <core/r4300/interrupt.h>
 #include <core/r4300/macros.h>
+#include <core/r4300/profiler.h>
 #include <core/r4300/r4300.h>
 #include <core/r4300/rom.h>
 #include <core/r4300/tracelog.h>
@@ -27,8 +28,66 @@ uint32_t interp_addr;
 uint32_t vr_op;
 static int32_t skip;
 
+/**
+ * The handler of the last prefetched instruction, with the SPECIAL, REGIMM and COP0 sub-tables already resolved.
+ */
+static void (*interp_handler)();
+
+/**
+ * A decoded instruction in the pure interpreter's instruction cache.
+ */
+struct interp_decoded_instr
+{
+    /**
+     * The opcode this entry was decoded from. Entries are only used if it matches the opcode in memory.
+     */
+    uint32_t op;
+    void (*handler)();
+    decltype(precomp_instr::f) f;
+
+    /**
+     * The write generation of the page when op was last compared against memory. Fetches only skip the comparison while it's current.
+     */
+    uint32_t generation;
+};
+
+/**
+ * The number of instructions in a 4 KB page.
+ */
+constexpr size_t interp_page_instrs = 0x1000 / 4;
+
+/**
+ * Decoded instructions per physical RDRAM page, allocated when code in the page is first executed.
+ */
+static std::unique_ptr<interp_decoded_instr[]> g_decoded_pages[0x800000 / 0x1000];
+
+/**
+ * The page of the last fetch which went through the instruction cache. Fetches from the same virtual page skip the
+ * address translation and the opcode load, as long as neither the physical page nor the TLB changed since.
+ */
+struct interp_fetch_page
+{
+    uint32_t vpage = UINT32_MAX;
+    uint32_t ppage;
+    interp_decoded_instr* decoded;
+    uint32_t rdram_generation;
+    uint32_t tlb_generation;
+};
+
+static interp_fetch_page g_fetch_page;
+
+/**
+ * The virtual address of the instruction being fetched, before the address translation.
+ */
+static uint32_t g_fetch_vaddr;
+
 void prefetch();
 
+/**
+ * Whether a feature affecting the interpreter loop variant was toggled. The loop picks a new variant after finishing the current instruction when this is set.
+ */
+volatile bool g_interp_variant_dirty;
+
 extern void (*interp_ops[])(void);
 
 extern uint32_t next_vi;
@@ -87,7 +146,7 @@ static void JR()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    interp_handler();
     update_count();
     delay_slot = 0;
     interp_addr = local_rs32;
@@ -102,7 +161,7 @@ static void JALR()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    interp_handler();
     update_count();
     delay_slot = 0;
     if (!skip_jump)
@@ -487,7 +546,7 @@ static void BLTZ()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    interp_handler();
     update_count();
     delay_slot = 0;
     if (local_rs < 0)
@@ -517,7 +576,7 @@ static void BGEZ()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    interp_handler();
     update_count();
     delay_slot = 0;
     if (local_rs >= 0)
@@ -549,7 +608,7 @@ static void BLTZL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        interp_handler();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -582,7 +641,7 @@ static void BGEZL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        interp_handler();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -616,7 +675,7 @@ static void BLTZAL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        interp_handler();
         update_count();
         delay_slot = 0;
         if (local_rs < 0)
@@ -651,7 +710,7 @@ static void BGEZAL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        interp_handler();
         update_count();
         delay_slot = 0;
         if (local_rs >= 0)
@@ -688,7 +747,7 @@ static void BLTZALL()
             interp_addr += 4;
             delay_slot = 1;
             prefetch();
-            interp_ops[((vr_op >> 26) & 0x3F)]();
+            interp_handler();
             update_count();
             delay_slot = 0;
             interp_addr += (local_immediate - 1) * 4;
@@ -726,7 +785,7 @@ static void BGEZALL()
             interp_addr += 4;
             delay_slot = 1;
             prefetch();
-            interp_ops[((vr_op >> 26) & 0x3F)]();
+            interp_handler();
             update_count();
             delay_slot = 0;
             interp_addr += (local_immediate - 1) * 4;
@@ -763,24 +822,12 @@ static void TLBR()
 
 static void TLBWI()
 {
-    uint32_t i;
-
     if (tlb_e[core_Index & 0x3F].v_even)
-    {
-        for (i = tlb_e[core_Index & 0x3F].start_even; i < tlb_e[core_Index & 0x3F].end_even; i++)
-            tlb_LUT_r[i >> 12] = 0;
-        if (tlb_e[core_Index & 0x3F].d_even)
-            for (i = tlb_e[core_Index & 0x3F].start_even; i < tlb_e[core_Index & 0x3F].end_even; i++)
-                tlb_LUT_w[i >> 12] = 0;
-    }
+        tlb_unmap_range(tlb_e[core_Index & 0x3F].start_even, tlb_e[core_Index & 0x3F].end_even,
+            tlb_e[core_Index & 0x3F].d_even);
     if (tlb_e[core_Index & 0x3F].v_odd)
-    {
-        for (i = tlb_e[core_Index & 0x3F].start_odd; i < tlb_e[core_Index & 0x3F].end_odd; i++)
-            tlb_LUT_r[i >> 12] = 0;
-        if (tlb_e[core_Index & 0x3F].d_odd)
-            for (i = tlb_e[core_Index & 0x3F].start_odd; i < tlb_e[core_Index & 0x3F].end_odd; i++)
-                tlb_LUT_w[i >> 12] = 0;
-    }
+        tlb_unmap_range(tlb_e[core_Index & 0x3F].start_odd, tlb_e[core_Index & 0x3F].end_odd,
+            tlb_e[core_Index & 0x3F].d_odd);
     tlb_e[core_Index & 0x3F].g = (core_EntryLo0 & core_EntryLo1 & 1);
     tlb_e[core_Index & 0x3F].pfn_even = (core_EntryLo0 & 0x3FFFFFC0) >> 6;
     tlb_e[core_Index & 0x3F].pfn_odd = (core_EntryLo1 & 0x3FFFFFC0) >> 6;
@@ -801,21 +848,8 @@ static void TLBWI()
     tlb_e[core_Index & 0x3F].phys_even = tlb_e[core_Index & 0x3F].pfn_even << 12;
 
     if (tlb_e[core_Index & 0x3F].v_even)
-    {
-        if (tlb_e[core_Index & 0x3F].start_even < tlb_e[core_Index & 0x3F].end_even &&
-            !(tlb_e[core_Index & 0x3F].start_even >= 0x80000000 &&
-                tlb_e[core_Index & 0x3F].end_even < 0xC0000000) &&
-            tlb_e[core_Index & 0x3F].phys_even < 0x20000000)
-        {
-            for (i = tlb_e[core_Index & 0x3F].start_even; i < tlb_e[core_Index & 0x3F].end_even; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Index & 0x3F].phys_even + (i - tlb_e[core_Index & 0x3F].start_even));
-            if (tlb_e[core_Index & 0x3F].d_even)
-                for (i = tlb_e[core_Index & 0x3F].start_even; i < tlb_e[core_Index & 0x3F].end_even; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                        (tlb_e[core_Index & 0x3F].phys_even + (i - tlb_e[core_Index & 0x3F].start_even));
-        }
-    }
+        tlb_map_range(tlb_e[core_Index & 0x3F].start_even, tlb_e[core_Index & 0x3F].end_even,
+            tlb_e[core_Index & 0x3F].phys_even, tlb_e[core_Index & 0x3F].d_even);
 
     tlb_e[core_Index & 0x3F].start_odd = tlb_e[core_Index & 0x3F].end_even + 1;
     tlb_e[core_Index & 0x3F].end_odd = tlb_e[core_Index & 0x3F].start_odd +
@@ -823,45 +857,19 @@ static void TLBWI()
     tlb_e[core_Index & 0x3F].phys_odd = tlb_e[core_Index & 0x3F].pfn_odd << 12;
 
     if (tlb_e[core_Index & 0x3F].v_odd)
-    {
-        if (tlb_e[core_Index & 0x3F].start_odd < tlb_e[core_Index & 0x3F].end_odd &&
-            !(tlb_e[core_Index & 0x3F].start_odd >= 0x80000000 &&
-                tlb_e[core_Index & 0x3F].end_odd < 0xC0000000) &&
-            tlb_e[core_Index & 0x3F].phys_odd < 0x20000000)
-        {
-            for (i = tlb_e[core_Index & 0x3F].start_odd; i < tlb_e[core_Index & 0x3F].end_odd; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Index & 0x3F].phys_odd + (i - tlb_e[core_Index & 0x3F].start_odd));
-            if (tlb_e[core_Index & 0x3F].d_odd)
-                for (i = tlb_e[core_Index & 0x3F].start_odd; i < tlb_e[core_Index & 0x3F].end_odd; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                        (tlb_e[core_Index & 0x3F].phys_odd + (i - tlb_e[core_Index & 0x3F].start_odd));
-        }
-    }
+        tlb_map_range(tlb_e[core_Index & 0x3F].start_odd, tlb_e[core_Index & 0x3F].end_odd,
+            tlb_e[core_Index & 0x3F].phys_odd, tlb_e[core_Index & 0x3F].d_odd);
     interp_addr += 4;
 }
 
 static void TLBWR()
 {
-    uint32_t i;
     update_count();
     core_Random = (core_Count / 2 % (32 - core_Wired)) + core_Wired;
     if (tlb_e[core_Random].v_even)
-    {
-        for (i = tlb_e[core_Random].start_even; i < tlb_e[core_Random].end_even; i++)
-            tlb_LUT_r[i >> 12] = 0;
-        if (tlb_e[core_Random].d_even)
-            for (i = tlb_e[core_Random].start_even; i < tlb_e[core_Random].end_even; i++)
-                tlb_LUT_w[i >> 12] = 0;
-    }
+        tlb_unmap_range(tlb_e[core_Random].start_even, tlb_e[core_Random].end_even, tlb_e[core_Random].d_even);
     if (tlb_e[core_Random].v_odd)
-    {
-        for (i = tlb_e[core_Random].start_odd; i < tlb_e[core_Random].end_odd; i++)
-            tlb_LUT_r[i >> 12] = 0;
-        if (tlb_e[core_Random].d_odd)
-            for (i = tlb_e[core_Random].start_odd; i < tlb_e[core_Random].end_odd; i++)
-                tlb_LUT_w[i >> 12] = 0;
-    }
+        tlb_unmap_range(tlb_e[core_Random].start_odd, tlb_e[core_Random].end_odd, tlb_e[core_Random].d_odd);
     tlb_e[core_Random].g = (core_EntryLo0 & core_EntryLo1 & 1);
     tlb_e[core_Random].pfn_even = (core_EntryLo0 & 0x3FFFFFC0) >> 6;
     tlb_e[core_Random].pfn_odd = (core_EntryLo1 & 0x3FFFFFC0) >> 6;
@@ -882,42 +890,16 @@ static void TLBWR()
     tlb_e[core_Random].phys_even = tlb_e[core_Random].pfn_even << 12;
 
     if (tlb_e[core_Random].v_even)
-    {
-        if (tlb_e[core_Random].start_even < tlb_e[core_Random].end_even &&
-            !(tlb_e[core_Random].start_even >= 0x80000000 &&
-                tlb_e[core_Random].end_even < 0xC0000000) &&
-            tlb_e[core_Random].phys_even < 0x20000000)
-        {
-            for (i = tlb_e[core_Random].start_even; i < tlb_e[core_Random].end_even; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Random].phys_even + (i - tlb_e[core_Random].start_even));
-            if (tlb_e[core_Random].d_even)
-                for (i = tlb_e[core_Random].start_even; i < tlb_e[core_Random].end_even; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                        (tlb_e[core_Random].phys_even + (i - tlb_e[core_Random].start_even));
-        }
-    }
+        tlb_map_range(tlb_e[core_Random].start_even, tlb_e[core_Random].end_even,
+            tlb_e[core_Random].phys_even, tlb_e[core_Random].d_even);
     tlb_e[core_Random].start_odd = tlb_e[core_Random].end_even + 1;
     tlb_e[core_Random].end_odd = tlb_e[core_Random].start_odd +
         (tlb_e[core_Random].mask << 12) + 0xFFF;
     tlb_e[core_Random].phys_odd = tlb_e[core_Random].pfn_odd << 12;
 
     if (tlb_e[core_Random].v_odd)
-    {
-        if (tlb_e[core_Random].start_odd < tlb_e[core_Random].end_odd &&
-            !(tlb_e[core_Random].start_odd >= 0x80000000 &&
-                tlb_e[core_Random].end_odd < 0xC0000000) &&
-            tlb_e[core_Random].phys_odd < 0x20000000)
-        {
-            for (i = tlb_e[core_Random].start_odd; i < tlb_e[core_Random].end_odd; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Random].phys_odd + (i - tlb_e[core_Random].start_odd));
-            if (tlb_e[core_Random].d_odd)
-                for (i = tlb_e[core_Random].start_odd; i < tlb_e[core_Random].end_odd; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                        (tlb_e[core_Random].phys_odd + (i - tlb_e[core_Random].start_odd));
-        }
-    }
+        tlb_map_range(tlb_e[core_Random].start_odd, tlb_e[core_Random].end_odd,
+            tlb_e[core_Random].phys_odd, tlb_e[core_Random].d_odd);
     interp_addr += 4;
 }
 
@@ -1146,7 +1128,7 @@ static void BC1F()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    interp_handler();
     update_count();
     delay_slot = 0;
     if ((FCR31 & 0x800000) == 0)
@@ -1175,7 +1157,7 @@ static void BC1T()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    interp_handler();
     update_count();
     delay_slot = 0;
     if ((FCR31 & 0x800000) != 0)
@@ -1206,7 +1188,7 @@ static void BC1FL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        interp_handler();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -1239,7 +1221,7 @@ static void BC1TL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        interp_handler();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -2197,7 +2179,7 @@ static void J()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    interp_handler();
     update_count();
     delay_slot = 0;
     interp_addr = naddr;
@@ -2215,7 +2197,7 @@ static void JAL()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    interp_handler();
     update_count();
     delay_slot = 0;
     if (!skip_jump)
@@ -2241,7 +2223,7 @@ static void BEQ()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    interp_handler();
     update_count();
     delay_slot = 0;
     if (local_rs == local_rt && !g_vr_beq_ignore_jmp)
@@ -2262,7 +2244,7 @@ static void BNE()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    interp_handler();
     update_count();
     delay_slot = 0;
     if (local_rs != local_rt)
@@ -2282,7 +2264,7 @@ static void BLEZ()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    interp_handler();
     update_count();
     delay_slot = 0;
     if (local_rs <= 0)
@@ -2302,7 +2284,7 @@ static void BGTZ()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    interp_handler();
     update_count();
     delay_slot = 0;
     if (local_rs > 0)
@@ -2405,7 +2387,7 @@ static void BEQL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        interp_handler();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -2443,7 +2425,7 @@ static void BNEL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        interp_handler();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -2480,7 +2462,7 @@ static void BLEZL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        interp_handler();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -2517,7 +2499,7 @@ static void BGTZL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        interp_handler();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -2658,18 +2640,16 @@ static void LDR()
 static void LB()
 {
     interp_addr += 4;
-    address = core_iimmediate + irs32;
-    rdword = (uint64_t*)&core_irt;
-    read_byte_in_memory();
+    if (const auto value = mem_load<uint8_t>(core_iimmediate + irs32))
+        core_irt = *value;
     sign_extendedb(core_irt);
 }
 
 static void LH()
 {
     interp_addr += 4;
-    address = core_iimmediate + irs32;
-    rdword = (uint64_t*)&core_irt;
-    read_hword_in_memory();
+    if (const auto value = mem_load<uint16_t>(core_iimmediate + irs32))
+        core_irt = *value;
     sign_extendedh(core_irt);
 }
 
@@ -2708,27 +2688,24 @@ static void LWL()
 
 static void LW()
 {
-    address = core_iimmediate + irs32;
-    rdword = (uint64_t*)&core_irt;
     interp_addr += 4;
-    read_word_in_memory();
+    if (const auto value = mem_load<uint32_t>(core_iimmediate + irs32))
+        core_irt = *value;
     sign_extended(core_irt);
 }
 
 static void LBU()
 {
     interp_addr += 4;
-    address = core_iimmediate + irs32;
-    rdword = (uint64_t*)&core_irt;
-    read_byte_in_memory();
+    if (const auto value = mem_load<uint8_t>(core_iimmediate + irs32))
+        core_irt = *value;
 }
 
 static void LHU()
 {
     interp_addr += 4;
-    address = core_iimmediate + irs32;
-    rdword = (uint64_t*)&core_irt;
-    read_hword_in_memory();
+    if (const auto value = mem_load<uint16_t>(core_iimmediate + irs32))
+        core_irt = *value;
 }
 
 static void LWR()
@@ -2765,26 +2742,21 @@ static void LWR()
 
 static void LWU()
 {
-    address = core_iimmediate + irs32;
-    rdword = (uint64_t*)&core_irt;
     interp_addr += 4;
-    read_word_in_memory();
+    if (const auto value = mem_load<uint32_t>(core_iimmediate + irs32))
+        core_irt = *value;
 }
 
 static void SB()
 {
     interp_addr += 4;
-    address = core_iimmediate + irs32;
-    g_byte = (unsigned char)(core_irt & 0xFF);
-    write_byte_in_memory();
+    mem_store<uint8_t>(core_iimmediate + irs32, core_irt & 0xFF);
 }
 
 static void SH()
 {
     interp_addr += 4;
-    address = core_iimmediate + irs32;
-    hword = (uint16_t)(core_irt & 0xFFFF);
-    write_hword_in_memory();
+    mem_store<uint16_t>(core_iimmediate + irs32, core_irt & 0xFFFF);
 }
 
 static void SWL()
@@ -2823,9 +2795,7 @@ static void SWL()
 static void SW()
 {
     interp_addr += 4;
-    address = core_iimmediate + irs32;
-    word = (uint32_t)(core_irt & 0xFFFFFFFF);
-    write_word_in_memory();
+    mem_store<uint32_t>(core_iimmediate + irs32, core_irt & 0xFFFFFFFF);
 }
 
 static void SDL()
@@ -2996,10 +2966,9 @@ static void CACHE()
 
 static void LL()
 {
-    address = core_iimmediate + irs32;
-    rdword = (uint64_t*)&core_irt;
     interp_addr += 4;
-    read_word_in_memory();
+    if (const auto value = mem_load<uint32_t>(core_iimmediate + irs32))
+        core_irt = *value;
     sign_extended(core_irt);
     llbit = 1;
 }
@@ -3027,9 +2996,8 @@ static void LDC1()
 static void LD()
 {
     interp_addr += 4;
-    address = core_iimmediate + irs32;
-    rdword = (uint64_t*)&core_irt;
-    read_dword_in_memory();
+    if (const auto value = mem_load<uint64_t>(core_iimmediate + irs32))
+        core_irt = *value;
 }
 
 static void SC()
@@ -3037,9 +3005,7 @@ static void SC()
     interp_addr += 4;
     if (llbit)
     {
-        address = core_iimmediate + irs32;
-        word = (uint32_t)(core_irt & 0xFFFFFFFF);
-        write_word_in_memory();
+        mem_store<uint32_t>(core_iimmediate + irs32, core_irt & 0xFFFFFFFF);
         llbit = 0;
         core_irt = 1;
     }
@@ -3070,9 +3036,7 @@ static void SDC1()
 static void SD()
 {
     interp_addr += 4;
-    address = core_iimmediate + irs32;
-    dword = core_irt;
-    write_dword_in_memory();
+    mem_store<uint64_t>(core_iimmediate + irs32, core_irt);
 }
 
 void (*interp_ops[64])(void) =
@@ -3088,7 +3052,78 @@ void (*interp_ops[64])(void) =
 };
 
 //Get opcode from address (interp_address)
-void prefetch()
+/**
+ * Resolves the handler of an opcode, skipping the sub-table dispatchers which only index into another table.
+ * COP1 isn't resolved, as its dispatcher also checks for the coprocessor being usable.
+ */
+static void (*resolve_handler(uint32_t op))()
+{
+    auto handler = interp_ops[(op >> 26) & 0x3F];
+    if (handler == SPECIAL)
+        return interp_special[op & 0x3F];
+    if (handler == REGIMM)
+        return interp_regimm[(op >> 16) & 0x1F];
+    if (handler == COP0)
+    {
+        handler = interp_cop0[(op >> 21) & 0x1F];
+        return handler == TLB ? interp_tlb[op & 0x3F] : handler;
+    }
+    return handler;
+}
+
+/**
+ * Decodes vr_op into PC and interp_handler.
+ */
+static void prefetch_decode()
+{
+    prefetch_opcode(vr_op);
+    interp_handler = resolve_handler(vr_op);
+}
+
+/**
+ * Decodes vr_op into PC and interp_handler, going through the instruction cache.
+ * \param paddr The physical RDRAM address vr_op was fetched from.
+ * \remarks The decoded fields only depend on the opcode, so comparing it against the one in memory is enough to
+ * catch stores, DMAs and plugin writes to code. invalid_code isn't maintained in the pure interpreter.
+ * The page is remembered along with its write generation, which lets the next fetches from it skip this comparison.
+ */
+static void prefetch_cached(uint32_t paddr)
+{
+    auto& page = g_decoded_pages[paddr >> 12];
+    if (!page)
+    {
+        page = std::make_unique<interp_decoded_instr[]>(interp_page_instrs);
+    }
+
+    g_fetch_page = interp_fetch_page{
+    .vpage = g_fetch_vaddr >> 12,
+    .ppage = paddr >> 12,
+    .decoded = page.get(),
+    .rdram_generation = g_rdram_page_generations[paddr >> 12],
+    .tlb_generation = tlb_LUT_r.generation(),
+    };
+
+    interp_decoded_instr& entry = page[(paddr & 0xFFF) / 4];
+    entry.generation = g_fetch_page.rdram_generation;
+    if (entry.handler == nullptr || entry.op != vr_op)
+    {
+        prefetch_decode();
+        entry.op = vr_op;
+        entry.handler = interp_handler;
+        entry.f = PC->f;
+        return;
+    }
+
+    PC->f = entry.f;
+    interp_handler = entry.handler;
+}
+
+/**
+ * Fetches and decodes the instruction at interp_addr, translating its address and reading it from memory.
+ * \tparam Trace Whether the instruction is trace logged.
+ */
+template <bool Trace>
+static void fetch_uncached()
 {
     //static FILE *f = NULL;
     //static int32_t line=1;
@@ -3118,23 +3153,24 @@ void prefetch()
             /*if ((debug_count+Count) > 0xabaa20)
               g_core->logger->info("count:%x, add:%x, op:%x, l{}\n", (int32_t)(Count+debug_count),
                  interp_addr, op, line);*/
-            prefetch_opcode(vr_op);
+            prefetch_cached(interp_addr & 0x7FFFFF);
         }
         else if ((interp_addr >= 0xa4000000) && (interp_addr < 0xa4001000))
         {
             vr_op = SP_DMEM[(interp_addr & 0xFFF) / 4];
-            prefetch_opcode(vr_op);
+            prefetch_decode();
         }
         else if ((interp_addr > 0xb0000000))
         {
             vr_op = ((uint32_t*)rom)[(interp_addr & 0xFFFFFFF) / 4];
-            prefetch_opcode(vr_op);
+            prefetch_decode();
         }
         else
         {
             //unmapped memory exception
             g_core->logger->info("Exception, attempt to prefetch unmapped memory at: {:#08x}\n", (int32_t)interp_addr);
             stop = 1;
+            interp_handler = resolve_handler(vr_op);
         }
     }
     else
@@ -3144,22 +3180,141 @@ void prefetch()
         if (phys != 0x00000000) interp_addr = phys;
         else
         {
-            prefetch();
+            g_fetch_vaddr = interp_addr;
+            fetch_uncached<Trace>();
             //tlb_used = 0;
             return;
         }
         //tlb_used = 1;
-        prefetch();
+        fetch_uncached<Trace>();
         //tlb_used = 0;
         interp_addr = addr;
         return;
     }
-    if (core_vr_is_tracelog_active())
+    if constexpr (Trace)
         tracelog_log_pure();
 }
 
+/**
+ * Fetches and decodes the instruction at interp_addr.
+ * \tparam Trace Whether the instruction is trace logged.
+ */
+template <bool Trace>
+static void fetch()
+{
+    // Traced fetches take the regular path, so the logged addresses stay the same
+    if constexpr (!Trace)
+    {
+        if ((interp_addr >> 12) == g_fetch_page.vpage
+            && g_rdram_page_generations[g_fetch_page.ppage] == g_fetch_page.rdram_generation
+            && tlb_LUT_r.generation() == g_fetch_page.tlb_generation)
+        {
+            const interp_decoded_instr& entry = g_fetch_page.decoded[(interp_addr & 0xFFF) / 4];
+            if (entry.handler != nullptr && entry.generation == g_fetch_page.rdram_generation)
+            {
+                vr_op = entry.op;
+                PC->f = entry.f;
+                interp_handler = entry.handler;
+                return;
+            }
+        }
+    }
+
+    g_fetch_vaddr = interp_addr;
+    fetch_uncached<Trace>();
+}
+
+void prefetch()
+{
+    if (core_vr_is_tracelog_active())
+        fetch<true>();
+    else
+        fetch<false>();
+}
+
+/**
+ * Executes one instruction.
+ * \tparam Trace Whether the instruction is trace logged.
+ * \tparam Debug Whether the debugger is notified of the instruction and may pause execution after it.
+ * \tparam Profile Whether the profiler is notified of the instruction.
+ */
+template <bool Trace, bool Debug, bool Profile>
+static void step()
+{
+    //if (interp_addr == 0x10022d08) stop = 1;
+    //g_core->logger->info("addr: %x", interp_addr);
+    fetch<Trace>();
+#ifdef COMPARE_CORE
+	compare_core();
+#endif
+    if constexpr (Profile)
+        prof_on_instruction(interp_addr, vr_op);
+    //if (Count > 0x2000000) g_core->logger->info("inter:%x,%x", interp_addr,op);
+    //if ((Count+debug_count) > 0xabaa2c) stop=1;
+    interp_handler();
+
+    //Count = (uint32_t)Count + 2;
+    //if (interp_addr == 0x80000180) last_addr = interp_addr;
+#ifdef DBG
+	PC->addr = interp_addr;
+	if (debugger_mode) update_debugger();
+#endif
+    if constexpr (Debug)
+    {
+        while (!core_dbg_get_resumed())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        Debugger::on_late_cycle(vr_op, interp_addr);
+    }
+}
+
+/**
+ * Executes instructions until the core stops or the enabled features change.
+ */
+template <bool Trace, bool Debug, bool Profile>
+static void run()
+{
+    // The flag is only meant to affect the instruction during which it was set, which always ends the previous variant
+    g_vr_beq_ignore_jmp = false;
+
+    // A pause requested while another variant ran takes effect after the instruction during which it was requested, like with this one,
+    // rather than after the next one. This also brings the debugger's CPU state up to date, since other variants don't maintain it.
+    if constexpr (Debug)
+    {
+        if (!core_dbg_get_resumed())
+        {
+            Debugger::on_late_cycle(vr_op, interp_addr);
+        }
+    }
+
+    while (!stop && !g_interp_variant_dirty)
+    {
+        step<Trace, Debug, Profile>();
+    }
+}
+
+/**
+ * The interpreter loop variants, indexed by the enabled features: tracing in bit 0, debugging in bit 1 and profiling in bit 2.
+ */
+static void (*const g_run_variants[])() = {
+run<false, false, false>,
+run<true, false, false>,
+run<false, true, false>,
+run<true, true, false>,
+run<false, false, true>,
+run<true, false, true>,
+run<false, true, true>,
+run<true, true, true>,
+};
+
 void pure_interpreter()
 {
+    for (auto& page : g_decoded_pages)
+    {
+        page.reset();
+    }
+    g_fetch_page = {};
     interp_addr = 0xa4000040;
     stop = 0;
     PC = (precomp_instr*)malloc(sizeof(precomp_instr));
@@ -3169,28 +3324,13 @@ void pure_interpreter()
     g_core->logger->info(L"core_executing: {}", (bool)core_executing);
     while (!stop)
     {
-        //if (interp_addr == 0x10022d08) stop = 1;
-        //g_core->logger->info("addr: %x", interp_addr);
-        prefetch();
-#ifdef COMPARE_CORE
-		compare_core();
-#endif
-        //if (Count > 0x2000000) g_core->logger->info("inter:%x,%x", interp_addr,op);
-        //if ((Count+debug_count) > 0xabaa2c) stop=1;
-        interp_ops[((vr_op >> 26) & 0x3F)]();
-        g_vr_beq_ignore_jmp = false;
+        g_interp_variant_dirty = false;
 
-        //Count = (uint32_t)Count + 2;
-        //if (interp_addr == 0x80000180) last_addr = interp_addr;
-#ifdef DBG
-		PC->addr = interp_addr;
-		if (debugger_mode) update_debugger();
-#endif
-        while (!core_dbg_get_resumed())
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        }
-        Debugger::on_late_cycle(vr_op, interp_addr);
+        const size_t variant = (core_vr_is_tracelog_active() ? 1 : 0)
+        | (Debugger::is_active() ? 2 : 0)
+        | (g_prof_enabled ? 4 : 0);
+
+        g_run_variants[variant]();
     }
     PC->addr = interp_addr;
 }
@@ -3206,7 +3346,7 @@ void interprete_section(uint32_t addr)
         if (core_vr_is_tracelog_active())
             tracelog_log_pure();
         PC->addr = interp_addr;
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        interp_handler();
 #ifdef DBG
 		PC->addr = interp_addr;
 		if (debugger_mode) update_debugger();
@@ -8,13 +8,17 @@
 #include <core/Core.h>
 #include <core/memory/memory.h>
 #include <core/memory/pif.h>
+#include <core/memory/savedata.h>
 #include <core/memory/savestates.h>
+#include <core/r4300/bruteforce.h>
 #include <core/r4300/exception.h>
 #include <core/r4300/interrupt.h>
 #include <core/r4300/macros.h>
 #include <core/r4300/ops.h>
+#include <core/r4300/profiler.h>
 #include <core/r4300/r4300.h>
 #include <core/r4300/recomp.h>
+#include <core/r4300/recomph.h>
 #include <core/r4300/timers.h>
 #include <core/r4300/vcr.h>
 // Threading crap
@@ -73,11 +77,8 @@ uint32_t next_vi;
 int32_t vi_field = 0;
 bool g_vr_fast_forward;
 bool g_vr_frame_skipped;
+bool g_vr_benchmark_enabled;
 
-FILE* g_eeprom_file;
-FILE* g_sram_file;
-FILE* g_fram_file;
-FILE* g_mpak_file;
 
 /*#define check_memory() \
    if (!invalid_code[address>>12]) \
@@ -93,26 +94,6 @@ void core_vr_invalidate_visuals()
     screen_invalidated = true;
 }
 
-std::filesystem::path get_sram_path()
-{
-    return std::format(L"{}{} {}.sra", g_core->get_saves_directory().wstring(), string_to_wstring((const char*)ROM_HEADER.nom), core_vr_country_code_to_country_name(ROM_HEADER.Country_code));
-}
-
-std::filesystem::path get_eeprom_path()
-{
-    return std::format(L"{}{} {}.eep", g_core->get_saves_directory().wstring(), string_to_wstring((const char*)ROM_HEADER.nom), core_vr_country_code_to_country_name(ROM_HEADER.Country_code));
-}
-
-std::filesystem::path get_flashram_path()
-{
-    return std::format(L"{}{} {}.fla", g_core->get_saves_directory().wstring(), string_to_wstring((const char*)ROM_HEADER.nom), core_vr_country_code_to_country_name(ROM_HEADER.Country_code));
-}
-
-std::filesystem::path get_mempak_path()
-{
-    return std::format(L"{}{} {}.mpk", g_core->get_saves_directory().wstring(), string_to_wstring((const char*)ROM_HEADER.nom), core_vr_country_code_to_country_name(ROM_HEADER.Country_code));
-}
-
 void core_vr_resume_emu()
 {
     if (emu_launched)
@@ -1488,7 +1469,7 @@ void NOTCOMPILED()
         uint32_t paddr = 0;
         if (PC->addr >= 0x80000000 && PC->addr < 0xc0000000)
             paddr = PC->addr;
-        // else paddr = (tlb_LUT_r[PC->addr>>12]&0xFFFFF000)|(PC->addr&0xFFF);
+        // else paddr = (tlb_LUT_r.get(PC->addr>>12)&0xFFFFF000)|(PC->addr&0xFFF);
         else
             paddr = virtual_to_physical_address(PC->addr, 2);
         if (paddr)
@@ -1573,16 +1554,16 @@ inline void jump_to_func()
     paddr = update_invalid_addr(addr);
     if (!paddr)
         return;
+    // The calling code is never returned to from here on
+    if (dynacore)
+        dyna_check_code_arena();
     actual = blocks[addr >> 12];
-    if (invalid_code[addr >> 12])
+    if (invalid_code[addr >> 12] && !revalidate_block(actual))
     {
         if (!blocks[addr >> 12])
         {
-            blocks[addr >> 12] = (precomp_block*)malloc(sizeof(precomp_block));
+            blocks[addr >> 12] = create_block(addr);
             actual = blocks[addr >> 12];
-            blocks[addr >> 12]->code = NULL;
-            blocks[addr >> 12]->block = NULL;
-            blocks[addr >> 12]->jumps_table = NULL;
         }
         blocks[addr >> 12]->start = addr & ~0xFFF;
         blocks[addr >> 12]->end = (addr & ~0xFFF) + 0x1000;
@@ -1641,13 +1622,8 @@ void init_blocks()
         invalid_code[i] = 1;
         blocks[i] = NULL;
     }
-    blocks[0xa4000000 >> 12] = (precomp_block*)malloc(sizeof(precomp_block));
+    blocks[0xa4000000 >> 12] = create_block(0xa4000000);
     invalid_code[0xa4000000 >> 12] = 1;
-    blocks[0xa4000000 >> 12]->code = NULL;
-    blocks[0xa4000000 >> 12]->block = NULL;
-    blocks[0xa4000000 >> 12]->jumps_table = NULL;
-    blocks[0xa4000000 >> 12]->start = 0xa4000000;
-    blocks[0xa4000000 >> 12]->end = 0xa4001000;
     actual = blocks[0xa4000000 >> 12];
     init_block((int32_t*)SP_DMEM, blocks[0xa4000000 >> 12]);
     PC = actual->block + (0x40 / 4);
@@ -1722,8 +1698,8 @@ void core_start()
         tlb_e[i].end_odd = 0;
         tlb_e[i].phys_odd = 0;
     }
-    memset(tlb_LUT_r, 0, sizeof(tlb_LUT_r));
-    memset(tlb_LUT_r, 0, sizeof(tlb_LUT_w));
+    tlb_LUT_r.clear();
+    tlb_LUT_w.clear();
     llbit = 0;
     hi = 0;
     lo = 0;
@@ -1956,6 +1932,8 @@ void core_start()
                 virtual_to_physical_address(PC->addr, 2);
             compare_core();
 #endif
+            if (g_prof_enabled)
+                prof_on_instruction(PC->addr, PC->src);
             PC->ops();
             g_vr_beq_ignore_jmp = false;
             /*if (j!= (Count & 0xFFF00000))
@@ -2001,7 +1979,7 @@ void core_start()
             }
             if (blocks[i]->code)
             {
-                free(blocks[i]->code);
+                free_code(blocks[i]->code);
                 blocks[i]->code = NULL;
             }
             if (blocks[i]->jumps_table)
@@ -2009,67 +1987,16 @@ void core_start()
                 free(blocks[i]->jumps_table);
                 blocks[i]->jumps_table = NULL;
             }
-            free(blocks[i]);
             blocks[i] = NULL;
         }
     }
+    free_blocks();
     if (!dynacore && interpcore)
         free(PC);
     core_executing = false;
     g_core->callbacks.core_executing_changed(core_executing);
 }
 
-bool open_core_file_stream(const std::filesystem::path& path, FILE** file)
-{
-    g_core->logger->info("[Core] Opening core stream from {}...", path.string().c_str());
-
-    if (!exists(path))
-    {
-        FILE* f = fopen(path.string().c_str(), "w");
-        if (!f)
-        {
-            return false;
-        }
-        fflush(f);
-        fclose(f);
-    }
-    *file = fopen(path.string().c_str(), "rb+");
-    return *file != nullptr;
-}
-
-
-void clear_save_data()
-{
-    open_core_file_stream(get_eeprom_path(), &g_eeprom_file);
-    open_core_file_stream(get_sram_path(), &g_sram_file);
-    open_core_file_stream(get_flashram_path(), &g_fram_file);
-    open_core_file_stream(get_mempak_path(), &g_mpak_file);
-
-    {
-        memset(sram, 0, sizeof(sram));
-        fseek(g_sram_file, 0, SEEK_SET);
-        fwrite(sram, 1, 0x8000, g_sram_file);
-    }
-    {
-        memset(eeprom, 0, sizeof(eeprom));
-        fseek(g_eeprom_file, 0, SEEK_SET);
-        fwrite(eeprom, 1, 0x800, g_eeprom_file);
-    }
-    {
-        fseek(g_mpak_file, 0, SEEK_SET);
-        for (auto buf : mempack)
-        {
-            memset(buf, 0, sizeof(mempack) / 4);
-            fwrite(buf, 1, 0x800, g_mpak_file);
-        }
-    }
-
-    fclose(g_eeprom_file);
-    fclose(g_sram_file);
-    fclose(g_fram_file);
-    fclose(g_mpak_file);
-}
-
 void audio_thread()
 {
     g_core->logger->info("Sound thread entering...");
@@ -2120,6 +2047,7 @@ void emu_thread()
     g_core->logger->info("[Core] Emu thread entry took {}ms", static_cast<int32_t>((std::chrono::high_resolution_clock::now() - start_time).count() / 1'000'000));
     core_start();
 
+    bf_on_core_stop();
     st_on_core_stop();
 
     g_core->plugin_funcs.rom_closed_gfx();
@@ -2168,14 +2096,7 @@ core_result vr_close_rom_impl(bool stop_vcr)
 
     emu_thread_handle.join();
 
-    fflush(g_eeprom_file);
-    fflush(g_sram_file);
-    fflush(g_fram_file);
-    fflush(g_mpak_file);
-    fclose(g_eeprom_file);
-    fclose(g_sram_file);
-    fclose(g_fram_file);
-    fclose(g_mpak_file);
+    save_close();
 
     return Res_Ok;
 }
@@ -2235,8 +2156,8 @@ core_result vr_start_rom_impl(std::filesystem::path path)
         return VR_RomInvalid;
     }
 
-    // Open all the save file streams
-    if (!open_core_file_stream(get_eeprom_path(), &g_eeprom_file) || !open_core_file_stream(get_sram_path(), &g_sram_file) || !open_core_file_stream(get_flashram_path(), &g_fram_file) || !open_core_file_stream(get_mempak_path(), &g_mpak_file))
+    // Load the save memories
+    if (!save_open())
     {
         g_core->callbacks.emu_starting_changed(false);
         return VR_FileOpenFailed;
@@ -2327,7 +2248,7 @@ core_result vr_reset_rom_impl(bool reset_save_data, bool stop_vcr, bool skip_res
 
     if (reset_save_data)
     {
-        clear_save_data();
+        save_clear();
     }
 
     result = core_vr_start_rom(rom_path, false);
@@ -2372,6 +2293,11 @@ void core_vr_set_fast_forward(bool value)
     g_vr_fast_forward = value;
 }
 
+void core_vr_set_benchmark_enabled(bool value)
+{
+    g_vr_benchmark_enabled = value;
+}
+
 bool core_vr_is_fullscreen()
 {
     return fullscreen;
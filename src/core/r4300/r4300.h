@@ -24,6 +24,7 @@ extern precomp_block *blocks[0x100000], *actual;
 extern void (*interp_ops[64])(void);
 extern int32_t fast_memory;
 extern bool g_vr_beq_ignore_jmp;
+extern volatile bool g_interp_variant_dirty;
 extern volatile bool emu_launched;
 extern volatile bool emu_paused;
 extern volatile bool core_executing;
@@ -57,11 +58,6 @@ extern int32_t compare_core_mode;
 extern bool g_vr_fast_forward;
 extern bool g_vr_frame_skipped;
 
-extern FILE* g_eeprom_file;
-extern FILE* g_sram_file;
-extern FILE* g_fram_file;
-extern FILE* g_mpak_file;
-
 extern bool g_vr_benchmark_enabled;
 
 void pure_interpreter();
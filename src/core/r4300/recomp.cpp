@@ -5,14 +5,20 @@
  */
 
 #include "stdafx.h"
+#include <core/Core.h>
 #include "ops.h"
 #include "recomp.h"
 #include "r4300.h"
 #include "../memory/memory.h"
+#ifdef _M_X64
+#include <core/r4300/x64/regcache.h>
+#else
 #include <core/r4300/x86/regcache.h>
+#endif
 #include "recomph.h"
 #include "rom.h"
 #include "tracelog.h"
+#include <xxh64.h>
 
 // global variables :
 precomp_instr* dst; // destination structure for the recompiled instruction
@@ -23,13 +29,40 @@ precomp_block* dst_block; // the current block that we are recompiling
 uint32_t src; // the current recompiled instruction
 int32_t fast_memory;
 
-uint32_t* return_address; // that's where the dynarec will restart when
+uintptr_t* return_address; // that's where the dynarec will restart when
 // going back from a C function
 
 static int32_t* SRC; // currently recompiled instruction in the input stream
 static int32_t check_nop; // next instruction is nop ?
 static int32_t delay_slot_compiled = 0;
 
+// Block headers are allocated in chunks rather than one by one, and are only freed as a whole when emulation stops.
+constexpr size_t BLOCK_CHUNK_SIZE = 256;
+
+static std::vector<std::unique_ptr<precomp_block[]>> g_block_chunks;
+static size_t g_block_chunk_used = BLOCK_CHUNK_SIZE;
+
+precomp_block* create_block(uint32_t addr)
+{
+    if (g_block_chunk_used == BLOCK_CHUNK_SIZE)
+    {
+        g_block_chunks.emplace_back(std::make_unique<precomp_block[]>(BLOCK_CHUNK_SIZE));
+        g_block_chunk_used = 0;
+    }
+
+    precomp_block* block = &g_block_chunks.back()[g_block_chunk_used++];
+    *block = {};
+    block->start = addr & ~0xFFF;
+    block->end = (addr & ~0xFFF) + 0x1000;
+    return block;
+}
+
+void free_blocks()
+{
+    g_block_chunks.clear();
+    g_block_chunk_used = BLOCK_CHUNK_SIZE;
+}
+
 
 static void RSV()
 {
@@ -2156,6 +2189,53 @@ static void (*recomp_ops[64])(void) =
     RSC, RSWC1, RSV, RSV, RSCD, RSDC1, RSV, RSD
 };
 
+/**
+ * Gets whether a block is in the directly mapped RDRAM segments.
+ */
+static bool is_rdram_block(const precomp_block* block)
+{
+    return block->start >= 0x80000000 && block->start < 0xc0000000 && (block->start & 0x1FFFFFFF) < 0x800000;
+}
+
+/**
+ * Gets whether a dirty block still has its compiled code and a known hash.
+ */
+static bool can_revalidate(const precomp_block* block)
+{
+    return block && block->hash && block->block && (!dynacore || block->code) && is_rdram_block(block);
+}
+
+uint64_t hash_code_page(const void* page)
+{
+    return xxh64::hash((const char*)page, 0x1000, 0);
+}
+
+bool revalidate_block(precomp_block* block)
+{
+    if (!can_revalidate(block))
+        return false;
+
+    const uint64_t hash = hash_code_page(rdram + ((block->start & 0x7FFFFF) >> 2));
+    if (hash != block->hash)
+        return false;
+
+    // The mirror is dirtied along with the page, and would dirty it again on the next jump if it stayed dirty
+    const uint32_t mirror = (block->start ^ 0x20000000) >> 12;
+    if (invalid_code[mirror] && !blocks[mirror])
+        return false;
+
+    invalid_code[block->start >> 12] = 0;
+    if (invalid_code[mirror])
+    {
+        if (can_revalidate(blocks[mirror]) && blocks[mirror]->hash == hash)
+            invalid_code[mirror] = 0;
+        else
+            init_block(0, blocks[mirror]);
+    }
+
+    return true;
+}
+
 /**********************************************************************
  ******************** initialize an empty block ***********************
  **********************************************************************/
@@ -2166,6 +2246,7 @@ void init_block(int32_t* source, precomp_block* block)
     //g_core->logger->info("init block recompiled {:#06x}\n", (int32_t)block->start);
 
     length = (block->end - block->start) / 4;
+    block->hash = 0;
 
     if (!block->block)
     {
@@ -2176,11 +2257,23 @@ void init_block(int32_t* source, precomp_block* block)
     {
         if (!block->code)
         {
-            block->code = (unsigned char*)malloc(5000);
+            // The stubs have to be generated again if the code was discarded
+            block->code = alloc_code(5000);
+            if (!block->code)
+            {
+                g_core->logger->error("[Core] Failed to allocate code for the block at {:#08x}, stopping emulation", block->start);
+                stop = 1;
+                dyna_stop();
+                return;
+            }
             max_code_length = 5000;
+            already_exist = 0;
         }
         else
+        {
+            dyna_unlink_block(block);
             max_code_length = block->max_code_length;
+        }
         code_length = 0;
         inst_pointer = &block->code;
 
@@ -2241,12 +2334,7 @@ void init_block(int32_t* source, precomp_block* block)
         invalid_code[paddr >> 12] = 0;
         if (!blocks[paddr >> 12])
         {
-            blocks[paddr >> 12] = (precomp_block*)malloc(sizeof(precomp_block));
-            blocks[paddr >> 12]->code = NULL;
-            blocks[paddr >> 12]->block = NULL;
-            blocks[paddr >> 12]->jumps_table = NULL;
-            blocks[paddr >> 12]->start = paddr & ~0xFFF;
-            blocks[paddr >> 12]->end = (paddr & ~0xFFF) + 0x1000;
+            blocks[paddr >> 12] = create_block(paddr);
         }
         init_block(0, blocks[paddr >> 12]);
 
@@ -2254,12 +2342,7 @@ void init_block(int32_t* source, precomp_block* block)
         invalid_code[paddr >> 12] = 0;
         if (!blocks[paddr >> 12])
         {
-            blocks[paddr >> 12] = (precomp_block*)malloc(sizeof(precomp_block));
-            blocks[paddr >> 12]->code = NULL;
-            blocks[paddr >> 12]->block = NULL;
-            blocks[paddr >> 12]->jumps_table = NULL;
-            blocks[paddr >> 12]->start = paddr & ~0xFFF;
-            blocks[paddr >> 12]->end = (paddr & ~0xFFF) + 0x1000;
+            blocks[paddr >> 12] = create_block(paddr);
         }
         init_block(0, blocks[paddr >> 12]);
     }
@@ -2270,12 +2353,7 @@ void init_block(int32_t* source, precomp_block* block)
         {
             if (!blocks[(block->start + 0x20000000) >> 12])
             {
-                blocks[(block->start + 0x20000000) >> 12] = (precomp_block*)malloc(sizeof(precomp_block));
-                blocks[(block->start + 0x20000000) >> 12]->code = NULL;
-                blocks[(block->start + 0x20000000) >> 12]->block = NULL;
-                blocks[(block->start + 0x20000000) >> 12]->jumps_table = NULL;
-                blocks[(block->start + 0x20000000) >> 12]->start = (block->start + 0x20000000) & ~0xFFF;
-                blocks[(block->start + 0x20000000) >> 12]->end = ((block->start + 0x20000000) & ~0xFFF) + 0x1000;
+                blocks[(block->start + 0x20000000) >> 12] = create_block(block->start + 0x20000000);
             }
             init_block(0, blocks[(block->start + 0x20000000) >> 12]);
         }
@@ -2284,12 +2362,7 @@ void init_block(int32_t* source, precomp_block* block)
         {
             if (!blocks[(block->start - 0x20000000) >> 12])
             {
-                blocks[(block->start - 0x20000000) >> 12] = (precomp_block*)malloc(sizeof(precomp_block));
-                blocks[(block->start - 0x20000000) >> 12]->code = NULL;
-                blocks[(block->start - 0x20000000) >> 12]->block = NULL;
-                blocks[(block->start - 0x20000000) >> 12]->jumps_table = NULL;
-                blocks[(block->start - 0x20000000) >> 12]->start = (block->start - 0x20000000) & ~0xFFF;
-                blocks[(block->start - 0x20000000) >> 12]->end = ((block->start - 0x20000000) & ~0xFFF) + 0x1000;
+                blocks[(block->start - 0x20000000) >> 12] = create_block(block->start - 0x20000000);
             }
             init_block(0, blocks[(block->start - 0x20000000) >> 12]);
         }
@@ -2306,7 +2379,7 @@ void recompile_block(int32_t* source, precomp_block* block, uint32_t func)
     dst_block = block;
 
     //for (i=0; i<16; i++) block->md5[i] = 0;
-    block->adler32 = 0;
+    block->hash = 0;
 
     if (dynacore)
     {
@@ -2335,12 +2408,12 @@ void recompile_block(int32_t* source, precomp_block* block, uint32_t func)
         dst->addr = block->start + i * 4;
         dst->reg_cache_infos.need_map = 0;
         dst->local_addr = code_length;
+        dst->src = src;
         recomp_ops[((src >> 26) & 0x3F)]();
         if (core_vr_is_tracelog_active())
         {
             dst->s_ops = dst->ops;
             dst->ops = tracelog_log_interp_ops;
-            dst->src = src;
         }
         dst = block->block + i;
         /*if ((dst+1)->ops != NOTCOMPILED && !delay_slot_compiled &&
@@ -2400,6 +2473,11 @@ void recompile_block(int32_t* source, precomp_block* block, uint32_t func)
         block->max_code_length = max_code_length;
         free_assembler(&block->jumps_table, &block->jumps_number);
     }
+
+    // Stores to compiled instructions dirty the page, so if neither the page nor its mirror is dirty,
+    // the code compiled so far matches the current source
+    if (is_rdram_block(block) && !invalid_code[block->start >> 12] && !invalid_code[(block->start ^ 0x20000000) >> 12])
+        block->hash = hash_code_page(source);
     //g_core->logger->info("block recompiled ({:#06x}-%x)\n", (int32_t)func, (int32_t)(block->start+i*4));
     //getchar();
 }
@@ -6,7 +6,11 @@
 
 #pragma once
 
+#ifdef _M_X64
+#include <core/r4300/x64/assemble.h>
+#else
 #include <core/r4300/x86/assemble.h>
+#endif
 
 typedef struct _precomp_instr
 {
@@ -71,7 +75,8 @@ typedef struct _precomp_block
     void* jumps_table;
     int32_t jumps_number;
     //unsigned char md5[16];
-    uint32_t adler32;
+    // The hash of the page's source when it was last compiled, or 0 if it's unknown
+    uint64_t hash;
 } precomp_block;
 
 void recompile_block(int32_t* source, precomp_block* block, uint32_t func);
@@ -82,6 +87,39 @@ void dyna_jump();
 void dyna_start(void (*code)());
 void dyna_stop();
 
+/**
+ * \brief Undoes the links from other blocks into a block's code, before the code is discarded
+ */
+void dyna_unlink_block(precomp_block* block);
+
+/**
+ * \brief Discards the code of all blocks if the code arena is running low, so it can be reused.
+ * The blocks are recompiled when they're jumped to next. Must only be called when the calling code is never returned to.
+ */
+void dyna_check_code_arena();
+
+/**
+ * \brief Creates an empty block for the page containing the specified address. The block's header is never freed individually.
+ */
+precomp_block* create_block(uint32_t addr);
+
+/**
+ * \brief Frees the headers of all blocks created with create_block
+ */
+void free_blocks();
+
+/**
+ * \brief Computes the hash of a 4 KB code page, as stored in precomp_block::hash
+ */
+uint64_t hash_code_page(const void* page);
+
+/**
+ * \brief Revalidates a dirty block if its source is unchanged since it was compiled, so it doesn't have to be recompiled.
+ * Only blocks in the directly mapped RDRAM segments are tracked.
+ * \return Whether the block was revalidated
+ */
+bool revalidate_block(precomp_block* block);
+
 /**
  * \brief Recompiles the block at the specified address
  * \param addr The virtual address to invalidate
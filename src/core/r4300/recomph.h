@@ -13,14 +13,29 @@ extern int32_t max_code_length;
 extern unsigned char** inst_pointer;
 extern precomp_block* dst_block;
 extern int32_t jump_marker;
-extern uint32_t* return_address;
+extern uintptr_t* return_address;
 extern int32_t fast_memory;
 
 void passe2(precomp_instr* dest, int32_t start, int32_t end, precomp_block* block);
 void init_assembler(void* block_jumps_table, int32_t block_jumps_number);
 void free_assembler(void** block_jumps_table, int32_t* block_jumps_number);
 
-void gencallinterp(uint32_t addr, int32_t jump);
+/**
+ * \brief Allocates a buffer which recompiled code can be executed from
+ */
+unsigned char* alloc_code(size_t size);
+
+/**
+ * \brief Resizes a buffer allocated with alloc_code, preserving its contents
+ */
+unsigned char* realloc_code(unsigned char* code, size_t size);
+
+/**
+ * \brief Frees a buffer allocated with alloc_code
+ */
+void free_code(unsigned char* code);
+
+void gencallinterp(uintptr_t addr, int32_t jump);
 
 void genupdate_system(int32_t type);
 void genbnel();
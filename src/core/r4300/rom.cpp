@@ -10,8 +10,164 @@
 #include <md5.h>
 #include <core/memory/memory.h>
 #include <core/r4300/rom.h>
+#include <immintrin.h>
 
-std::unordered_map<std::filesystem::path, std::pair<uint8_t*, size_t>> rom_cache;
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * ROMs are loaded from a read-only mapping of the file when it isn't compressed, which is converted into the emulator's byte order
+ * while being copied into the ROM buffer. The MD5 is computed on another thread at the same time.
+ *
+ * Loaded ROMs are immutable unless the SummerCart is enabled, so they're shared with the cache instead of being copied.
+ */
+
+struct t_rom_image {
+    /// The ROM data in the emulator's byte order, padded to the SummerCart's size if needed.
+    std::unique_ptr<uint8_t[]> data;
+
+    /// The size of the ROM data, excluding the padding.
+    size_t size;
+
+    /// The size of the allocation.
+    size_t capacity;
+
+    core_rom_header header;
+
+    char md5[33];
+};
+
+/**
+ * The byte order conversions applied to ROM data.
+ */
+enum class t_rom_swap {
+    /// Copies the data as-is.
+    none,
+    /// Reverses the bytes of each halfword.
+    swap16,
+    /// Reverses the bytes of each word.
+    swap32,
+    /// Swaps the halfwords of each word.
+    swap_halves,
+};
+
+/**
+ * A read-only mapping of a file.
+ */
+class t_file_mapping {
+public:
+    explicit t_file_mapping(const std::filesystem::path& path)
+    {
+#ifdef _WIN32
+        m_file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            return;
+        }
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+        {
+            return;
+        }
+
+        m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping)
+        {
+            return;
+        }
+
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        m_size = m_data ? static_cast<size_t>(size.QuadPart) : 0;
+#else
+        m_fd = open(path.c_str(), O_RDONLY);
+        if (m_fd < 0)
+        {
+            return;
+        }
+
+        struct stat st{};
+        if (fstat(m_fd, &st) != 0 || st.st_size == 0)
+        {
+            return;
+        }
+
+        void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (data == MAP_FAILED)
+        {
+            return;
+        }
+
+        madvise(data, st.st_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const uint8_t*>(data);
+        m_size = st.st_size;
+#endif
+    }
+
+    ~t_file_mapping()
+    {
+#ifdef _WIN32
+        if (m_data)
+        {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping)
+        {
+            CloseHandle(m_mapping);
+        }
+        if (m_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_file);
+        }
+#else
+        if (m_data)
+        {
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+        }
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+        }
+#endif
+    }
+
+    t_file_mapping(const t_file_mapping&) = delete;
+    t_file_mapping& operator=(const t_file_mapping&) = delete;
+
+    /**
+     * \return The mapped data, or nullptr if the file couldn't be mapped.
+     */
+    const uint8_t* data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+std::unordered_map<std::filesystem::path, std::shared_ptr<const t_rom_image>> rom_cache;
+
+// The loaded ROM, which backs the rom pointer.
+static std::shared_ptr<const t_rom_image> g_rom_image;
 
 uint8_t* rom;
 size_t rom_size;
@@ -131,104 +287,237 @@ void core_vr_byteswap(uint8_t* rom)
     }
 }
 
-bool rom_load(std::filesystem::path path)
+/**
+ * Copies ROM data while applying a byte order conversion. Trailing bytes which don't form a whole word are copied as-is.
+ */
+static void rom_convert(const uint8_t* src, uint8_t* dst, size_t size, t_rom_swap swap)
 {
-    if (rom)
+    if (swap == t_rom_swap::none)
     {
-        free(rom);
-        g_core->rom = rom = nullptr;
+        memcpy(dst, src, size);
+        return;
     }
 
-    if (rom_cache.contains(path))
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
     {
-        g_core->logger->info("[Core] Loading cached ROM...");
-        g_core->rom = rom = (unsigned char*)malloc(rom_cache[path].second);
-        memcpy(rom, rom_cache[path].first, rom_cache[path].second);
-        return true;
-    }
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+
+        if (swap == t_rom_swap::swap16 || swap == t_rom_swap::swap32)
+        {
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        }
+        if (swap == t_rom_swap::swap_halves || swap == t_rom_swap::swap32)
+        {
+            v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        }
 
-    auto rom_buf = read_file_buffer(path);
-    auto decompressed_rom = auto_decompress(rom_buf);
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
 
-    if (decompressed_rom.empty())
+    for (; i + 4 <= size; i += 4)
     {
-        return false;
+        uint32_t word;
+        memcpy(&word, src + i, 4);
+
+        switch (swap)
+        {
+        case t_rom_swap::swap16:
+            word = ((word & 0x00FF00FF) << 8) | ((word >> 8) & 0x00FF00FF);
+            break;
+        case t_rom_swap::swap32:
+            word = sl(word);
+            break;
+        case t_rom_swap::swap_halves:
+            word = std::rotl(word, 16);
+            break;
+        default:
+            break;
+        }
+
+        memcpy(dst + i, &word, 4);
     }
 
-    rom_size = decompressed_rom.size();
-    uint32_t taille = rom_size;
-    if (g_core->cfg->use_summercart && taille < 0x4000000) taille = 0x4000000;
+    memcpy(dst + i, src + i, size - i);
+}
 
-    g_core->rom = rom = (unsigned char*)malloc(taille);
-    memcpy(rom, decompressed_rom.data(), rom_size);
+/**
+ * Computes the MD5 of ROM data as it appears in the big-endian format.
+ * \param src The ROM data.
+ * \param size The ROM data's size.
+ * \param swap The conversion bringing the data into the big-endian format.
+ * \param md5 The hex digest.
+ */
+static void rom_compute_md5(const uint8_t* src, size_t size, t_rom_swap swap, char (&md5)[33])
+{
+    constexpr size_t chunk_size = 0x100000;
 
-    uint8_t tmp;
-    if (rom[0] == 0x37)
+    std::unique_ptr<uint8_t[]> chunk;
+    if (swap != t_rom_swap::none)
     {
-        for (size_t i = 0; i < (rom_size / 2); i++)
-        {
-            tmp = rom[i * 2];
-            rom[i * 2] = rom[i * 2 + 1];
-            rom[i * 2 + 1] = (unsigned char)tmp;
-        }
+        chunk = std::make_unique_for_overwrite<uint8_t[]>(chunk_size);
     }
-    if (rom[0] == 0x40)
+
+    md5_state_t state;
+    md5_byte_t digest[16];
+    md5_init(&state);
+
+    for (size_t i = 0; i < size; i += chunk_size)
     {
-        for (size_t i = 0; i < (rom_size / 4); i++)
+        const size_t len = std::min(chunk_size, size - i);
+        const uint8_t* data = src + i;
+
+        if (chunk)
         {
-            tmp = rom[i * 4];
-            rom[i * 4] = rom[i * 4 + 3];
-            rom[i * 4 + 3] = (unsigned char)tmp;
-            tmp = rom[i * 4 + 1];
-            rom[i * 4 + 1] = rom[i * 4 + 2];
-            rom[i * 4 + 2] = (unsigned char)tmp;
+            rom_convert(data, chunk.get(), len, swap);
+            data = chunk.get();
         }
+
+        md5_append(&state, data, static_cast<int>(len));
     }
-    else if ((rom[0] != 0x80)
-        || (rom[1] != 0x37)
-        || (rom[2] != 0x12)
-        || (rom[3] != 0x40)
 
-    )
+    md5_finish(&state, digest);
+
+    for (size_t i = 0; i < 16; i++) sprintf(md5 + i * 2, "%02X", digest[i]);
+}
+
+/**
+ * Builds a ROM image from ROM data in any of the supported byte orders.
+ * \param src The ROM data.
+ * \param size The ROM data's size.
+ * \return The ROM image, or nullptr if the data isn't a ROM.
+ */
+static std::shared_ptr<t_rom_image> rom_create_image(const uint8_t* src, size_t size)
+{
+    if (size < sizeof(core_rom_header))
     {
         g_core->logger->info("wrong file format !");
-        return false;
+        return nullptr;
     }
 
-    g_core->logger->info("rom loaded succesfully");
+    // The conversions to the big-endian format, which the header and MD5 are read from, and to the emulator's byte order.
+    t_rom_swap to_big_endian;
+    t_rom_swap to_native;
 
-    memcpy(&ROM_HEADER, rom, sizeof(core_rom_header));
-    ROM_HEADER.unknown = 0;
+    if (src[0] == 0x37 && src[1] == 0x80 && src[2] == 0x40 && src[3] == 0x12)
+    {
+        to_big_endian = t_rom_swap::swap16;
+        to_native = t_rom_swap::swap_halves;
+    }
+    else if (src[0] == 0x40)
+    {
+        to_big_endian = t_rom_swap::swap32;
+        to_native = t_rom_swap::none;
+    }
+    else if (src[0] == 0x80 && src[1] == 0x37 && src[2] == 0x12 && src[3] == 0x40)
+    {
+        to_big_endian = t_rom_swap::none;
+        to_native = t_rom_swap::swap32;
+    }
+    else
+    {
+        g_core->logger->info("wrong file format !");
+        return nullptr;
+    }
+
+    auto image = std::make_shared<t_rom_image>();
+    image->size = size;
+    image->capacity = size;
+    if (g_core->cfg->use_summercart && image->capacity < 0x4000000) image->capacity = 0x4000000;
+    image->data = std::make_unique_for_overwrite<uint8_t[]>(image->capacity);
+
+    std::thread md5_thread([&] {
+        rom_compute_md5(src, size, to_big_endian, image->md5);
+    });
+    rom_convert(src, image->data.get(), size, to_native);
+    md5_thread.join();
+
+    rom_convert(src, (uint8_t*)&image->header, sizeof(core_rom_header), to_big_endian);
+    image->header.unknown = 0;
     // Clean up ROMs that accidentally set the unused bytes (ensuring previous fields are null terminated)
-    ROM_HEADER.Unknown[0] = 0;
-    ROM_HEADER.Unknown[1] = 0;
+    image->header.Unknown[0] = 0;
+    image->header.Unknown[1] = 0;
 
     //trim header
-    strtrim((char*)ROM_HEADER.nom, sizeof(ROM_HEADER.nom));
+    strtrim((char*)image->header.nom, sizeof(image->header.nom));
 
-    {
-        md5_state_t state;
-        md5_byte_t digest[16];
-        md5_init(&state);
-        md5_append(&state, rom, rom_size);
-        md5_finish(&state, digest);
+    return image;
+}
 
-        char arg[256] = {0};
-        for (size_t i = 0; i < 16; i++) sprintf(arg + i * 2, "%02X", digest[i]);
-        strcpy(rom_md5, arg);
-    }
+/**
+ * Copies a ROM image, so it can be written to without affecting the original.
+ */
+static std::shared_ptr<t_rom_image> rom_clone_image(const t_rom_image& image, size_t capacity)
+{
+    auto clone = std::make_shared<t_rom_image>(t_rom_image{
+    .size = image.size,
+    .capacity = std::max(capacity, image.size),
+    .header = image.header,
+    });
+    clone->data = std::make_unique_for_overwrite<uint8_t[]>(clone->capacity);
+    memcpy(clone->data.get(), image.data.get(), image.size);
+    memcpy(clone->md5, image.md5, sizeof(image.md5));
+    return clone;
+}
+
+bool rom_load(std::filesystem::path path)
+{
+    g_rom_image.reset();
+    g_core->rom = rom = nullptr;
 
-    auto roml = (uint32_t*)rom;
-    for (size_t i = 0; i < (rom_size / 4); i++)
-        roml[i] = sl(roml[i]);
+    // The SummerCart writes to the ROM, so it needs its own copy
+    const bool writable = g_core->cfg->use_summercart;
+    const size_t capacity = writable ? 0x4000000 : 0;
 
-    if (rom_cache.size() < g_core->cfg->rom_cache_size)
+    std::shared_ptr<const t_rom_image> image;
+
+    if (rom_cache.contains(path))
     {
-        g_core->logger->info("[Core] Putting ROM in cache... ({}/{} full)\n", rom_cache.size(), g_core->cfg->rom_cache_size);
-        auto data = (uint8_t*)malloc(taille);
-        memcpy(data, rom, taille);
-        rom_cache[path] = std::make_pair(data, taille);
+        g_core->logger->info("[Core] Loading cached ROM...");
+        image = rom_cache[path];
+        if (writable)
+        {
+            image = rom_clone_image(*image, capacity);
+        }
+    }
+    else
+    {
+        const t_file_mapping mapping(path);
+
+        if (mapping.data() && !(mapping.size() >= 2 && mapping.data()[0] == 0x1F && mapping.data()[1] == 0x8B))
+        {
+            image = rom_create_image(mapping.data(), mapping.size());
+        }
+        else
+        {
+            auto rom_buf = read_file_buffer(path);
+            if (rom_buf.size() >= 2 && rom_buf[0] == 0x1F && rom_buf[1] == 0x8B)
+            {
+                rom_buf = auto_decompress(rom_buf);
+            }
+            image = rom_create_image(rom_buf.data(), rom_buf.size());
+        }
+
+        if (!image)
+        {
+            return false;
+        }
+
+        g_core->logger->info("rom loaded succesfully");
+
+        if (rom_cache.size() < g_core->cfg->rom_cache_size)
+        {
+            g_core->logger->info("[Core] Putting ROM in cache... ({}/{} full)\n", rom_cache.size(), g_core->cfg->rom_cache_size);
+            rom_cache[path] = writable ? rom_clone_image(*image, 0) : image;
+        }
     }
 
+    g_rom_image = image;
+    g_core->rom = rom = image->data.get();
+    rom_size = image->size;
+    ROM_HEADER = image->header;
+    memcpy(rom_md5, image->md5, sizeof(rom_md5));
+
     return true;
 }
@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include "seek_savestates.h"
+#include <libdeflate.h>
+#include <core/Core.h>
+#include <ranges>
+
+struct t_seek_entry {
+    /// The order in which the checkpoint was added.
+    uint64_t sequence;
+
+    /// The checkpoint's savestate while it's uncompressed.
+    std::shared_ptr<const t_st_delta> delta;
+
+    /// The checkpoint's savestate as a gzip-compressed standalone buffer, once compressed.
+    std::shared_ptr<const std::vector<uint8_t>> compressed;
+};
+
+// The number of most recently added checkpoints which are kept as deltas. These are the ones seeks usually go back to.
+constexpr size_t HOT_ENTRY_COUNT = 8;
+
+// The compression level used for compressing checkpoints.
+constexpr int32_t COMPRESSION_LEVEL = 3;
+
+// Locked when accessing the store's state.
+static std::mutex g_store_mutex;
+
+// Signalled when there might be checkpoints to compress, or when the compressor should stop.
+static std::condition_variable g_store_cv;
+
+// The checkpoints, keyed by frame.
+static std::map<size_t, t_seek_entry> g_entries;
+
+// The sequence number of the most recently added checkpoint.
+static uint64_t g_sequence = 0;
+
+// The memory used by the checkpoints, as counted by entry_bytes. Kept up to date as checkpoints are added, compressed and removed.
+static size_t g_store_bytes = 0;
+
+static std::thread g_compressor;
+static bool g_compressor_stop = false;
+
+// Stops the compressor thread on shutdown. Must be declared after the state it uses.
+static struct t_compressor_guard {
+    ~t_compressor_guard()
+    {
+        {
+            std::scoped_lock lock(g_store_mutex);
+            g_compressor_stop = true;
+        }
+        g_store_cv.notify_all();
+        if (g_compressor.joinable())
+        {
+            g_compressor.join();
+        }
+    }
+} g_compressor_guard;
+
+/**
+ * Gets the memory a checkpoint accounts for: its compressed buffer once compressed, and its own delta pages until then.
+ * Ancestors are accounted for by the checkpoints they were stored for, even if newer deltas keep them alive after those were compressed.
+ */
+static size_t entry_bytes(const t_seek_entry& entry)
+{
+    return entry.compressed ? entry.compressed->size() : entry.delta->data.size();
+}
+
+/**
+ * Removes a checkpoint and its memory from the total. The store mutex must be held.
+ */
+static void erase_entry(std::map<size_t, t_seek_entry>::iterator it)
+{
+    g_store_bytes -= entry_bytes(it->second);
+    g_entries.erase(it);
+}
+
+static bool is_hot(const t_seek_entry& entry)
+{
+    return entry.sequence + HOT_ENTRY_COUNT > g_sequence;
+}
+
+/**
+ * Finds the oldest checkpoint which should be compressed. The store mutex must be held.
+ */
+static std::map<size_t, t_seek_entry>::iterator find_compression_candidate()
+{
+    auto candidate = g_entries.end();
+    for (auto it = g_entries.begin(); it != g_entries.end(); ++it)
+    {
+        if (!it->second.delta || is_hot(it->second))
+        {
+            continue;
+        }
+        if (candidate == g_entries.end() || it->second.sequence < candidate->second.sequence)
+        {
+            candidate = it;
+        }
+    }
+    return candidate;
+}
+
+static std::vector<uint8_t> compress(const std::vector<uint8_t>& buffer)
+{
+    const auto compressor = libdeflate_alloc_compressor(COMPRESSION_LEVEL);
+
+    std::vector<uint8_t> compressed(libdeflate_gzip_compress_bound(compressor, buffer.size()));
+    const size_t size = libdeflate_gzip_compress(compressor, buffer.data(), buffer.size(), compressed.data(), compressed.size());
+    libdeflate_free_compressor(compressor);
+
+    compressed.resize(size);
+    compressed.shrink_to_fit();
+    return compressed;
+}
+
+/**
+ * Replaces a checkpoint's delta with its compressed buffer. The store mutex must be held.
+ */
+static void install_compressed(size_t frame, const std::shared_ptr<const t_st_delta>& delta, std::shared_ptr<const std::vector<uint8_t>> compressed)
+{
+    // The checkpoint might have been replaced or removed while the lock wasn't held
+    const auto entry = g_entries.find(frame);
+    if (entry == g_entries.end() || entry->second.delta != delta)
+    {
+        return;
+    }
+
+    g_core->logger->trace("[Seek] Compressed checkpoint at frame {} to {} bytes", frame, compressed->size());
+    g_store_bytes -= entry_bytes(entry->second);
+    entry->second.compressed = std::move(compressed);
+    entry->second.delta.reset();
+    g_store_bytes += entry_bytes(entry->second);
+}
+
+static void compressor_thread()
+{
+    std::unique_lock lock(g_store_mutex);
+
+    while (true)
+    {
+        g_store_cv.wait(lock, [] {
+            return g_compressor_stop || find_compression_candidate() != g_entries.end();
+        });
+
+        if (g_compressor_stop)
+        {
+            return;
+        }
+
+        const auto it = find_compression_candidate();
+        const size_t frame = it->first;
+        const auto delta = it->second.delta;
+
+        lock.unlock();
+        auto compressed = std::make_shared<const std::vector<uint8_t>>(compress(st_decode_delta(*delta)));
+        lock.lock();
+
+        install_compressed(frame, delta, std::move(compressed));
+    }
+}
+
+/**
+ * Picks the checkpoint whose removal hurts seeking the least. The store mutex must be held.
+ *
+ * A checkpoint's removal leaves a gap between its neighbours. That gap is weighed against the checkpoint's distance from the newest one,
+ * so removals keep the spacing of old checkpoints proportional to their age, giving a logarithmic distribution.
+ * The first and last checkpoints are never picked, and neither are hot ones, since their memory is shared with the newest delta.
+ */
+static std::optional<size_t> find_eviction_candidate()
+{
+    if (g_entries.size() < 3)
+    {
+        return std::nullopt;
+    }
+
+    const size_t latest = g_entries.rbegin()->first;
+
+    std::optional<size_t> candidate;
+    double lowest_score = std::numeric_limits<double>::max();
+
+    for (auto it = std::next(g_entries.begin()); std::next(it) != g_entries.end(); ++it)
+    {
+        if (is_hot(it->second))
+        {
+            continue;
+        }
+
+        const double gap = static_cast<double>(std::next(it)->first - std::prev(it)->first);
+        const double age = static_cast<double>(latest - it->first);
+        const double score = gap / age;
+
+        if (score < lowest_score)
+        {
+            lowest_score = score;
+            candidate = it->first;
+        }
+    }
+
+    return candidate;
+}
+
+std::vector<size_t> seek_store_put(size_t frame, std::shared_ptr<const t_st_delta> delta)
+{
+    std::vector<size_t> evicted;
+
+    {
+        std::scoped_lock lock(g_store_mutex);
+
+        if (const auto it = g_entries.find(frame); it != g_entries.end())
+        {
+            erase_entry(it);
+        }
+
+        const auto& entry = g_entries[frame] = t_seek_entry{
+        .sequence = ++g_sequence,
+        .delta = std::move(delta),
+        };
+        g_store_bytes += entry_bytes(entry);
+
+        const auto max_count = static_cast<size_t>(std::max(g_core->cfg->seek_savestate_max_count, 0));
+        const auto max_bytes = static_cast<size_t>(std::max(g_core->cfg->seek_savestate_max_size, 0)) * 1024 * 1024;
+
+        // Cold checkpoints the compressor didn't get to yet are counted at their uncompressed size
+        while ((max_count && g_entries.size() > max_count) || (max_bytes && g_store_bytes > max_bytes))
+        {
+            const auto candidate = find_eviction_candidate();
+            if (!candidate.has_value())
+            {
+                break;
+            }
+
+            erase_entry(g_entries.find(candidate.value()));
+            evicted.push_back(candidate.value());
+        }
+
+        if (!g_compressor.joinable())
+        {
+            g_compressor = std::thread(compressor_thread);
+        }
+    }
+
+    g_store_cv.notify_one();
+    return evicted;
+}
+
+std::vector<uint8_t> seek_store_get(size_t frame)
+{
+    std::shared_ptr<const t_st_delta> delta;
+    std::shared_ptr<const std::vector<uint8_t>> compressed;
+
+    {
+        std::scoped_lock lock(g_store_mutex);
+        const auto it = g_entries.find(frame);
+        if (it == g_entries.end())
+        {
+            return {};
+        }
+        delta = it->second.delta;
+        compressed = it->second.compressed;
+    }
+
+    if (compressed)
+    {
+        return *compressed;
+    }
+
+    return st_decode_delta(*delta);
+}
+
+bool seek_store_contains(size_t frame)
+{
+    std::scoped_lock lock(g_store_mutex);
+    return g_entries.contains(frame);
+}
+
+size_t seek_store_find_before(size_t frame)
+{
+    std::scoped_lock lock(g_store_mutex);
+
+    const auto it = g_entries.lower_bound(frame);
+    if (it == g_entries.begin())
+    {
+        return 0;
+    }
+    return std::prev(it)->first;
+}
+
+std::vector<size_t> seek_store_erase_from(size_t frame)
+{
+    std::scoped_lock lock(g_store_mutex);
+
+    std::vector<size_t> erased;
+    const auto first = g_entries.lower_bound(frame);
+    for (auto it = first; it != g_entries.end(); ++it)
+    {
+        erased.push_back(it->first);
+        g_store_bytes -= entry_bytes(it->second);
+    }
+    g_entries.erase(first, g_entries.end());
+
+    return erased;
+}
+
+std::vector<size_t> seek_store_clear()
+{
+    std::scoped_lock lock(g_store_mutex);
+
+    std::vector<size_t> erased;
+    erased.reserve(g_entries.size());
+    for (const auto frame : g_entries | std::views::keys)
+    {
+        erased.push_back(frame);
+    }
+    g_entries.clear();
+    g_store_bytes = 0;
+
+    return erased;
+}
+
+std::vector<size_t> seek_store_frames()
+{
+    std::scoped_lock lock(g_store_mutex);
+
+    std::vector<size_t> frames;
+    frames.reserve(g_entries.size());
+    for (const auto frame : g_entries | std::views::keys)
+    {
+        frames.push_back(frame);
+    }
+
+    return frames;
+}
+
+size_t seek_store_size()
+{
+    std::scoped_lock lock(g_store_mutex);
+    return g_entries.size();
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <core/memory/savestates.h>
+
+/*
+ * The seek savestate store keeps the checkpoints used for seeking and warp modify within a memory budget.
+ *
+ * Recent checkpoints are kept as delta savestates. Older ones are compressed into standalone savestates in the background.
+ * When the store exceeds its budget, checkpoints are thinned out so that their spacing grows with their distance from the newest one,
+ * which keeps recent checkpoints dense and old ones sparse.
+ */
+
+/**
+ * \brief Adds a checkpoint, replacing any existing one at the same frame, then evicts checkpoints until the store fits in its budget.
+ * \param frame The checkpoint's frame.
+ * \param delta The checkpoint's savestate.
+ * \return The frames of the evicted checkpoints.
+ */
+std::vector<size_t> seek_store_put(size_t frame, std::shared_ptr<const t_st_delta> delta);
+
+/**
+ * \brief Gets a checkpoint's savestate buffer.
+ * \param frame The checkpoint's frame.
+ * \return The savestate buffer, which may be compressed, or an empty buffer if there's no checkpoint at the frame.
+ * \remarks Decoding can take a while, so this should be called off the emulation thread.
+ */
+std::vector<uint8_t> seek_store_get(size_t frame);
+
+/**
+ * \brief Gets whether there's a checkpoint at the specified frame.
+ */
+bool seek_store_contains(size_t frame);
+
+/**
+ * \brief Finds the closest checkpoint before the specified frame.
+ * \param frame The frame, which is excluded from the search.
+ * \return The checkpoint's frame, or 0 if there's none.
+ */
+size_t seek_store_find_before(size_t frame);
+
+/**
+ * \brief Removes all checkpoints at or after the specified frame.
+ * \return The frames of the removed checkpoints.
+ */
+std::vector<size_t> seek_store_erase_from(size_t frame);
+
+/**
+ * \brief Removes all checkpoints.
+ * \return The frames of the removed checkpoints.
+ */
+std::vector<size_t> seek_store_clear();
+
+/**
+ * \brief Gets the frames of all checkpoints, in ascending order.
+ */
+std::vector<size_t> seek_store_frames();
+
+/**
+ * \brief Gets the number of checkpoints.
+ */
+size_t seek_store_size();
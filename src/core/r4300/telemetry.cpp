@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include "telemetry.h"
+
+// The amount of samples kept in the ring.
+constexpr size_t RING_SIZE = 1024;
+
+// The names of the sections in dumps.
+constexpr const char* SECTION_NAMES[core_tm_section_count] = {
+"cpu",
+"rsp_gfx",
+"rsp_audio",
+"update_screen",
+"callbacks",
+"sleep",
+"idle",
+};
+
+static core_tm_sample g_ring[RING_SIZE];
+
+// The amount of samples published so far. The sample with index i is stored at i % RING_SIZE.
+static std::atomic<uint64_t> g_published = 0;
+
+// The index of the first sample visible to readers.
+static std::atomic<uint64_t> g_first_visible = 0;
+
+// The sample of the VI in progress. Only touched by the emulation thread.
+static core_tm_sample g_current{};
+
+void tm_add(core_tm_section section, std::chrono::nanoseconds duration)
+{
+    g_current.sections[section] += duration.count();
+}
+
+void tm_on_frame()
+{
+    ++g_current.frames;
+}
+
+void tm_on_vi(std::chrono::nanoseconds total)
+{
+    g_current.total = total.count();
+
+    // The CPU gets the time not covered by any other section
+    uint64_t measured = 0;
+    for (size_t i = 0; i < core_tm_section_count; ++i)
+    {
+        if (i != core_tm_cpu)
+        {
+            measured += g_current.sections[i];
+        }
+    }
+    g_current.sections[core_tm_cpu] = g_current.total > measured ? g_current.total - measured : 0;
+
+    const uint64_t index = g_published.load(std::memory_order_relaxed);
+    g_ring[index % RING_SIZE] = g_current;
+    g_published.store(index + 1, std::memory_order_release);
+
+    g_current = {};
+}
+
+void tm_reset()
+{
+    g_first_visible = g_published.load();
+}
+
+size_t core_tm_get_samples(core_tm_sample* samples, size_t count)
+{
+    const uint64_t end = g_published.load(std::memory_order_acquire);
+    const uint64_t first = std::max({g_first_visible.load(), end - std::min<uint64_t>(end, count), end - std::min<uint64_t>(end, RING_SIZE)});
+
+    for (uint64_t i = first; i < end; ++i)
+    {
+        samples[i - first] = g_ring[i % RING_SIZE];
+    }
+
+    // Samples whose slots were reused by the writer while we were copying them are torn, so they're dropped
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t published_after = g_published.load(std::memory_order_relaxed);
+    const uint64_t first_intact = published_after >= RING_SIZE ? published_after - RING_SIZE + 1 : 0;
+
+    if (first_intact <= first)
+    {
+        return end - first;
+    }
+    if (first_intact >= end)
+    {
+        return 0;
+    }
+
+    std::copy(samples + (first_intact - first), samples + (end - first), samples);
+    return end - first_intact;
+}
+
+static core_tm_distribution compute_distribution(std::vector<uint64_t>& values)
+{
+    if (values.empty())
+    {
+        return {};
+    }
+
+    std::ranges::sort(values);
+
+    // Nearest-rank percentiles
+    const auto percentile = [&](double p) {
+        const auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(values.size())));
+        return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+    };
+
+    double sum = 0;
+    for (const auto value : values)
+    {
+        sum += static_cast<double>(value);
+    }
+
+    return core_tm_distribution{
+    .mean = sum / static_cast<double>(values.size()),
+    .p50 = percentile(0.50),
+    .p95 = percentile(0.95),
+    .p99 = percentile(0.99),
+    .max = values.back(),
+    };
+}
+
+void core_tm_get_stats(size_t count, core_tm_stats* stats)
+{
+    std::vector<core_tm_sample> samples(std::min(count, RING_SIZE));
+    samples.resize(core_tm_get_samples(samples.data(), samples.size()));
+
+    *stats = {};
+    stats->sample_count = samples.size();
+
+    std::vector<uint64_t> values(samples.size());
+
+    uint64_t total_time = 0;
+    uint64_t total_frames = 0;
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        values[i] = samples[i].total;
+        total_time += samples[i].total;
+        total_frames += samples[i].frames;
+    }
+    stats->total = compute_distribution(values);
+
+    for (size_t section = 0; section < core_tm_section_count; ++section)
+    {
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            values[i] = samples[i].sections[section];
+        }
+        stats->sections[section] = compute_distribution(values);
+    }
+
+    if (total_time > 0)
+    {
+        const double seconds = static_cast<double>(total_time) / 1'000'000'000.0;
+        stats->vis_per_second = static_cast<double>(samples.size()) / seconds;
+        stats->frames_per_second = static_cast<double>(total_frames) / seconds;
+    }
+}
+
+static std::string format_distribution(const core_tm_distribution& distribution)
+{
+    return std::format(R"({{"mean":{:.0f},"p50":{},"p95":{},"p99":{},"max":{}}})",
+                       distribution.mean, distribution.p50, distribution.p95, distribution.p99, distribution.max);
+}
+
+std::string core_tm_dump(size_t count)
+{
+    core_tm_stats stats{};
+    core_tm_get_stats(count, &stats);
+
+    std::string sections;
+    for (size_t i = 0; i < core_tm_section_count; ++i)
+    {
+        sections += std::format(R"({}"{}":{})", i == 0 ? "" : ",", SECTION_NAMES[i], format_distribution(stats.sections[i]));
+    }
+
+    return std::format(R"({{"samples":{},"vis_per_second":{:.3f},"frames_per_second":{:.3f},"total":{},"sections":{{{}}}}})",
+                       stats.sample_count, stats.vis_per_second, stats.frames_per_second, format_distribution(stats.total), sections);
+}
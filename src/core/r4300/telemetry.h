@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <core/include/core_api.h>
+
+/*
+ * Telemetry accumulates the time spent in each section during a VI, and publishes it as a sample into a ring when the VI ends.
+ * The emulation thread is the ring's only writer. Readers copy samples out and discard the ones which were overwritten while copying, so neither side locks.
+ */
+
+/**
+ * \brief Adds time spent in a section to the current VI.
+ * \warning This function must only be called from the emulation thread.
+ */
+void tm_add(core_tm_section section, std::chrono::nanoseconds duration);
+
+/**
+ * \brief Notifies telemetry of a frame being generated.
+ * \warning This function must only be called from the emulation thread.
+ */
+void tm_on_frame();
+
+/**
+ * \brief Ends the current VI and publishes its sample.
+ * \param total The VI's duration.
+ * \warning This function must only be called from the emulation thread.
+ */
+void tm_on_vi(std::chrono::nanoseconds total);
+
+/**
+ * \brief Makes readers ignore the samples published so far, e.g. after the speed modifier changed.
+ */
+void tm_reset();
+
+/**
+ * \brief Adds the time spent in a scope to a section.
+ */
+struct t_tm_scope {
+    explicit t_tm_scope(core_tm_section section)
+        : section(section), start(std::chrono::high_resolution_clock::now())
+    {
+    }
+
+    ~t_tm_scope()
+    {
+        tm_add(section, std::chrono::high_resolution_clock::now() - start);
+    }
+
+    t_tm_scope(const t_tm_scope&) = delete;
+    t_tm_scope& operator=(const t_tm_scope&) = delete;
+
+private:
+    core_tm_section section;
+    std::chrono::high_resolution_clock::time_point start;
+};
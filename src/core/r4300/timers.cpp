@@ -10,17 +10,24 @@
 #include <core/include/core_api.h>
 #include <core/memory/pif.h>
 #include <core/r4300/r4300.h>
+#include <core/r4300/macros.h>
+#include <core/r4300/telemetry.h>
 
 extern int32_t m_current_vi;
 extern int32_t m_current_sample;
 
 std::chrono::duration<double, std::milli> max_vi_s_ms;
 
-size_t frame_deltas_ptr = 0;
-size_t vi_deltas_ptr = 0;
-
 time_point last_vi_time;
-time_point last_frame_time;
+
+// The Count register's value at the last VI, used for counting executed instructions in benchmark mode.
+uint32_t last_vi_count;
+uint64_t executed_instructions;
+
+uint64_t core_vr_get_executed_instructions()
+{
+    return executed_instructions;
+}
 
 void core_vr_on_speed_modifier_changed()
 {
@@ -28,33 +35,17 @@ void core_vr_on_speed_modifier_changed()
     max_vi_s_ms = std::chrono::duration<double, std::milli>(
     1000.0 / (max_vi_s * static_cast<double>(g_core->cfg->fps_modifier) / 100));
 
-    last_frame_time = std::chrono::high_resolution_clock::now();
     last_vi_time = std::chrono::high_resolution_clock::now();
 
-    for (auto& delta : g_core->g_frame_deltas)
-    {
-        delta = {};
-    }
-    for (auto& delta : g_core->g_vi_deltas)
-    {
-        delta = {};
-    }
-
-    frame_deltas_ptr = 0;
-    vi_deltas_ptr = 0;
+    tm_reset();
 }
 
 void timer_new_frame()
 {
-    const auto current_frame_time = std::chrono::high_resolution_clock::now();
-
-    g_core->g_frame_deltas_mutex.lock();
-    g_core->g_frame_deltas[frame_deltas_ptr] = current_frame_time - last_frame_time;
-    g_core->g_frame_deltas_mutex.unlock();
-    frame_deltas_ptr = (frame_deltas_ptr + 1) % core_timer_max_deltas;
+    tm_on_frame();
 
+    t_tm_scope scope(core_tm_callbacks);
     g_core->callbacks.frame();
-    last_frame_time = std::chrono::high_resolution_clock::now();
 }
 
 void timer_new_vi()
@@ -66,7 +57,14 @@ void timer_new_vi()
 
     auto current_vi_time = std::chrono::high_resolution_clock::now();
 
-    if (!g_vr_fast_forward)
+    if (g_vr_benchmark_enabled)
+    {
+        // Count advances by 2 for each executed instruction
+        executed_instructions += static_cast<uint32_t>(core_Count - last_vi_count) / 2;
+    }
+    last_vi_count = core_Count;
+
+    if (!g_vr_fast_forward && !g_vr_benchmark_enabled)
     {
         static std::chrono::duration<double, std::nano> last_sleep_error;
         // if we're playing game normally with no frame advance or ff and overstepping max time between frames,
@@ -90,6 +88,8 @@ void timer_new_vi()
                 // this value isnt usually too large
                 last_sleep_error = end_sleep - start_sleep - goal_sleep;
 
+                tm_add(core_tm_sleep, end_sleep - start_sleep);
+
                 // This value is used later to calculate the deltas so we need to reassign it here to cut out the sleep time from the current delta
                 current_vi_time = std::chrono::high_resolution_clock::now();
             }
@@ -105,10 +105,7 @@ void timer_new_vi()
         }
     }
 
-    g_core->g_vi_deltas_mutex.lock();
-    g_core->g_vi_deltas[vi_deltas_ptr] = current_vi_time - last_vi_time;
-    g_core->g_vi_deltas_mutex.unlock();
-    vi_deltas_ptr = (vi_deltas_ptr + 1) % core_timer_max_deltas;
+    tm_on_vi(current_vi_time - last_vi_time);
 
     last_vi_time = std::chrono::high_resolution_clock::now();
 }
@@ -8,14 +8,65 @@
 #include "tracelog.h"
 #include "disasm.h"
 #include "r4300.h"
+#include <libdeflate.h>
+#include <core/Core.h>
+
+/*
+ * Every logged instruction is captured into a fixed-size record holding its address, opcode and the two operand values relevant to its format.
+ * The text and binary formats are rendered from the record immediately, while the compressed format pushes it into a ring buffer,
+ * which a writer thread drains, compresses in blocks and writes to disk. Compressed logs can be rendered to text later on.
+ *
+ * Compressed log layout (little endian):
+ *  header: magic "M64T", version, record size, reserved (u32 each)
+ *  blocks: compressed size (u32), record count (u32), raw deflate data
+ *  index:  for every block, its offset and the index of its first record (u64 each)
+ *  footer: index offset (u64), block count (u32), magic "M64I"
+ */
+
+/**
+ * A logged instruction.
+ */
+struct t_tl_record {
+    /// The instruction's address. The lowest bit is set if the instruction is in a delay slot.
+    uint32_t pc;
+
+    /// The instruction's opcode.
+    uint32_t opcode;
+
+    /// The operand values, as laid out by the binary format.
+    uint32_t values[2];
+};
+
+static_assert(sizeof(t_tl_record) == 16);
+
+constexpr uint32_t TL_MAGIC = 0x5434364D; // M64T
+constexpr uint32_t TL_INDEX_MAGIC = 0x4934364D; // M64I
+constexpr uint32_t TL_VERSION = 1;
+
+// The amount of records in the ring buffer. Must be a power of two.
+constexpr size_t RING_CAPACITY = 1 << 20;
+
+// The maximum amount of records compressed together.
+constexpr size_t BLOCK_RECORDS = 1 << 16;
+
+// The compression level used for blocks. Favours speed, as the writer has to keep up with the emulator.
+constexpr int32_t COMPRESSION_LEVEL = 1;
 
 bool enabled = false;
-bool use_binary = false;
+core_tl_format g_format = core_tl_format_text;
 
 FILE* log_file;
 char traceLoggingBuf[0x10000];
 char* traceLoggingPointer = traceLoggingBuf;
 
+// The ring buffer which the emulation thread pushes records into when using the compressed format.
+std::vector<t_tl_record> g_ring(RING_CAPACITY);
+alignas(64) std::atomic<size_t> g_ring_head = 0;
+alignas(64) std::atomic<size_t> g_ring_tail = 0;
+
+std::thread g_writer_thread;
+std::atomic<bool> g_writer_stop = false;
+
 bool core_vr_is_tracelog_active()
 {
     return enabled;
@@ -37,120 +88,96 @@ void write_buf()
     }
 }
 
-
-void log_bin(uint32_t pc, uint32_t w)
+/**
+ * Captures the record of an instruction which is about to be executed.
+ */
+static t_tl_record capture(uint32_t pc, uint32_t w)
 {
-    char*& p = traceLoggingPointer;
     INSTDECODE decode;
-    // little endian
-#define HEX8(n)        \
-    *(uint32_t*)p = n; \
-    p += 4
-
     DecodeInstruction(w, &decode);
-    HEX8(pc);
-    HEX8(w);
+
+    t_tl_record record = {
+    .pc = pc | (delay_slot ? 1 : 0),
+    .opcode = w,
+    };
+
     INSTOPERAND& o = decode.operand;
-    // n�͌ォ��f�R�[�h����΂킩��
-#define REGCPU(n) \
-    HEX8(reg[n])
-#define REGCPU2(n, m) \
-    REGCPU(n);        \
-    REGCPU(m);
-    // 10�i��
-#define REGFPU(n) \
-    HEX8(*(uint32_t*)reg_cop1_simple[n])
-#define REGFPU2(n, m) \
-    REGFPU(n);        \
-    REGFPU(m)
-#define NONE           \
-    *(uint32_t*)p = 0; \
-    p += 4
-#define NONE2 \
-    NONE;     \
-    NONE
+    uint32_t* v = record.values;
+#define REGCPU(n) (uint32_t)reg[n]
+#define REGFPU(n) *(uint32_t*)reg_cop1_simple[n]
 
     switch (decode.format)
     {
     case INSTF_NONE:
-        NONE2;
-        break;
     case INSTF_J:
     case INSTF_0BRANCH:
-        NONE2;
-        break;
     case INSTF_LUI:
-        NONE2;
+    case INSTF_MFC0:
         break;
     case INSTF_1BRANCH:
     case INSTF_JR:
     case INSTF_ISIGN:
     case INSTF_IUNSIGN:
-        REGCPU(o.i.rs);
-        NONE;
+        v[0] = REGCPU(o.i.rs);
         break;
     case INSTF_2BRANCH:
-        REGCPU2(o.i.rs, o.i.rt);
+    case INSTF_R2:
+    case INSTF_R3:
+        v[0] = REGCPU(o.i.rs);
+        v[1] = REGCPU(o.i.rt);
         break;
     case INSTF_ADDRW:
-        HEX8(reg[o.i.rs] + (int16_t)o.i.immediate);
-        REGCPU(o.i.rt);
+        v[0] = (uint32_t)(reg[o.i.rs] + (int16_t)o.i.immediate);
+        v[1] = REGCPU(o.i.rt);
         break;
     case INSTF_ADDRR:
-        HEX8(reg[o.i.rs] + (int16_t)o.i.immediate);
-        NONE;
+        v[0] = (uint32_t)(reg[o.i.rs] + (int16_t)o.i.immediate);
         break;
     case INSTF_LFW:
-        HEX8(reg[o.lf.base] + (int16_t)o.lf.offset);
-        REGFPU(o.lf.ft);
+        v[0] = (uint32_t)(reg[o.lf.base] + (int16_t)o.lf.offset);
+        v[1] = REGFPU(o.lf.ft);
         break;
     case INSTF_LFR:
-        HEX8(reg[o.lf.base] + (int16_t)o.lf.offset);
-        NONE;
+        v[0] = (uint32_t)(reg[o.lf.base] + (int16_t)o.lf.offset);
         break;
     case INSTF_R1:
-        REGCPU(o.r.rd);
-        NONE;
-        break;
-    case INSTF_R2:
-        REGCPU2(o.i.rs, o.i.rt);
-        break;
-    case INSTF_R3:
-        REGCPU2(o.i.rs, o.i.rt);
+        v[0] = REGCPU(o.r.rd);
         break;
     case INSTF_MTC0:
     case INSTF_MTC1:
     case INSTF_SA:
-        REGCPU(o.r.rt);
-        NONE;
+        v[0] = REGCPU(o.r.rt);
         break;
     case INSTF_R2F:
-        REGFPU(o.cf.fs);
-        NONE;
+        v[0] = REGFPU(o.cf.fs);
         break;
     case INSTF_R3F:
     case INSTF_C:
-        REGFPU2(o.cf.fs, o.cf.ft);
-        break;
-    case INSTF_MFC0:
-        NONE2;
+        v[0] = REGFPU(o.cf.fs);
+        v[1] = REGFPU(o.cf.ft);
         break;
     case INSTF_MFC1:
-        REGFPU(((uint8_t)o.r.rs));
-        NONE;
+        v[0] = REGFPU(((uint8_t)o.r.rs));
         break;
     }
-    write_buf();
-#undef HEX8
+
+    return record;
 #undef REGCPU
 #undef REGFPU
-#undef REGCPU2
-#undef REGFPU2
 }
 
-void log(uint32_t pc, uint32_t w)
+/**
+ * Renders a record as a line of text.
+ * \param p The output buffer, which must have room for at least 512 characters.
+ * \param record The record.
+ * \return The end of the written text.
+ */
+static char* render(char* p, const t_tl_record& record)
 {
-    char*& p = traceLoggingPointer;
+    const uint32_t pc = record.pc & ~1;
+    const uint32_t w = record.opcode;
+    const uint32_t* v = record.values;
+
     INSTDECODE decode;
     const char* const x = "0123456789abcdef";
 #define HEX8(n)                          \
@@ -192,7 +219,7 @@ void log(uint32_t pc, uint32_t w)
     }
     *(p++) = ';';
     INSTOPERAND& o = decode.operand;
-#define REGCPU(n)                                         \
+#define REGCPU(n, value)                                  \
     if ((n) != 0)                                         \
     {                                                     \
         for (const char* l = CPURegisterName[n]; *l; l++) \
@@ -200,32 +227,31 @@ void log(uint32_t pc, uint32_t w)
             *(p++) = *l;                                  \
         }                                                 \
         *(p++) = '=';                                     \
-        HEX8(reg[n]);                                     \
+        HEX8(value);                                      \
     }
 #define REGCPU2(n, m)           \
-    REGCPU(n);                  \
+    REGCPU(n, v[0]);            \
     if ((n) != (m) && (m) != 0) \
     {                           \
         C;                      \
-        REGCPU(m);              \
+        REGCPU(m, v[1]);        \
     }
-    // 10�i��
-#define REGFPU(n)         \
-    *(p++) = 'f';         \
-    *(p++) = x[(n) / 10]; \
-    *(p++) = x[(n) % 10]; \
-    *(p++) = '=';         \
-    p += sprintf(p, "%f", *reg_cop1_simple[n])
-#define REGFPU2(n, m) \
-    REGFPU(n);        \
-    if ((n) != (m))   \
-    {                 \
-        C;            \
-        REGFPU(m);    \
+#define REGFPU(n, value)                               \
+    *(p++) = 'f';                                      \
+    *(p++) = x[(n) / 10];                              \
+    *(p++) = x[(n) % 10];                              \
+    *(p++) = '=';                                      \
+    p += sprintf(p, "%f", std::bit_cast<float>(value))
+#define REGFPU2(n, m)    \
+    REGFPU(n, v[0]);     \
+    if ((n) != (m))      \
+    {                    \
+        C;               \
+        REGFPU(m, v[1]); \
     }
 #define C *(p++) = ','
 
-    if (delay_slot)
+    if (record.pc & 1)
     {
         *(p++) = '#';
     }
@@ -242,13 +268,13 @@ void log(uint32_t pc, uint32_t w)
     case INSTF_JR:
     case INSTF_ISIGN:
     case INSTF_IUNSIGN:
-        REGCPU(o.i.rs);
+        REGCPU(o.i.rs, v[0]);
         break;
     case INSTF_2BRANCH:
         REGCPU2(o.i.rs, o.i.rt);
         break;
     case INSTF_ADDRW:
-        REGCPU(o.i.rt);
+        REGCPU(o.i.rt, v[1]);
         if (o.i.rt != 0)
         {
             C;
@@ -256,18 +282,18 @@ void log(uint32_t pc, uint32_t w)
     case INSTF_ADDRR:
         *(p++) = '@';
         *(p++) = '=';
-        HEX8(reg[o.i.rs] + (int16_t)o.i.immediate);
+        HEX8(v[0]);
         break;
     case INSTF_LFW:
-        REGFPU(o.lf.ft);
+        REGFPU(o.lf.ft, v[1]);
         C;
     case INSTF_LFR:
         *(p++) = '@';
         *(p++) = '=';
-        HEX8(reg[o.lf.base] + (int16_t)o.lf.offset);
+        HEX8(v[0]);
         break;
     case INSTF_R1:
-        REGCPU(o.r.rd);
+        REGCPU(o.r.rd, v[0]);
         break;
     case INSTF_R2:
         REGCPU2(o.i.rs, o.i.rt);
@@ -278,10 +304,10 @@ void log(uint32_t pc, uint32_t w)
     case INSTF_MTC0:
     case INSTF_MTC1:
     case INSTF_SA:
-        REGCPU(o.r.rt);
+        REGCPU(o.r.rt, v[0]);
         break;
     case INSTF_R2F:
-        REGFPU(o.cf.fs);
+        REGFPU(o.cf.fs, v[0]);
         break;
     case INSTF_R3F:
     case INSTF_C:
@@ -290,12 +316,12 @@ void log(uint32_t pc, uint32_t w)
     case INSTF_MFC0:
         break;
     case INSTF_MFC1:
-        REGFPU(((uint8_t)o.r.rs));
+        REGFPU(((uint8_t)o.r.rs), v[0]);
         break;
     }
     *(p++) = '\n';
 
-    write_buf();
+    return p;
 #undef HEX8
 #undef REGCPU
 #undef REGFPU
@@ -304,40 +330,146 @@ void log(uint32_t pc, uint32_t w)
 #undef C
 }
 
-void tracelog_log_pure()
+void log_bin(uint32_t pc, uint32_t w)
+{
+    auto record = capture(pc, w);
+    record.pc = pc;
+    memcpy(traceLoggingPointer, &record, sizeof(record));
+    traceLoggingPointer += sizeof(record);
+    write_buf();
+}
+
+void log(uint32_t pc, uint32_t w)
+{
+    traceLoggingPointer = render(traceLoggingPointer, capture(pc, w));
+    write_buf();
+}
+
+void log_compressed(uint32_t pc, uint32_t w)
 {
-    if (!use_binary)
+    const size_t head = g_ring_head.load(std::memory_order_relaxed);
+
+    // When the writer falls behind, we wait for it instead of dropping records
+    while (head - g_ring_tail.load(std::memory_order_acquire) >= RING_CAPACITY)
     {
-        log(interp_addr, vr_op);
+        std::this_thread::yield();
     }
-    else
+
+    g_ring[head & (RING_CAPACITY - 1)] = capture(pc, w);
+    g_ring_head.store(head + 1, std::memory_order_release);
+}
+
+static void log_instruction(uint32_t pc, uint32_t w)
+{
+    switch (g_format)
     {
-        log_bin(interp_addr, vr_op);
+    case core_tl_format_text:
+        log(pc, w);
+        break;
+    case core_tl_format_binary:
+        log_bin(pc, w);
+        break;
+    case core_tl_format_compressed:
+        log_compressed(pc, w);
+        break;
     }
 }
 
-void tracelog_log_interp_ops()
+static void writer_thread()
 {
-    if (enabled)
+    struct t_block_info {
+        uint64_t offset;
+        uint64_t first_record;
+    };
+
+    const auto compressor = libdeflate_alloc_compressor(COMPRESSION_LEVEL);
+    std::vector<t_tl_record> block;
+    std::vector<uint8_t> compressed(libdeflate_deflate_compress_bound(compressor, BLOCK_RECORDS * sizeof(t_tl_record)));
+    std::vector<t_block_info> index;
+    uint64_t record_count = 0;
+    uint64_t offset = 16;
+
+    while (true)
     {
-        if (!use_binary)
+        const bool stopping = g_writer_stop.load(std::memory_order_acquire);
+        const size_t tail = g_ring_tail.load(std::memory_order_relaxed);
+        const size_t available = g_ring_head.load(std::memory_order_acquire) - tail;
+
+        // Small blocks compress poorly, so we wait for a full one unless we're stopping
+        if (available < BLOCK_RECORDS && !stopping)
         {
-            log(PC->addr, PC->src);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
         }
-        else
+
+        if (available == 0)
         {
-            log_bin(PC->addr, PC->src);
+            break;
         }
+
+        const size_t count = std::min(available, BLOCK_RECORDS);
+        block.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            block[i] = g_ring[(tail + i) & (RING_CAPACITY - 1)];
+        }
+        g_ring_tail.store(tail + count, std::memory_order_release);
+
+        const auto compressed_size = static_cast<uint32_t>(libdeflate_deflate_compress(compressor, block.data(), count * sizeof(t_tl_record), compressed.data(), compressed.size()));
+        const uint32_t block_header[2] = {compressed_size, static_cast<uint32_t>(count)};
+        fwrite(block_header, sizeof(block_header), 1, log_file);
+        fwrite(compressed.data(), compressed_size, 1, log_file);
+
+        index.push_back({offset, record_count});
+        offset += sizeof(block_header) + compressed_size;
+        record_count += count;
+    }
+
+    for (const auto& block_info : index)
+    {
+        fwrite(&block_info, sizeof(block_info), 1, log_file);
+    }
+
+    const uint32_t footer[4] = {(uint32_t)offset, (uint32_t)(offset >> 32), (uint32_t)index.size(), TL_INDEX_MAGIC};
+    fwrite(footer, sizeof(footer), 1, log_file);
+
+    libdeflate_free_compressor(compressor);
+
+    g_core->logger->info("[TL] Wrote {} records in {} blocks", record_count, index.size());
+}
+
+void tracelog_log_pure()
+{
+    log_instruction(interp_addr, vr_op);
+}
+
+void tracelog_log_interp_ops()
+{
+    if (enabled)
+    {
+        log_instruction(PC->addr, PC->src);
     }
     PC->s_ops();
 }
 
-void core_tl_start(std::filesystem::path path, bool binary, bool append)
+void core_tl_start(std::filesystem::path path, core_tl_format format, bool append)
 {
-    use_binary = binary;
+    g_format = format;
     log_file = _wfopen(path.wstring().c_str(), L"wb");
 
+    if (format == core_tl_format_compressed)
+    {
+        const uint32_t header[4] = {TL_MAGIC, TL_VERSION, sizeof(t_tl_record), 0};
+        fwrite(header, sizeof(header), 1, log_file);
+
+        g_ring_head = 0;
+        g_ring_tail = 0;
+        g_writer_stop = false;
+        g_writer_thread = std::thread(writer_thread);
+    }
+
     enabled = true;
+    g_interp_variant_dirty = true;
     if (interpcore == 0)
     {
         recompile_all();
@@ -348,6 +480,101 @@ void core_tl_start(std::filesystem::path path, bool binary, bool append)
 void core_tl_stop()
 {
     enabled = false;
-    flush_buf();
+    g_interp_variant_dirty = true;
+
+    if (g_format == core_tl_format_compressed)
+    {
+        g_writer_stop = true;
+        g_writer_thread.join();
+    }
+    else
+    {
+        flush_buf();
+    }
+
     fclose(log_file);
 }
+
+core_result core_tl_convert(const std::filesystem::path& src, const std::filesystem::path& dst)
+{
+    const auto buffer = read_file_buffer(src);
+
+    const auto read_u32 = [&](size_t offset) {
+        uint32_t value;
+        memcpy(&value, buffer.data() + offset, sizeof(value));
+        return value;
+    };
+
+    if (buffer.size() < 16 || read_u32(0) != TL_MAGIC || read_u32(4) != TL_VERSION || read_u32(8) != sizeof(t_tl_record))
+    {
+        return TL_InvalidFormat;
+    }
+
+    // Logs which weren't stopped properly have no index, in which case we go through the blocks one after another
+    std::vector<uint64_t> block_offsets;
+    const size_t footer_offset = buffer.size() - 16;
+    if (buffer.size() >= 32 && read_u32(footer_offset + 12) == TL_INDEX_MAGIC)
+    {
+        const uint64_t index_offset = read_u32(footer_offset) | (uint64_t)read_u32(footer_offset + 4) << 32;
+        const uint32_t block_count = read_u32(footer_offset + 8);
+
+        if (index_offset + block_count * 16ull != footer_offset)
+        {
+            return TL_InvalidFormat;
+        }
+
+        for (uint32_t i = 0; i < block_count; ++i)
+        {
+            block_offsets.push_back(read_u32(index_offset + i * 16) | (uint64_t)read_u32(index_offset + i * 16 + 4) << 32);
+        }
+    }
+    else
+    {
+        for (uint64_t offset = 16; offset + 8 <= buffer.size(); offset += 8 + read_u32(offset))
+        {
+            block_offsets.push_back(offset);
+        }
+    }
+
+    FILE* f = _wfopen(dst.wstring().c_str(), L"wb");
+    if (!f)
+    {
+        return TL_FileOpenFailed;
+    }
+
+    const auto decompressor = libdeflate_alloc_decompressor();
+    std::vector<t_tl_record> block(BLOCK_RECORDS);
+    std::vector<char> text(BLOCK_RECORDS * 512);
+    core_result result = Res_Ok;
+
+    for (const auto offset : block_offsets)
+    {
+        if (offset + 8 > buffer.size())
+        {
+            result = TL_InvalidFormat;
+            break;
+        }
+
+        const uint32_t compressed_size = read_u32(offset);
+        const uint32_t count = read_u32(offset + 4);
+
+        if (count > BLOCK_RECORDS || offset + 8 + compressed_size > buffer.size()
+            || libdeflate_deflate_decompress(decompressor, buffer.data() + offset + 8, compressed_size, block.data(), count * sizeof(t_tl_record), nullptr) != LIBDEFLATE_SUCCESS)
+        {
+            result = TL_InvalidFormat;
+            break;
+        }
+
+        char* p = text.data();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            p = render(p, block[i]);
+        }
+        fwrite(text.data(), 1, p - text.data(), f);
+    }
+
+    libdeflate_free_decompressor(decompressor);
+    fclose(f);
+
+    return result;
+}
@@ -12,6 +12,8 @@
 #include <core/memory/savestates.h>
 #include <core/r4300/r4300.h>
 #include <core/r4300/rom.h>
+#include <core/r4300/seek_savestates.h>
+#include <core/r4300/telemetry.h>
 #include <core/r4300/timers.h>
 #include <core/r4300/vcr.h>
 
@@ -39,7 +41,6 @@ std::optional<size_t> seek_to_frame;
 bool g_seek_pause_at_end;
 std::atomic g_seek_savestate_loading = false;
 std::atomic g_reset_pending = false;
-std::unordered_map<size_t, std::vector<uint8_t>> g_seek_savestates;
 
 bool g_warp_modify_active = false;
 size_t g_warp_modify_first_difference_frame = 0;
@@ -529,21 +530,6 @@ void vcr_create_n_frame_savestate(size_t frame)
         }
     }
 
-    // If our seek savestate map is getting too large, we'll start purging the oldest ones (but not the first one!!!)
-    if (g_seek_savestates.size() > g_core->cfg->seek_savestate_max_count)
-    {
-        for (int32_t i = 1; i < g_header.length_samples; ++i)
-        {
-            if (g_seek_savestates.contains(i))
-            {
-                g_core->logger->info("[VCR] Map too large! Purging seek savestate at frame {}...", i);
-                g_seek_savestates.erase(i);
-                g_core->callbacks.seek_savestate_changed((size_t)i);
-                break;
-            }
-        }
-    }
-
     g_core->logger->info("[VCR] Creating seek savestate at frame {}...", frame);
     core_st_do_memory({}, core_st_job_save, [frame](core_result result, const auto& buf)
     {
@@ -555,12 +541,27 @@ void vcr_create_n_frame_savestate(size_t frame)
             return;
         }
 
-        g_core->logger->info("[VCR] Seek savestate at frame {} of size {} completed", frame, buf.size());
-        g_seek_savestates[frame] = buf;
+        const auto delta = st_encode_delta(buf);
+        g_core->logger->info("[VCR] Seek savestate at frame {} of size {} completed, {} bytes stored", frame, buf.size(), delta->data.size());
+
+        for (const auto evicted_frame : seek_store_put(frame, delta))
+        {
+            g_core->logger->info("[VCR] Evicted seek savestate at frame {}", evicted_frame);
+            g_core->callbacks.seek_savestate_changed(evicted_frame);
+        }
         g_core->callbacks.seek_savestate_changed((size_t)frame);
     }, false);
 }
 
+/**
+ * Invokes the host's input callback, accounting its time in telemetry.
+ */
+static void invoke_input_callback(core_buttons* input, int32_t index)
+{
+    t_tm_scope scope(core_tm_callbacks);
+    g_core->callbacks.input(input, index);
+}
+
 void vcr_handle_starting_tasks(int32_t index, core_buttons* input)
 {
     if (g_task == task_start_recording_from_reset)
@@ -645,13 +646,13 @@ void vcr_handle_recording(int32_t index, core_buttons* input)
 
             const auto prev_input = *input;
             // NOTE: We want to notify Lua of inputs but won't actually accept the new values
-            g_core->callbacks.input(input, index);
+            invoke_input_callback(input, index);
             *input = prev_input;
         }
         else
         {
             g_core->plugin_funcs.get_keys(index, input);
-            g_core->callbacks.input(input, index);
+            invoke_input_callback(input, index);
         }
     }
 
@@ -746,7 +747,7 @@ void vcr_handle_playback(int32_t index, core_buttons* input)
         }, 0);
     }
 
-    g_core->callbacks.input(input, index);
+    invoke_input_callback(input, index);
     m_current_sample++;
     g_core->callbacks.current_sample_changed(m_current_sample);
 }
@@ -825,7 +826,7 @@ void vcr_on_controller_poll(int32_t index, core_buttons* input)
     if (g_task == task_idle)
     {
         g_core->plugin_funcs.get_keys(index, input);
-        g_core->callbacks.input(input, index);
+        invoke_input_callback(input, index);
         return;
     }
 
@@ -932,10 +933,10 @@ core_result core_vcr_start_record(std::filesystem::path path, uint16_t flags, st
 
     if (flags & MOVIE_START_FROM_SNAPSHOT)
     {
-        // save state
+        // save state. The file is written synchronously, as recording has to start on the frame the state was saved on.
         g_core->logger->info("[VCR] Saving state...");
         g_task = task_start_recording_from_snapshot;
-        core_st_do_file(get_savestate_path_for_new_movie(g_movie_path), core_st_job_save, [](core_result result, auto)
+        st_do_file(get_savestate_path_for_new_movie(g_movie_path), core_st_job_save, [](core_result result, auto)
         {
             std::scoped_lock lock(vcr_mutex);
 
@@ -950,7 +951,7 @@ core_result core_vcr_start_record(std::filesystem::path path, uint16_t flags, st
             g_task = task_recording;
             // FIXME: Doesn't this need a message broadcast?
             // TODO: Also, what about clearing the input on first frame
-        }, true);
+        }, true, true);
     }
     else if (flags & MOVIE_START_FROM_EXISTING_SNAPSHOT)
     {
@@ -1369,26 +1370,7 @@ size_t compute_sample_from_seek_string(const std::wstring& str)
 
 size_t vcr_find_closest_savestate_before_frame(size_t frame)
 {
-    int32_t lowest_distance = INT32_MAX;
-    size_t lowest_distance_frame = 0;
-    for (const auto& [slot_frame, _] : g_seek_savestates)
-    {
-        // Current and future sts are invalid for rewinding
-        if (slot_frame >= frame)
-        {
-            continue;
-        }
-
-        auto distance = frame - slot_frame;
-
-        if (distance < lowest_distance)
-        {
-            lowest_distance = distance;
-            lowest_distance_frame = slot_frame;
-        }
-    }
-
-    return lowest_distance_frame;
+    return seek_store_find_before(frame);
 }
 
 core_result vcr_begin_seek_impl(std::wstring str, bool pause_at_end, bool resume, bool warp_modify)
@@ -1465,7 +1447,8 @@ core_result vcr_begin_seek_impl(std::wstring str, bool pause_at_end, bool resume
             // NOTE: This needs to go through AsyncExecutor (despite us already being on a worker thread) or it will cause a deadlock.
             g_core->invoke_async([=]
             {
-                core_st_do_memory(g_seek_savestates[closest_key], core_st_job_load, [=](core_result result, auto buf)
+                const auto buffer = seek_store_get(closest_key);
+                core_st_do_memory(buffer, core_st_job_load, [=](core_result result, auto buf)
                 {
                     if (result != Res_Ok)
                     {
@@ -1509,19 +1492,10 @@ core_result vcr_begin_seek_impl(std::wstring str, bool pause_at_end, bool resume
         // All seek savestates after the target frame need to be purged, as the user will invalidate them by overwriting inputs prior to them
         if (!g_core->cfg->vcr_readonly)
         {
-            std::vector<size_t> to_erase;
-            for (const auto& [sample, _] : g_seek_savestates)
+            for (const auto sample : seek_store_erase_from(target_sample))
             {
-                if (sample >= target_sample)
-                {
-                    to_erase.push_back(sample);
-                }
-            }
-            for (const auto sample : to_erase)
-            {
-                g_core->logger->info("[VCR] Erasing now-invalidated seek savestate at frame {}...", sample);
-                g_seek_savestates.erase(sample);
-                g_core->callbacks.seek_savestate_changed((size_t)sample);
+                g_core->logger->info("[VCR] Erased now-invalidated seek savestate at frame {}", sample);
+                g_core->callbacks.seek_savestate_changed(sample);
             }
         }
 
@@ -1533,7 +1507,8 @@ core_result vcr_begin_seek_impl(std::wstring str, bool pause_at_end, bool resume
         // NOTE: This needs to go through AsyncExecutor (despite us already being on a worker thread) or it will cause a deadlock.
         g_core->invoke_async([=]
         {
-            core_st_do_memory(g_seek_savestates[closest_key], core_st_job_load, [=](core_result result, auto buf)
+            const auto buffer = seek_store_get(closest_key);
+            core_st_do_memory(buffer, core_st_job_load, [=](core_result result, auto buf)
             {
                 if (result != Res_Ok)
                 {
@@ -1629,16 +1604,7 @@ static void vcr_clear_seek_savestates()
 
 	g_core->logger->info("[VCR] Clearing seek savestates...");
 
-	std::vector<size_t> prev_seek_savestate_keys;
-    prev_seek_savestate_keys.reserve(g_seek_savestates.size());
-    for (const auto& [key, _] : g_seek_savestates)
-    {
-        prev_seek_savestate_keys.push_back(key);
-    }
-
-    g_seek_savestates.clear();
-
-    for (const auto frame : prev_seek_savestate_keys)
+    for (const auto frame : seek_store_clear())
     {
         g_core->callbacks.seek_savestate_changed(frame);
     }
@@ -1818,15 +1784,15 @@ void core_vcr_get_seek_savestate_frames(std::unordered_map<size_t, bool>& map)
 {
     map.clear();
 
-    for (const auto& [key, _] : g_seek_savestates)
+    for (const auto frame : seek_store_frames())
     {
-        map[key] = true;
+        map[frame] = true;
     }
 }
 
 bool core_vcr_has_seek_savestate_at_frame(const size_t frame)
 {
-    return g_seek_savestates.contains(frame);
+    return seek_store_contains(frame);
 }
 
 void vcr_on_vi()
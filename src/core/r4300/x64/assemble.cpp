@@ -0,0 +1,1006 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include "assemble.h"
+#include <core/Core.h>
+#include <core/r4300/r4300.h>
+#include <core/r4300/recomph.h>
+#include <core/r4300/x64/regcache.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+typedef struct _jump_table
+{
+    uint32_t mi_addr;
+    uint32_t pc_addr;
+} jump_table;
+
+static jump_table* jumps_table = NULL;
+static int32_t jumps_number, max_jumps_number;
+
+// All recompiled code lives in one reserved arena, so blocks which call each other stay close in memory.
+// Code is bump allocated and only reclaimed as a whole, once every allocation was freed.
+constexpr size_t CODE_ARENA_SIZE = 128 * 1024 * 1024;
+
+// The top of the arena holds code which outlives the blocks, such as the entry and exit stubs
+constexpr size_t CODE_PERSISTENT_SIZE = 64 * 1024;
+
+// Once less than this is left, the code cache is flushed at the next block exit.
+// It's large enough to never run out while recompiling a single block.
+constexpr size_t CODE_ARENA_RESERVE = 8 * 1024 * 1024;
+
+// The granularity in which the arena is committed
+constexpr size_t CODE_COMMIT_GRANULARITY = 1024 * 1024;
+
+// Each allocation is preceded by a header holding its size
+constexpr size_t CODE_HEADER_SIZE = 16;
+
+typedef struct _code_link
+{
+    // The link site in the calling block's code
+    unsigned char* site;
+    // The code the site jumps to
+    unsigned char* target;
+    // The displacement of the site's jump to the dispatcher
+    unsigned char skip;
+} code_link;
+
+static unsigned char* g_code_arena = nullptr;
+static size_t g_code_used = 0;
+static size_t g_code_persistent_used = 0;
+static size_t g_code_committed = 0;
+static size_t g_code_live = 0;
+
+// The latest allocation, which can grow in place
+static unsigned char* g_code_last = nullptr;
+
+static std::vector<code_link> g_code_links;
+static uint32_t g_code_generation = 0;
+
+static bool commit_code(size_t offset, size_t size)
+{
+#ifdef _WIN32
+    return VirtualAlloc(g_code_arena + offset, size, MEM_COMMIT, PAGE_EXECUTE_READWRITE) != nullptr;
+#else
+    // Anonymous mappings are backed lazily anyway
+    return true;
+#endif
+}
+
+static bool reserve_code_arena()
+{
+    if (g_code_arena)
+    {
+        return true;
+    }
+
+#ifdef _WIN32
+    g_code_arena = (unsigned char*)VirtualAlloc(nullptr, CODE_ARENA_SIZE, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void* mem = mmap(nullptr, CODE_ARENA_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    g_code_arena = mem == MAP_FAILED ? nullptr : (unsigned char*)mem;
+#endif
+
+    if (!g_code_arena || !commit_code(CODE_ARENA_SIZE - CODE_PERSISTENT_SIZE, CODE_PERSISTENT_SIZE))
+    {
+        g_core->logger->error("[Core] Failed to reserve the code arena");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Moves the bump pointer to the specified offset, committing the arena up to it.
+ */
+static bool bump_code(size_t end)
+{
+    if (end > CODE_ARENA_SIZE - CODE_PERSISTENT_SIZE)
+    {
+        g_core->logger->error("[Core] Code arena exhausted");
+        return false;
+    }
+
+    if (end > g_code_committed)
+    {
+        const size_t committed = std::min((end + CODE_COMMIT_GRANULARITY - 1) & ~(CODE_COMMIT_GRANULARITY - 1), CODE_ARENA_SIZE - CODE_PERSISTENT_SIZE);
+        if (!commit_code(g_code_committed, committed - g_code_committed))
+        {
+            g_core->logger->error("[Core] Failed to commit the code arena");
+            return false;
+        }
+        g_code_committed = committed;
+    }
+
+    g_code_used = end;
+    return true;
+}
+
+static void unlink_code_link(const code_link& link)
+{
+    link.site[0] = 0xEB;
+    link.site[1] = link.skip;
+}
+
+unsigned char* alloc_code(size_t size)
+{
+    if (!reserve_code_arena())
+    {
+        return nullptr;
+    }
+
+    const size_t offset = (g_code_used + 15) & ~15;
+    if (!bump_code(offset + CODE_HEADER_SIZE + size))
+    {
+        return nullptr;
+    }
+
+    unsigned char* code = g_code_arena + offset + CODE_HEADER_SIZE;
+    *(size_t*)(code - CODE_HEADER_SIZE) = size;
+    g_code_last = code;
+    g_code_live++;
+    return code;
+}
+
+unsigned char* realloc_code(unsigned char* code, size_t size)
+{
+    if (!code)
+    {
+        return alloc_code(size);
+    }
+
+    const size_t old_size = *(size_t*)(code - CODE_HEADER_SIZE);
+
+    if (code == g_code_last)
+    {
+        if (!bump_code(code - g_code_arena + size))
+        {
+            return nullptr;
+        }
+        *(size_t*)(code - CODE_HEADER_SIZE) = size;
+        return code;
+    }
+
+    unsigned char* new_code = alloc_code(size);
+    if (!new_code)
+    {
+        return nullptr;
+    }
+    memcpy(new_code, code, std::min(size, old_size));
+
+    // Links into the old code are undone, while links from it move along with the code, as they're absolute
+    std::erase_if(g_code_links, [&](code_link& link) {
+        if (link.target >= code && link.target < code + old_size)
+        {
+            unlink_code_link(link);
+            return true;
+        }
+        if (link.site >= code && link.site < code + old_size)
+        {
+            link.site = new_code + (link.site - code);
+        }
+        return false;
+    });
+    g_code_generation++;
+
+    free_code(code);
+    return new_code;
+}
+
+void free_code(unsigned char* code)
+{
+    if (!code)
+    {
+        return;
+    }
+
+    if (--g_code_live == 0)
+    {
+        g_code_used = 0;
+        g_code_last = nullptr;
+        g_code_links.clear();
+        g_code_generation++;
+    }
+}
+
+unsigned char* alloc_persistent_code(size_t size)
+{
+    if (!reserve_code_arena())
+    {
+        return nullptr;
+    }
+
+    size = (size + 15) & ~15;
+    if (g_code_persistent_used + size > CODE_PERSISTENT_SIZE)
+    {
+        return nullptr;
+    }
+
+    unsigned char* code = g_code_arena + CODE_ARENA_SIZE - CODE_PERSISTENT_SIZE + g_code_persistent_used;
+    g_code_persistent_used += size;
+    return code;
+}
+
+bool is_code_arena_low()
+{
+    return g_code_used + CODE_ARENA_RESERVE > CODE_ARENA_SIZE - CODE_PERSISTENT_SIZE;
+}
+
+void link_code(unsigned char* site, unsigned char* target, precomp_block* block, precomp_instr* instr)
+{
+    if (site[0] != 0xEB)
+    {
+        return;
+    }
+
+    *(uint64_t*)(site + LINK_BLOCK_OFFSET) = (uint64_t)block;
+    *(uint64_t*)(site + LINK_INSTR_OFFSET) = (uint64_t)instr;
+    *(uint64_t*)(site + LINK_TARGET_OFFSET) = (uint64_t)target;
+
+    g_code_links.push_back({site, target, site[1]});
+
+    // Replace the jump to the dispatcher with a 2-byte nop, falling through into the linked path
+    site[0] = 0x66;
+    site[1] = 0x90;
+}
+
+void unlink_code(unsigned char* code, size_t size)
+{
+    std::erase_if(g_code_links, [&](const code_link& link) {
+        if (link.target >= code && link.target < code + size)
+        {
+            unlink_code_link(link);
+            return true;
+        }
+        // Sites in the discarded code are about to be overwritten
+        return link.site >= code && link.site < code + size;
+    });
+    g_code_generation++;
+}
+
+uint32_t get_code_generation()
+{
+    return g_code_generation;
+}
+
+uintptr_t get_base_address()
+{
+    return (uintptr_t)reg;
+}
+
+void init_assembler(void* block_jumps_table, int32_t block_jumps_number)
+{
+    if (block_jumps_table)
+    {
+        jumps_table = (jump_table*)block_jumps_table;
+        jumps_number = block_jumps_number;
+        max_jumps_number = jumps_number;
+    }
+    else
+    {
+        jumps_table = (jump_table*)malloc(1000 * sizeof(jump_table));
+        jumps_number = 0;
+        max_jumps_number = 1000;
+    }
+}
+
+void free_assembler(void** block_jumps_table, int32_t* block_jumps_number)
+{
+    *block_jumps_table = jumps_table;
+    *block_jumps_number = jumps_number;
+}
+
+static void add_jump(uint32_t pc_addr, uint32_t mi_addr)
+{
+    if (jumps_number == max_jumps_number)
+    {
+        max_jumps_number += 1000;
+        jumps_table = (jump_table*)realloc(jumps_table, max_jumps_number * sizeof(jump_table));
+    }
+    jumps_table[jumps_number].pc_addr = pc_addr;
+    jumps_table[jumps_number].mi_addr = mi_addr;
+    jumps_number++;
+}
+
+void passe2(precomp_instr* dest, int32_t start, int32_t end, precomp_block* block)
+{
+    uint32_t i, real_code_length, addr_dest;
+    // The wrappers are appended to the code, so jumps to them stay relative to the block
+    build_wrappers(dest, start, end, block);
+    real_code_length = code_length;
+
+    for (i = 0; i < jumps_number; i++)
+    {
+        code_length = jumps_table[i].pc_addr;
+        if (dest[(jumps_table[i].mi_addr - dest[0].addr) / 4].reg_cache_infos.need_map)
+            addr_dest = dest[(jumps_table[i].mi_addr - dest[0].addr) / 4].reg_cache_infos.jump_wrapper;
+        else
+            addr_dest = dest[(jumps_table[i].mi_addr - dest[0].addr) / 4].local_addr;
+        put32(addr_dest - code_length - 4);
+    }
+    code_length = real_code_length;
+}
+
+static void grow_code(int32_t needed)
+{
+    if ((code_length + needed) >= max_code_length)
+    {
+        max_code_length += 1000;
+        *inst_pointer = realloc_code(*inst_pointer, max_code_length);
+    }
+}
+
+void put8(unsigned char octet)
+{
+    grow_code(1);
+    (*inst_pointer)[code_length] = octet;
+    code_length++;
+}
+
+void put16(uint16_t word)
+{
+    grow_code(2);
+    *((uint16_t*)(&(*inst_pointer)[code_length])) = word;
+    code_length += 2;
+}
+
+void put32(uint32_t dword)
+{
+    grow_code(4);
+    *((uint32_t*)(&(*inst_pointer)[code_length])) = dword;
+    code_length += 4;
+}
+
+void put64(uint64_t qword)
+{
+    grow_code(8);
+    *((uint64_t*)(&(*inst_pointer)[code_length])) = qword;
+    code_length += 8;
+}
+
+/**
+ * Emits a REX prefix if one is needed.
+ * \param w Whether the operation is 64-bit wide.
+ * \param force Whether to emit the prefix even if it's empty, which is needed to access SPL, BPL, SIL and DIL.
+ */
+static void rex(bool w, int32_t reg, int32_t index, int32_t base, bool force = false)
+{
+    unsigned char prefix = 0x40 | (w << 3) | ((reg & 8) >> 1) | ((index & 8) >> 2) | ((base & 8) >> 3);
+    if (prefix != 0x40 || force)
+        put8(prefix);
+}
+
+static void opcode(std::initializer_list<unsigned char> bytes)
+{
+    for (auto byte : bytes)
+        put8(byte);
+}
+
+/**
+ * Emits a register to register instruction.
+ */
+static void op_rr(int32_t prefix, bool w, std::initializer_list<unsigned char> op, int32_t reg, int32_t rm, bool force_rex = false)
+{
+    if (prefix)
+        put8(prefix);
+    rex(w, reg, 0, rm, force_rex);
+    opcode(op);
+    put8(0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+/**
+ * Resolves an absolute address to a base register and displacement.
+ * Globals are reached relative to RBASE, anything further away goes through RSCRATCH.
+ */
+static int32_t resolve_address(void* m, int32_t* disp)
+{
+    const intptr_t diff = (intptr_t)m - (intptr_t)get_base_address();
+    if (diff == (int32_t)diff)
+    {
+        *disp = (int32_t)diff;
+        return RBASE;
+    }
+    mov_reg64_imm64(RSCRATCH, (uint64_t)m);
+    *disp = 0;
+    return RSCRATCH;
+}
+
+/**
+ * Emits an instruction with an absolute memory operand.
+ */
+static void op_rm(int32_t prefix, bool w, std::initializer_list<unsigned char> op, int32_t reg, void* m, bool force_rex = false)
+{
+    int32_t disp;
+    const int32_t base = resolve_address(m, &disp);
+
+    if (prefix)
+        put8(prefix);
+    rex(w, reg, 0, base, force_rex);
+    opcode(op);
+    put8(0x80 | ((reg & 7) << 3) | (base & 7));
+    if ((base & 7) == RSP)
+        put8(0x24);
+    put32(disp);
+}
+
+/**
+ * Emits an instruction with a memory operand indexed by a register.
+ */
+static void op_rmi(int32_t prefix, bool w, std::initializer_list<unsigned char> op, int32_t reg, int32_t index, int32_t scale, void* m, bool force_rex = false)
+{
+    int32_t disp;
+    const int32_t base = resolve_address(m, &disp);
+    const int32_t ss = scale == 8 ? 3 : scale == 4 ? 2 : scale == 2 ? 1 : 0;
+
+    assert(index != RSP);
+
+    if (prefix)
+        put8(prefix);
+    rex(w, reg, index, base, force_rex);
+    opcode(op);
+    put8(0x80 | ((reg & 7) << 3) | 4);
+    put8((ss << 6) | ((index & 7) << 3) | (base & 7));
+    put32(disp);
+}
+
+/**
+ * Emits an instruction with a memory operand pointed to by a register.
+ */
+static void op_rb(int32_t prefix, bool w, std::initializer_list<unsigned char> op, int32_t reg, int32_t base)
+{
+    if (prefix)
+        put8(prefix);
+    rex(w, reg, 0, base);
+    opcode(op);
+    if ((base & 7) == RBP)
+    {
+        put8(0x40 | ((reg & 7) << 3) | (base & 7));
+        if ((base & 7) == RSP)
+            put8(0x24);
+        put8(0);
+        return;
+    }
+    put8(((reg & 7) << 3) | (base & 7));
+    if ((base & 7) == RSP)
+        put8(0x24);
+}
+
+void mov_reg64_imm64(int32_t reg64, uint64_t imm64)
+{
+    rex(true, 0, 0, reg64);
+    put8(0xB8 + (reg64 & 7));
+    put64(imm64);
+}
+
+void mov_reg32_imm32(int32_t reg32, uint32_t imm32)
+{
+    rex(false, 0, 0, reg32);
+    put8(0xB8 + (reg32 & 7));
+    put32(imm32);
+}
+
+void mov_reg64_reg64(int32_t reg1, int32_t reg2)
+{
+    op_rr(0, true, {0x89}, reg2, reg1);
+}
+
+void mov_reg32_reg32(int32_t reg1, int32_t reg2)
+{
+    op_rr(0, false, {0x89}, reg2, reg1);
+}
+
+void movsxd_reg64_reg32(int32_t reg64, int32_t reg32)
+{
+    op_rr(0, true, {0x63}, reg64, reg32);
+}
+
+void mov_reg64_m64(int32_t reg64, void* m64)
+{
+    op_rm(0, true, {0x8B}, reg64, m64);
+}
+
+void mov_m64_reg64(void* m64, int32_t reg64)
+{
+    op_rm(0, true, {0x89}, reg64, m64);
+}
+
+void mov_reg32_m32(int32_t reg32, void* m32)
+{
+    op_rm(0, false, {0x8B}, reg32, m32);
+}
+
+void mov_m32_reg32(void* m32, int32_t reg32)
+{
+    op_rm(0, false, {0x89}, reg32, m32);
+}
+
+void movsxd_reg64_m32(int32_t reg64, void* m32)
+{
+    op_rm(0, true, {0x63}, reg64, m32);
+}
+
+void mov_m32_imm32(void* m32, uint32_t imm32)
+{
+    op_rm(0, false, {0xC7}, 0, m32);
+    put32(imm32);
+}
+
+void mov_m64_imm32(void* m64, int32_t imm32)
+{
+    op_rm(0, true, {0xC7}, 0, m64);
+    put32(imm32);
+}
+
+void mov_m_ptr(void* m64, const void* ptr)
+{
+    if ((intptr_t)ptr == (int32_t)(intptr_t)ptr)
+    {
+        mov_m64_imm32(m64, (int32_t)(intptr_t)ptr);
+        return;
+    }
+    mov_reg64_imm64(RAX, (uint64_t)ptr);
+    mov_m64_reg64(m64, RAX);
+}
+
+void add_m32_reg32(void* m32, int32_t reg32)
+{
+    op_rm(0, false, {0x01}, reg32, m32);
+}
+
+void sub_reg32_m32(int32_t reg32, void* m32)
+{
+    op_rm(0, false, {0x2B}, reg32, m32);
+}
+
+void cmp_reg32_m32(int32_t reg32, void* m32)
+{
+    op_rm(0, false, {0x3B}, reg32, m32);
+}
+
+void cmp_m32_imm32(void* m32, uint32_t imm32)
+{
+    op_rm(0, false, {0x81}, 7, m32);
+    put32(imm32);
+}
+
+void cmp_m8_imm8(void* m8, unsigned char imm8)
+{
+    op_rm(0, false, {0x80}, 7, m8);
+    put8(imm8);
+}
+
+void test_m32_imm32(void* m32, uint32_t imm32)
+{
+    op_rm(0, false, {0xF7}, 0, m32);
+    put32(imm32);
+}
+
+void mov_reg64_preg64x8pm(int32_t reg64, int32_t index, void* table)
+{
+    op_rmi(0, true, {0x8B}, reg64, index, 8, table);
+}
+
+void mov_reg64_preg64pm(int32_t reg64, int32_t index, void* m)
+{
+    op_rmi(0, true, {0x8B}, reg64, index, 1, m);
+}
+
+void mov_reg32_preg64pm(int32_t reg32, int32_t index, void* m)
+{
+    op_rmi(0, false, {0x8B}, reg32, index, 1, m);
+}
+
+void movzx_reg32_preg64pm8(int32_t reg32, int32_t index, void* m)
+{
+    op_rmi(0, false, {0x0F, 0xB6}, reg32, index, 1, m);
+}
+
+void movzx_reg32_preg64pm16(int32_t reg32, int32_t index, void* m)
+{
+    op_rmi(0, false, {0x0F, 0xB7}, reg32, index, 1, m);
+}
+
+void movsx_reg64_preg64pm8(int32_t reg64, int32_t index, void* m)
+{
+    op_rmi(0, true, {0x0F, 0xBE}, reg64, index, 1, m);
+}
+
+void movsx_reg64_preg64pm16(int32_t reg64, int32_t index, void* m)
+{
+    op_rmi(0, true, {0x0F, 0xBF}, reg64, index, 1, m);
+}
+
+void movsxd_reg64_preg64pm(int32_t reg64, int32_t index, void* m)
+{
+    op_rmi(0, true, {0x63}, reg64, index, 1, m);
+}
+
+void mov_preg64pm_reg64(int32_t index, void* m, int32_t reg64)
+{
+    op_rmi(0, true, {0x89}, reg64, index, 1, m);
+}
+
+void mov_preg64pm_reg32(int32_t index, void* m, int32_t reg32)
+{
+    op_rmi(0, false, {0x89}, reg32, index, 1, m);
+}
+
+void mov_preg64pm_reg16(int32_t index, void* m, int32_t reg16)
+{
+    op_rmi(0x66, false, {0x89}, reg16, index, 1, m);
+}
+
+void mov_preg64pm_reg8(int32_t index, void* m, int32_t reg8)
+{
+    op_rmi(0, false, {0x88}, reg8, index, 1, m, reg8 >= RSP);
+}
+
+void cmp_preg64pm_imm8(int32_t index, void* m, unsigned char imm8)
+{
+    op_rmi(0, false, {0x80}, 7, index, 1, m);
+    put8(imm8);
+}
+
+void mov_reg32_preg64(int32_t reg32, int32_t base)
+{
+    op_rb(0, false, {0x8B}, reg32, base);
+}
+
+void mov_reg64_preg64(int32_t reg64, int32_t base)
+{
+    op_rb(0, true, {0x8B}, reg64, base);
+}
+
+void mov_preg64_reg32(int32_t base, int32_t reg32)
+{
+    op_rb(0, false, {0x89}, reg32, base);
+}
+
+void mov_preg64_reg64(int32_t base, int32_t reg64)
+{
+    op_rb(0, true, {0x89}, reg64, base);
+}
+
+void add_reg64_reg64(int32_t reg1, int32_t reg2)
+{
+    op_rr(0, true, {0x01}, reg2, reg1);
+}
+
+void add_reg32_reg32(int32_t reg1, int32_t reg2)
+{
+    op_rr(0, false, {0x01}, reg2, reg1);
+}
+
+void sub_reg64_reg64(int32_t reg1, int32_t reg2)
+{
+    op_rr(0, true, {0x29}, reg2, reg1);
+}
+
+void sub_reg32_reg32(int32_t reg1, int32_t reg2)
+{
+    op_rr(0, false, {0x29}, reg2, reg1);
+}
+
+void and_reg64_reg64(int32_t reg1, int32_t reg2)
+{
+    op_rr(0, true, {0x21}, reg2, reg1);
+}
+
+void or_reg64_reg64(int32_t reg1, int32_t reg2)
+{
+    op_rr(0, true, {0x09}, reg2, reg1);
+}
+
+void xor_reg64_reg64(int32_t reg1, int32_t reg2)
+{
+    op_rr(0, true, {0x31}, reg2, reg1);
+}
+
+void xor_reg32_reg32(int32_t reg1, int32_t reg2)
+{
+    op_rr(0, false, {0x31}, reg2, reg1);
+}
+
+void cmp_reg64_reg64(int32_t reg1, int32_t reg2)
+{
+    op_rr(0, true, {0x39}, reg2, reg1);
+}
+
+void imul_reg64_reg64(int32_t reg1, int32_t reg2)
+{
+    op_rr(0, true, {0x0F, 0xAF}, reg1, reg2);
+}
+
+void not_reg64(int32_t reg64)
+{
+    op_rr(0, true, {0xF7}, 2, reg64);
+}
+
+void add_reg32_imm32(int32_t reg32, int32_t imm32)
+{
+    op_rr(0, false, {0x81}, 0, reg32);
+    put32(imm32);
+}
+
+void add_reg64_imm32(int32_t reg64, int32_t imm32)
+{
+    op_rr(0, true, {0x81}, 0, reg64);
+    put32(imm32);
+}
+
+void sub_reg64_imm32(int32_t reg64, int32_t imm32)
+{
+    op_rr(0, true, {0x81}, 5, reg64);
+    put32(imm32);
+}
+
+void and_reg32_imm32(int32_t reg32, uint32_t imm32)
+{
+    op_rr(0, false, {0x81}, 4, reg32);
+    put32(imm32);
+}
+
+void and_reg64_imm32(int32_t reg64, int32_t imm32)
+{
+    op_rr(0, true, {0x81}, 4, reg64);
+    put32(imm32);
+}
+
+void or_reg64_imm32(int32_t reg64, int32_t imm32)
+{
+    op_rr(0, true, {0x81}, 1, reg64);
+    put32(imm32);
+}
+
+void xor_reg32_imm32(int32_t reg32, uint32_t imm32)
+{
+    op_rr(0, false, {0x81}, 6, reg32);
+    put32(imm32);
+}
+
+void xor_reg64_imm32(int32_t reg64, int32_t imm32)
+{
+    op_rr(0, true, {0x81}, 6, reg64);
+    put32(imm32);
+}
+
+void cmp_reg32_imm32(int32_t reg32, uint32_t imm32)
+{
+    op_rr(0, false, {0x81}, 7, reg32);
+    put32(imm32);
+}
+
+void cmp_reg64_imm32(int32_t reg64, int32_t imm32)
+{
+    op_rr(0, true, {0x81}, 7, reg64);
+    put32(imm32);
+}
+
+void test_reg64_reg64(int32_t reg1, int32_t reg2)
+{
+    op_rr(0, true, {0x85}, reg2, reg1);
+}
+
+void shl_reg32_imm8(int32_t reg32, unsigned char imm8)
+{
+    op_rr(0, false, {0xC1}, 4, reg32);
+    put8(imm8);
+}
+
+void shr_reg32_imm8(int32_t reg32, unsigned char imm8)
+{
+    op_rr(0, false, {0xC1}, 5, reg32);
+    put8(imm8);
+}
+
+void sar_reg32_imm8(int32_t reg32, unsigned char imm8)
+{
+    op_rr(0, false, {0xC1}, 7, reg32);
+    put8(imm8);
+}
+
+void shl_reg64_imm8(int32_t reg64, unsigned char imm8)
+{
+    op_rr(0, true, {0xC1}, 4, reg64);
+    put8(imm8);
+}
+
+void shr_reg64_imm8(int32_t reg64, unsigned char imm8)
+{
+    op_rr(0, true, {0xC1}, 5, reg64);
+    put8(imm8);
+}
+
+void sar_reg64_imm8(int32_t reg64, unsigned char imm8)
+{
+    op_rr(0, true, {0xC1}, 7, reg64);
+    put8(imm8);
+}
+
+void rol_reg64_imm8(int32_t reg64, unsigned char imm8)
+{
+    op_rr(0, true, {0xC1}, 0, reg64);
+    put8(imm8);
+}
+
+void shl_reg32_cl(int32_t reg32)
+{
+    op_rr(0, false, {0xD3}, 4, reg32);
+}
+
+void shr_reg32_cl(int32_t reg32)
+{
+    op_rr(0, false, {0xD3}, 5, reg32);
+}
+
+void sar_reg32_cl(int32_t reg32)
+{
+    op_rr(0, false, {0xD3}, 7, reg32);
+}
+
+void shl_reg64_cl(int32_t reg64)
+{
+    op_rr(0, true, {0xD3}, 4, reg64);
+}
+
+void shr_reg64_cl(int32_t reg64)
+{
+    op_rr(0, true, {0xD3}, 5, reg64);
+}
+
+void sar_reg64_cl(int32_t reg64)
+{
+    op_rr(0, true, {0xD3}, 7, reg64);
+}
+
+void setcc_reg8(int32_t cc, int32_t reg8)
+{
+    op_rr(0, false, {0x0F, (unsigned char)(0x90 + cc)}, 0, reg8, reg8 >= RSP);
+}
+
+void movzx_reg32_reg8(int32_t reg32, int32_t reg8)
+{
+    op_rr(0, false, {0x0F, 0xB6}, reg32, reg8, reg8 >= RSP);
+}
+
+void call_reg64(int32_t reg64)
+{
+    op_rr(0, false, {0xFF}, 2, reg64);
+}
+
+void jmp_reg64(int32_t reg64)
+{
+    op_rr(0, false, {0xFF}, 4, reg64);
+}
+
+void ret()
+{
+    put8(0xC3);
+}
+
+void ud2()
+{
+    put8(0x0F);
+    put8(0x0B);
+}
+
+void jcc_rj(int32_t cc, unsigned char saut)
+{
+    put8(0x70 + cc);
+    put8(saut);
+}
+
+void jcc_near_rj(int32_t cc, uint32_t saut)
+{
+    put8(0x0F);
+    put8(0x80 + cc);
+    put32(saut);
+}
+
+void jmp_imm_short(unsigned char saut)
+{
+    put8(0xEB);
+    put8(saut);
+}
+
+void jmp_near_rj(uint32_t saut)
+{
+    put8(0xE9);
+    put32(saut);
+}
+
+void patch_rj(uint32_t after_jump)
+{
+    int32_t diff = code_length - after_jump;
+    assert(-128 <= diff && diff < 128);
+    (*inst_pointer)[after_jump - 1] = (unsigned char)(diff & 0xFF);
+}
+
+void patch_near_rj(uint32_t after_jump)
+{
+    *((uint32_t*)(&(*inst_pointer)[after_jump - 4])) = code_length - after_jump;
+}
+
+void jmp(uint32_t mi_addr)
+{
+    put8(0xE9);
+    put32(0);
+    add_jump(code_length - 4, mi_addr);
+}
+
+void movss_xreg_preg64(int32_t xreg, int32_t base)
+{
+    op_rb(0xF3, false, {0x0F, 0x10}, xreg, base);
+}
+
+void movss_preg64_xreg(int32_t base, int32_t xreg)
+{
+    op_rb(0xF3, false, {0x0F, 0x11}, xreg, base);
+}
+
+void movsd_xreg_preg64(int32_t xreg, int32_t base)
+{
+    op_rb(0xF2, false, {0x0F, 0x10}, xreg, base);
+}
+
+void movsd_preg64_xreg(int32_t base, int32_t xreg)
+{
+    op_rb(0xF2, false, {0x0F, 0x11}, xreg, base);
+}
+
+void addss_xreg_preg64(int32_t xreg, int32_t base)
+{
+    op_rb(0xF3, false, {0x0F, 0x58}, xreg, base);
+}
+
+void subss_xreg_preg64(int32_t xreg, int32_t base)
+{
+    op_rb(0xF3, false, {0x0F, 0x5C}, xreg, base);
+}
+
+void mulss_xreg_preg64(int32_t xreg, int32_t base)
+{
+    op_rb(0xF3, false, {0x0F, 0x59}, xreg, base);
+}
+
+void divss_xreg_preg64(int32_t xreg, int32_t base)
+{
+    op_rb(0xF3, false, {0x0F, 0x5E}, xreg, base);
+}
+
+void sqrtss_xreg_preg64(int32_t xreg, int32_t base)
+{
+    op_rb(0xF3, false, {0x0F, 0x51}, xreg, base);
+}
+
+void addsd_xreg_preg64(int32_t xreg, int32_t base)
+{
+    op_rb(0xF2, false, {0x0F, 0x58}, xreg, base);
+}
+
+void subsd_xreg_preg64(int32_t xreg, int32_t base)
+{
+    op_rb(0xF2, false, {0x0F, 0x5C}, xreg, base);
+}
+
+void mulsd_xreg_preg64(int32_t xreg, int32_t base)
+{
+    op_rb(0xF2, false, {0x0F, 0x59}, xreg, base);
+}
+
+void divsd_xreg_preg64(int32_t xreg, int32_t base)
+{
+    op_rb(0xF2, false, {0x0F, 0x5E}, xreg, base);
+}
+
+void sqrtsd_xreg_preg64(int32_t xreg, int32_t base)
+{
+    op_rb(0xF2, false, {0x0F, 0x51}, xreg, base);
+}
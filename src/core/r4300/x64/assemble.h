@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#define RAX 0
+#define RCX 1
+#define RDX 2
+#define RBX 3
+#define RSP 4
+#define RBP 5
+#define RSI 6
+#define RDI 7
+#define R8 8
+#define R9 9
+#define R10 10
+#define R11 11
+#define R12 12
+#define R13 13
+#define R14 14
+#define R15 15
+
+#define XMM0 0
+#define XMM1 1
+
+/**
+ * The register holding the base address for all accesses to emulator globals.
+ * It's set up by the entry stub and never allocated.
+ */
+#define RBASE R15
+
+/**
+ * A scratch register which is never allocated, used to reach globals too far away from RBASE.
+ */
+#define RSCRATCH R11
+
+#define CC_B 0x2
+#define CC_AE 0x3
+#define CC_E 0x4
+#define CC_NE 0x5
+#define CC_BE 0x6
+#define CC_A 0x7
+#define CC_L 0xC
+#define CC_GE 0xD
+#define CC_LE 0xE
+#define CC_G 0xF
+
+typedef struct _reg_cache_struct
+{
+    int32_t need_map;
+    void* needed_registers[16];
+    // Offset of the wrapper loading needed_registers in the block's code
+    uint32_t jump_wrapper;
+    int32_t need_cop1_check;
+} reg_cache_struct;
+
+/*
+ * Exits to other blocks start with a link site, which is patched to jump to the target block directly once it's compiled:
+ *  jmp short <dispatch>      ; replaced with a 2-byte nop while linked
+ *  mov rax, <block>
+ *  mov rcx, <instr>
+ *  mov rdx, <target code>
+ *  <jump to dispatch if the target page or its mirror was invalidated>
+ *  mov [actual], rax
+ *  mov [PC], rcx
+ *  jmp rdx
+ * dispatch:
+ *  <call dyna_jump_link>
+ */
+#define LINK_BLOCK_OFFSET 4
+#define LINK_INSTR_OFFSET 14
+#define LINK_TARGET_OFFSET 24
+
+typedef struct _precomp_instr precomp_instr;
+typedef struct _precomp_block precomp_block;
+
+extern int32_t branch_taken;
+
+/**
+ * The distance from a link site to the return address of its call to dyna_jump_link.
+ */
+extern uint32_t link_distance;
+
+/**
+ * \brief Leaves the block for the address in jump_to_address. Called by recompiled code which is never returned to.
+ */
+void dyna_jump_out();
+
+/**
+ * \brief Leaves the block for the address in jump_to_address like dyna_jump_out, then links the calling site to the target block.
+ */
+void dyna_jump_link();
+
+/**
+ * \brief Allocates a buffer for code which is never freed, such as the entry and exit stubs
+ */
+unsigned char* alloc_persistent_code(size_t size);
+
+/**
+ * \brief Gets whether the code arena is running low, so the code cache should be flushed
+ */
+bool is_code_arena_low();
+
+/**
+ * \brief Links a site to the specified code
+ * \param site The link site, which must be unlinked
+ * \param target The code to jump to
+ * \param block The block containing the code
+ * \param instr The instruction the code belongs to
+ */
+void link_code(unsigned char* site, unsigned char* target, precomp_block* block, precomp_instr* instr);
+
+/**
+ * \brief Undoes all links into the specified code and forgets the link sites in it
+ */
+void unlink_code(unsigned char* code, size_t size);
+
+/**
+ * \brief Gets a counter which is incremented whenever code is discarded, moved or unlinked
+ */
+uint32_t get_code_generation();
+
+void debug();
+
+/**
+ * \brief Gets whether the jump at dst must be left to the interpreter
+ */
+bool genjump_interp_fallback();
+
+/**
+ * \brief Emits a call to a C function, clobbering RAX
+ */
+void gencall(const void* func);
+
+/**
+ * \brief Sets branch_taken according to the condition code, using the flags set by the previous comparison
+ */
+void genset_branch_taken(int32_t cc);
+
+/**
+ * \brief Gets the base address which RBASE points to while recompiled code runs
+ */
+uintptr_t get_base_address();
+
+void put8(unsigned char octet);
+void put16(uint16_t word);
+void put32(uint32_t dword);
+void put64(uint64_t qword);
+
+void mov_reg64_imm64(int32_t reg64, uint64_t imm64);
+void mov_reg32_imm32(int32_t reg32, uint32_t imm32);
+void mov_reg64_reg64(int32_t reg1, int32_t reg2);
+void mov_reg32_reg32(int32_t reg1, int32_t reg2);
+void movsxd_reg64_reg32(int32_t reg64, int32_t reg32);
+
+void mov_reg64_m64(int32_t reg64, void* m64);
+void mov_m64_reg64(void* m64, int32_t reg64);
+void mov_reg32_m32(int32_t reg32, void* m32);
+void mov_m32_reg32(void* m32, int32_t reg32);
+void movsxd_reg64_m32(int32_t reg64, void* m32);
+void mov_m32_imm32(void* m32, uint32_t imm32);
+void mov_m64_imm32(void* m64, int32_t imm32);
+void mov_m_ptr(void* m64, const void* ptr);
+void add_m32_reg32(void* m32, int32_t reg32);
+void sub_reg32_m32(int32_t reg32, void* m32);
+void cmp_reg32_m32(int32_t reg32, void* m32);
+void cmp_m32_imm32(void* m32, uint32_t imm32);
+void cmp_m8_imm8(void* m8, unsigned char imm8);
+void test_m32_imm32(void* m32, uint32_t imm32);
+
+void mov_reg64_preg64x8pm(int32_t reg64, int32_t index, void* table);
+void mov_reg64_preg64pm(int32_t reg64, int32_t index, void* m);
+void mov_reg32_preg64pm(int32_t reg32, int32_t index, void* m);
+void movzx_reg32_preg64pm8(int32_t reg32, int32_t index, void* m);
+void movzx_reg32_preg64pm16(int32_t reg32, int32_t index, void* m);
+void movsx_reg64_preg64pm8(int32_t reg64, int32_t index, void* m);
+void movsx_reg64_preg64pm16(int32_t reg64, int32_t index, void* m);
+void movsxd_reg64_preg64pm(int32_t reg64, int32_t index, void* m);
+void mov_preg64pm_reg64(int32_t index, void* m, int32_t reg64);
+void mov_preg64pm_reg32(int32_t index, void* m, int32_t reg32);
+void mov_preg64pm_reg16(int32_t index, void* m, int32_t reg16);
+void mov_preg64pm_reg8(int32_t index, void* m, int32_t reg8);
+void cmp_preg64pm_imm8(int32_t index, void* m, unsigned char imm8);
+void mov_reg32_preg64(int32_t reg32, int32_t base);
+void mov_reg64_preg64(int32_t reg64, int32_t base);
+void mov_preg64_reg32(int32_t base, int32_t reg32);
+void mov_preg64_reg64(int32_t base, int32_t reg64);
+
+void add_reg64_reg64(int32_t reg1, int32_t reg2);
+void add_reg32_reg32(int32_t reg1, int32_t reg2);
+void sub_reg64_reg64(int32_t reg1, int32_t reg2);
+void sub_reg32_reg32(int32_t reg1, int32_t reg2);
+void and_reg64_reg64(int32_t reg1, int32_t reg2);
+void or_reg64_reg64(int32_t reg1, int32_t reg2);
+void xor_reg64_reg64(int32_t reg1, int32_t reg2);
+void xor_reg32_reg32(int32_t reg1, int32_t reg2);
+void cmp_reg64_reg64(int32_t reg1, int32_t reg2);
+void imul_reg64_reg64(int32_t reg1, int32_t reg2);
+void not_reg64(int32_t reg64);
+
+void add_reg32_imm32(int32_t reg32, int32_t imm32);
+void add_reg64_imm32(int32_t reg64, int32_t imm32);
+void sub_reg64_imm32(int32_t reg64, int32_t imm32);
+void and_reg32_imm32(int32_t reg32, uint32_t imm32);
+void and_reg64_imm32(int32_t reg64, int32_t imm32);
+void or_reg64_imm32(int32_t reg64, int32_t imm32);
+void xor_reg32_imm32(int32_t reg32, uint32_t imm32);
+void xor_reg64_imm32(int32_t reg64, int32_t imm32);
+void cmp_reg32_imm32(int32_t reg32, uint32_t imm32);
+void cmp_reg64_imm32(int32_t reg64, int32_t imm32);
+void test_reg64_reg64(int32_t reg1, int32_t reg2);
+
+void shl_reg32_imm8(int32_t reg32, unsigned char imm8);
+void shr_reg32_imm8(int32_t reg32, unsigned char imm8);
+void sar_reg32_imm8(int32_t reg32, unsigned char imm8);
+void shl_reg64_imm8(int32_t reg64, unsigned char imm8);
+void shr_reg64_imm8(int32_t reg64, unsigned char imm8);
+void sar_reg64_imm8(int32_t reg64, unsigned char imm8);
+void rol_reg64_imm8(int32_t reg64, unsigned char imm8);
+void shl_reg32_cl(int32_t reg32);
+void shr_reg32_cl(int32_t reg32);
+void sar_reg32_cl(int32_t reg32);
+void shl_reg64_cl(int32_t reg64);
+void shr_reg64_cl(int32_t reg64);
+void sar_reg64_cl(int32_t reg64);
+
+void setcc_reg8(int32_t cc, int32_t reg8);
+void movzx_reg32_reg8(int32_t reg32, int32_t reg8);
+
+void call_reg64(int32_t reg64);
+void jmp_reg64(int32_t reg64);
+void ret();
+void ud2();
+
+void jcc_rj(int32_t cc, unsigned char saut);
+void jcc_near_rj(int32_t cc, uint32_t saut);
+void jmp_imm_short(unsigned char saut);
+void jmp_near_rj(uint32_t saut);
+void patch_rj(uint32_t after_jump);
+void patch_near_rj(uint32_t after_jump);
+void jmp(uint32_t mi_addr);
+
+void movss_xreg_preg64(int32_t xreg, int32_t base);
+void movss_preg64_xreg(int32_t base, int32_t xreg);
+void movsd_xreg_preg64(int32_t xreg, int32_t base);
+void movsd_preg64_xreg(int32_t base, int32_t xreg);
+void addss_xreg_preg64(int32_t xreg, int32_t base);
+void subss_xreg_preg64(int32_t xreg, int32_t base);
+void mulss_xreg_preg64(int32_t xreg, int32_t base);
+void divss_xreg_preg64(int32_t xreg, int32_t base);
+void sqrtss_xreg_preg64(int32_t xreg, int32_t base);
+void addsd_xreg_preg64(int32_t xreg, int32_t base);
+void subsd_xreg_preg64(int32_t xreg, int32_t base);
+void mulsd_xreg_preg64(int32_t xreg, int32_t base);
+void divsd_xreg_preg64(int32_t xreg, int32_t base);
+void sqrtsd_xreg_preg64(int32_t xreg, int32_t base);
@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <core/r4300/x64/assemble.h>
+
+void debug()
+{
+#ifdef COMPARE_CORE
+    compare_core();
+#endif
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <core/r4300/ops.h>
+#include <core/r4300/recomph.h>
+
+void genmfc0()
+{
+    gencallinterp((uintptr_t)MFC0, 0);
+}
+
+void genmtc0()
+{
+    gencallinterp((uintptr_t)MTC0, 0);
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <core/r4300/ops.h>
+#include <core/r4300/r4300.h>
+#include <core/r4300/recomph.h>
+
+void genmfc1()
+{
+    gencallinterp((uintptr_t)MFC1, 0);
+}
+
+void gendmfc1()
+{
+    gencallinterp((uintptr_t)DMFC1, 0);
+}
+
+void gencfc1()
+{
+    gencallinterp((uintptr_t)CFC1, 0);
+}
+
+void genmtc1()
+{
+    gencallinterp((uintptr_t)MTC1, 0);
+}
+
+void gendmtc1()
+{
+    gencallinterp((uintptr_t)DMTC1, 0);
+}
+
+void genctc1()
+{
+    gencallinterp((uintptr_t)CTC1, 0);
+}
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <core/Core.h>
+#include <core/r4300/ops.h>
+#include <core/r4300/r4300.h>
+#include <core/r4300/recomph.h>
+#include <core/r4300/x64/assemble.h>
+
+// The operands are loaded through the reg_cop1_double pointers, which depend on the FR bit
+static void genload_d(int32_t xreg, int32_t fpr)
+{
+    mov_reg64_m64(RAX, &reg_cop1_double[fpr]);
+    movsd_xreg_preg64(xreg, RAX);
+}
+
+static void genstore_d(int32_t fpr, int32_t xreg)
+{
+    mov_reg64_m64(RAX, &reg_cop1_double[fpr]);
+    movsd_preg64_xreg(RAX, xreg);
+}
+
+// Float exception propagation needs the interpreter's input and output checks
+static void genarith_d(void (*op)(int32_t, int32_t), void (*interp)(), bool binary)
+{
+    if (g_core->cfg->is_float_exception_propagation_enabled)
+    {
+        gencallinterp((uintptr_t)interp, 0);
+        return;
+    }
+
+    gencheck_cop1_unusable();
+    if (binary)
+    {
+        genload_d(XMM0, dst->f.cf.fs);
+        mov_reg64_m64(RAX, &reg_cop1_double[dst->f.cf.ft]);
+        op(XMM0, RAX);
+    }
+    else
+    {
+        mov_reg64_m64(RAX, &reg_cop1_double[dst->f.cf.fs]);
+        op(XMM0, RAX);
+    }
+    genstore_d(dst->f.cf.fd, XMM0);
+}
+
+// abs, neg and mov only touch the sign bit, so they are done on the raw bits
+static void gensign_d(void (*interp)(), int32_t mode)
+{
+    if (mode != 0 && g_core->cfg->is_float_exception_propagation_enabled)
+    {
+        gencallinterp((uintptr_t)interp, 0);
+        return;
+    }
+
+    gencheck_cop1_unusable();
+    mov_reg64_m64(RAX, &reg_cop1_double[dst->f.cf.fs]);
+    mov_reg64_preg64(RDX, RAX);
+    if (mode == 1)
+    {
+        shl_reg64_imm8(RDX, 1);
+        shr_reg64_imm8(RDX, 1);
+    }
+    else if (mode == 2)
+    {
+        mov_reg64_imm64(RCX, 0x8000000000000000);
+        xor_reg64_reg64(RDX, RCX);
+    }
+    mov_reg64_m64(RAX, &reg_cop1_double[dst->f.cf.fd]);
+    mov_preg64_reg64(RAX, RDX);
+}
+
+void genadd_d()
+{
+#ifdef INTERPRET_ADD_D
+    gencallinterp((uintptr_t)ADD_D, 0);
+#else
+    genarith_d(addsd_xreg_preg64, ADD_D, true);
+#endif
+}
+
+void gensub_d()
+{
+#ifdef INTERPRET_SUB_D
+    gencallinterp((uintptr_t)SUB_D, 0);
+#else
+    genarith_d(subsd_xreg_preg64, SUB_D, true);
+#endif
+}
+
+void genmul_d()
+{
+#ifdef INTERPRET_MUL_D
+    gencallinterp((uintptr_t)MUL_D, 0);
+#else
+    genarith_d(mulsd_xreg_preg64, MUL_D, true);
+#endif
+}
+
+void gendiv_d()
+{
+#ifdef INTERPRET_DIV_D
+    gencallinterp((uintptr_t)DIV_D, 0);
+#else
+    genarith_d(divsd_xreg_preg64, DIV_D, true);
+#endif
+}
+
+void gensqrt_d()
+{
+#ifdef INTERPRET_SQRT_D
+    gencallinterp((uintptr_t)SQRT_D, 0);
+#else
+    genarith_d(sqrtsd_xreg_preg64, SQRT_D, false);
+#endif
+}
+
+void genabs_d()
+{
+#ifdef INTERPRET_ABS_D
+    gencallinterp((uintptr_t)ABS_D, 0);
+#else
+    gensign_d(ABS_D, 1);
+#endif
+}
+
+void genmov_d()
+{
+#ifdef INTERPRET_MOV_D
+    gencallinterp((uintptr_t)MOV_D, 0);
+#else
+    gensign_d(MOV_D, 0);
+#endif
+}
+
+void genneg_d()
+{
+#ifdef INTERPRET_NEG_D
+    gencallinterp((uintptr_t)NEG_D, 0);
+#else
+    gensign_d(NEG_D, 2);
+#endif
+}
+
+void genround_l_d()
+{
+    gencallinterp((uintptr_t)ROUND_L_D, 0);
+}
+
+void gentrunc_l_d()
+{
+    gencallinterp((uintptr_t)TRUNC_L_D, 0);
+}
+
+void genceil_l_d()
+{
+    gencallinterp((uintptr_t)CEIL_L_D, 0);
+}
+
+void genfloor_l_d()
+{
+    gencallinterp((uintptr_t)FLOOR_L_D, 0);
+}
+
+void genround_w_d()
+{
+    gencallinterp((uintptr_t)ROUND_W_D, 0);
+}
+
+void gentrunc_w_d()
+{
+    gencallinterp((uintptr_t)TRUNC_W_D, 0);
+}
+
+void genceil_w_d()
+{
+    gencallinterp((uintptr_t)CEIL_W_D, 0);
+}
+
+void genfloor_w_d()
+{
+    gencallinterp((uintptr_t)FLOOR_W_D, 0);
+}
+
+void gencvt_s_d()
+{
+    gencallinterp((uintptr_t)CVT_S_D, 0);
+}
+
+void gencvt_w_d()
+{
+    gencallinterp((uintptr_t)CVT_W_D, 0);
+}
+
+void gencvt_l_d()
+{
+    gencallinterp((uintptr_t)CVT_L_D, 0);
+}
+
+void genc_f_d()
+{
+    gencallinterp((uintptr_t)C_F_D, 0);
+}
+
+void genc_un_d()
+{
+    gencallinterp((uintptr_t)C_UN_D, 0);
+}
+
+void genc_eq_d()
+{
+    gencallinterp((uintptr_t)C_EQ_D, 0);
+}
+
+void genc_ueq_d()
+{
+    gencallinterp((uintptr_t)C_UEQ_D, 0);
+}
+
+void genc_olt_d()
+{
+    gencallinterp((uintptr_t)C_OLT_D, 0);
+}
+
+void genc_ult_d()
+{
+    gencallinterp((uintptr_t)C_ULT_D, 0);
+}
+
+void genc_ole_d()
+{
+    gencallinterp((uintptr_t)C_OLE_D, 0);
+}
+
+void genc_ule_d()
+{
+    gencallinterp((uintptr_t)C_ULE_D, 0);
+}
+
+void genc_sf_d()
+{
+    gencallinterp((uintptr_t)C_SF_D, 0);
+}
+
+void genc_ngle_d()
+{
+    gencallinterp((uintptr_t)C_NGLE_D, 0);
+}
+
+void genc_seq_d()
+{
+    gencallinterp((uintptr_t)C_SEQ_D, 0);
+}
+
+void genc_ngl_d()
+{
+    gencallinterp((uintptr_t)C_NGL_D, 0);
+}
+
+void genc_lt_d()
+{
+    gencallinterp((uintptr_t)C_LT_D, 0);
+}
+
+void genc_nge_d()
+{
+    gencallinterp((uintptr_t)C_NGE_D, 0);
+}
+
+void genc_le_d()
+{
+    gencallinterp((uintptr_t)C_LE_D, 0);
+}
+
+void genc_ngt_d()
+{
+    gencallinterp((uintptr_t)C_NGT_D, 0);
+}
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <core/Core.h>
+#include <core/r4300/ops.h>
+#include <core/r4300/r4300.h>
+#include <core/r4300/recomph.h>
+#include <core/r4300/x64/assemble.h>
+
+// The operands are loaded through the reg_cop1_simple pointers, which depend on the FR bit
+static void genload_s(int32_t xreg, int32_t fpr)
+{
+    mov_reg64_m64(RAX, &reg_cop1_simple[fpr]);
+    movss_xreg_preg64(xreg, RAX);
+}
+
+static void genstore_s(int32_t fpr, int32_t xreg)
+{
+    mov_reg64_m64(RAX, &reg_cop1_simple[fpr]);
+    movss_preg64_xreg(RAX, xreg);
+}
+
+// Float exception propagation needs the interpreter's input and output checks
+static void genarith_s(void (*op)(int32_t, int32_t), void (*interp)(), bool binary)
+{
+    if (g_core->cfg->is_float_exception_propagation_enabled)
+    {
+        gencallinterp((uintptr_t)interp, 0);
+        return;
+    }
+
+    gencheck_cop1_unusable();
+    if (binary)
+    {
+        genload_s(XMM0, dst->f.cf.fs);
+        mov_reg64_m64(RAX, &reg_cop1_simple[dst->f.cf.ft]);
+        op(XMM0, RAX);
+    }
+    else
+    {
+        mov_reg64_m64(RAX, &reg_cop1_simple[dst->f.cf.fs]);
+        op(XMM0, RAX);
+    }
+    genstore_s(dst->f.cf.fd, XMM0);
+}
+
+// abs, neg and mov only touch the sign bit, so they are done on the raw bits
+static void gensign_s(void (*interp)(), int32_t mode)
+{
+    if (mode != 0 && g_core->cfg->is_float_exception_propagation_enabled)
+    {
+        gencallinterp((uintptr_t)interp, 0);
+        return;
+    }
+
+    gencheck_cop1_unusable();
+    mov_reg64_m64(RAX, &reg_cop1_simple[dst->f.cf.fs]);
+    mov_reg32_preg64(RDX, RAX);
+    if (mode == 1)
+        and_reg32_imm32(RDX, 0x7FFFFFFF);
+    else if (mode == 2)
+        xor_reg32_imm32(RDX, 0x80000000);
+    mov_reg64_m64(RAX, &reg_cop1_simple[dst->f.cf.fd]);
+    mov_preg64_reg32(RAX, RDX);
+}
+
+void genadd_s()
+{
+#ifdef INTERPRET_ADD_S
+    gencallinterp((uintptr_t)ADD_S, 0);
+#else
+    genarith_s(addss_xreg_preg64, ADD_S, true);
+#endif
+}
+
+void gensub_s()
+{
+#ifdef INTERPRET_SUB_S
+    gencallinterp((uintptr_t)SUB_S, 0);
+#else
+    genarith_s(subss_xreg_preg64, SUB_S, true);
+#endif
+}
+
+void genmul_s()
+{
+#ifdef INTERPRET_MUL_S
+    gencallinterp((uintptr_t)MUL_S, 0);
+#else
+    genarith_s(mulss_xreg_preg64, MUL_S, true);
+#endif
+}
+
+void gendiv_s()
+{
+#ifdef INTERPRET_DIV_S
+    gencallinterp((uintptr_t)DIV_S, 0);
+#else
+    genarith_s(divss_xreg_preg64, DIV_S, true);
+#endif
+}
+
+void gensqrt_s()
+{
+#ifdef INTERPRET_SQRT_S
+    gencallinterp((uintptr_t)SQRT_S, 0);
+#else
+    genarith_s(sqrtss_xreg_preg64, SQRT_S, false);
+#endif
+}
+
+void genabs_s()
+{
+#ifdef INTERPRET_ABS_S
+    gencallinterp((uintptr_t)ABS_S, 0);
+#else
+    gensign_s(ABS_S, 1);
+#endif
+}
+
+void genmov_s()
+{
+#ifdef INTERPRET_MOV_S
+    gencallinterp((uintptr_t)MOV_S, 0);
+#else
+    gensign_s(MOV_S, 0);
+#endif
+}
+
+void genneg_s()
+{
+#ifdef INTERPRET_NEG_S
+    gencallinterp((uintptr_t)NEG_S, 0);
+#else
+    gensign_s(NEG_S, 2);
+#endif
+}
+
+void genround_l_s()
+{
+    gencallinterp((uintptr_t)ROUND_L_S, 0);
+}
+
+void gentrunc_l_s()
+{
+    gencallinterp((uintptr_t)TRUNC_L_S, 0);
+}
+
+void genceil_l_s()
+{
+    gencallinterp((uintptr_t)CEIL_L_S, 0);
+}
+
+void genfloor_l_s()
+{
+    gencallinterp((uintptr_t)FLOOR_L_S, 0);
+}
+
+void genround_w_s()
+{
+    gencallinterp((uintptr_t)ROUND_W_S, 0);
+}
+
+void gentrunc_w_s()
+{
+    gencallinterp((uintptr_t)TRUNC_W_S, 0);
+}
+
+void genceil_w_s()
+{
+    gencallinterp((uintptr_t)CEIL_W_S, 0);
+}
+
+void genfloor_w_s()
+{
+    gencallinterp((uintptr_t)FLOOR_W_S, 0);
+}
+
+void gencvt_d_s()
+{
+    gencallinterp((uintptr_t)CVT_D_S, 0);
+}
+
+void gencvt_w_s()
+{
+    gencallinterp((uintptr_t)CVT_W_S, 0);
+}
+
+void gencvt_l_s()
+{
+    gencallinterp((uintptr_t)CVT_L_S, 0);
+}
+
+void genc_f_s()
+{
+    gencallinterp((uintptr_t)C_F_S, 0);
+}
+
+void genc_un_s()
+{
+    gencallinterp((uintptr_t)C_UN_S, 0);
+}
+
+void genc_eq_s()
+{
+    gencallinterp((uintptr_t)C_EQ_S, 0);
+}
+
+void genc_ueq_s()
+{
+    gencallinterp((uintptr_t)C_UEQ_S, 0);
+}
+
+void genc_olt_s()
+{
+    gencallinterp((uintptr_t)C_OLT_S, 0);
+}
+
+void genc_ult_s()
+{
+    gencallinterp((uintptr_t)C_ULT_S, 0);
+}
+
+void genc_ole_s()
+{
+    gencallinterp((uintptr_t)C_OLE_S, 0);
+}
+
+void genc_ule_s()
+{
+    gencallinterp((uintptr_t)C_ULE_S, 0);
+}
+
+void genc_sf_s()
+{
+    gencallinterp((uintptr_t)C_SF_S, 0);
+}
+
+void genc_ngle_s()
+{
+    gencallinterp((uintptr_t)C_NGLE_S, 0);
+}
+
+void genc_seq_s()
+{
+    gencallinterp((uintptr_t)C_SEQ_S, 0);
+}
+
+void genc_ngl_s()
+{
+    gencallinterp((uintptr_t)C_NGL_S, 0);
+}
+
+void genc_lt_s()
+{
+    gencallinterp((uintptr_t)C_LT_S, 0);
+}
+
+void genc_nge_s()
+{
+    gencallinterp((uintptr_t)C_NGE_S, 0);
+}
+
+void genc_le_s()
+{
+    gencallinterp((uintptr_t)C_LE_S, 0);
+}
+
+void genc_ngt_s()
+{
+    gencallinterp((uintptr_t)C_NGT_S, 0);
+}
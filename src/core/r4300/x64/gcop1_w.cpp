@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <core/r4300/ops.h>
+#include <core/r4300/r4300.h>
+#include <core/r4300/recomph.h>
+
+void gencvt_s_w()
+{
+    gencallinterp((uintptr_t)CVT_S_W, 0);
+}
+
+void gencvt_d_w()
+{
+    gencallinterp((uintptr_t)CVT_D_W, 0);
+}
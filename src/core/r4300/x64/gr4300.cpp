@@ -0,0 +1,1359 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <core/Core.h>
+#include <core/memory/memory.h>
+#include <core/r4300/interrupt.h>
+#include <core/r4300/macros.h>
+#include <core/r4300/ops.h>
+#include <core/r4300/r4300.h>
+#include <core/r4300/recomph.h>
+#include <core/r4300/x64/assemble.h>
+#include <core/r4300/x64/regcache.h>
+
+extern uint32_t src; //recomp.c
+
+precomp_instr fake_instr;
+static uint64_t saved_registers[16];
+
+int32_t branch_taken;
+
+enum class mem_width
+{
+    byte,
+    ubyte,
+    half,
+    uhalf,
+    word,
+    uword,
+    dword,
+};
+
+bool genjump_interp_fallback()
+{
+    return ((dst->addr & 0xFFF) == 0xFFC &&
+            (dst->addr < 0x80000000 || dst->addr >= 0xC0000000)) ||
+        !g_core->cfg->is_compiled_jump_enabled;
+}
+
+void gencall(const void* func)
+{
+    mov_reg64_imm64(RAX, (uint64_t)func);
+    call_reg64(RAX);
+}
+
+void genset_branch_taken(int32_t cc)
+{
+    uint32_t taken, end;
+
+    jcc_rj(cc, 0);
+    taken = code_length;
+    mov_m32_imm32(&branch_taken, 0);
+    jmp_imm_short(0);
+    end = code_length;
+    patch_rj(taken);
+    mov_m32_imm32(&branch_taken, 1);
+    patch_rj(end);
+}
+
+void gennotcompiled()
+{
+    free_all_registers();
+    simplify_access();
+
+    // return_address is set up by the entry stub, so unlike on x86 the first block needs no special treatment
+    mov_m_ptr(&PC, dst);
+    gencall((void*)NOTCOMPILED);
+}
+
+void genlink_subblock()
+{
+    free_all_registers();
+    jmp(dst->addr + 4);
+}
+
+void gendebug()
+{
+    int32_t i;
+    for (i = 0; i < 16; i++)
+    {
+        if (i != RSP)
+            mov_m64_reg64(&saved_registers[i], i);
+    }
+
+    mov_m_ptr(&PC, dst);
+    mov_m32_imm32(&vr_op, src);
+    gencall((void*)debug);
+
+    for (i = 0; i < 16; i++)
+    {
+        if (i != RSP)
+            mov_reg64_m64(i, &saved_registers[i]);
+    }
+}
+
+void gencallinterp(uintptr_t addr, int32_t jump)
+{
+    free_all_registers();
+    simplify_access();
+    if (jump)
+        mov_m32_imm32(&dyna_interp, 1);
+    mov_m_ptr(&PC, dst);
+    gencall((void*)addr);
+    if (jump)
+    {
+        mov_m32_imm32(&dyna_interp, 0);
+        gencall((void*)dyna_jump);
+    }
+}
+
+void genupdate_count(uint32_t addr)
+{
+#if !defined(COMPARE_CORE) && !defined(DBG)
+    mov_reg32_imm32(RAX, addr);
+    sub_reg32_m32(RAX, &last_addr);
+    shr_reg32_imm8(RAX, 1);
+    add_m32_reg32(&core_Count, RAX);
+#else
+    mov_m_ptr(&PC, dst + 1);
+    gencall((void*)update_count);
+#endif
+}
+
+void gendelayslot()
+{
+    mov_m32_imm32(&delay_slot, 1);
+    recompile_opcode();
+
+    free_all_registers();
+    genupdate_count(dst->addr + 4);
+
+    mov_m32_imm32(&delay_slot, 0);
+}
+
+void genni()
+{
+#ifdef EMU64_DEBUG
+    gencallinterp((uintptr_t)NI, 0);
+#endif
+}
+
+void genreserved()
+{
+#ifdef EMU64_DEBUG
+    gencallinterp((uintptr_t)RESERVED, 0);
+#endif
+}
+
+void genfin_block()
+{
+    gencallinterp((uintptr_t)FIN_BLOCK, 0);
+}
+
+void gencheck_interrupt(precomp_instr* instr_structure)
+{
+    uint32_t skip;
+
+    mov_reg32_m32(RAX, &next_interrupt);
+    cmp_reg32_m32(RAX, &core_Count);
+    jcc_rj(CC_A, 0);
+    skip = code_length;
+    mov_m_ptr(&PC, instr_structure);
+    gencall((void*)gen_interrupt);
+    patch_rj(skip);
+}
+
+void gencheck_interrupt_out(uint32_t addr)
+{
+    uint32_t skip;
+
+    mov_reg32_m32(RAX, &next_interrupt);
+    cmp_reg32_m32(RAX, &core_Count);
+    jcc_rj(CC_A, 0);
+    skip = code_length;
+    mov_m32_imm32(&fake_instr.addr, addr);
+    mov_m_ptr(&PC, &fake_instr);
+    gencall((void*)gen_interrupt);
+    patch_rj(skip);
+}
+
+void gencheck_interrupt_reg() // addr is in EAX
+{
+    uint32_t skip;
+
+    mov_reg32_m32(RCX, &next_interrupt);
+    cmp_reg32_m32(RCX, &core_Count);
+    jcc_rj(CC_A, 0);
+    skip = code_length;
+    mov_m32_reg32(&fake_instr.addr, RAX);
+    mov_m_ptr(&PC, &fake_instr);
+    gencall((void*)gen_interrupt);
+    patch_rj(skip);
+}
+
+void gennop()
+{
+}
+
+// Skips the interrupt wait of an idle loop by adding the remaining cycles to Count directly
+static void genskip_idle(int32_t reg)
+{
+    uint32_t skip;
+
+    mov_reg32_m32(reg, &next_interrupt);
+    sub_reg32_m32(reg, &core_Count);
+    cmp_reg32_imm32(reg, 3);
+    jcc_rj(CC_BE, 0);
+    skip = code_length;
+
+    and_reg32_imm32(reg, 0xFFFFFFFC);
+    add_m32_reg32(&core_Count, reg);
+    patch_rj(skip);
+}
+
+static void genjump_out(uint32_t naddr)
+{
+    // Only jumps to RDRAM can be linked, see dyna_jump_link
+    if (naddr < 0x80000000 || naddr >= 0xC0000000 || (naddr & 0x1FFFFFFF) >= 0x800000)
+    {
+        mov_m32_imm32(&jump_to_address, naddr);
+        mov_m_ptr(&PC, dst + 1);
+        gencall((void*)dyna_jump_out);
+        return;
+    }
+
+    uint32_t site, invalid, mirror_invalid, distance;
+
+    site = code_length;
+    jmp_imm_short(0);
+    mov_reg64_imm64(RAX, 0);
+    mov_reg64_imm64(RCX, 0);
+    mov_reg64_imm64(RDX, 0);
+    cmp_m8_imm8(&invalid_code[naddr >> 12], 0);
+    jcc_rj(CC_NE, 0);
+    invalid = code_length;
+    cmp_m8_imm8(&invalid_code[(naddr ^ 0x20000000) >> 12], 0);
+    jcc_rj(CC_NE, 0);
+    mirror_invalid = code_length;
+    mov_m64_reg64(&actual, RAX);
+    mov_m64_reg64(&PC, RCX);
+    jmp_reg64(RDX);
+
+    patch_rj(site + 2);
+    patch_rj(invalid);
+    patch_rj(mirror_invalid);
+    mov_m32_imm32(&jump_to_address, naddr);
+    mov_m_ptr(&PC, dst + 1);
+    mov_m32_imm32(&link_distance, 0);
+    distance = code_length;
+    gencall((void*)dyna_jump_link);
+    *(uint32_t*)(*inst_pointer + distance - 4) = code_length - site;
+}
+
+void genj()
+{
+#ifdef INTERPRET_J
+    gencallinterp((uintptr_t)J, 1);
+#else
+    uint32_t naddr;
+
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)J, 1);
+        return;
+    }
+
+    gendelayslot();
+    naddr = ((dst - 1)->f.j.inst_index << 2) | (dst->addr & 0xF0000000);
+
+    mov_m32_imm32(&last_addr, naddr);
+    gencheck_interrupt(&actual->block[(naddr - actual->start) / 4]);
+    jmp(naddr);
+#endif
+}
+
+void genj_out()
+{
+#ifdef INTERPRET_J_OUT
+    gencallinterp((uintptr_t)J_OUT, 1);
+#else
+    uint32_t naddr;
+
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)J_OUT, 1);
+        return;
+    }
+
+    gendelayslot();
+    naddr = ((dst - 1)->f.j.inst_index << 2) | (dst->addr & 0xF0000000);
+
+    mov_m32_imm32(&last_addr, naddr);
+    gencheck_interrupt_out(naddr);
+    genjump_out(naddr);
+#endif
+}
+
+void genj_idle()
+{
+#ifdef INTERPRET_J_IDLE
+    gencallinterp((uintptr_t)J_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)J_IDLE, 1);
+        return;
+    }
+
+    free_all_registers();
+    genskip_idle(RAX);
+    genj();
+#endif
+}
+
+static void genlink_ra()
+{
+    mov_m64_imm32(&reg[31], (int32_t)(dst->addr + 4));
+}
+
+void genjal()
+{
+#ifdef INTERPRET_JAL
+    gencallinterp((uintptr_t)JAL, 1);
+#else
+    uint32_t naddr;
+
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)JAL, 1);
+        return;
+    }
+
+    gendelayslot();
+    genlink_ra();
+
+    naddr = ((dst - 1)->f.j.inst_index << 2) | (dst->addr & 0xF0000000);
+
+    mov_m32_imm32(&last_addr, naddr);
+    gencheck_interrupt(&actual->block[(naddr - actual->start) / 4]);
+    jmp(naddr);
+#endif
+}
+
+void genjal_out()
+{
+#ifdef INTERPRET_JAL_OUT
+    gencallinterp((uintptr_t)JAL_OUT, 1);
+#else
+    uint32_t naddr;
+
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)JAL_OUT, 1);
+        return;
+    }
+
+    gendelayslot();
+    genlink_ra();
+
+    naddr = ((dst - 1)->f.j.inst_index << 2) | (dst->addr & 0xF0000000);
+
+    mov_m32_imm32(&last_addr, naddr);
+    gencheck_interrupt_out(naddr);
+    genjump_out(naddr);
+#endif
+}
+
+void genjal_idle()
+{
+#ifdef INTERPRET_JAL_IDLE
+    gencallinterp((uintptr_t)JAL_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)JAL_IDLE, 1);
+        return;
+    }
+
+    free_all_registers();
+    genskip_idle(RAX);
+    genjal();
+#endif
+}
+
+void genbeq_test()
+{
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+    int32_t rt = allocate_register((uint64_t*)dst->f.i.rt);
+
+    cmp_reg64_reg64(rs, rt);
+    genset_branch_taken(CC_E);
+}
+
+void gentest()
+{
+    uint32_t temp;
+
+    cmp_m32_imm32(&branch_taken, 0);
+    jcc_near_rj(CC_E, 0);
+    temp = code_length;
+    mov_m32_imm32(&last_addr, dst->addr + (dst - 1)->f.i.immediate * 4);
+    gencheck_interrupt(dst + (dst - 1)->f.i.immediate);
+    jmp(dst->addr + (dst - 1)->f.i.immediate * 4);
+
+    patch_near_rj(temp);
+    mov_m32_imm32(&last_addr, dst->addr + 4);
+    gencheck_interrupt(dst + 1);
+    jmp(dst->addr + 4);
+}
+
+void genbeq()
+{
+#ifdef INTERPRET_BEQ
+    gencallinterp((uintptr_t)BEQ, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BEQ, 1);
+        return;
+    }
+
+    genbeq_test();
+    gendelayslot();
+    gentest();
+#endif
+}
+
+void gentest_out()
+{
+    uint32_t temp;
+
+    cmp_m32_imm32(&branch_taken, 0);
+    jcc_near_rj(CC_E, 0);
+    temp = code_length;
+    mov_m32_imm32(&last_addr, dst->addr + (dst - 1)->f.i.immediate * 4);
+    gencheck_interrupt_out(dst->addr + (dst - 1)->f.i.immediate * 4);
+    genjump_out(dst->addr + (dst - 1)->f.i.immediate * 4);
+
+    patch_near_rj(temp);
+    mov_m32_imm32(&last_addr, dst->addr + 4);
+    gencheck_interrupt(dst + 1);
+    jmp(dst->addr + 4);
+}
+
+void genbeq_out()
+{
+#ifdef INTERPRET_BEQ_OUT
+    gencallinterp((uintptr_t)BEQ_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BEQ_OUT, 1);
+        return;
+    }
+
+    genbeq_test();
+    gendelayslot();
+    gentest_out();
+#endif
+}
+
+void gentest_idle()
+{
+    uint32_t temp;
+    int32_t reg;
+
+    reg = lru_register();
+    free_register(reg);
+
+    cmp_m32_imm32(&branch_taken, 0);
+    jcc_near_rj(CC_E, 0);
+    temp = code_length;
+
+    genskip_idle(reg);
+
+    patch_near_rj(temp);
+}
+
+void genbeq_idle()
+{
+#ifdef INTERPRET_BEQ_IDLE
+    gencallinterp((uintptr_t)BEQ_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BEQ_IDLE, 1);
+        return;
+    }
+
+    genbeq_test();
+    gentest_idle();
+    genbeq();
+#endif
+}
+
+void genbne_test()
+{
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+    int32_t rt = allocate_register((uint64_t*)dst->f.i.rt);
+
+    cmp_reg64_reg64(rs, rt);
+    genset_branch_taken(CC_NE);
+}
+
+void genbne()
+{
+#ifdef INTERPRET_BNE
+    gencallinterp((uintptr_t)BNE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BNE, 1);
+        return;
+    }
+
+    genbne_test();
+    gendelayslot();
+    gentest();
+#endif
+}
+
+void genbne_out()
+{
+#ifdef INTERPRET_BNE_OUT
+    gencallinterp((uintptr_t)BNE_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BNE_OUT, 1);
+        return;
+    }
+
+    genbne_test();
+    gendelayslot();
+    gentest_out();
+#endif
+}
+
+void genbne_idle()
+{
+#ifdef INTERPRET_BNE_IDLE
+    gencallinterp((uintptr_t)BNE_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BNE_IDLE, 1);
+        return;
+    }
+
+    genbne_test();
+    gentest_idle();
+    genbne();
+#endif
+}
+
+void genblez_test()
+{
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+
+    cmp_reg64_imm32(rs, 0);
+    genset_branch_taken(CC_LE);
+}
+
+void genblez()
+{
+#ifdef INTERPRET_BLEZ
+    gencallinterp((uintptr_t)BLEZ, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLEZ, 1);
+        return;
+    }
+
+    genblez_test();
+    gendelayslot();
+    gentest();
+#endif
+}
+
+void genblez_out()
+{
+#ifdef INTERPRET_BLEZ_OUT
+    gencallinterp((uintptr_t)BLEZ_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLEZ_OUT, 1);
+        return;
+    }
+
+    genblez_test();
+    gendelayslot();
+    gentest_out();
+#endif
+}
+
+void genblez_idle()
+{
+#ifdef INTERPRET_BLEZ_IDLE
+    gencallinterp((uintptr_t)BLEZ_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLEZ_IDLE, 1);
+        return;
+    }
+
+    genblez_test();
+    gentest_idle();
+    genblez();
+#endif
+}
+
+void genbgtz_test()
+{
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+
+    cmp_reg64_imm32(rs, 0);
+    genset_branch_taken(CC_G);
+}
+
+void genbgtz()
+{
+#ifdef INTERPRET_BGTZ
+    gencallinterp((uintptr_t)BGTZ, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGTZ, 1);
+        return;
+    }
+
+    genbgtz_test();
+    gendelayslot();
+    gentest();
+#endif
+}
+
+void genbgtz_out()
+{
+#ifdef INTERPRET_BGTZ_OUT
+    gencallinterp((uintptr_t)BGTZ_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGTZ_OUT, 1);
+        return;
+    }
+
+    genbgtz_test();
+    gendelayslot();
+    gentest_out();
+#endif
+}
+
+void genbgtz_idle()
+{
+#ifdef INTERPRET_BGTZ_IDLE
+    gencallinterp((uintptr_t)BGTZ_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGTZ_IDLE, 1);
+        return;
+    }
+
+    genbgtz_test();
+    gentest_idle();
+    genbgtz();
+#endif
+}
+
+void genaddi()
+{
+#ifdef INTERPRET_ADDI
+    gencallinterp((uintptr_t)ADDI, 0);
+#else
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+    int32_t rt = allocate_register_w((uint64_t*)dst->f.i.rt);
+
+    mov_reg32_reg32(rt, rs);
+    add_reg32_imm32(rt, (int32_t)dst->f.i.immediate);
+    movsxd_reg64_reg32(rt, rt);
+#endif
+}
+
+void genaddiu()
+{
+#ifdef INTERPRET_ADDIU
+    gencallinterp((uintptr_t)ADDIU, 0);
+#else
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+    int32_t rt = allocate_register_w((uint64_t*)dst->f.i.rt);
+
+    mov_reg32_reg32(rt, rs);
+    add_reg32_imm32(rt, (int32_t)dst->f.i.immediate);
+    movsxd_reg64_reg32(rt, rt);
+#endif
+}
+
+void genslti()
+{
+#ifdef INTERPRET_SLTI
+    gencallinterp((uintptr_t)SLTI, 0);
+#else
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+    int32_t rt = allocate_register_w((uint64_t*)dst->f.i.rt);
+
+    cmp_reg64_imm32(rs, (int32_t)dst->f.i.immediate);
+    setcc_reg8(CC_L, rt);
+    movzx_reg32_reg8(rt, rt);
+#endif
+}
+
+void gensltiu()
+{
+#ifdef INTERPRET_SLTIU
+    gencallinterp((uintptr_t)SLTIU, 0);
+#else
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+    int32_t rt = allocate_register_w((uint64_t*)dst->f.i.rt);
+
+    cmp_reg64_imm32(rs, (int32_t)dst->f.i.immediate);
+    setcc_reg8(CC_B, rt);
+    movzx_reg32_reg8(rt, rt);
+#endif
+}
+
+void genandi()
+{
+#ifdef INTERPRET_ANDI
+    gencallinterp((uintptr_t)ANDI, 0);
+#else
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+    int32_t rt = allocate_register_w((uint64_t*)dst->f.i.rt);
+
+    mov_reg64_reg64(rt, rs);
+    and_reg64_imm32(rt, (uint16_t)dst->f.i.immediate);
+#endif
+}
+
+void genori()
+{
+#ifdef INTERPRET_ORI
+    gencallinterp((uintptr_t)ORI, 0);
+#else
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+    int32_t rt = allocate_register_w((uint64_t*)dst->f.i.rt);
+
+    mov_reg64_reg64(rt, rs);
+    or_reg64_imm32(rt, (uint16_t)dst->f.i.immediate);
+#endif
+}
+
+void genxori()
+{
+#ifdef INTERPRET_XORI
+    gencallinterp((uintptr_t)XORI, 0);
+#else
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+    int32_t rt = allocate_register_w((uint64_t*)dst->f.i.rt);
+
+    mov_reg64_reg64(rt, rs);
+    xor_reg64_imm32(rt, (uint16_t)dst->f.i.immediate);
+#endif
+}
+
+void genlui()
+{
+#ifdef INTERPRET_LUI
+    gencallinterp((uintptr_t)LUI, 0);
+#else
+    int32_t rt = allocate_register_w((uint64_t*)dst->f.i.rt);
+
+    mov_reg64_imm64(rt, (int64_t)(int32_t)((uint32_t)dst->f.i.immediate << 16));
+#endif
+}
+
+void gentestl()
+{
+    uint32_t temp;
+
+    cmp_m32_imm32(&branch_taken, 0);
+    jcc_near_rj(CC_E, 0);
+    temp = code_length;
+    gendelayslot();
+    mov_m32_imm32(&last_addr, dst->addr + (dst - 1)->f.i.immediate * 4);
+    gencheck_interrupt(dst + (dst - 1)->f.i.immediate);
+    jmp(dst->addr + (dst - 1)->f.i.immediate * 4);
+
+    patch_near_rj(temp);
+    genupdate_count(dst->addr - 4);
+    mov_m32_imm32(&last_addr, dst->addr + 4);
+    gencheck_interrupt(dst + 1);
+    jmp(dst->addr + 4);
+}
+
+void genbeql()
+{
+#ifdef INTERPRET_BEQL
+    gencallinterp((uintptr_t)BEQL, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BEQL, 1);
+        return;
+    }
+
+    genbeq_test();
+    free_all_registers();
+    gentestl();
+#endif
+}
+
+void gentestl_out()
+{
+    uint32_t temp;
+
+    cmp_m32_imm32(&branch_taken, 0);
+    jcc_near_rj(CC_E, 0);
+    temp = code_length;
+    gendelayslot();
+    mov_m32_imm32(&last_addr, dst->addr + (dst - 1)->f.i.immediate * 4);
+    gencheck_interrupt_out(dst->addr + (dst - 1)->f.i.immediate * 4);
+    genjump_out(dst->addr + (dst - 1)->f.i.immediate * 4);
+
+    patch_near_rj(temp);
+    genupdate_count(dst->addr - 4);
+    mov_m32_imm32(&last_addr, dst->addr + 4);
+    gencheck_interrupt(dst + 1);
+    jmp(dst->addr + 4);
+}
+
+void genbeql_out()
+{
+#ifdef INTERPRET_BEQL_OUT
+    gencallinterp((uintptr_t)BEQL_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BEQL_OUT, 1);
+        return;
+    }
+
+    genbeq_test();
+    free_all_registers();
+    gentestl_out();
+#endif
+}
+
+void genbeql_idle()
+{
+#ifdef INTERPRET_BEQL_IDLE
+    gencallinterp((uintptr_t)BEQL_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BEQL_IDLE, 1);
+        return;
+    }
+
+    genbeq_test();
+    gentest_idle();
+    genbeql();
+#endif
+}
+
+void genbnel()
+{
+#ifdef INTERPRET_BNEL
+    gencallinterp((uintptr_t)BNEL, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BNEL, 1);
+        return;
+    }
+
+    genbne_test();
+    free_all_registers();
+    gentestl();
+#endif
+}
+
+void genbnel_out()
+{
+#ifdef INTERPRET_BNEL_OUT
+    gencallinterp((uintptr_t)BNEL_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BNEL_OUT, 1);
+        return;
+    }
+
+    genbne_test();
+    free_all_registers();
+    gentestl_out();
+#endif
+}
+
+void genbnel_idle()
+{
+#ifdef INTERPRET_BNEL_IDLE
+    gencallinterp((uintptr_t)BNEL_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BNEL_IDLE, 1);
+        return;
+    }
+
+    genbne_test();
+    gentest_idle();
+    genbnel();
+#endif
+}
+
+void genblezl()
+{
+#ifdef INTERPRET_BLEZL
+    gencallinterp((uintptr_t)BLEZL, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLEZL, 1);
+        return;
+    }
+
+    genblez_test();
+    free_all_registers();
+    gentestl();
+#endif
+}
+
+void genblezl_out()
+{
+#ifdef INTERPRET_BLEZL_OUT
+    gencallinterp((uintptr_t)BLEZL_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLEZL_OUT, 1);
+        return;
+    }
+
+    genblez_test();
+    free_all_registers();
+    gentestl_out();
+#endif
+}
+
+void genblezl_idle()
+{
+#ifdef INTERPRET_BLEZL_IDLE
+    gencallinterp((uintptr_t)BLEZL_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLEZL_IDLE, 1);
+        return;
+    }
+
+    genblez_test();
+    gentest_idle();
+    genblezl();
+#endif
+}
+
+void genbgtzl()
+{
+#ifdef INTERPRET_BGTZL
+    gencallinterp((uintptr_t)BGTZL, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGTZL, 1);
+        return;
+    }
+
+    genbgtz_test();
+    free_all_registers();
+    gentestl();
+#endif
+}
+
+void genbgtzl_out()
+{
+#ifdef INTERPRET_BGTZL_OUT
+    gencallinterp((uintptr_t)BGTZL_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGTZL_OUT, 1);
+        return;
+    }
+
+    genbgtz_test();
+    free_all_registers();
+    gentestl_out();
+#endif
+}
+
+void genbgtzl_idle()
+{
+#ifdef INTERPRET_BGTZL_IDLE
+    gencallinterp((uintptr_t)BGTZL_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGTZL_IDLE, 1);
+        return;
+    }
+
+    genbgtz_test();
+    gentest_idle();
+    genbgtzl();
+#endif
+}
+
+void gendaddi()
+{
+#ifdef INTERPRET_DADDI
+    gencallinterp((uintptr_t)DADDI, 0);
+#else
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+    int32_t rt = allocate_register_w((uint64_t*)dst->f.i.rt);
+
+    mov_reg64_reg64(rt, rs);
+    add_reg64_imm32(rt, dst->f.i.immediate);
+#endif
+}
+
+void gendaddiu()
+{
+#ifdef INTERPRET_DADDIU
+    gencallinterp((uintptr_t)DADDIU, 0);
+#else
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+    int32_t rt = allocate_register_w((uint64_t*)dst->f.i.rt);
+
+    mov_reg64_reg64(rt, rs);
+    add_reg64_imm32(rt, dst->f.i.immediate);
+#endif
+}
+
+void genldl()
+{
+    gencallinterp((uintptr_t)LDL, 0);
+}
+
+void genldr()
+{
+    gencallinterp((uintptr_t)LDR, 0);
+}
+
+// Computes the effective address into EAX and jumps to the returned patch site if it's not in RDRAM
+static uint32_t genaddress_rdram_check(void* handlers, void* rdram_handler)
+{
+    mov_reg32_m32(RAX, (uint32_t*)dst->f.i.rs);
+    add_reg32_imm32(RAX, (int32_t)dst->f.i.immediate);
+    mov_reg32_reg32(RCX, RAX);
+    if (fast_memory)
+    {
+        and_reg32_imm32(RCX, 0xDF800000);
+        cmp_reg32_imm32(RCX, 0x80000000);
+    }
+    else
+    {
+        shr_reg32_imm8(RCX, 16);
+        mov_reg64_preg64x8pm(RCX, RCX, handlers);
+        mov_reg64_imm64(RDX, (uint64_t)rdram_handler);
+        cmp_reg64_reg64(RCX, RDX);
+    }
+    jcc_rj(CC_NE, 0);
+    return code_length;
+}
+
+// Loads are done inline when they hit RDRAM, everything else goes through the interpreter
+static void genload(void (*op)(), void* handlers, void* rdram_handler, mem_width width)
+{
+    uint32_t slow, done;
+
+    free_all_registers();
+    simplify_access();
+
+    slow = genaddress_rdram_check(handlers, rdram_handler);
+
+    and_reg32_imm32(RAX, 0x7FFFFF);
+    switch (width)
+    {
+    case mem_width::byte:
+        xor_reg32_imm32(RAX, 3);
+        movsx_reg64_preg64pm8(RAX, RAX, rdram);
+        break;
+    case mem_width::ubyte:
+        xor_reg32_imm32(RAX, 3);
+        movzx_reg32_preg64pm8(RAX, RAX, rdram);
+        break;
+    case mem_width::half:
+        xor_reg32_imm32(RAX, 2);
+        movsx_reg64_preg64pm16(RAX, RAX, rdram);
+        break;
+    case mem_width::uhalf:
+        xor_reg32_imm32(RAX, 2);
+        movzx_reg32_preg64pm16(RAX, RAX, rdram);
+        break;
+    case mem_width::word:
+        movsxd_reg64_preg64pm(RAX, RAX, rdram);
+        break;
+    case mem_width::uword:
+        mov_reg32_preg64pm(RAX, RAX, rdram);
+        break;
+    case mem_width::dword:
+        // The high word is stored first
+        mov_reg64_preg64pm(RAX, RAX, rdram);
+        rol_reg64_imm8(RAX, 32);
+        break;
+    }
+    mov_m64_reg64(dst->f.i.rt, RAX);
+    jmp_imm_short(0);
+    done = code_length;
+
+    patch_rj(slow);
+    mov_m_ptr(&PC, dst);
+    gencall((void*)op);
+    patch_rj(done);
+}
+
+// Stores are only done inline when they hit RDRAM pages without any compiled code,
+// the interpreter takes care of invalidating blocks otherwise
+static void genstore(void (*op)(), void* handlers, void* rdram_handler, mem_width width)
+{
+    uint32_t slow, slow_code, done;
+
+    free_all_registers();
+    simplify_access();
+
+    slow = genaddress_rdram_check(handlers, rdram_handler);
+
+    mov_reg32_reg32(RCX, RAX);
+    shr_reg32_imm8(RCX, 12);
+    cmp_preg64pm_imm8(RCX, invalid_code, 0);
+    jcc_rj(CC_E, 0);
+    slow_code = code_length;
+
+    mov_reg64_m64(RCX, dst->f.i.rt);
+    and_reg32_imm32(RAX, 0x7FFFFF);
+    switch (width)
+    {
+    case mem_width::byte:
+        xor_reg32_imm32(RAX, 3);
+        mov_preg64pm_reg8(RAX, rdram, RCX);
+        break;
+    case mem_width::half:
+        xor_reg32_imm32(RAX, 2);
+        mov_preg64pm_reg16(RAX, rdram, RCX);
+        break;
+    case mem_width::word:
+        mov_preg64pm_reg32(RAX, rdram, RCX);
+        break;
+    case mem_width::dword:
+        rol_reg64_imm8(RCX, 32);
+        mov_preg64pm_reg64(RAX, rdram, RCX);
+        break;
+    default:
+        assert(false);
+        break;
+    }
+    jmp_imm_short(0);
+    done = code_length;
+
+    patch_rj(slow);
+    patch_rj(slow_code);
+    mov_m_ptr(&PC, dst);
+    gencall((void*)op);
+    patch_rj(done);
+}
+
+void genlb()
+{
+#ifdef INTERPRET_LB
+    gencallinterp((uintptr_t)LB, 0);
+#else
+    genload(LB, readmemb, (void*)read_rdramb, mem_width::byte);
+#endif
+}
+
+void genlh()
+{
+#ifdef INTERPRET_LH
+    gencallinterp((uintptr_t)LH, 0);
+#else
+    genload(LH, readmemh, (void*)read_rdramh, mem_width::half);
+#endif
+}
+
+void genlwl()
+{
+    gencallinterp((uintptr_t)LWL, 0);
+}
+
+void genlw()
+{
+#ifdef INTERPRET_LW
+    gencallinterp((uintptr_t)LW, 0);
+#else
+    genload(LW, readmem, (void*)read_rdram, mem_width::word);
+#endif
+}
+
+void genlbu()
+{
+#ifdef INTERPRET_LBU
+    gencallinterp((uintptr_t)LBU, 0);
+#else
+    genload(LBU, readmemb, (void*)read_rdramb, mem_width::ubyte);
+#endif
+}
+
+void genlhu()
+{
+#ifdef INTERPRET_LHU
+    gencallinterp((uintptr_t)LHU, 0);
+#else
+    genload(LHU, readmemh, (void*)read_rdramh, mem_width::uhalf);
+#endif
+}
+
+void genlwr()
+{
+    gencallinterp((uintptr_t)LWR, 0);
+}
+
+void genlwu()
+{
+#ifdef INTERPRET_LWU
+    gencallinterp((uintptr_t)LWU, 0);
+#else
+    genload(LWU, readmem, (void*)read_rdram, mem_width::uword);
+#endif
+}
+
+void gensb()
+{
+#ifdef INTERPRET_SB
+    gencallinterp((uintptr_t)SB, 0);
+#else
+    genstore(SB, writememb, (void*)write_rdramb, mem_width::byte);
+#endif
+}
+
+void gensh()
+{
+#ifdef INTERPRET_SH
+    gencallinterp((uintptr_t)SH, 0);
+#else
+    genstore(SH, writememh, (void*)write_rdramh, mem_width::half);
+#endif
+}
+
+void genswl()
+{
+    gencallinterp((uintptr_t)SWL, 0);
+}
+
+void gensw()
+{
+#ifdef INTERPRET_SW
+    gencallinterp((uintptr_t)SW, 0);
+#else
+    genstore(SW, writemem, (void*)write_rdram, mem_width::word);
+#endif
+}
+
+void gensdl()
+{
+    gencallinterp((uintptr_t)SDL, 0);
+}
+
+void gensdr()
+{
+    gencallinterp((uintptr_t)SDR, 0);
+}
+
+void genswr()
+{
+    gencallinterp((uintptr_t)SWR, 0);
+}
+
+void gencheck_cop1_unusable()
+{
+    uint32_t skip;
+    free_all_registers();
+    simplify_access();
+    test_m32_imm32(&core_Status, 0x20000000);
+    jcc_rj(CC_NE, 0);
+    skip = code_length;
+
+    gencallinterp((uintptr_t)check_cop1_unusable, 0);
+
+    patch_rj(skip);
+}
+
+void genlwc1()
+{
+    gencallinterp((uintptr_t)LWC1, 0);
+}
+
+void genldc1()
+{
+    gencallinterp((uintptr_t)LDC1, 0);
+}
+
+void gencache()
+{
+}
+
+void genld()
+{
+#ifdef INTERPRET_LD
+    gencallinterp((uintptr_t)LD, 0);
+#else
+    genload(LD, readmemd, (void*)read_rdramd, mem_width::dword);
+#endif
+}
+
+void genswc1()
+{
+    gencallinterp((uintptr_t)SWC1, 0);
+}
+
+void gensdc1()
+{
+    gencallinterp((uintptr_t)SDC1, 0);
+}
+
+void gensd()
+{
+#ifdef INTERPRET_SD
+    gencallinterp((uintptr_t)SD, 0);
+#else
+    genstore(SD, writememd, (void*)write_rdramd, mem_width::dword);
+#endif
+}
+
+void genll()
+{
+    gencallinterp((uintptr_t)LL, 0);
+}
+
+void gensc()
+{
+    gencallinterp((uintptr_t)SC, 0);
+}
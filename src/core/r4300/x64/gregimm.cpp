@@ -0,0 +1,457 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <core/Core.h>
+#include <core/r4300/ops.h>
+#include <core/r4300/r4300.h>
+#include <core/r4300/recomp.h>
+#include <core/r4300/recomph.h>
+#include <core/r4300/x64/assemble.h>
+#include <core/r4300/x64/regcache.h>
+
+void genbranchlink()
+{
+    int32_t r31 = allocate_register_w((uint64_t*)&reg[31]);
+
+    mov_reg64_imm64(r31, (int64_t)(int32_t)(dst->addr + 8));
+}
+
+void genbltz_test()
+{
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+
+    cmp_reg64_imm32(rs, 0);
+    genset_branch_taken(CC_L);
+}
+
+void genbltz()
+{
+#ifdef INTERPRET_BLTZ
+    gencallinterp((uintptr_t)BLTZ, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLTZ, 1);
+        return;
+    }
+
+    genbltz_test();
+    gendelayslot();
+    gentest();
+#endif
+}
+
+void genbltz_out()
+{
+#ifdef INTERPRET_BLTZ_OUT
+    gencallinterp((uintptr_t)BLTZ_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLTZ_OUT, 1);
+        return;
+    }
+
+    genbltz_test();
+    gendelayslot();
+    gentest_out();
+#endif
+}
+
+void genbltz_idle()
+{
+#ifdef INTERPRET_BLTZ_IDLE
+    gencallinterp((uintptr_t)BLTZ_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLTZ_IDLE, 1);
+        return;
+    }
+
+    genbltz_test();
+    gentest_idle();
+    genbltz();
+#endif
+}
+
+void genbltzl()
+{
+#ifdef INTERPRET_BLTZL
+    gencallinterp((uintptr_t)BLTZL, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLTZL, 1);
+        return;
+    }
+
+    genbltz_test();
+    free_all_registers();
+    gentestl();
+#endif
+}
+
+void genbltzl_out()
+{
+#ifdef INTERPRET_BLTZL_OUT
+    gencallinterp((uintptr_t)BLTZL_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLTZL_OUT, 1);
+        return;
+    }
+
+    genbltz_test();
+    free_all_registers();
+    gentestl_out();
+#endif
+}
+
+void genbltzl_idle()
+{
+#ifdef INTERPRET_BLTZL_IDLE
+    gencallinterp((uintptr_t)BLTZL_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLTZL_IDLE, 1);
+        return;
+    }
+
+    genbltz_test();
+    gentest_idle();
+    genbltzl();
+#endif
+}
+
+void genbltzal()
+{
+#ifdef INTERPRET_BLTZAL
+    gencallinterp((uintptr_t)BLTZAL, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLTZAL, 1);
+        return;
+    }
+
+    genbltz_test();
+    genbranchlink();
+    gendelayslot();
+    gentest();
+#endif
+}
+
+void genbltzal_out()
+{
+#ifdef INTERPRET_BLTZAL_OUT
+    gencallinterp((uintptr_t)BLTZAL_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLTZAL_OUT, 1);
+        return;
+    }
+
+    genbltz_test();
+    genbranchlink();
+    gendelayslot();
+    gentest_out();
+#endif
+}
+
+void genbltzal_idle()
+{
+#ifdef INTERPRET_BLTZAL_IDLE
+    gencallinterp((uintptr_t)BLTZAL_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLTZAL_IDLE, 1);
+        return;
+    }
+
+    genbltz_test();
+    genbranchlink();
+    gentest_idle();
+    genbltzal();
+#endif
+}
+
+void genbltzall()
+{
+#ifdef INTERPRET_BLTZALL
+    gencallinterp((uintptr_t)BLTZALL, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLTZALL, 1);
+        return;
+    }
+
+    genbltz_test();
+    genbranchlink();
+    free_all_registers();
+    gentestl();
+#endif
+}
+
+void genbltzall_out()
+{
+#ifdef INTERPRET_BLTZALL_OUT
+    gencallinterp((uintptr_t)BLTZALL_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLTZALL_OUT, 1);
+        return;
+    }
+
+    genbltz_test();
+    genbranchlink();
+    free_all_registers();
+    gentestl_out();
+#endif
+}
+
+void genbltzall_idle()
+{
+#ifdef INTERPRET_BLTZALL_IDLE
+    gencallinterp((uintptr_t)BLTZALL_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BLTZALL_IDLE, 1);
+        return;
+    }
+
+    genbltz_test();
+    genbranchlink();
+    gentest_idle();
+    genbltzall();
+#endif
+}
+
+void genbgez_test()
+{
+    int32_t rs = allocate_register((uint64_t*)dst->f.i.rs);
+
+    cmp_reg64_imm32(rs, 0);
+    genset_branch_taken(CC_GE);
+}
+
+void genbgez()
+{
+#ifdef INTERPRET_BGEZ
+    gencallinterp((uintptr_t)BGEZ, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGEZ, 1);
+        return;
+    }
+
+    genbgez_test();
+    gendelayslot();
+    gentest();
+#endif
+}
+
+void genbgez_out()
+{
+#ifdef INTERPRET_BGEZ_OUT
+    gencallinterp((uintptr_t)BGEZ_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGEZ_OUT, 1);
+        return;
+    }
+
+    genbgez_test();
+    gendelayslot();
+    gentest_out();
+#endif
+}
+
+void genbgez_idle()
+{
+#ifdef INTERPRET_BGEZ_IDLE
+    gencallinterp((uintptr_t)BGEZ_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGEZ_IDLE, 1);
+        return;
+    }
+
+    genbgez_test();
+    gentest_idle();
+    genbgez();
+#endif
+}
+
+void genbgezl()
+{
+#ifdef INTERPRET_BGEZL
+    gencallinterp((uintptr_t)BGEZL, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGEZL, 1);
+        return;
+    }
+
+    genbgez_test();
+    free_all_registers();
+    gentestl();
+#endif
+}
+
+void genbgezl_out()
+{
+#ifdef INTERPRET_BGEZL_OUT
+    gencallinterp((uintptr_t)BGEZL_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGEZL_OUT, 1);
+        return;
+    }
+
+    genbgez_test();
+    free_all_registers();
+    gentestl_out();
+#endif
+}
+
+void genbgezl_idle()
+{
+#ifdef INTERPRET_BGEZL_IDLE
+    gencallinterp((uintptr_t)BGEZL_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGEZL_IDLE, 1);
+        return;
+    }
+
+    genbgez_test();
+    gentest_idle();
+    genbgezl();
+#endif
+}
+
+void genbgezal()
+{
+#ifdef INTERPRET_BGEZAL
+    gencallinterp((uintptr_t)BGEZAL, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGEZAL, 1);
+        return;
+    }
+
+    genbgez_test();
+    genbranchlink();
+    gendelayslot();
+    gentest();
+#endif
+}
+
+void genbgezal_out()
+{
+#ifdef INTERPRET_BGEZAL_OUT
+    gencallinterp((uintptr_t)BGEZAL_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGEZAL_OUT, 1);
+        return;
+    }
+
+    genbgez_test();
+    genbranchlink();
+    gendelayslot();
+    gentest_out();
+#endif
+}
+
+void genbgezal_idle()
+{
+#ifdef INTERPRET_BGEZAL_IDLE
+    gencallinterp((uintptr_t)BGEZAL_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGEZAL_IDLE, 1);
+        return;
+    }
+
+    genbgez_test();
+    genbranchlink();
+    gentest_idle();
+    genbgezal();
+#endif
+}
+
+void genbgezall()
+{
+#ifdef INTERPRET_BGEZALL
+    gencallinterp((uintptr_t)BGEZALL, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGEZALL, 1);
+        return;
+    }
+
+    genbgez_test();
+    genbranchlink();
+    free_all_registers();
+    gentestl();
+#endif
+}
+
+void genbgezall_out()
+{
+#ifdef INTERPRET_BGEZALL_OUT
+    gencallinterp((uintptr_t)BGEZALL_OUT, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGEZALL_OUT, 1);
+        return;
+    }
+
+    genbgez_test();
+    genbranchlink();
+    free_all_registers();
+    gentestl_out();
+#endif
+}
+
+void genbgezall_idle()
+{
+#ifdef INTERPRET_BGEZALL_IDLE
+    gencallinterp((uintptr_t)BGEZALL_IDLE, 1);
+#else
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)BGEZALL_IDLE, 1);
+        return;
+    }
+
+    genbgez_test();
+    genbranchlink();
+    gentest_idle();
+    genbgezall();
+#endif
+}
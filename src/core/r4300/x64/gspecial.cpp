@@ -0,0 +1,543 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <core/Core.h>
+#include <core/r4300/exception.h>
+#include <core/r4300/macros.h>
+#include <core/r4300/ops.h>
+#include <core/r4300/r4300.h>
+#include <core/r4300/recomp.h>
+#include <core/r4300/recomph.h>
+#include <core/r4300/x64/assemble.h>
+#include <core/r4300/x64/regcache.h>
+
+// rd = rt shifted by sa, 32-bit shifts sign-extend their result
+static void genshift_imm(void (*shift)(int32_t, unsigned char), unsigned char sa, bool sign_extend)
+{
+    int32_t rt = allocate_register((uint64_t*)dst->f.r.rt);
+    int32_t rd = allocate_register_w((uint64_t*)dst->f.r.rd);
+
+    mov_reg64_reg64(rd, rt);
+    shift(rd, sa);
+    if (sign_extend)
+        movsxd_reg64_reg32(rd, rd);
+}
+
+// rd = rt shifted by rs, the shift amount is masked by the host just like the interpreter does
+static void genshift_var(void (*shift)(int32_t), bool sign_extend)
+{
+    int32_t rt, rd;
+    allocate_register_manually(RCX, (uint64_t*)dst->f.r.rs);
+
+    rt = allocate_register((uint64_t*)dst->f.r.rt);
+    rd = allocate_register_w((uint64_t*)dst->f.r.rd);
+
+    if (rd != RCX)
+    {
+        mov_reg64_reg64(rd, rt);
+        shift(rd);
+        if (sign_extend)
+            movsxd_reg64_reg32(rd, rd);
+    }
+    else
+    {
+        mov_reg64_reg64(RSCRATCH, rt);
+        shift(RSCRATCH);
+        if (sign_extend)
+            movsxd_reg64_reg32(rd, RSCRATCH);
+        else
+            mov_reg64_reg64(rd, RSCRATCH);
+    }
+}
+
+// rd = rs op rt
+static void genalu(void (*op)(int32_t, int32_t), bool commutative, bool sign_extend)
+{
+    int32_t rs = allocate_register((uint64_t*)dst->f.r.rs);
+    int32_t rt = allocate_register((uint64_t*)dst->f.r.rt);
+    int32_t rd = allocate_register_w((uint64_t*)dst->f.r.rd);
+
+    if (rd == rt && rd != rs)
+    {
+        if (commutative)
+            op(rd, rs);
+        else
+        {
+            mov_reg64_reg64(RSCRATCH, rs);
+            op(RSCRATCH, rt);
+            mov_reg64_reg64(rd, RSCRATCH);
+        }
+    }
+    else
+    {
+        mov_reg64_reg64(rd, rs);
+        op(rd, rt);
+    }
+    if (sign_extend)
+        movsxd_reg64_reg32(rd, rd);
+}
+
+// rd = rs < rt
+static void genset_less(int32_t cc)
+{
+    int32_t rs = allocate_register((uint64_t*)dst->f.r.rs);
+    int32_t rt = allocate_register((uint64_t*)dst->f.r.rt);
+    int32_t rd = allocate_register_w((uint64_t*)dst->f.r.rd);
+
+    cmp_reg64_reg64(rs, rt);
+    setcc_reg8(cc, rd);
+    movzx_reg32_reg8(rd, rd);
+}
+
+static void genmove(uint64_t* to, uint64_t* from)
+{
+    int32_t src = allocate_register(from);
+    int32_t dest = allocate_register_w(to);
+
+    mov_reg64_reg64(dest, src);
+}
+
+void gensll()
+{
+#ifdef INTERPRET_SLL
+    gencallinterp((uintptr_t)SLL, 0);
+#else
+    genshift_imm(shl_reg32_imm8, dst->f.r.sa, true);
+#endif
+}
+
+void gensrl()
+{
+#ifdef INTERPRET_SRL
+    gencallinterp((uintptr_t)SRL, 0);
+#else
+    genshift_imm(shr_reg32_imm8, dst->f.r.sa, true);
+#endif
+}
+
+void gensra()
+{
+#ifdef INTERPRET_SRA
+    gencallinterp((uintptr_t)SRA, 0);
+#else
+    genshift_imm(sar_reg32_imm8, dst->f.r.sa, true);
+#endif
+}
+
+void gensllv()
+{
+#ifdef INTERPRET_SLLV
+    gencallinterp((uintptr_t)SLLV, 0);
+#else
+    genshift_var(shl_reg32_cl, true);
+#endif
+}
+
+void gensrlv()
+{
+#ifdef INTERPRET_SRLV
+    gencallinterp((uintptr_t)SRLV, 0);
+#else
+    genshift_var(shr_reg32_cl, true);
+#endif
+}
+
+void gensrav()
+{
+#ifdef INTERPRET_SRAV
+    gencallinterp((uintptr_t)SRAV, 0);
+#else
+    genshift_var(sar_reg32_cl, true);
+#endif
+}
+
+// Indirect jumps always leave the block through dyna_jump_out, which looks up the target block
+static void genjump_reg(void (*op)(), bool link)
+{
+    if (genjump_interp_fallback())
+    {
+        gencallinterp((uintptr_t)op, 1);
+        return;
+    }
+
+    free_all_registers();
+    simplify_access();
+    mov_reg32_m32(RAX, (uint32_t*)dst->f.r.rs);
+    mov_m32_reg32(&local_rs, RAX);
+
+    gendelayslot();
+
+    if (link)
+        mov_m64_imm32((dst - 1)->f.r.rd, (int32_t)(dst->addr + 4));
+
+    mov_reg32_m32(RAX, &local_rs);
+    mov_m32_reg32(&last_addr, RAX);
+
+    gencheck_interrupt_reg();
+
+    mov_reg32_m32(RAX, &local_rs);
+    mov_m32_reg32(&jump_to_address, RAX);
+    mov_m_ptr(&PC, dst + 1);
+    gencall((void*)dyna_jump_out);
+}
+
+void genjr()
+{
+#ifdef INTERPRET_JR
+    gencallinterp((uintptr_t)JR, 1);
+#else
+    genjump_reg(JR, false);
+#endif
+}
+
+void genjalr()
+{
+#ifdef INTERPRET_JALR
+    gencallinterp((uintptr_t)JALR, 0);
+#else
+    genjump_reg(JALR, true);
+#endif
+}
+
+void gensyscall()
+{
+#ifdef INTERPRET_SYSCALL
+    gencallinterp((uintptr_t)SYSCALL, 0);
+#else
+    free_all_registers();
+    simplify_access();
+    mov_m32_imm32(&core_Cause, 8 << 2);
+    gencallinterp((uintptr_t)exception_general, 0);
+#endif
+}
+
+void gensync()
+{
+}
+
+void genmfhi()
+{
+#ifdef INTERPRET_MFHI
+    gencallinterp((uintptr_t)MFHI, 0);
+#else
+    genmove((uint64_t*)dst->f.r.rd, (uint64_t*)&hi);
+#endif
+}
+
+void genmthi()
+{
+#ifdef INTERPRET_MTHI
+    gencallinterp((uintptr_t)MTHI, 0);
+#else
+    genmove((uint64_t*)&hi, (uint64_t*)dst->f.r.rs);
+#endif
+}
+
+void genmflo()
+{
+#ifdef INTERPRET_MFLO
+    gencallinterp((uintptr_t)MFLO, 0);
+#else
+    genmove((uint64_t*)dst->f.r.rd, (uint64_t*)&lo);
+#endif
+}
+
+void genmtlo()
+{
+#ifdef INTERPRET_MTLO
+    gencallinterp((uintptr_t)MTLO, 0);
+#else
+    genmove((uint64_t*)&lo, (uint64_t*)dst->f.r.rs);
+#endif
+}
+
+void gendsllv()
+{
+#ifdef INTERPRET_DSLLV
+    gencallinterp((uintptr_t)DSLLV, 0);
+#else
+    genshift_var(shl_reg64_cl, false);
+#endif
+}
+
+void gendsrlv()
+{
+#ifdef INTERPRET_DSRLV
+    gencallinterp((uintptr_t)DSRLV, 0);
+#else
+    genshift_var(shr_reg64_cl, false);
+#endif
+}
+
+void gendsrav()
+{
+#ifdef INTERPRET_DSRAV
+    gencallinterp((uintptr_t)DSRAV, 0);
+#else
+    genshift_var(sar_reg64_cl, false);
+#endif
+}
+
+// hi:lo = rs * rt, both operands are extended to 64 bits beforehand so the low half of the product is enough
+static void genmul32(bool is_signed)
+{
+    int32_t rs = allocate_register((uint64_t*)dst->f.r.rs);
+    int32_t rt = allocate_register((uint64_t*)dst->f.r.rt);
+    int32_t lo_reg = allocate_register_w((uint64_t*)&lo);
+    int32_t hi_reg = allocate_register_w((uint64_t*)&hi);
+
+    if (is_signed)
+    {
+        mov_reg64_reg64(lo_reg, rs);
+        mov_reg64_reg64(hi_reg, rt);
+    }
+    else
+    {
+        mov_reg32_reg32(lo_reg, rs);
+        mov_reg32_reg32(hi_reg, rt);
+    }
+    imul_reg64_reg64(lo_reg, hi_reg);
+    mov_reg64_reg64(hi_reg, lo_reg);
+    sar_reg64_imm8(hi_reg, 32);
+    movsxd_reg64_reg32(lo_reg, lo_reg);
+}
+
+void genmult()
+{
+#ifdef INTERPRET_MULT
+    gencallinterp((uintptr_t)MULT, 0);
+#else
+    genmul32(true);
+#endif
+}
+
+void genmultu()
+{
+#ifdef INTERPRET_MULTU
+    gencallinterp((uintptr_t)MULTU, 0);
+#else
+    genmul32(false);
+#endif
+}
+
+void gendiv()
+{
+    gencallinterp((uintptr_t)DIV, 0);
+}
+
+void gendivu()
+{
+    gencallinterp((uintptr_t)DIVU, 0);
+}
+
+void gendmult()
+{
+    gencallinterp((uintptr_t)DMULT, 0);
+}
+
+void gendmultu()
+{
+    gencallinterp((uintptr_t)DMULTU, 0);
+}
+
+void genddiv()
+{
+    gencallinterp((uintptr_t)DDIV, 0);
+}
+
+void genddivu()
+{
+    gencallinterp((uintptr_t)DDIVU, 0);
+}
+
+void genadd()
+{
+#ifdef INTERPRET_ADD
+    gencallinterp((uintptr_t)ADD, 0);
+#else
+    genalu(add_reg64_reg64, true, true);
+#endif
+}
+
+void genaddu()
+{
+#ifdef INTERPRET_ADDU
+    gencallinterp((uintptr_t)ADDU, 0);
+#else
+    genalu(add_reg64_reg64, true, true);
+#endif
+}
+
+void gensub()
+{
+#ifdef INTERPRET_SUB
+    gencallinterp((uintptr_t)SUB, 0);
+#else
+    genalu(sub_reg64_reg64, false, true);
+#endif
+}
+
+void gensubu()
+{
+#ifdef INTERPRET_SUBU
+    gencallinterp((uintptr_t)SUBU, 0);
+#else
+    genalu(sub_reg64_reg64, false, true);
+#endif
+}
+
+void genand()
+{
+#ifdef INTERPRET_AND
+    gencallinterp((uintptr_t)AND, 0);
+#else
+    genalu(and_reg64_reg64, true, false);
+#endif
+}
+
+void genor()
+{
+#ifdef INTERPRET_OR
+    gencallinterp((uintptr_t)OR, 0);
+#else
+    genalu(or_reg64_reg64, true, false);
+#endif
+}
+
+void genxor()
+{
+#ifdef INTERPRET_XOR
+    gencallinterp((uintptr_t)XOR, 0);
+#else
+    genalu(xor_reg64_reg64, true, false);
+#endif
+}
+
+void gennor()
+{
+#ifdef INTERPRET_NOR
+    gencallinterp((uintptr_t)NOR, 0);
+#else
+    int32_t rd;
+    genalu(or_reg64_reg64, true, false);
+    rd = allocate_register_w((uint64_t*)dst->f.r.rd);
+    not_reg64(rd);
+#endif
+}
+
+void genslt()
+{
+#ifdef INTERPRET_SLT
+    gencallinterp((uintptr_t)SLT, 0);
+#else
+    genset_less(CC_L);
+#endif
+}
+
+void gensltu()
+{
+#ifdef INTERPRET_SLTU
+    gencallinterp((uintptr_t)SLTU, 0);
+#else
+    genset_less(CC_B);
+#endif
+}
+
+void gendadd()
+{
+#ifdef INTERPRET_DADD
+    gencallinterp((uintptr_t)DADD, 0);
+#else
+    genalu(add_reg64_reg64, true, false);
+#endif
+}
+
+void gendaddu()
+{
+#ifdef INTERPRET_DADDU
+    gencallinterp((uintptr_t)DADDU, 0);
+#else
+    genalu(add_reg64_reg64, true, false);
+#endif
+}
+
+void gendsub()
+{
+#ifdef INTERPRET_DSUB
+    gencallinterp((uintptr_t)DSUB, 0);
+#else
+    genalu(sub_reg64_reg64, false, false);
+#endif
+}
+
+void gendsubu()
+{
+#ifdef INTERPRET_DSUBU
+    gencallinterp((uintptr_t)DSUBU, 0);
+#else
+    genalu(sub_reg64_reg64, false, false);
+#endif
+}
+
+void genteq()
+{
+    gencallinterp((uintptr_t)TEQ, 0);
+}
+
+void gendsll()
+{
+#ifdef INTERPRET_DSLL
+    gencallinterp((uintptr_t)DSLL, 0);
+#else
+    genshift_imm(shl_reg64_imm8, dst->f.r.sa, false);
+#endif
+}
+
+void gendsrl()
+{
+#ifdef INTERPRET_DSRL
+    gencallinterp((uintptr_t)DSRL, 0);
+#else
+    genshift_imm(shr_reg64_imm8, dst->f.r.sa, false);
+#endif
+}
+
+void gendsra()
+{
+#ifdef INTERPRET_DSRA
+    gencallinterp((uintptr_t)DSRA, 0);
+#else
+    genshift_imm(sar_reg64_imm8, dst->f.r.sa, false);
+#endif
+}
+
+void gendsll32()
+{
+#ifdef INTERPRET_DSLL32
+    gencallinterp((uintptr_t)DSLL32, 0);
+#else
+    genshift_imm(shl_reg64_imm8, dst->f.r.sa + 32, false);
+#endif
+}
+
+void gendsrl32()
+{
+#ifdef INTERPRET_DSRL32
+    gencallinterp((uintptr_t)DSRL32, 0);
+#else
+    genshift_imm(shr_reg64_imm8, dst->f.r.sa + 32, false);
+#endif
+}
+
+void gendsra32()
+{
+#ifdef INTERPRET_DSRA32
+    gencallinterp((uintptr_t)DSRA32, 0);
+#else
+    genshift_imm(sar_reg64_imm8, dst->f.r.sa + 32, false);
+#endif
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <core/r4300/ops.h>
+#include <core/r4300/recomph.h>
+
+void gentlbwi()
+{
+    gencallinterp((uintptr_t)TLBWI, 0);
+}
+
+void gentlbp()
+{
+    gencallinterp((uintptr_t)TLBP, 0);
+}
+
+void gentlbr()
+{
+    gencallinterp((uintptr_t)TLBR, 0);
+}
+
+void generet()
+{
+    gencallinterp((uintptr_t)ERET, 1);
+}
+
+void gentlbwr()
+{
+    gencallinterp((uintptr_t)TLBWR, 0);
+}
@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include "regcache.h"
+#include <core/r4300/r4300.h>
+#include <core/r4300/recomp.h>
+#include <core/r4300/recomph.h>
+
+#define LOCKED_ACCESS ((precomp_instr*)UINTPTR_MAX)
+
+static uint64_t* reg_content[16];
+static precomp_instr* last_access[16];
+static precomp_instr* free_since[16];
+static int32_t dirty[16];
+static uint64_t* r0;
+
+// RSP, RBASE and RSCRATCH are never handed out
+static bool is_allocatable(int32_t reg)
+{
+    return reg != RSP && reg != RBASE && reg != RSCRATCH;
+}
+
+static void forget_needed_since(int32_t reg)
+{
+    while (free_since[reg] <= dst)
+    {
+        free_since[reg]->reg_cache_infos.needed_registers[reg] = NULL;
+        free_since[reg]++;
+    }
+}
+
+static void mark_needed_until_dst(int32_t reg)
+{
+    precomp_instr* last = last_access[reg] + 1;
+
+    while (last <= dst)
+    {
+        last->reg_cache_infos.needed_registers[reg] = reg_content[reg];
+        last++;
+    }
+    last_access[reg] = dst;
+}
+
+static void load_register(int32_t reg, uint64_t* addr)
+{
+    if (addr == r0)
+        xor_reg32_reg32(reg, reg);
+    else
+        mov_reg64_m64(reg, addr);
+}
+
+void init_cache(precomp_instr* start)
+{
+    int32_t i;
+    for (i = 0; i < 16; i++)
+    {
+        last_access[i] = NULL;
+        free_since[i] = start;
+        dirty[i] = 0;
+    }
+    r0 = (uint64_t*)reg;
+}
+
+void free_all_registers()
+{
+    int32_t i;
+    for (i = 0; i < 16; i++)
+    {
+        if (last_access[i])
+            free_register(i);
+        else
+            forget_needed_since(i);
+    }
+}
+
+// this function frees a specific X64 GPR
+void free_register(int32_t reg)
+{
+    precomp_instr* last;
+
+    if (last_access[reg] == LOCKED_ACCESS)
+        return;
+
+    if (last_access[reg] != NULL)
+        last = last_access[reg] + 1;
+    else
+        last = free_since[reg];
+
+    while (last <= dst)
+    {
+        if (last_access[reg] != NULL && dirty[reg])
+            last->reg_cache_infos.needed_registers[reg] = reg_content[reg];
+        else
+            last->reg_cache_infos.needed_registers[reg] = NULL;
+        last++;
+    }
+    if (last_access[reg] == NULL)
+    {
+        free_since[reg] = dst + 1;
+        return;
+    }
+
+    if (dirty[reg])
+        mov_m64_reg64(reg_content[reg], reg);
+
+    last_access[reg] = NULL;
+    free_since[reg] = dst + 1;
+}
+
+int32_t lru_register()
+{
+    return lru_register_exc1(-1);
+}
+
+int32_t lru_register_exc1(int32_t exc1)
+{
+    uintptr_t oldest_access = UINTPTR_MAX;
+    int32_t i, reg = 0;
+    for (i = 0; i < 16; i++)
+    {
+        if (is_allocatable(i) && i != exc1 && (uintptr_t)last_access[i] < oldest_access)
+        {
+            oldest_access = (uintptr_t)last_access[i];
+            reg = i;
+        }
+    }
+    return reg;
+}
+
+static int32_t find_cached(uint64_t* addr)
+{
+    int32_t i;
+    for (i = 0; i < 16; i++)
+    {
+        if (last_access[i] != NULL && last_access[i] != LOCKED_ACCESS && reg_content[i] == addr)
+            return i;
+    }
+    return -1;
+}
+
+static void evict(int32_t reg)
+{
+    if (last_access[reg])
+        free_register(reg);
+    else
+        forget_needed_since(reg);
+}
+
+// this function finds a register to put the data contained in addr,
+// if there was another value before it's cleanly removed of the
+// register cache. After that, the register number is returned.
+// If data are already cached, the function only returns the register number
+int32_t allocate_register(uint64_t* addr)
+{
+    int32_t reg;
+
+    if (addr != NULL && (reg = find_cached(addr)) != -1)
+    {
+        mark_needed_until_dst(reg);
+        return reg;
+    }
+
+    reg = lru_register();
+    evict(reg);
+
+    last_access[reg] = dst;
+    reg_content[reg] = addr;
+    dirty[reg] = 0;
+
+    if (addr != NULL)
+        load_register(reg, addr);
+
+    return reg;
+}
+
+int32_t allocate_register_w(uint64_t* addr)
+{
+    int32_t reg;
+
+    if ((reg = find_cached(addr)) != -1)
+    {
+        precomp_instr* last = last_access[reg] + 1;
+
+        while (last <= dst)
+        {
+            last->reg_cache_infos.needed_registers[reg] = NULL;
+            last++;
+        }
+        last_access[reg] = dst;
+        dirty[reg] = 1;
+        return reg;
+    }
+
+    reg = lru_register();
+    evict(reg);
+
+    last_access[reg] = dst;
+    reg_content[reg] = addr;
+    dirty[reg] = 1;
+
+    return reg;
+}
+
+void set_register_state(int32_t reg, uint64_t* addr, int32_t d)
+{
+    last_access[reg] = dst;
+    reg_content[reg] = addr;
+    dirty[reg] = d;
+}
+
+void lock_register(int32_t reg)
+{
+    free_register(reg);
+    last_access[reg] = LOCKED_ACCESS;
+    reg_content[reg] = NULL;
+    dirty[reg] = 0;
+}
+
+void unlock_register(int32_t reg)
+{
+    last_access[reg] = NULL;
+    free_since[reg] = dst + 1;
+}
+
+void allocate_register_manually(int32_t reg, uint64_t* addr)
+{
+    int32_t i;
+
+    if (last_access[reg] != NULL && last_access[reg] != LOCKED_ACCESS && reg_content[reg] == addr)
+    {
+        mark_needed_until_dst(reg);
+        return;
+    }
+
+    evict(reg);
+
+    // is it already cached ?
+    if ((i = find_cached(addr)) != -1)
+    {
+        mark_needed_until_dst(i);
+
+        mov_reg64_reg64(reg, i);
+        last_access[reg] = dst;
+        dirty[reg] = dirty[i];
+        reg_content[reg] = reg_content[i];
+        free_since[i] = dst + 1;
+        last_access[i] = NULL;
+        return;
+    }
+
+    last_access[reg] = dst;
+    reg_content[reg] = addr;
+    dirty[reg] = 0;
+
+    if (addr != NULL)
+        load_register(reg, addr);
+}
+
+void allocate_register_manually_w(int32_t reg, uint64_t* addr, int32_t load)
+{
+    int32_t i;
+
+    if (last_access[reg] != NULL && last_access[reg] != LOCKED_ACCESS && reg_content[reg] == addr)
+    {
+        mark_needed_until_dst(reg);
+        dirty[reg] = 1;
+        return;
+    }
+
+    evict(reg);
+
+    // is it already cached ?
+    if ((i = find_cached(addr)) != -1)
+    {
+        mark_needed_until_dst(i);
+
+        if (load)
+            mov_reg64_reg64(reg, i);
+        last_access[reg] = dst;
+        dirty[reg] = 1;
+        reg_content[reg] = reg_content[i];
+        free_since[i] = dst + 1;
+        last_access[i] = NULL;
+        return;
+    }
+
+    last_access[reg] = dst;
+    reg_content[reg] = addr;
+    dirty[reg] = 1;
+
+    if (addr != NULL && load)
+        load_register(reg, addr);
+}
+
+// Wrappers are appended to the block's code, so unlike on x86 they move along with it when the code buffer grows:
+// mov reg, [RBASE + disp32]   (for each needed register)
+// jmp local_addr
+static void build_wrapper(precomp_instr* instr)
+{
+    int32_t i;
+
+    instr->reg_cache_infos.jump_wrapper = code_length;
+    for (i = 0; i < 16; i++)
+    {
+        if (instr->reg_cache_infos.needed_registers[i] != NULL)
+            mov_reg64_m64(i, instr->reg_cache_infos.needed_registers[i]);
+    }
+    jmp_near_rj(instr->local_addr - (code_length + 5));
+}
+
+void build_wrappers(precomp_instr* instr, int32_t start, int32_t end, precomp_block* block)
+{
+    int32_t i, reg;
+    for (i = start; i < end; i++)
+    {
+        instr[i].reg_cache_infos.need_map = 0;
+        for (reg = 0; reg < 16; reg++)
+        {
+            if (instr[i].reg_cache_infos.needed_registers[reg] != NULL)
+            {
+                instr[i].reg_cache_infos.need_map = 1;
+                build_wrapper(&instr[i]);
+                break;
+            }
+        }
+    }
+}
+
+void simplify_access()
+{
+    int32_t i;
+    dst->local_addr = code_length;
+    for (i = 0; i < 16; i++)
+        dst->reg_cache_infos.needed_registers[i] = NULL;
+}
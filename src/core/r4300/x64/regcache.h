@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <core/r4300/recomp.h>
+
+// Unlike the x86 register cache, every host register holds a full 64-bit MIPS register,
+// so there are no register pairs to keep track of.
+
+void init_cache(precomp_instr* start);
+void free_all_registers();
+void free_register(int32_t reg);
+int32_t allocate_register(uint64_t* addr);
+int32_t allocate_register_w(uint64_t* addr);
+void build_wrappers(precomp_instr*, int32_t, int32_t, precomp_block*);
+int32_t lru_register();
+int32_t lru_register_exc1(int32_t exc1);
+void set_register_state(int32_t reg, uint64_t* addr, int32_t dirty);
+void lock_register(int32_t reg);
+void unlock_register(int32_t reg);
+void allocate_register_manually(int32_t reg, uint64_t* addr);
+void allocate_register_manually_w(int32_t reg, uint64_t* addr, int32_t load);
+void simplify_access();
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <core/Core.h>
+#include <core/r4300/ops.h>
+#include <core/r4300/r4300.h>
+#include <core/r4300/recomp.h>
+#include <core/r4300/recomph.h>
+
+// NOTE: dynarec isn't compatible with the game debugger
+
+// Recompiled code runs on a frame set up by the entry stub and never touches RSP itself,
+// so the return address of every call it makes lives in the same stack slot.
+// Leaving the recompiled code is done by pointing that slot at the exit stub instead of longjmp'ing,
+// as unwinding through code without unwind info isn't possible on x64 Windows.
+static void (*g_entry_stub)(void (*)()) = nullptr;
+static unsigned char* g_exit_stub = nullptr;
+static bool g_dyna_stopping = false;
+
+static void build_stubs()
+{
+    constexpr unsigned char push_callee_saved[] = {
+    0x53, // push rbx
+    0x55, // push rbp
+    0x56, // push rsi
+    0x57, // push rdi
+    0x41, 0x54, // push r12
+    0x41, 0x55, // push r13
+    0x41, 0x56, // push r14
+    0x41, 0x57, // push r15
+    0x48, 0x83, 0xEC, 0x28, // sub rsp, 40 (shadow space + alignment)
+    };
+    constexpr unsigned char pop_callee_saved[] = {
+    0x48, 0x83, 0xC4, 0x28, // add rsp, 40
+    0x41, 0x5F, // pop r15
+    0x41, 0x5E, // pop r14
+    0x41, 0x5D, // pop r13
+    0x41, 0x5C, // pop r12
+    0x5F, // pop rdi
+    0x5E, // pop rsi
+    0x5D, // pop rbp
+    0x5B, // pop rbx
+    0xC3, // ret
+    };
+
+    unsigned char* code = alloc_persistent_code(128);
+    size_t i = 0;
+
+    memcpy(code, push_callee_saved, sizeof(push_callee_saved));
+    i += sizeof(push_callee_saved);
+
+    // mov r15, base
+    code[i++] = 0x49;
+    code[i++] = 0xBF;
+    *(uint64_t*)&code[i] = get_base_address();
+    i += 8;
+
+    // lea rax, [rsp - 8]
+    code[i++] = 0x48;
+    code[i++] = 0x8D;
+    code[i++] = 0x44;
+    code[i++] = 0x24;
+    code[i++] = 0xF8;
+
+    // mov r11, &return_address
+    code[i++] = 0x49;
+    code[i++] = 0xBB;
+    *(uint64_t*)&code[i] = (uint64_t)&return_address;
+    i += 8;
+
+    // mov [r11], rax
+    code[i++] = 0x49;
+    code[i++] = 0x89;
+    code[i++] = 0x03;
+
+    // jmp to the code passed as first argument
+    code[i++] = 0xFF;
+#ifdef _WIN32
+    code[i++] = 0xE1; // rcx
+#else
+    code[i++] = 0xE7; // rdi
+#endif
+
+    g_entry_stub = (void (*)(void (*)()))code;
+    g_exit_stub = code + i;
+    memcpy(g_exit_stub, pop_callee_saved, sizeof(pop_callee_saved));
+}
+
+void dyna_jump()
+{
+    if (g_dyna_stopping)
+        return;
+
+    if (PC->reg_cache_infos.need_map)
+        *return_address = (uintptr_t)(actual->code + PC->reg_cache_infos.jump_wrapper);
+    else
+        *return_address = (uintptr_t)(actual->code + PC->local_addr);
+}
+
+uint32_t link_distance;
+
+void dyna_check_code_arena()
+{
+    if (!is_code_arena_low())
+        return;
+
+    g_core->logger->info("[Core] Code arena is running low, flushing the code cache");
+
+    for (uint32_t i = 0; i < 0x100000; i++)
+    {
+        if (blocks[i] && blocks[i]->code)
+        {
+            free_code(blocks[i]->code);
+            blocks[i]->code = NULL;
+            blocks[i]->code_length = 0;
+            blocks[i]->max_code_length = 0;
+            invalid_code[i] = 1;
+        }
+    }
+}
+
+void dyna_jump_out()
+{
+    jump_to_func();
+}
+
+void dyna_jump_link()
+{
+    unsigned char* site = (unsigned char*)*return_address - link_distance;
+    const uint32_t addr = jump_to_address;
+    const uint32_t generation = get_code_generation();
+
+    dyna_jump_out();
+
+    // The site may have been discarded or moved while the target was compiled, in which case it's linked the next time
+    if (g_dyna_stopping || skip_jump || generation != get_code_generation())
+        return;
+
+    // Only RDRAM isn't subject to the TLB, and the linked path only checks the target page for invalidation
+    if (addr < 0x80000000 || addr >= 0xC0000000 || (addr & 0x1FFFFFFF) >= 0x800000)
+        return;
+
+    // Linking to a stub would recompile the target on every jump
+    if (PC->ops == NOTCOMPILED || PC->ops == NOTCOMPILED2)
+        return;
+
+    link_code(site, (unsigned char*)*return_address, actual, PC);
+}
+
+void dyna_unlink_block(precomp_block* block)
+{
+    if (block->code)
+    {
+        unlink_code(block->code, block->max_code_length);
+    }
+}
+
+void dyna_start(void (*code)())
+{
+    core_executing = true;
+    g_core->callbacks.core_executing_changed(core_executing);
+    g_core->logger->info(L"core_executing: {}", (bool)core_executing);
+
+    if (!g_entry_stub)
+    {
+        build_stubs();
+    }
+
+    g_dyna_stopping = false;
+    g_entry_stub(code);
+}
+
+void dyna_stop()
+{
+    // The C function called by the recompiled code will return into the exit stub, which returns from dyna_start()
+    g_dyna_stopping = true;
+    *return_address = (uintptr_t)g_exit_stub;
+}
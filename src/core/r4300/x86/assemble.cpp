@@ -6,9 +6,16 @@
 
 #include "stdafx.h"
 #include "assemble.h"
+#include <core/Core.h>
 #include <core/r4300/recomph.h>
 #include <core/r4300/x86/regcache.h>
 
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
 typedef struct _jump_table
 {
     uint32_t mi_addr;
@@ -18,6 +25,229 @@ typedef struct _jump_table
 static jump_table* jumps_table = NULL;
 static int32_t jumps_number, max_jumps_number;
 
+// All recompiled code lives in one reserved arena, so blocks which call each other stay close in memory.
+// Code is bump allocated and only reclaimed as a whole, once every allocation was freed.
+// The arena is smaller than on x64 to leave room in the 32-bit address space.
+constexpr size_t CODE_ARENA_SIZE = 64 * 1024 * 1024;
+
+// Once less than this is left, the code cache is flushed at the next block exit.
+// It's large enough to never run out while recompiling a single block.
+constexpr size_t CODE_ARENA_RESERVE = 8 * 1024 * 1024;
+
+// The granularity in which the arena is committed
+constexpr size_t CODE_COMMIT_GRANULARITY = 1024 * 1024;
+
+// Each allocation is preceded by a header holding its size
+constexpr size_t CODE_HEADER_SIZE = 16;
+
+typedef struct _code_link
+{
+    // The link site in the calling block's code
+    unsigned char* site;
+    // The code the site jumps to
+    unsigned char* target;
+    // The displacement of the site's jump to the dispatcher
+    unsigned char skip;
+} code_link;
+
+static unsigned char* g_code_arena = nullptr;
+static size_t g_code_used = 0;
+static size_t g_code_committed = 0;
+static size_t g_code_live = 0;
+
+// The latest allocation, which can grow in place
+static unsigned char* g_code_last = nullptr;
+
+static std::vector<code_link> g_code_links;
+static uint32_t g_code_generation = 0;
+
+static bool commit_code(size_t offset, size_t size)
+{
+#ifdef _WIN32
+    return VirtualAlloc(g_code_arena + offset, size, MEM_COMMIT, PAGE_EXECUTE_READWRITE) != nullptr;
+#else
+    // Anonymous mappings are backed lazily anyway
+    return true;
+#endif
+}
+
+static bool reserve_code_arena()
+{
+    if (g_code_arena)
+    {
+        return true;
+    }
+
+#ifdef _WIN32
+    g_code_arena = (unsigned char*)VirtualAlloc(nullptr, CODE_ARENA_SIZE, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void* mem = mmap(nullptr, CODE_ARENA_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    g_code_arena = mem == MAP_FAILED ? nullptr : (unsigned char*)mem;
+#endif
+
+    if (!g_code_arena)
+    {
+        g_core->logger->error("[Core] Failed to reserve the code arena");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Moves the bump pointer to the specified offset, committing the arena up to it.
+ */
+static bool bump_code(size_t end)
+{
+    if (end > CODE_ARENA_SIZE)
+    {
+        g_core->logger->error("[Core] Code arena exhausted");
+        return false;
+    }
+
+    if (end > g_code_committed)
+    {
+        const size_t committed = std::min((end + CODE_COMMIT_GRANULARITY - 1) & ~(CODE_COMMIT_GRANULARITY - 1), CODE_ARENA_SIZE);
+        if (!commit_code(g_code_committed, committed - g_code_committed))
+        {
+            g_core->logger->error("[Core] Failed to commit the code arena");
+            return false;
+        }
+        g_code_committed = committed;
+    }
+
+    g_code_used = end;
+    return true;
+}
+
+static void unlink_code_link(const code_link& link)
+{
+    link.site[0] = 0xEB;
+    link.site[1] = link.skip;
+}
+
+unsigned char* alloc_code(size_t size)
+{
+    if (!reserve_code_arena())
+    {
+        return nullptr;
+    }
+
+    const size_t offset = (g_code_used + 15) & ~15;
+    if (!bump_code(offset + CODE_HEADER_SIZE + size))
+    {
+        return nullptr;
+    }
+
+    unsigned char* code = g_code_arena + offset + CODE_HEADER_SIZE;
+    *(size_t*)(code - CODE_HEADER_SIZE) = size;
+    g_code_last = code;
+    g_code_live++;
+    return code;
+}
+
+unsigned char* realloc_code(unsigned char* code, size_t size)
+{
+    if (!code)
+    {
+        return alloc_code(size);
+    }
+
+    const size_t old_size = *(size_t*)(code - CODE_HEADER_SIZE);
+
+    if (code == g_code_last)
+    {
+        if (!bump_code(code - g_code_arena + size))
+        {
+            return nullptr;
+        }
+        *(size_t*)(code - CODE_HEADER_SIZE) = size;
+        return code;
+    }
+
+    unsigned char* new_code = alloc_code(size);
+    if (!new_code)
+    {
+        return nullptr;
+    }
+    memcpy(new_code, code, std::min(size, old_size));
+
+    // Links into the old code are undone, while links from it move along with the code, as they're absolute
+    std::erase_if(g_code_links, [&](code_link& link) {
+        if (link.target >= code && link.target < code + old_size)
+        {
+            unlink_code_link(link);
+            return true;
+        }
+        if (link.site >= code && link.site < code + old_size)
+        {
+            link.site = new_code + (link.site - code);
+        }
+        return false;
+    });
+    g_code_generation++;
+
+    free_code(code);
+    return new_code;
+}
+
+void free_code(unsigned char* code)
+{
+    if (!code)
+    {
+        return;
+    }
+
+    if (--g_code_live == 0)
+    {
+        g_code_used = 0;
+        g_code_last = nullptr;
+        g_code_links.clear();
+        g_code_generation++;
+    }
+}
+
+bool is_code_arena_low()
+{
+    return g_code_used + CODE_ARENA_RESERVE > CODE_ARENA_SIZE;
+}
+
+void link_code(unsigned char* site, unsigned char* target, precomp_block* block, precomp_instr* instr)
+{
+    if (site[0] != 0xEB)
+    {
+        return;
+    }
+
+    *(uint32_t*)(site + LINK_BLOCK_OFFSET) = (uint32_t)block;
+    *(uint32_t*)(site + LINK_INSTR_OFFSET) = (uint32_t)instr;
+    *(uint32_t*)(site + LINK_TARGET_OFFSET) = (uint32_t)target;
+
+    g_code_links.push_back({site, target, site[1]});
+
+    // Replace the jump to the dispatcher with a 2-byte nop, falling through into the linked path
+    site[0] = 0x66;
+    site[1] = 0x90;
+}
+
+void unlink_code(unsigned char* code, size_t size)
+{
+    std::erase_if(g_code_links, [&](const code_link& link) {
+        if (link.target >= code && link.target < code + size)
+        {
+            unlink_code_link(link);
+            return true;
+        }
+        // Sites in the discarded code are about to be overwritten
+        return link.site >= code && link.site < code + size;
+    });
+    g_code_generation++;
+}
+
+uint32_t get_code_generation()
+{
+    return g_code_generation;
+}
+
 void init_assembler(void* block_jumps_table, int32_t block_jumps_number)
 {
     if (block_jumps_table)
@@ -82,7 +312,7 @@ inline void put8(unsigned char octet)
     if (code_length == max_code_length)
     {
         max_code_length += 1000;
-        *inst_pointer = (unsigned char*)realloc(*inst_pointer, max_code_length);
+        *inst_pointer = realloc_code(*inst_pointer, max_code_length);
     }
 }
 
@@ -91,7 +321,7 @@ inline void put32(uint32_t dword)
     if ((code_length + 4) >= max_code_length)
     {
         max_code_length += 1000;
-        *inst_pointer = (unsigned char*)realloc(*inst_pointer, max_code_length);
+        *inst_pointer = realloc_code(*inst_pointer, max_code_length);
     }
     *((uint32_t*)(&(*inst_pointer)[code_length])) = dword;
     code_length += 4;
@@ -102,7 +332,7 @@ inline void put16(uint16_t word)
     if ((code_length + 2) >= max_code_length)
     {
         max_code_length += 1000;
-        *inst_pointer = (unsigned char*)realloc(*inst_pointer, max_code_length);
+        *inst_pointer = realloc_code(*inst_pointer, max_code_length);
     }
     *((uint16_t*)(&(*inst_pointer)[code_length])) = word;
     code_length += 2;
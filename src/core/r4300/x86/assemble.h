@@ -41,8 +41,62 @@ typedef struct _reg_cache_struct
     int32_t need_cop1_check;
 } reg_cache_struct;
 
+/*
+ * Exits to other blocks start with a link site, which is patched to jump to the target block directly once it's compiled:
+ *  jmp short <dispatch>      ; replaced with a 2-byte nop while linked
+ *  mov eax, <block>
+ *  mov ecx, <instr>
+ *  mov edx, <target code>
+ *  <jump to dispatch if the target page or its mirror was invalidated>
+ *  mov [actual], eax
+ *  mov [PC], ecx
+ *  jmp edx
+ * dispatch:
+ *  <call dyna_jump_link>
+ */
+#define LINK_BLOCK_OFFSET 3
+#define LINK_INSTR_OFFSET 8
+#define LINK_TARGET_OFFSET 13
+
+typedef struct _precomp_instr precomp_instr;
+typedef struct _precomp_block precomp_block;
+
 extern int32_t branch_taken;
 
+/**
+ * The distance from a link site to the return address of its call to dyna_jump_link.
+ */
+extern uint32_t link_distance;
+
+/**
+ * \brief Leaves the block for the address in jump_to_address like jump_to_func, then links the calling site to the target block.
+ */
+void dyna_jump_link();
+
+/**
+ * \brief Gets whether the code arena is running low, so the code cache should be flushed
+ */
+bool is_code_arena_low();
+
+/**
+ * \brief Links a site to the specified code
+ * \param site The link site, which must be unlinked
+ * \param target The code to jump to
+ * \param block The block containing the code
+ * \param instr The instruction the code belongs to
+ */
+void link_code(unsigned char* site, unsigned char* target, precomp_block* block, precomp_instr* instr);
+
+/**
+ * \brief Undoes all links into the specified code and forgets the link sites in it
+ */
+void unlink_code(unsigned char* code, size_t size);
+
+/**
+ * \brief Gets a counter which is incremented whenever code is discarded, moved or unlinked
+ */
+uint32_t get_code_generation();
+
 void debug();
 
 
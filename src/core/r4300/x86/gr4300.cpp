@@ -70,7 +70,7 @@ void gendebug()
     mov_reg32_m32(EDI, (uint32_t*)&edi);
 }
 
-void gencallinterp(uint32_t addr, int32_t jump)
+void gencallinterp(uintptr_t addr, int32_t jump)
 {
     free_all_registers();
     simplify_access();
@@ -169,6 +169,41 @@ void gencheck_interrupt_reg() // addr is in EAX
     call_reg32(EAX); // 2
 }
 
+static void genjump_out(uint32_t naddr)
+{
+    // Only jumps to RDRAM can be linked, see dyna_jump_link
+    if (naddr < 0x80000000 || naddr >= 0xC0000000 || (naddr & 0x1FFFFFFF) >= 0x800000)
+    {
+        mov_m32_imm32(&jump_to_address, naddr);
+        mov_m32_imm32((uint32_t*)(&PC), (uint32_t)(dst + 1));
+        mov_reg32_imm32(EAX, (uint32_t)jump_to_func);
+        call_reg32(EAX);
+        return;
+    }
+
+    // The link site, see assemble.h
+    uint32_t site = code_length;
+    jmp_imm_short(47); // 2
+    mov_reg32_imm32(EAX, 0); // 5
+    mov_reg32_imm32(ECX, 0); // 5
+    mov_reg32_imm32(EDX, 0); // 5
+    cmp_m8_imm8((unsigned char*)&invalid_code[naddr >> 12], 0); // 7
+    jne_rj(23); // 2
+    cmp_m8_imm8((unsigned char*)&invalid_code[(naddr ^ 0x20000000) >> 12], 0); // 7
+    jne_rj(14); // 2
+    mov_m32_reg32((void*)(&actual), EAX); // 6
+    mov_m32_reg32((void*)(&PC), ECX); // 6
+    jmp_reg32(EDX); // 2
+
+    mov_m32_imm32(&jump_to_address, naddr);
+    mov_m32_imm32((uint32_t*)(&PC), (uint32_t)(dst + 1));
+    mov_m32_imm32(&link_distance, 0);
+    uint32_t distance = code_length;
+    mov_reg32_imm32(EAX, (uint32_t)dyna_jump_link);
+    call_reg32(EAX);
+    *(uint32_t*)(*inst_pointer + distance - 4) = code_length - site;
+}
+
 void gennop()
 {
 }
@@ -215,10 +250,7 @@ void genj_out()
 
     mov_m32_imm32((void*)(&last_addr), naddr);
     gencheck_interrupt_out(naddr);
-    mov_m32_imm32(&jump_to_address, naddr);
-    mov_m32_imm32((uint32_t*)(&PC), (uint32_t)(dst + 1));
-    mov_reg32_imm32(EAX, (uint32_t)jump_to_func);
-    call_reg32(EAX);
+    genjump_out(naddr);
 #endif
 }
 
@@ -302,10 +334,7 @@ void genjal_out()
 
     mov_m32_imm32((void*)(&last_addr), naddr);
     gencheck_interrupt_out(naddr);
-    mov_m32_imm32(&jump_to_address, naddr);
-    mov_m32_imm32((uint32_t*)(&PC), (uint32_t)(dst + 1));
-    mov_reg32_imm32(EAX, (uint32_t)jump_to_func);
-    call_reg32(EAX);
+    genjump_out(naddr);
 #endif
 }
 
@@ -449,10 +478,7 @@ void gentest_out()
     temp = code_length;
     mov_m32_imm32((void*)(&last_addr), dst->addr + (dst - 1)->f.i.immediate * 4);
     gencheck_interrupt_out(dst->addr + (dst - 1)->f.i.immediate * 4);
-    mov_m32_imm32(&jump_to_address, dst->addr + (dst - 1)->f.i.immediate * 4);
-    mov_m32_imm32((uint32_t*)(&PC), (uint32_t)(dst + 1));
-    mov_reg32_imm32(EAX, (uint32_t)jump_to_func);
-    call_reg32(EAX);
+    genjump_out(dst->addr + (dst - 1)->f.i.immediate * 4);
 
     temp2 = code_length;
     code_length = temp - 4;
@@ -1012,10 +1038,7 @@ void gentestl_out()
     gendelayslot();
     mov_m32_imm32((void*)(&last_addr), dst->addr + (dst - 1)->f.i.immediate * 4);
     gencheck_interrupt_out(dst->addr + (dst - 1)->f.i.immediate * 4);
-    mov_m32_imm32(&jump_to_address, dst->addr + (dst - 1)->f.i.immediate * 4);
-    mov_m32_imm32((uint32_t*)(&PC), (uint32_t)(dst + 1));
-    mov_reg32_imm32(EAX, (uint32_t)jump_to_func);
-    call_reg32(EAX);
+    genjump_out(dst->addr + (dst - 1)->f.i.immediate * 4);
 
     temp2 = code_length;
     code_length = temp - 4;
@@ -1722,7 +1745,7 @@ inline void put8gr(unsigned char octet)
     if (code_length == max_code_length)
     {
         max_code_length += 1000;
-        *inst_pointer = (unsigned char*)realloc(*inst_pointer, max_code_length);
+        *inst_pointer = realloc_code(*inst_pointer, max_code_length);
     }
 }
 
@@ -9,6 +9,8 @@
 #include <core/r4300/r4300.h>
 #include <core/r4300/recomp.h>
 #include <core/r4300/recomph.h>
+#include <core/r4300/ops.h>
+#include <core/r4300/x86/assemble.h>
 
 // NOTE: dynarec isn't compatible with the game debugger
 
@@ -40,3 +42,57 @@ void dyna_stop()
 {
     longjmp(g_jmp_state, 1); // goto dyna_start()
 }
+
+uint32_t link_distance;
+
+void dyna_check_code_arena()
+{
+    if (!is_code_arena_low())
+        return;
+
+    g_core->logger->info("[Core] Code arena is running low, flushing the code cache");
+
+    for (uint32_t i = 0; i < 0x100000; i++)
+    {
+        if (blocks[i] && blocks[i]->code)
+        {
+            free_code(blocks[i]->code);
+            blocks[i]->code = NULL;
+            blocks[i]->code_length = 0;
+            blocks[i]->max_code_length = 0;
+            invalid_code[i] = 1;
+        }
+    }
+}
+
+void dyna_jump_link()
+{
+    unsigned char* site = (unsigned char*)*return_address - link_distance;
+    const uint32_t addr = jump_to_address;
+    const uint32_t generation = get_code_generation();
+
+    jump_to_func();
+
+    // The site may have been discarded or moved while the target was compiled, in which case it's linked the next time
+    if (stop || skip_jump || generation != get_code_generation())
+        return;
+
+    // Only RDRAM isn't subject to the TLB, and the linked path only checks the target page for invalidation
+    if (addr < 0x80000000 || addr >= 0xC0000000 || (addr & 0x1FFFFFFF) >= 0x800000)
+        return;
+
+    // Linking to a stub would recompile the target on every jump.
+    // Jump wrappers live outside of the block's code, so links to them couldn't be undone along with it.
+    if (PC->ops == NOTCOMPILED || PC->ops == NOTCOMPILED2 || PC->reg_cache_infos.need_map)
+        return;
+
+    link_code(site, (unsigned char*)*return_address, actual, PC);
+}
+
+void dyna_unlink_block(precomp_block* block)
+{
+    if (block->code)
+    {
+        unlink_code(block->code, block->max_code_length);
+    }
+}
@@ -40,5 +40,6 @@
 #include <stack>
 #include <deque>
 #include <numeric>
+#include <bit>
 #include <spdlog/logger.h>
 #include <IOHelpers.h>
\ No newline at end of file
@@ -599,6 +599,7 @@ mINI::INIStructure handle_config_ini(bool is_reading, mINI::INIStructure ini)
     HANDLE_P_VALUE(is_recent_scripts_frozen)
     HANDLE_P_VALUE(seek_savestate_interval)
     HANDLE_P_VALUE(seek_savestate_max_count)
+    HANDLE_P_VALUE(seek_savestate_max_size)
     HANDLE_P_VALUE(piano_roll_constrain_edit_to_column)
     HANDLE_P_VALUE(piano_roll_undo_stack_size)
     HANDLE_P_VALUE(piano_roll_keep_selection_visible)
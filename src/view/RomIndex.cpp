@@ -0,0 +1,396 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <FrontendService.h>
+#include <RomIndex.h>
+#include <gui/Loggers.h>
+
+/*
+ * Index file layout (little endian):
+ *  header: magic "M64R", version, entry count (u32 each)
+ *  entry: path length (u32), path (UTF-16), size (u64), mtime (i64), header (core_rom_header), has header (u8)
+ */
+
+namespace RomIndex
+{
+    constexpr uint32_t INDEX_MAGIC = 0x5234364D; // "M64R"
+    constexpr uint32_t INDEX_VERSION = 2;
+
+    // Locked when accessing the entries.
+    std::mutex g_index_mutex;
+
+    // Locked while updating, so concurrent updates don't scan the same files.
+    std::mutex g_update_mutex;
+
+    std::unordered_map<std::wstring, t_rom_index_entry> g_entries;
+
+    // The paths of the last update, in the order they were provided in.
+    std::vector<std::wstring> g_order;
+
+    bool g_loaded = false;
+    std::atomic<bool> g_updated = false;
+
+    std::filesystem::path get_index_path()
+    {
+        return FrontendService::get_app_path() / L"rom_index.bin";
+    }
+
+    /**
+     * Loads the index from disk. The index mutex must be held.
+     */
+    void load()
+    {
+        g_loaded = true;
+
+        FILE* f = _wfopen(get_index_path().c_str(), L"rb");
+        if (!f)
+        {
+            return;
+        }
+
+        std::vector<uint8_t> buf;
+        uint8_t chunk[0x10000];
+        size_t read;
+        while ((read = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        {
+            buf.insert(buf.end(), chunk, chunk + read);
+        }
+        fclose(f);
+
+        const uint8_t* end = buf.data() + buf.size();
+        uint8_t* ptr = buf.data();
+
+        const auto remaining = [&] {
+            return static_cast<size_t>(end - ptr);
+        };
+
+        uint32_t header[3];
+        if (remaining() < sizeof(header))
+        {
+            return;
+        }
+        memread(&ptr, header, sizeof(header));
+
+        if (header[0] != INDEX_MAGIC || header[1] != INDEX_VERSION)
+        {
+            g_view_logger->info("[RomIndex] Discarding index with unsupported version {}", header[1]);
+            return;
+        }
+
+        for (uint32_t i = 0; i < header[2]; ++i)
+        {
+            uint32_t path_len;
+            if (remaining() < sizeof(path_len))
+            {
+                break;
+            }
+            memread(&ptr, &path_len, sizeof(path_len));
+
+            constexpr size_t fixed_size = sizeof(uint64_t) + sizeof(int64_t) + sizeof(core_rom_header) + sizeof(uint8_t);
+            if (remaining() < path_len * sizeof(wchar_t) + fixed_size)
+            {
+                break;
+            }
+
+            t_rom_index_entry entry{};
+            entry.path.resize(path_len);
+            memread(&ptr, entry.path.data(), path_len * sizeof(wchar_t));
+            memread(&ptr, &entry.size, sizeof(entry.size));
+            memread(&ptr, &entry.mtime, sizeof(entry.mtime));
+            memread(&ptr, &entry.header, sizeof(entry.header));
+            uint8_t has_header;
+            memread(&ptr, &has_header, sizeof(has_header));
+            entry.has_header = has_header;
+
+            g_entries[entry.path] = std::move(entry);
+        }
+
+        g_view_logger->info("[RomIndex] Loaded {} entries", g_entries.size());
+    }
+
+    /**
+     * Writes the index to disk. The index mutex must be held.
+     */
+    void save()
+    {
+        std::vector<uint8_t> buf;
+
+        uint32_t header[3] = {INDEX_MAGIC, INDEX_VERSION, static_cast<uint32_t>(g_entries.size())};
+        vecwrite(buf, header, sizeof(header));
+
+        for (auto& [_, entry] : g_entries)
+        {
+            uint32_t path_len = entry.path.size();
+            vecwrite(buf, &path_len, sizeof(path_len));
+            vecwrite(buf, entry.path.data(), path_len * sizeof(wchar_t));
+            vecwrite(buf, &entry.size, sizeof(entry.size));
+            vecwrite(buf, &entry.mtime, sizeof(entry.mtime));
+            vecwrite(buf, &entry.header, sizeof(entry.header));
+            const uint8_t has_header = entry.has_header;
+            vecwrite(buf, &has_header, sizeof(has_header));
+        }
+
+        FILE* f = _wfopen(get_index_path().c_str(), L"wb");
+        if (!f)
+        {
+            g_view_logger->error("[RomIndex] Failed to write index");
+            return;
+        }
+        fwrite(buf.data(), 1, buf.size(), f);
+        fclose(f);
+    }
+
+    /**
+     * Gets a file's size and modification time.
+     * \return Whether the file exists.
+     */
+    bool stat_file(const std::wstring& path, uint64_t& size, int64_t& mtime)
+    {
+        std::error_code ec;
+        size = std::filesystem::file_size(path, ec);
+        if (ec)
+        {
+            return false;
+        }
+        mtime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        return !ec;
+    }
+
+    /**
+     * Brings ROM data into the big-endian byte order. Trailing bytes which don't form a whole word are left as-is.
+     */
+    void to_big_endian(uint8_t* data, size_t size)
+    {
+        const uint8_t first = data[0];
+        for (size_t i = 0; i + 4 <= size; i += 4)
+        {
+            if (first == 0x37)
+            {
+                std::swap(data[i], data[i + 1]);
+                std::swap(data[i + 2], data[i + 3]);
+            }
+            else if (first == 0x40)
+            {
+                std::swap(data[i], data[i + 3]);
+                std::swap(data[i + 1], data[i + 2]);
+            }
+        }
+    }
+
+    /**
+     * Reads a ROM file's header and builds its entry. Only the header is read, so scanning stays cheap on network storage.
+     * \return The entry, or nothing if the file couldn't be opened.
+     */
+    std::optional<t_rom_index_entry> scan_file(const std::wstring& path, uint64_t size, int64_t mtime)
+    {
+        FILE* f = _wfopen(path.c_str(), L"rb");
+        if (!f)
+        {
+            g_view_logger->info(L"[RomIndex] Failed to read file '{}'. Skipping!", path);
+            return std::nullopt;
+        }
+
+        t_rom_index_entry entry{
+        .path = path,
+        .size = size,
+        .mtime = mtime,
+        .header = {},
+        };
+
+        uint8_t header[sizeof(core_rom_header)];
+        entry.has_header = fread(header, 1, sizeof(header), f) == sizeof(header);
+        fclose(f);
+
+        if (entry.has_header)
+        {
+            to_big_endian(header, sizeof(header));
+            memcpy(&entry.header, header, sizeof(header));
+        }
+
+        return entry;
+    }
+
+    /**
+     * Rescans an entry if its file changed since it was indexed. The index mutex must be held.
+     * \return The entry, or null if the file is gone.
+     */
+    const t_rom_index_entry* revalidate(std::unordered_map<std::wstring, t_rom_index_entry>::iterator it)
+    {
+        uint64_t size;
+        int64_t mtime;
+        if (!stat_file(it->first, size, mtime))
+        {
+            g_entries.erase(it);
+            return nullptr;
+        }
+
+        if (it->second.size == size && it->second.mtime == mtime)
+        {
+            return &it->second;
+        }
+
+        auto entry = scan_file(it->first, size, mtime);
+        if (!entry.has_value())
+        {
+            g_entries.erase(it);
+            return nullptr;
+        }
+
+        it->second = std::move(entry.value());
+        return &it->second;
+    }
+
+    void update(const std::vector<std::wstring>& paths)
+    {
+        std::scoped_lock update_lock(g_update_mutex);
+
+        const auto start_time = std::chrono::high_resolution_clock::now();
+
+        struct t_pending {
+            std::wstring path;
+            uint64_t size;
+            int64_t mtime;
+        };
+
+        std::vector<t_pending> pending;
+        bool changed = false;
+
+        {
+            std::scoped_lock lock(g_index_mutex);
+
+            if (!g_loaded)
+            {
+                load();
+            }
+
+            std::vector<std::wstring> sorted_paths = paths;
+            std::ranges::sort(sorted_paths);
+            changed |= std::erase_if(g_entries, [&](const auto& pair) {
+                return !std::ranges::binary_search(sorted_paths, pair.first);
+            }) > 0;
+
+            for (const auto& path : paths)
+            {
+                uint64_t size;
+                int64_t mtime;
+                if (!stat_file(path, size, mtime))
+                {
+                    changed |= g_entries.erase(path) > 0;
+                    continue;
+                }
+
+                const auto it = g_entries.find(path);
+                if (it == g_entries.end() || it->second.size != size || it->second.mtime != mtime)
+                {
+                    pending.push_back({path, size, mtime});
+                }
+            }
+
+            g_order = paths;
+        }
+
+        // ROM libraries often live on network storage, so more workers than cores helps hide the latency
+        const size_t worker_count = std::min<size_t>(pending.size(), std::max(4u, std::thread::hardware_concurrency()));
+        std::atomic<size_t> next = 0;
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < worker_count; ++i)
+        {
+            workers.emplace_back([&] {
+                for (size_t j = next++; j < pending.size(); j = next++)
+                {
+                    const auto& file = pending[j];
+                    auto entry = scan_file(file.path, file.size, file.mtime);
+
+                    std::scoped_lock lock(g_index_mutex);
+                    if (entry.has_value())
+                    {
+                        g_entries[file.path] = std::move(entry.value());
+                    }
+                    else
+                    {
+                        g_entries.erase(file.path);
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        if (changed || !pending.empty())
+        {
+            std::scoped_lock lock(g_index_mutex);
+            save();
+        }
+
+        g_updated = true;
+
+        g_view_logger->info("[RomIndex] Scanned {} of {} files in {}ms", pending.size(), paths.size(), static_cast<int32_t>((std::chrono::high_resolution_clock::now() - start_time).count() / 1'000'000));
+    }
+
+    bool is_updated()
+    {
+        return g_updated;
+    }
+
+    std::vector<t_rom_index_entry> get_entries(const std::vector<std::wstring>& paths)
+    {
+        std::scoped_lock lock(g_index_mutex);
+
+        std::vector<t_rom_index_entry> entries;
+        entries.reserve(paths.size());
+
+        for (const auto& path : paths)
+        {
+            if (const auto it = g_entries.find(path); it != g_entries.end())
+            {
+                entries.push_back(it->second);
+            }
+        }
+
+        return entries;
+    }
+
+    std::optional<t_rom_index_entry> find(const std::function<bool(const core_rom_header&)>& predicate)
+    {
+        std::scoped_lock lock(g_index_mutex);
+
+        bool changed = false;
+        std::optional<t_rom_index_entry> result;
+
+        for (const auto& path : g_order)
+        {
+            // Files too small to hold a header aren't ROMs
+            const auto it = g_entries.find(path);
+            if (it == g_entries.end() || !it->second.has_header || !predicate(it->second.header))
+            {
+                continue;
+            }
+
+            // The file might have changed since the index was last updated, so the match is checked against the file before it's returned
+            const auto old_size = it->second.size;
+            const auto old_mtime = it->second.mtime;
+            const auto entry = revalidate(it);
+            changed |= !entry || entry->size != old_size || entry->mtime != old_mtime;
+
+            if (entry && entry->has_header && predicate(entry->header))
+            {
+                result = *entry;
+                break;
+            }
+        }
+
+        if (changed)
+        {
+            save();
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <core_api.h>
+
+/*
+ *	Persistent index of the ROMs found in the ROM directories.
+ *
+ *	Entries are keyed by path and invalidated when the file's size or modification time changes.
+ *	Stale and new files are scanned in parallel, and the index is written back to disk after each update.
+ */
+
+namespace RomIndex
+{
+    struct t_rom_index_entry {
+        std::wstring path;
+
+        /// The file's size in bytes.
+        uint64_t size;
+
+        /// The file's last write time, in file clock ticks.
+        int64_t mtime;
+
+        /// The ROM header, corrected to the big-endian byte order.
+        core_rom_header header;
+
+        /// Whether the file is large enough to hold a header. Files which aren't are kept in the index, but aren't ROMs.
+        bool has_header;
+    };
+
+    /**
+     * \brief Brings the index up to date with the specified ROM files, scanning the files which are new or changed since they were last indexed
+     * Entries of files not in the list are removed.
+     * \param paths The ROM files' paths
+     */
+    void update(const std::vector<std::wstring>& paths);
+
+    /**
+     * \brief Gets whether the index was updated during this session
+     */
+    bool is_updated();
+
+    /**
+     * \brief Gets the indexed entries of the specified ROM files, in the same order
+     * \param paths The ROM files' paths. Paths which aren't indexed are skipped.
+     */
+    std::vector<t_rom_index_entry> get_entries(const std::vector<std::wstring>& paths);
+
+    /**
+     * \brief Finds the first indexed ROM whose header matches the predicate. The match is rescanned first if its file changed since it was indexed.
+     * \param predicate A predicate which determines if the rom matches
+     * \return The rom's entry, or nothing if no rom was found
+     */
+    std::optional<t_rom_index_entry> find(const std::function<bool(const core_rom_header&)>& predicate);
+}
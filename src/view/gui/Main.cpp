@@ -693,26 +693,6 @@ void update_titlebar()
     SetWindowText(g_main_hwnd, text.c_str());
 }
 
-/**
- * \brief Computes the average rate of entries in the time queue per second (e.g.: FPS from frame deltas)
- * \param times A circular buffer of deltas
- * \return The average rate per second from the delta in the queue
- */
-static double get_rate_per_second_from_deltas(const std::span<core_timer_delta>& times)
-{
-    size_t count = 0;
-    double sum = 0.0;
-    for (const auto& time : times)
-    {
-        if (time.count() > 0.0)
-        {
-            sum += time.count() / 1000000.0;
-            count++;
-        }
-    }
-    return count > 0 ? 1000.0 / (sum / count) : 0.0;
-}
-
 #pragma region Change notifications
 
 void on_script_started(std::any data)
@@ -1316,16 +1296,11 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT Message, WPARAM wParam, LPARAM lParam)
             // We throttle FPS and VI/s visual updates to 1 per second, so no unstable values are displayed
             if (time - last_statusbar_update > std::chrono::seconds(1))
             {
-                g_core.g_frame_deltas_mutex.lock();
-                auto fps = get_rate_per_second_from_deltas(g_core.g_frame_deltas);
-                g_core.g_frame_deltas_mutex.unlock();
+                core_tm_stats stats{};
+                core_tm_get_stats(60, &stats);
 
-                g_core.g_vi_deltas_mutex.lock();
-                auto vis = get_rate_per_second_from_deltas(g_core.g_vi_deltas);
-                g_core.g_vi_deltas_mutex.unlock();
-
-                Statusbar::post(std::format(L"FPS: {:.1f}", fps), Statusbar::Section::FPS);
-                Statusbar::post(std::format(L"VI/s: {:.1f}", vis), Statusbar::Section::VIs);
+                Statusbar::post(std::format(L"FPS: {:.1f}", stats.frames_per_second), Statusbar::Section::FPS);
+                Statusbar::post(std::format(L"VI/s: {:.1f}", stats.vis_per_second), Statusbar::Section::VIs);
 
                 last_statusbar_update = time;
             }
@@ -1531,13 +1506,44 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT Message, WPARAM wParam, LPARAM lParam)
                         break;
                     }
 
-                    auto result = MessageBox(g_main_hwnd, L"Should the trace log be generated in a binary format?", L"Trace Logger",
-                                             MB_YESNO | MB_ICONQUESTION | MB_DEFBUTTON1);
+                    const auto result = FrontendService::show_multiple_choice_dialog(
+                    {L"Text", L"Binary", L"Compressed"},
+                    L"Which format should the trace log be generated in?\r\nCompressed logs slow down emulation the least, and can be converted to text afterwards.",
+                    L"Trace Logger",
+                    fsvc_information);
 
-                    core_tl_start(path, result == IDYES, false);
+                    const core_tl_format formats[] = {core_tl_format_text, core_tl_format_binary, core_tl_format_compressed};
+                    core_tl_start(path, formats[result], false);
                     ModifyMenu(g_main_menu, IDM_TRACELOG, MF_BYCOMMAND | MF_STRING, IDM_TRACELOG, L"Stop &Trace Logger");
                 }
                 break;
+            case IDM_TRACELOG_CONVERT:
+                {
+                    const auto src = show_persistent_open_dialog(L"o_tracelog", g_main_hwnd, L"*.log");
+
+                    if (src.empty())
+                    {
+                        break;
+                    }
+
+                    const auto dst = show_persistent_save_dialog(L"s_tracelog_text", g_main_hwnd, L"*.log");
+
+                    if (dst.empty())
+                    {
+                        break;
+                    }
+
+                    AsyncExecutor::invoke_async([=] {
+                        const auto result = core_tl_convert(src, dst);
+                        if (result != Res_Ok)
+                        {
+                            FrontendService::show_dialog(std::format(L"Failed to convert the trace log (error code {}).", (int32_t)result).c_str(), L"Trace Logger", fsvc_error);
+                            return;
+                        }
+                        FrontendService::show_statusbar(L"Converted trace log");
+                    });
+                }
+                break;
             case IDM_CLOSE_ROM:
                 if (!confirm_user_exit())
                     break;
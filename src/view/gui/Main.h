@@ -144,6 +144,7 @@ template <typename T>
 static void StoreRDRAMSafe(uint32_t addr, T value)
 {
     *((T*)((uint8_t*)g_core.rdram + ((ToAddr<T>(addr) & AddrMask)))) = value;
+    core_st_mark_rdram_dirty(ToAddr<T>(addr), sizeof(T));
 }
 
 
@@ -1123,6 +1123,13 @@ void get_config_listview_items(std::vector<t_options_group>& groups, std::vector
     },
     t_options_item{
     .group_id = seek_piano_roll_group.id,
+    .name = L"Savestate Memory Budget",
+    .tooltip = L"The maximum amount of memory in megabytes used by savestates for seeking.\nOlder savestates are compressed and thinned out to stay within this budget.\n0 - No limit\nRecommended: 512",
+    .data = &g_config.seek_savestate_max_size,
+    .type = t_options_item::Type::Number,
+    },
+    t_options_item{
+    .group_id = seek_piano_roll_group.id,
     .name = L"Constrain edit to column",
     .tooltip = L"Whether piano roll edits are constrained to the column they started on.",
     .data = &g_config.piano_roll_constrain_edit_to_column,
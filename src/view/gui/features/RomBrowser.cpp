@@ -18,6 +18,7 @@
 #include <gui/features/Statusbar.h>
 #include <helpers/IOHelpers.h>
 #include <IOService.h>
+#include <RomIndex.h>
 #include <AsyncExecutor.h>
 #include <Messenger.h>
 
@@ -234,6 +235,10 @@ namespace RomBrowser
 
         auto start_time = std::chrono::high_resolution_clock::now();
 
+        // the previous contents stay visible while the index is brought up to date
+        auto rom_paths = find_available_roms();
+        RomIndex::update(rom_paths);
+
         // we disable redrawing because it would repaint after every added rom otherwise,
         // which is slow and causes flicker
         SendMessage(rombrowser_hwnd, WM_SETREDRAW, FALSE, 0);
@@ -245,54 +250,28 @@ namespace RomBrowser
         }
         rombrowser_entries.clear();
 
-        auto rom_paths = find_available_roms();
-
         LV_ITEM lv_item = {0};
         lv_item.mask = LVIF_TEXT | LVIF_IMAGE | LVIF_PARAM;
         lv_item.pszText = LPSTR_TEXTCALLBACK;
 
         int32_t i = 0;
-        for (auto& path : rom_paths)
+        for (const auto& index_entry : RomIndex::get_entries(rom_paths))
         {
-            FILE* f = _wfopen(path.c_str(), L"rb");
-
-            if (!f)
-            {
-                g_view_logger->info(L"[Rombrowser] Failed to read file '{}'. Skipping!\n", path.c_str());
-                continue;
-            }
-
-            fseek(f, 0, SEEK_END);
-            const size_t len = ftell(f);
-            fseek(f, 0, SEEK_SET);
-
             auto rombrowser_entry = new t_rombrowser_entry;
-            rombrowser_entry->path = path;
-            rombrowser_entry->size = len;
-            rombrowser_entry->rom_header = {};
-
-            if (len > sizeof(core_rom_header))
-            {
-                core_rom_header header{};
-                fread(&header, sizeof(core_rom_header), 1, f);
-
-                core_vr_byteswap((uint8_t*)&header);
-
-                strtrim((char*)header.nom, sizeof(header.nom));
+            rombrowser_entry->path = index_entry.path;
+            rombrowser_entry->size = index_entry.size;
+            rombrowser_entry->rom_header = index_entry.header;
 
-                // We need this for later, because listview assumes it has a nul terminator
-                header.nom[sizeof(header.nom) - 1] = '\0';
+            strtrim((char*)rombrowser_entry->rom_header.nom, sizeof(rombrowser_entry->rom_header.nom));
 
-                rombrowser_entry->rom_header = header;
-            }
+            // We need this for later, because listview assumes it has a nul terminator
+            rombrowser_entry->rom_header.nom[sizeof(rombrowser_entry->rom_header.nom) - 1] = '\0';
 
             lv_item.lParam = i;
             lv_item.iItem = i;
             lv_item.iImage = rombrowser_country_code_to_image_index(rombrowser_entry->rom_header.Country_code);
             ListView_InsertItem(rombrowser_hwnd, &lv_item);
 
-            fclose(f);
-
             rombrowser_entries.push_back(rombrowser_entry);
             i++;
         }
@@ -414,36 +393,14 @@ namespace RomBrowser
 
     std::wstring find_available_rom(std::function<bool(const core_rom_header&)> predicate)
     {
-        auto rom_paths = find_available_roms();
-        for (auto rom_path : rom_paths)
+        // The rombrowser keeps the index up to date, so we only have to scan if it wasn't built yet
+        if (!RomIndex::is_updated())
         {
-            FILE* f = _wfopen(rom_path.c_str(), L"rb");
-
-            fseek(f, 0, SEEK_END);
-            uint64_t len = ftell(f);
-            fseek(f, 0, SEEK_SET);
-
-            if (len > sizeof(core_rom_header))
-            {
-                auto header = (core_rom_header*)malloc(sizeof(core_rom_header));
-                fread(header, sizeof(core_rom_header), 1, f);
-
-                core_vr_byteswap((uint8_t*)header);
-
-                if (predicate(*header))
-                {
-                    free(header);
-                    fclose(f);
-                    return rom_path;
-                }
-
-                free(header);
-            }
-
-            fclose(f);
+            RomIndex::update(find_available_roms());
         }
 
-        return L"";
+        const auto entry = RomIndex::find(predicate);
+        return entry.has_value() ? entry->path : L"";
     }
 
     void emu_launched_changed(std::any data)
@@ -6,6 +6,7 @@
 
 #include "stdafx.h"
 #include "LuaConsole.h"
+#include "LuaEmuThread.h"
 
 #include "Config.h"
 #include "FrontendService.h"
@@ -48,7 +49,63 @@ std::atomic g_d2d_drawing_section = false;
 std::map<HWND, LuaEnvironment*> g_hwnd_lua_map;
 std::unordered_map<lua_State*, LuaEnvironment*> g_lua_env_map;
 
-uint64_t inputCount = 0;
+std::atomic<uint64_t> inputCount = 0;
+
+// The keys of the callbacks which are invoked from the emulation thread, whose registrations by UI thread states are counted
+// so the emulation thread can skip the round trip to the UI thread when there are none.
+const char* const g_counted_callback_keys[] = {REG_ATVI, REG_ATINPUT, REG_ATINTERVAL};
+std::atomic<int32_t> g_callback_counts[std::size(g_counted_callback_keys)];
+
+/**
+ * Gets the registration counter of a callback key, or null if registrations of the key aren't counted for the state.
+ */
+static std::atomic<int32_t>* get_callback_count(lua_State* L, const char* key)
+{
+    for (size_t i = 0; i < std::size(g_counted_callback_keys); ++i)
+    {
+        if (strcmp(g_counted_callback_keys[i], key))
+        {
+            continue;
+        }
+
+        // Callbacks of emulation thread states don't go through the UI thread
+        lua_getfield(L, LUA_REGISTRYINDEX, REG_EMUTHREAD);
+        const bool emu_thread = !lua_isnil(L, -1);
+        lua_pop(L, 1);
+
+        return emu_thread ? nullptr : &g_callback_counts[i];
+    }
+    return nullptr;
+}
+
+/**
+ * Removes a state's callbacks from the registration counters.
+ */
+static void forget_callback_counts(lua_State* L)
+{
+    for (const auto key : g_counted_callback_keys)
+    {
+        const auto count = get_callback_count(L, key);
+        lua_getfield(L, LUA_REGISTRYINDEX, key);
+        if (count && !lua_isnil(L, -1))
+        {
+            *count -= static_cast<int32_t>(luaL_len(L, -1));
+        }
+        lua_pop(L, 1);
+    }
+}
+
+bool has_callbacks_with_key(const char* key)
+{
+    for (size_t i = 0; i < std::size(g_counted_callback_keys); ++i)
+    {
+        if (!strcmp(g_counted_callback_keys[i], key))
+        {
+            return g_callback_counts[i] > 0;
+        }
+    }
+    return true;
+}
 
 
 int at_panic(lua_State* L)
@@ -256,6 +313,10 @@ int RegisterFunction(lua_State* L, const char* key)
     lua_pushvalue(L, -3); //
     lua_settable(L, -3);
     lua_pop(L, 1);
+    if (const auto count = get_callback_count(L, key))
+    {
+        ++*count;
+    }
     return i;
 }
 
@@ -281,6 +342,10 @@ void UnregisterFunction(lua_State* L, const char* key)
             lua_pushinteger(L, 1 + i);
             lua_call(L, 2, 0);
             lua_pop(L, 2);
+            if (const auto count = get_callback_count(L, key))
+            {
+                --*count;
+            }
             return;
         }
         lua_pop(L, 1);
@@ -314,6 +379,8 @@ const luaL_Reg emuFuncs[] = {{"console", LuaCore::Emu::ConsoleWriteLua},
                              {"atseekcompleted", LuaCore::Emu::RegisterSeekCompleted},
                              {"atwarpmodifystatuschanged", LuaCore::Emu::RegisterWarpModifyStatusChanged},
 
+                             {"start_emu_thread_script", LuaCore::Emu::StartEmuThreadScript},
+
                              {"framecount", LuaCore::Emu::GetVICount},
                              {"samplecount", LuaCore::Emu::GetSampleCount},
                              {"inputcount", LuaCore::Emu::GetInputCount},
@@ -374,6 +441,14 @@ const luaL_Reg memoryFuncs[] = {
 
 {"writesize", LuaCore::Memory::LuaWriteSize},
 
+// bulk functions
+{"readbytes", LuaCore::Memory::LuaReadBytes},
+{"writebytes", LuaCore::Memory::LuaWriteBytes},
+{"readarray", LuaCore::Memory::LuaReadArray},
+{"writearray", LuaCore::Memory::LuaWriteArray},
+{"compilestruct", LuaCore::Memory::LuaCompileStruct},
+{"readstruct", LuaCore::Memory::LuaReadStruct},
+
 {NULL, NULL}};
 
 const luaL_Reg wguiFuncs[] = {{"setbrush", LuaCore::Wgui::set_brush},
@@ -509,11 +584,13 @@ LRESULT CALLBACK d2d_overlay_wndproc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM
             if (!lua->presenter)
             {
                 failed = lua->invoke_callbacks_with_key(pcall_no_params, REG_ATDRAWD2D);
+                LuaEmuThread::present(lua);
             }
             else
             {
                 lua->presenter->begin_present();
                 failed = lua->invoke_callbacks_with_key(pcall_no_params, REG_ATDRAWD2D);
+                LuaEmuThread::present(lua);
                 lua->presenter->end_present();
             }
 
@@ -798,11 +875,13 @@ std::string LuaEnvironment::create(const std::filesystem::path& path, HWND wnd)
 LuaEnvironment::~LuaEnvironment()
 {
     m_ignore_renderer_creation = true;
+    LuaEmuThread::stop(this);
     invoke_callbacks_with_key(pcall_no_params, REG_ATSTOP);
     SelectObject(gdi_back_dc, nullptr);
     DeleteObject(brush);
     DeleteObject(pen);
     DeleteObject(font);
+    forget_callback_counts(L);
     lua_close(L);
     L = NULL;
     set_button_state(hwnd, false);
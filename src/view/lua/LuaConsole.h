@@ -65,6 +65,21 @@ void stop_all_scripts();
 void invoke_callbacks_with_key_on_all_instances(
  const std::function<int(lua_State*)>& function, const char* key);
 
+/**
+ * \brief Gets whether any script's UI thread state might have a callback registered with the specified key. Can be called from any thread.
+ * \param key The callback's registration key
+ * \remarks Registrations are only counted for the keys which are invoked from the emulation thread, and are assumed to exist for all other keys.
+ */
+bool has_callbacks_with_key(const char* key);
+
+/**
+ * \brief Registers a function table as a global package
+ * \param lua_state The lua state
+ * \param name The package's name, or null to register the functions as globals
+ * \param regs The functions
+ */
+void register_as_package(lua_State* lua_state, const char* name, const luaL_Reg regs[]);
+
 static const auto REG_LUACLASS = "C";
 static const auto REG_ATUPDATESCREEN = "S";
 static const auto REG_ATDRAWD2D = "SD2D";
@@ -83,6 +98,7 @@ static const auto REG_ATSAVESTATE = "SS";
 static const auto REG_ATRESET = "RE";
 static const auto REG_ATSEEKCOMPLETED = "SC";
 static const auto REG_ATWARPMODIFYSTATUSCHANGED = "WS";
+static const auto REG_EMUTHREAD = "ET";
 
 static uint32_t lua_gdi_color_mask = RGB(255, 0, 255);
 static HBRUSH alpha_mask_brush = CreateSolidBrush(lua_gdi_color_mask);
@@ -206,7 +222,7 @@ private:
     void register_functions();
 };
 
-extern uint64_t inputCount;
+extern std::atomic<uint64_t> inputCount;
 
 /**
  * \brief The controller data at time of the last input poll
@@ -225,6 +241,10 @@ extern bool overwrite_controller_data[4];
 
 extern std::map<HWND, LuaEnvironment*> g_hwnd_lua_map;
 
+// The function tables which are also available to emulation thread states
+extern const luaL_Reg memoryFuncs[];
+extern const luaL_Reg joypadFuncs[];
+
 /**
  * \brief Gets the Lua environment associated with a lua state.
  */
@@ -0,0 +1,469 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include "LuaEmuThread.h"
+#include "LuaConsole.h"
+#include <wincodec.h>
+#include <gui/Loggers.h>
+#include <gui/Main.h>
+#include "modules/D2D.h"
+#include "modules/Emu.h"
+
+namespace LuaEmuThread
+{
+    /// A d2d function whose calls are recorded instead of being executed.
+    struct t_recorded_function {
+        const char* name;
+
+        /// The function which executes the call when it's replayed.
+        lua_CFunction func;
+
+        /// The 1-based index of the brush argument, or 0 if there's none.
+        int brush_index;
+    };
+
+    using t_value = std::variant<std::monostate, lua_Integer, lua_Number, bool, std::string>;
+
+    /// A recorded d2d call.
+    struct t_d2d_command {
+        const t_recorded_function* function;
+        std::vector<t_value> args;
+    };
+
+    using t_frame = std::vector<t_d2d_command>;
+
+    struct t_state {
+        /// The environment which owns the state. Only dereferenced on the UI thread.
+        LuaEnvironment* env;
+
+        /// The Lua state, or null if the script failed and was closed.
+        lua_State* L;
+
+        /// The commands recorded since the last VI. Only accessed while running the state's Lua code.
+        t_frame recording;
+
+        // Locked when accessing the members below.
+        std::mutex output_mutex;
+
+        /// The commands recorded during the last complete frame.
+        std::shared_ptr<const t_frame> frame;
+
+        /// The text printed since the last time it was presented.
+        std::wstring console;
+    };
+
+    const t_recorded_function g_recorded_functions[] = {
+    {"clear", LuaCore::D2D::clear, 0},
+    {"fill_rectangle", LuaCore::D2D::fill_rectangle, 5},
+    {"draw_rectangle", LuaCore::D2D::draw_rectangle, 6},
+    {"fill_ellipse", LuaCore::D2D::fill_ellipse, 5},
+    {"draw_ellipse", LuaCore::D2D::draw_ellipse, 6},
+    {"draw_line", LuaCore::D2D::draw_line, 6},
+    {"draw_text", LuaCore::D2D::draw_text, 13},
+    {"push_clip", LuaCore::D2D::push_clip, 0},
+    {"pop_clip", LuaCore::D2D::pop_clip, 0},
+    {"fill_rounded_rectangle", LuaCore::D2D::fill_rounded_rectangle, 7},
+    {"draw_rounded_rectangle", LuaCore::D2D::draw_rounded_rectangle, 8},
+    {"set_text_antialias_mode", LuaCore::D2D::set_text_antialias_mode, 0},
+    {"set_antialias_mode", LuaCore::D2D::set_antialias_mode, 0},
+    };
+
+    // Locked by the emulation thread while running the states' Lua code, and by the UI thread while adding or removing states.
+    std::mutex g_states_mutex;
+
+    // The running states. Only accessed while holding the states mutex.
+    std::vector<t_state*> g_states;
+
+    // The states by their owning environment. Only accessed on the UI thread.
+    std::unordered_map<LuaEnvironment*, std::unique_ptr<t_state>> g_env_states;
+
+    t_state* get_state(lua_State* L)
+    {
+        lua_getfield(L, LUA_REGISTRYINDEX, REG_EMUTHREAD);
+        auto state = static_cast<t_state*>(lua_touserdata(L, -1));
+        lua_pop(L, 1);
+        return state;
+    }
+
+    void print(t_state* state, const std::wstring& text)
+    {
+        std::scoped_lock lock(state->output_mutex);
+        state->console += text;
+    }
+
+    int Print(lua_State* L)
+    {
+        print(get_state(L), string_to_wstring(luaL_tolstring(L, 1, nullptr)) + L"\r\n");
+        return 0;
+    }
+
+    /**
+     * Creates a brush. Brushes are only resolved when the commands are replayed, so they're just the color packed into an integer.
+     */
+    int CreateBrush(lua_State* L)
+    {
+        lua_Integer brush = 0;
+        for (int i = 1; i <= 4; ++i)
+        {
+            const auto channel = static_cast<lua_Integer>(std::clamp(luaL_checknumber(L, i), 0.0, 1.0) * 255.0 + 0.5);
+            brush = (brush << 8) | channel;
+        }
+        lua_pushinteger(L, brush);
+        return 1;
+    }
+
+    int FreeBrush(lua_State* L)
+    {
+        luaL_checkinteger(L, 1);
+        return 0;
+    }
+
+    D2D1::ColorF brush_to_color(lua_Integer brush)
+    {
+        return D2D1::ColorF(
+        ((brush >> 24) & 0xFF) / 255.0f,
+        ((brush >> 16) & 0xFF) / 255.0f,
+        ((brush >> 8) & 0xFF) / 255.0f,
+        (brush & 0xFF) / 255.0f);
+    }
+
+    int RecordD2DCall(lua_State* L)
+    {
+        const auto& function = g_recorded_functions[lua_tointeger(L, lua_upvalueindex(1))];
+        const int count = lua_gettop(L);
+
+        // Check the arguments before building the command, as raising an error skips destructors
+        for (int i = 1; i <= count; ++i)
+        {
+            const int type = lua_type(L, i);
+            if (type != LUA_TNUMBER && type != LUA_TSTRING && type != LUA_TBOOLEAN && type != LUA_TNIL)
+            {
+                return luaL_error(L, "d2d.%s: argument %d of type %s can't be recorded", function.name, i, lua_typename(L, type));
+            }
+        }
+
+        t_d2d_command command{.function = &function};
+        command.args.reserve(count);
+        for (int i = 1; i <= count; ++i)
+        {
+            switch (lua_type(L, i))
+            {
+            case LUA_TNUMBER:
+                if (lua_isinteger(L, i))
+                    command.args.emplace_back(lua_tointeger(L, i));
+                else
+                    command.args.emplace_back(lua_tonumber(L, i));
+                break;
+            case LUA_TSTRING:
+                command.args.emplace_back(std::string(lua_tostring(L, i)));
+                break;
+            case LUA_TBOOLEAN:
+                command.args.emplace_back(static_cast<bool>(lua_toboolean(L, i)));
+                break;
+            default:
+                command.args.emplace_back(std::monostate{});
+                break;
+            }
+        }
+
+        get_state(L)->recording.push_back(std::move(command));
+        return 0;
+    }
+
+    const luaL_Reg globalFuncs[] = {{"print", Print}, {NULL, NULL}};
+
+    const luaL_Reg emuFuncs[] = {{"atvi", LuaCore::Emu::RegisterVI},
+                                 {"atinput", LuaCore::Emu::RegisterInput},
+                                 {"atinterval", LuaCore::Emu::RegisterInterval},
+                                 {"framecount", LuaCore::Emu::GetVICount},
+                                 {"samplecount", LuaCore::Emu::GetSampleCount},
+                                 {"inputcount", LuaCore::Emu::GetInputCount},
+                                 {NULL, NULL}};
+
+    void register_functions(t_state* state)
+    {
+        lua_State* L = state->L;
+
+        luaL_openlibs(L);
+
+        lua_pushlightuserdata(L, state);
+        lua_setfield(L, LUA_REGISTRYINDEX, REG_EMUTHREAD);
+
+        register_as_package(L, nullptr, globalFuncs);
+        register_as_package(L, "emu", emuFuncs);
+        register_as_package(L, "memory", memoryFuncs);
+        register_as_package(L, "joypad", joypadFuncs);
+
+        lua_newtable(L);
+        lua_pushcfunction(L, CreateBrush);
+        lua_setfield(L, -2, "create_brush");
+        lua_pushcfunction(L, FreeBrush);
+        lua_setfield(L, -2, "free_brush");
+        for (size_t i = 0; i < std::size(g_recorded_functions); ++i)
+        {
+            lua_pushinteger(L, static_cast<lua_Integer>(i));
+            lua_pushcclosure(L, RecordD2DCall, 1);
+            lua_setfield(L, -2, g_recorded_functions[i].name);
+        }
+        lua_setglobal(L, "d2d");
+
+        // The state can't interact with the UI or the process, as it would block the emulation thread
+        luaL_dostring(L, "os.exit = function() print('os.exit is unavailable on the emulation thread') end");
+        luaL_dostring(L, "os.execute = function() print('os.execute is disabled') end");
+    }
+
+    void close_state(t_state* state)
+    {
+        if (state->L)
+        {
+            lua_close(state->L);
+            state->L = nullptr;
+        }
+    }
+
+    std::string start(LuaEnvironment* env, const std::filesystem::path& path)
+    {
+        assert(is_on_gui_thread());
+
+        stop(env);
+
+        auto state = std::make_unique<t_state>();
+        state->env = env;
+        state->L = luaL_newstate();
+        register_functions(state.get());
+
+        // The global code runs on the UI thread, as the state isn't visible to the emulation thread yet
+        if (luaL_dofile(state->L, path.string().c_str()))
+        {
+            std::string error_msg = lua_tostring(state->L, -1);
+            close_state(state.get());
+            return error_msg;
+        }
+
+        env->ensure_d2d_renderer_created();
+
+        {
+            std::scoped_lock lock(g_states_mutex);
+            g_states.push_back(state.get());
+        }
+        g_env_states[env] = std::move(state);
+
+        return "";
+    }
+
+    void stop(LuaEnvironment* env)
+    {
+        assert(is_on_gui_thread());
+
+        const auto it = g_env_states.find(env);
+        if (it == g_env_states.end())
+        {
+            return;
+        }
+
+        const auto state = it->second.get();
+        {
+            std::scoped_lock lock(g_states_mutex);
+            std::erase(g_states, state);
+        }
+        close_state(state);
+
+        if (!state->console.empty())
+        {
+            env->print(state->console);
+        }
+
+        g_env_states.erase(it);
+    }
+
+    /**
+     * Pushes a recorded argument. Brushes are backed by the specified brush, which is set to the brush's color.
+     */
+    void push_value(lua_State* L, const t_value& value, ID2D1SolidColorBrush* brush)
+    {
+        if (const auto integer = std::get_if<lua_Integer>(&value))
+        {
+            if (brush)
+            {
+                brush->SetColor(brush_to_color(*integer));
+                lua_pushinteger(L, (lua_Integer)brush);
+                return;
+            }
+            lua_pushinteger(L, *integer);
+        }
+        else if (const auto number = std::get_if<lua_Number>(&value))
+        {
+            lua_pushnumber(L, *number);
+        }
+        else if (const auto boolean = std::get_if<bool>(&value))
+        {
+            lua_pushboolean(L, *boolean);
+        }
+        else if (const auto string = std::get_if<std::string>(&value))
+        {
+            lua_pushlstring(L, string->data(), string->size());
+        }
+        else
+        {
+            lua_pushnil(L);
+        }
+    }
+
+    void present(LuaEnvironment* env)
+    {
+        assert(is_on_gui_thread());
+
+        const auto it = g_env_states.find(env);
+        if (it == g_env_states.end())
+        {
+            return;
+        }
+
+        const auto state = it->second.get();
+
+        std::shared_ptr<const t_frame> frame;
+        std::wstring console;
+        {
+            std::scoped_lock lock(state->output_mutex);
+            frame = state->frame;
+            console = std::move(state->console);
+            state->console.clear();
+        }
+
+        if (!console.empty())
+        {
+            env->print(console);
+        }
+
+        if (!frame || frame->empty() || !env->presenter)
+        {
+            return;
+        }
+
+        lua_State* L = env->L;
+
+        // One brush is shared by all commands, as they're executed one after another
+        ID2D1SolidColorBrush* brush = nullptr;
+        env->d2d_render_target_stack.top()->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Black), &brush);
+        if (!brush)
+        {
+            return;
+        }
+
+        for (const auto& command : *frame)
+        {
+            lua_pushcfunction(L, command.function->func);
+            for (size_t i = 0; i < command.args.size(); ++i)
+            {
+                push_value(L, command.args[i], static_cast<int>(i + 1) == command.function->brush_index ? brush : nullptr);
+            }
+
+            if (lua_pcall(L, static_cast<int>(command.args.size()), 0, 0))
+            {
+                env->print(string_to_wstring(lua_tostring(L, -1)) + L"\r\n");
+                lua_pop(L, 1);
+                break;
+            }
+        }
+
+        brush->Release();
+    }
+
+    /**
+     * Invokes a callback on all running states. States whose callback fails are closed.
+     */
+    void invoke_callbacks_with_key(const std::function<int(lua_State*)>& function, const char* key)
+    {
+        for (const auto state : g_states)
+        {
+            lua_State* L = state->L;
+            if (!L)
+            {
+                continue;
+            }
+
+            lua_getfield(L, LUA_REGISTRYINDEX, key);
+            if (lua_isnil(L, -1))
+            {
+                lua_pop(L, 1);
+                continue;
+            }
+
+            bool failed = false;
+            const int n = luaL_len(L, -1);
+            for (LUA_INTEGER i = 0; i < n; i++)
+            {
+                lua_pushinteger(L, 1 + i);
+                lua_gettable(L, -2);
+                if (function(L))
+                {
+                    const char* str = lua_tostring(L, -1);
+                    print(state, string_to_wstring(str) + L"\r\n");
+                    g_view_logger->info("Lua error: {}", str);
+                    failed = true;
+                    break;
+                }
+            }
+
+            if (failed)
+            {
+                close_state(state);
+                continue;
+            }
+
+            lua_pop(L, 1);
+        }
+    }
+
+    void call_vi()
+    {
+        std::scoped_lock lock(g_states_mutex);
+
+        if (g_states.empty())
+        {
+            return;
+        }
+
+        invoke_callbacks_with_key(pcall_no_params, REG_ATVI);
+
+        for (const auto state : g_states)
+        {
+            auto frame = std::make_shared<const t_frame>(std::move(state->recording));
+            state->recording.clear();
+
+            std::scoped_lock output_lock(state->output_mutex);
+            state->frame = std::move(frame);
+        }
+    }
+
+    void call_input(int index)
+    {
+        std::scoped_lock lock(g_states_mutex);
+
+        if (g_states.empty())
+        {
+            return;
+        }
+
+        invoke_callbacks_with_key([=](lua_State* L) {
+            lua_pushinteger(L, index);
+            return lua_pcall(L, 1, 0, 0);
+        }, REG_ATINPUT);
+    }
+
+    void call_interval()
+    {
+        std::scoped_lock lock(g_states_mutex);
+
+        if (g_states.empty())
+        {
+            return;
+        }
+
+        invoke_callbacks_with_key(pcall_no_params, REG_ATINTERVAL);
+    }
+} // namespace LuaEmuThread
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+class LuaEnvironment;
+
+/*
+ *	Scripts can run a companion script in an isolated Lua state on the emulation thread.
+ *
+ *	Its atinput, atvi and atinterval callbacks are called directly by the emulation thread, without a round trip to the UI thread.
+ *	Only functions which don't touch the UI are available to it: the memory and joypad functions, and the emu callbacks and counters.
+ *	The savestate functions are left out, as their work and callbacks would run in the middle of the emulation thread's own callbacks.
+ *	Its d2d drawing calls are recorded into a command list, which is handed over at every VI and replayed by the UI thread when the owning script's overlay is painted.
+ */
+
+namespace LuaEmuThread
+{
+    /**
+     * \brief Runs a script in an isolated state on the emulation thread, replacing the environment's previous one. Must be called from the UI thread.
+     * \param env The environment which owns the state
+     * \param path The script's path
+     * \return An error string, or an empty string if the operation succeeded
+     */
+    std::string start(LuaEnvironment* env, const std::filesystem::path& path);
+
+    /**
+     * \brief Stops and destroys the environment's emulation thread state, if it has one. Must be called from the UI thread.
+     * \param env The environment which owns the state
+     */
+    void stop(LuaEnvironment* env);
+
+    /**
+     * \brief Prints the pending console output of the environment's emulation thread state and replays the drawing commands of its last frame.
+     * Must be called from the UI thread while the environment's D2D overlay is being presented.
+     * \param env The environment which owns the state
+     */
+    void present(LuaEnvironment* env);
+
+    /**
+     * \brief Calls the atvi callbacks of all emulation thread states and hands their recorded frames over to the UI thread
+     */
+    void call_vi();
+
+    /**
+     * \brief Calls the atinput callbacks of all emulation thread states
+     * \param index The index of the controller being polled
+     */
+    void call_input(int index);
+
+    /**
+     * \brief Calls the atinterval callbacks of all emulation thread states
+     */
+    void call_interval();
+} // namespace LuaEmuThread
@@ -6,6 +6,7 @@
 
 #include "stdafx.h"
 #include <lua/LuaConsole.h>
+#include <lua/LuaEmuThread.h>
 #include <gui/Main.h>
 #include <core_api.h>
 
@@ -55,6 +56,11 @@ namespace LuaService
     void call_vi()
     {
         RET_IF_EMPTY;
+        LuaEmuThread::call_vi();
+        if (!has_callbacks_with_key(REG_ATVI))
+        {
+            return;
+        }
         g_main_window_dispatcher->invoke([]
         {
             invoke_callbacks_with_key_on_all_instances(pcall_no_params, REG_ATVI);
@@ -69,12 +75,22 @@ namespace LuaService
 
         RET_IF_EMPTY;
 
-        g_main_window_dispatcher->invoke([=]
+        LuaEmuThread::call_input(index);
+
+        // The count is incremented after the UI thread's atinput callbacks ran, so they keep seeing the previous count
+        if (has_callbacks_with_key(REG_ATINPUT))
+        {
+            g_main_window_dispatcher->invoke([=]
+            {
+                current_input_n = index;
+                invoke_callbacks_with_key_on_all_instances(AtInput, REG_ATINPUT);
+                inputCount++;
+            });
+        }
+        else
         {
-            current_input_n = index;
-            invoke_callbacks_with_key_on_all_instances(AtInput, REG_ATINPUT);
             inputCount++;
-        });
+        }
 
         if (overwrite_controller_data[index])
         {
@@ -87,6 +103,11 @@ namespace LuaService
     void call_interval()
     {
         RET_IF_EMPTY;
+        LuaEmuThread::call_interval();
+        if (!has_callbacks_with_key(REG_ATINTERVAL))
+        {
+            return;
+        }
         g_main_window_dispatcher->invoke([]
         {
             invoke_callbacks_with_key_on_all_instances(pcall_no_params, REG_ATINTERVAL);
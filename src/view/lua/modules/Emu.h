@@ -14,6 +14,7 @@ extern "C" {
 #include <gui/Main.h>
 #include <gui/features/Statusbar.h>
 #include <lua/LuaConsole.h>
+#include <lua/LuaEmuThread.h>
 
 namespace LuaCore::Emu
 {
@@ -261,6 +262,29 @@ namespace LuaCore::Emu
         return 0;
     }
 
+    static int StartEmuThreadScript(lua_State* L)
+    {
+        {
+            LuaEnvironment* lua = get_lua_class(L);
+
+            // Relative paths are resolved against the calling script's directory
+            std::filesystem::path path = luaL_checkstring(L, 1);
+            if (path.is_relative())
+            {
+                path = lua->path.parent_path() / path;
+            }
+
+            const auto error_msg = LuaEmuThread::start(lua, path);
+            if (error_msg.empty())
+            {
+                return 0;
+            }
+            lua_pushstring(L, error_msg.c_str());
+        }
+        // Raised outside the scope, as raising an error skips destructors
+        return lua_error(L);
+    }
+
     static int Screenshot(lua_State* L)
     {
         g_core.plugin_funcs.capture_screen((char*)luaL_checkstring(L, 1));
@@ -20,27 +20,154 @@ namespace LuaCore::Memory
         return (DWORD)luaL_checknumber(L, i);
     }
 
+    /**
+     * \brief Gets a qword argument, which is either an integer or a legacy table of the upper and lower 4 bytes
+     */
     static ULONGLONG LuaCheckQWord(lua_State* L, int i)
     {
-        lua_pushinteger(L, 1);
-        lua_gettable(L, i);
+        if (!lua_istable(L, i))
+        {
+            return (ULONGLONG)luaL_checkinteger(L, i);
+        }
+
+        lua_rawgeti(L, i, 1);
         ULONGLONG n = (ULONGLONG)LuaCheckIntegerU(L) << 32;
         lua_pop(L, 1);
-        lua_pushinteger(L, 2);
-        lua_gettable(L, i);
+        lua_rawgeti(L, i, 2);
         n |= LuaCheckIntegerU(L);
+        lua_pop(L, 1);
         return n;
     }
 
     static void LuaPushQword(lua_State* L, ULONGLONG x)
     {
-        lua_newtable(L);
-        lua_pushinteger(L, 1);
-        lua_pushinteger(L, x >> 32);
-        lua_settable(L, -3);
-        lua_pushinteger(L, 2);
-        lua_pushinteger(L, x & 0xFFFFFFFF);
-        lua_settable(L, -3);
+        lua_pushinteger(L, (lua_Integer)x);
+    }
+
+    /**
+     * \brief Gets the qword at the specified address from RDRAM. Qwords are stored as two big-endian ordered dwords.
+     */
+    static ULONGLONG LoadQWord(uint32_t addr)
+    {
+        return (ULONGLONG)LoadRDRAMSafe<ULONG>(addr) << 32 | LoadRDRAMSafe<ULONG>(addr + 4);
+    }
+
+    /**
+     * \brief Sets the qword at the specified address in RDRAM
+     */
+    static void StoreQWord(uint32_t addr, ULONGLONG value)
+    {
+        StoreRDRAMSafe<ULONG>(addr, value >> 32);
+        StoreRDRAMSafe<ULONG>(addr + 4, value & 0xFFFFFFFF);
+    }
+
+    /**
+     * \brief Marks an RDRAM range modified by a bulk write as dirty, splitting it where it wraps around the end of RDRAM
+     */
+    static void MarkRDRAMRangeDirty(uint32_t addr, size_t len)
+    {
+        const uint32_t offset = addr & AddrMask;
+        const size_t head = std::min<size_t>(len, AddrMask + 1 - offset);
+        core_st_mark_rdram_dirty(offset, head);
+        if (len > head)
+        {
+            core_st_mark_rdram_dirty(0, len - head);
+        }
+    }
+
+    /**
+     * The value types of typed arrays and struct layout fields.
+     */
+    enum t_value_type {
+        vt_u8,
+        vt_s8,
+        vt_u16,
+        vt_s16,
+        vt_u32,
+        vt_s32,
+        vt_u64,
+        vt_s64,
+        vt_f32,
+        vt_f64,
+    };
+
+    static const char* const VALUE_TYPE_NAMES[] = {"u8", "s8", "u16", "s16", "u32", "s32", "u64", "s64", "f32", "f64", nullptr};
+    static constexpr uint32_t VALUE_TYPE_SIZES[] = {1, 1, 2, 2, 4, 4, 8, 8, 4, 8};
+
+    static t_value_type LuaCheckValueType(lua_State* L, int i)
+    {
+        return (t_value_type)luaL_checkoption(L, i, nullptr, VALUE_TYPE_NAMES);
+    }
+
+    /**
+     * \brief Pushes the value of the specified type at the specified address in RDRAM
+     */
+    static void PushValue(lua_State* L, t_value_type type, uint32_t addr)
+    {
+        switch (type)
+        {
+        case vt_u8: lua_pushinteger(L, LoadRDRAMSafe<UCHAR>(addr));
+            break;
+        case vt_s8: lua_pushinteger(L, LoadRDRAMSafe<CHAR>(addr));
+            break;
+        case vt_u16: lua_pushinteger(L, LoadRDRAMSafe<USHORT>(addr));
+            break;
+        case vt_s16: lua_pushinteger(L, LoadRDRAMSafe<SHORT>(addr));
+            break;
+        case vt_u32: lua_pushinteger(L, LoadRDRAMSafe<ULONG>(addr));
+            break;
+        case vt_s32: lua_pushinteger(L, LoadRDRAMSafe<LONG>(addr));
+            break;
+        case vt_u64:
+        case vt_s64: LuaPushQword(L, LoadQWord(addr));
+            break;
+        case vt_f32:
+            {
+                ULONG value = LoadRDRAMSafe<ULONG>(addr);
+                lua_pushnumber(L, *(FLOAT*)&value);
+                break;
+            }
+        case vt_f64:
+            {
+                ULONGLONG value = LoadQWord(addr);
+                lua_pushnumber(L, *(DOUBLE*)&value);
+                break;
+            }
+        }
+    }
+
+    /**
+     * \brief Stores the value at the specified stack index as the specified type at the specified address in RDRAM
+     */
+    static void StoreValue(lua_State* L, t_value_type type, uint32_t addr, int i)
+    {
+        switch (type)
+        {
+        case vt_u8:
+        case vt_s8: StoreRDRAMSafe<UCHAR>(addr, luaL_checkinteger(L, i));
+            break;
+        case vt_u16:
+        case vt_s16: StoreRDRAMSafe<USHORT>(addr, luaL_checkinteger(L, i));
+            break;
+        case vt_u32:
+        case vt_s32: StoreRDRAMSafe<ULONG>(addr, luaL_checkinteger(L, i));
+            break;
+        case vt_u64:
+        case vt_s64: StoreQWord(addr, LuaCheckQWord(L, i));
+            break;
+        case vt_f32:
+            {
+                FLOAT f = luaL_checknumber(L, i);
+                StoreRDRAMSafe<ULONG>(addr, *(ULONG*)&f);
+                break;
+            }
+        case vt_f64:
+            {
+                DOUBLE f = luaL_checknumber(L, i);
+                StoreQWord(addr, *(ULONGLONG*)&f);
+                break;
+            }
+        }
     }
 
     // Read functions
@@ -89,14 +216,14 @@ namespace LuaCore::Memory
 
     static int LuaReadQWordUnsigned(lua_State* L)
     {
-        ULONGLONG value = LoadRDRAMSafe<ULONGLONG>(luaL_checkinteger(L, 1));
+        ULONGLONG value = LoadQWord(luaL_checkinteger(L, 1));
         LuaPushQword(L, value);
         return 1;
     }
 
     static int LuaReadQWordSigned(lua_State* L)
     {
-        LONGLONG value = LoadRDRAMSafe<LONGLONG>(luaL_checkinteger(L, 1));
+        LONGLONG value = LoadQWord(luaL_checkinteger(L, 1));
         LuaPushQword(L, value);
         return 1;
     }
@@ -110,8 +237,8 @@ namespace LuaCore::Memory
 
     static int LuaReadDouble(lua_State* L)
     {
-        ULONGLONG value = LoadRDRAMSafe<ULONGLONG>(luaL_checkinteger(L, 1));
-        lua_pushnumber(L, *(DOUBLE*)value);
+        ULONGLONG value = LoadQWord(luaL_checkinteger(L, 1));
+        lua_pushnumber(L, *(DOUBLE*)&value);
         return 1;
     }
 
@@ -138,7 +265,7 @@ namespace LuaCore::Memory
 
     static int LuaWriteQWordUnsigned(lua_State* L)
     {
-        StoreRDRAMSafe<ULONGLONG>(luaL_checkinteger(L, 1), LuaCheckQWord(L, 2));
+        StoreQWord(luaL_checkinteger(L, 1), LuaCheckQWord(L, 2));
         return 0;
     }
 
@@ -152,7 +279,7 @@ namespace LuaCore::Memory
     static int LuaWriteDoubleUnsigned(lua_State* L)
     {
         DOUBLE f = luaL_checknumber(L, -1);
-        StoreRDRAMSafe<ULONGLONG>(luaL_checkinteger(L, 1), *(ULONGLONG*)&f);
+        StoreQWord(luaL_checkinteger(L, 1), *(ULONGLONG*)&f);
         return 0;
     }
 
@@ -169,7 +296,7 @@ namespace LuaCore::Memory
             break;
         case 4: lua_pushinteger(L, LoadRDRAMSafe<ULONG>(addr));
             break;
-        case 8: LuaPushQword(L, LoadRDRAMSafe<ULONGLONG>(addr));
+        case 8: LuaPushQword(L, LoadQWord(addr));
             break;
         // signed
         case -1: lua_pushinteger(L, LoadRDRAMSafe<CHAR>(addr));
@@ -178,7 +305,7 @@ namespace LuaCore::Memory
             break;
         case -4: lua_pushinteger(L, LoadRDRAMSafe<LONG>(addr));
             break;
-        case -8: LuaPushQword(L, LoadRDRAMSafe<LONGLONG>(addr));
+        case -8: LuaPushQword(L, LoadQWord(addr));
             break;
         default: luaL_error(L, "size must be 1, 2, 4, 8, -1, -2, -4, -8");
         }
@@ -197,7 +324,7 @@ namespace LuaCore::Memory
             break;
         case 4: StoreRDRAMSafe<ULONG>(addr, luaL_checkinteger(L, 3));
             break;
-        case 8: StoreRDRAMSafe<ULONGLONG>(addr, LuaCheckQWord(L, 3));
+        case 8: StoreQWord(addr, LuaCheckQWord(L, 3));
             break;
         case -1: StoreRDRAMSafe<CHAR>(addr, luaL_checkinteger(L, 3));
             break;
@@ -205,7 +332,7 @@ namespace LuaCore::Memory
             break;
         case -4: StoreRDRAMSafe<LONG>(addr, luaL_checkinteger(L, 3));
             break;
-        case -8: StoreRDRAMSafe<LONGLONG>(addr, LuaCheckQWord(L, 3));
+        case -8: StoreQWord(addr, LuaCheckQWord(L, 3));
             break;
         default: luaL_error(L, "size must be 1, 2, 4, 8, -1, -2, -4, -8");
         }
@@ -247,6 +374,190 @@ namespace LuaCore::Memory
         return 1;
     }
 
+    // Bulk functions
+
+    static int LuaReadBytes(lua_State* L)
+    {
+        const uint32_t addr = luaL_checkinteger(L, 1);
+        const lua_Integer len = luaL_checkinteger(L, 2);
+        luaL_argcheck(L, len >= 0 && len <= AddrMask + 1, 2, "length out of range");
+
+        luaL_Buffer b;
+        auto out = (uint8_t*)luaL_buffinitsize(L, &b, len);
+
+        // Whole words are swapped into the N64 byte order at once, only the unaligned ends are copied bytewise
+        lua_Integer i = 0;
+        for (; i < len && (addr + i) % 4 != 0; ++i)
+        {
+            out[i] = LoadRDRAMSafe<UCHAR>(addr + i);
+        }
+        for (; i + 4 <= len; i += 4)
+        {
+            const ULONG word = _byteswap_ulong(LoadRDRAMSafe<ULONG>(addr + i));
+            memcpy(out + i, &word, sizeof(word));
+        }
+        for (; i < len; ++i)
+        {
+            out[i] = LoadRDRAMSafe<UCHAR>(addr + i);
+        }
+
+        luaL_pushresultsize(&b, len);
+        return 1;
+    }
+
+    static int LuaWriteBytes(lua_State* L)
+    {
+        const uint32_t addr = luaL_checkinteger(L, 1);
+        size_t len;
+        const auto data = (const uint8_t*)luaL_checklstring(L, 2, &len);
+        luaL_argcheck(L, len <= AddrMask + 1, 2, "string too long");
+
+        const auto rdram = (uint8_t*)g_core.rdram;
+        for (size_t i = 0; i < len; ++i)
+        {
+            rdram[((addr + i) ^ S8) & AddrMask] = data[i];
+        }
+
+        MarkRDRAMRangeDirty(addr, len);
+        return 0;
+    }
+
+    static int LuaReadArray(lua_State* L)
+    {
+        const uint32_t addr = luaL_checkinteger(L, 1);
+        const lua_Integer count = luaL_checkinteger(L, 2);
+        const auto type = LuaCheckValueType(L, 3);
+        luaL_argcheck(L, count >= 0 && count <= AddrMask + 1, 2, "count out of range");
+
+        if (lua_istable(L, 4))
+        {
+            lua_pushvalue(L, 4);
+        }
+        else
+        {
+            lua_createtable(L, (int)count, 0);
+        }
+
+        const uint32_t stride = VALUE_TYPE_SIZES[type];
+        for (lua_Integer i = 0; i < count; ++i)
+        {
+            PushValue(L, type, addr + i * stride);
+            lua_rawseti(L, -2, i + 1);
+        }
+        return 1;
+    }
+
+    static int LuaWriteArray(lua_State* L)
+    {
+        const uint32_t addr = luaL_checkinteger(L, 1);
+        const auto type = LuaCheckValueType(L, 2);
+        luaL_checktype(L, 3, LUA_TTABLE);
+
+        const uint32_t stride = VALUE_TYPE_SIZES[type];
+        const lua_Unsigned count = lua_rawlen(L, 3);
+        for (lua_Unsigned i = 0; i < count; ++i)
+        {
+            lua_rawgeti(L, 3, i + 1);
+            StoreValue(L, type, addr + i * stride, -1);
+            lua_pop(L, 1);
+        }
+        return 0;
+    }
+
+    // Struct layouts
+
+    struct t_struct_field {
+        uint32_t offset;
+        t_value_type type;
+    };
+
+    /**
+     * A compiled struct layout. The field names are kept in the userdata's user value, in the same order as the fields.
+     */
+    struct t_struct_layout {
+        std::vector<t_struct_field> fields;
+    };
+
+    static constexpr auto STRUCT_LAYOUT_METATABLE = "mupen64.struct_layout";
+
+    static int LuaStructLayoutGc(lua_State* L)
+    {
+        auto layout = (t_struct_layout*)luaL_checkudata(L, 1, STRUCT_LAYOUT_METATABLE);
+        layout->~t_struct_layout();
+        return 0;
+    }
+
+    static int LuaCompileStruct(lua_State* L)
+    {
+        luaL_checktype(L, 1, LUA_TTABLE);
+
+        // The userdata is created before parsing, so the layout is collected if a field is invalid
+        auto layout = new(lua_newuserdatauv(L, sizeof(t_struct_layout), 1)) t_struct_layout();
+        if (luaL_newmetatable(L, STRUCT_LAYOUT_METATABLE))
+        {
+            lua_pushcfunction(L, LuaStructLayoutGc);
+            lua_setfield(L, -2, "__gc");
+        }
+        lua_setmetatable(L, -2);
+
+        lua_newtable(L);
+        lua_pushnil(L);
+        while (lua_next(L, 1))
+        {
+            luaL_argcheck(L, lua_type(L, -2) == LUA_TSTRING && lua_istable(L, -1), 1, "fields must be name = {offset, type} pairs");
+
+            t_struct_field field{};
+            lua_rawgeti(L, -1, 1);
+            field.offset = luaL_checkinteger(L, -1);
+            lua_rawgeti(L, -2, 2);
+            field.type = LuaCheckValueType(L, -1);
+            lua_pop(L, 2);
+
+            layout->fields.push_back(field);
+
+            // Stack: layout, names, key, value
+            lua_pushvalue(L, -2);
+            lua_rawseti(L, -4, (lua_Integer)layout->fields.size());
+            lua_pop(L, 1);
+        }
+        lua_setiuservalue(L, -2, 1);
+        return 1;
+    }
+
+    static int LuaReadStruct(lua_State* L)
+    {
+        const uint32_t addr = luaL_checkinteger(L, 1);
+
+        if (lua_istable(L, 2))
+        {
+            lua_pushcfunction(L, LuaCompileStruct);
+            lua_pushvalue(L, 2);
+            lua_call(L, 1, 1);
+            lua_replace(L, 2);
+        }
+        const auto layout = (t_struct_layout*)luaL_checkudata(L, 2, STRUCT_LAYOUT_METATABLE);
+
+        if (lua_istable(L, 3))
+        {
+            lua_pushvalue(L, 3);
+        }
+        else
+        {
+            lua_createtable(L, 0, (int)layout->fields.size());
+        }
+
+        lua_getiuservalue(L, 2, 1);
+        for (size_t i = 0; i < layout->fields.size(); ++i)
+        {
+            // Stack: result, names, name, value
+            lua_rawgeti(L, -1, i + 1);
+            PushValue(L, layout->fields[i].type, addr + layout->fields[i].offset);
+            lua_rawset(L, -4);
+        }
+        lua_pop(L, 1);
+        return 1;
+    }
+
     template <typename T>
     static void PushT(lua_State* L, T value)
     {
@@ -272,6 +272,7 @@
 #define ID_LUA_CLEAR_RECENT             6036
 #define IDM_LOAD_LATEST_LUA             6037
 #define ID_LUA_RECENT                   6038
+#define IDM_TRACELOG_CONVERT            6039
 #define IDC_HOTKEYS_FLOWGROUP           6106
 #define IDC_HOT_SCREENSHOT              6108
 #define IDC_HOT_PAUSE                   6109
@@ -19,8 +19,11 @@ savestate = {}
 iohelper = {}
 avi = {}
 
----@alias qword integer[] A representation of an 8 byte integer (quad word) as
----two 4 byte integers.
+---@alias qword integer|integer[] An 8 byte integer (quad word). Tables of the
+---upper and lower 4 bytes are still accepted as arguments for compatibility.
+
+---@alias memtype "u8"|"s8"|"u16"|"s16"|"u32"|"s32"|"u64"|"s64"|"f32"|"f64" The
+---type of a value in memory.
 
 ---@alias tostringusable string|number The `lua_tostring` c function converts
 ---numbers to strings, so numbers are acceptable to pass into some functions
@@ -181,6 +184,21 @@ function emu.atseekcompleted(f, unregister) end
 ---@return nil
 function emu.atwarpmodifystatuschanged(f, unregister) end
 
+---Runs the script at `path` in a separate Lua state on the emulation thread,
+---replacing the one previously started by this script. Its `emu.atinput`,
+---`emu.atvi` and `emu.atinterval` callbacks are called directly by the
+---emulation thread, which is much faster than the callbacks of regular
+---scripts. It shares no globals with this script and only has access to
+---`print`, the `memory` and `joypad` functions, the `atinput`,
+---`atvi`, `atinterval`, `framecount`, `samplecount` and `inputcount` emu
+---functions, and the d2d functions which draw or create brushes. Its d2d calls
+---are recorded and drawn on this script's overlay after every VI. It is
+---stopped along with this script. Relative paths are resolved against this
+---script's directory.
+---@param path string The path of the script to run.
+---@return nil
+function emu.start_emu_thread_script(path) end
+
 ---Returns the number of VIs since the last movie was played. This should match
 ---the statusbar. If no movie has been played, it returns the number of VIs
 ---since the emulator was started, not reset.
@@ -307,11 +325,11 @@ function memory.inttodouble(n) end
 ---@return integer
 function memory.floattoint(n) end
 
----Reinterprets the bits of a 8 byte integer `n` as a double and returns it.
----This does not convert from an int to a float, but reinterprets the memory.
+---Reinterprets the bits of a double `n` as an 8 byte integer and returns it.
+---This does not convert from a double to an int, but reinterprets the memory.
 ---@nodiscard
----@param n qword
----@return number
+---@param n number
+---@return integer
 function memory.doubletoint(n) end
 
 ---Takes in an 8 byte integer and returns it as a lua number. This function
@@ -357,15 +375,14 @@ function memory.readdwordsigned(address) end
 ---@return integer
 function memory.readdword(address) end
 
----Reads a signed qword (8 bytes) from memory at `address` and returns it as a
----table of the upper and lower 4 bytes.
+---Reads a signed qword (8 bytes) from memory at `address` and returns it.
 ---@nodiscard
 ---@param address integer
----@return qword
+---@return integer
 function memory.readqwordsigned(address) end
 
----Reads an unsigned qword (8 bytes) from memory at `address` and returns it as
----a table of the upper and lower 4 bytes.
+---Reads an unsigned qword (8 bytes) from memory at `address` and returns it.
+---Values above the signed range wrap around to negative integers.
 ---@nodiscard
 ---@param address integer
 ---@return integer
@@ -409,8 +426,7 @@ function memory.writeword(address, data) end
 ---@return nil
 function memory.writedword(address, data) end
 
----Writes an unsigned qword consisting of a table with the upper and lower 4
----bytes to memory at `address`.
+---Writes an unsigned qword (8 bytes) to memory at `address`.
 ---@param address integer
 ---@param data qword
 ---@return nil
@@ -436,6 +452,57 @@ function memory.writedouble(address, data) end
 ---@return nil
 function memory.writesize(address, size, data) end
 
+---Reads `length` bytes from memory at `address` and returns them as a string,
+---in the order they have in the N64's memory.
+---@nodiscard
+---@param address integer
+---@param length integer
+---@return string
+function memory.readbytes(address, length) end
+
+---Writes the bytes of `data` to memory at `address`.
+---@param address integer
+---@param data string
+---@return nil
+function memory.writebytes(address, data) end
+
+---Reads `count` consecutive values of `type` from memory at `address` and
+---returns them as an array. If `result` is provided, the values are stored
+---into it instead of a new table, so it can be reused across calls.
+---@nodiscard
+---@param address integer
+---@param count integer
+---@param type memtype
+---@param result table?
+---@return number[]
+function memory.readarray(address, count, type, result) end
+
+---Writes the values of the array `data` as consecutive values of `type` to
+---memory at `address`.
+---@param address integer
+---@param type memtype
+---@param data number[]
+---@return nil
+function memory.writearray(address, type, data) end
+
+---Compiles a struct layout for `memory.readstruct`. `fields` maps each field's
+---name to a table of its offset and type, e.g. `{ x = {0x0, "f32"} }`.
+---@nodiscard
+---@param fields table<string, [integer, memtype]>
+---@return userdata
+function memory.compilestruct(fields) end
+
+---Reads all fields of `layout` from the struct at `address` and returns them
+---as a table keyed by field name. `layout` is either a compiled layout or a
+---table of fields, which is compiled on every call. If `result` is provided,
+---the fields are stored into it instead of a new table.
+---@nodiscard
+---@param address integer
+---@param layout userdata|table<string, [integer, memtype]>
+---@param result table?
+---@return table<string, number>
+function memory.readstruct(address, layout, result) end
+
 --#endregion
 
 